@@ -18,6 +18,7 @@ freelook(0);
 cam_distance(1024.0);
 setCameraViewDistance(32768);
 noclip(0);
+--entity_activation(3);                -- sleep entities farther than 3 rooms from the player
 --playVideo(base_path .. "data/tr3/fmv/logo.rpl");
 --playVideo(base_path .. "data/tr3/fmv/Crsh_Eng.rpl");
 
@@ -57,6 +57,24 @@ controls =
     joy_look_deadzone = 1500;
 }
 
+physics =
+{
+    threads = 1;
+    ragdoll_linear_sleep = 10.00;
+    ragdoll_angular_sleep = 10.00;
+    ragdoll_settle_time = 2.00;
+    ragdoll_bake = 0;
+    room_collision = 0;
+    hair_lod = 1;
+    hair_lod_distance = 4096.00;
+    hair_lod_screen_size = 0.020;
+}
+
+animation =
+{
+    compression = 0;
+}
+
 console =
 {
     background_color = {r = 0, g = 0, b = 0, a = 200};
@@ -969,8 +969,11 @@ inline void		btDbvt::rayTestInternal(	const btDbvtNode* root,
 
 		int								depth=1;
 		int								treshold=DOUBLE_STACKSIZE-2;
-		btAlignedObjectArray<const btDbvtNode*>&	stack = m_rayTestStack;
-		stack.resize(DOUBLE_STACKSIZE);
+		// OpenTomb: local stack instead of shared m_rayTestStack, so world
+		// ray / sweep tests may run on several threads at the same time
+		const btDbvtNode*				local_stack[DOUBLE_STACKSIZE];
+		btAlignedObjectArray<const btDbvtNode*>	heap_stack;
+		const btDbvtNode**				stack = local_stack;
 		stack[0]=root;
 		btVector3 bounds[2];
 		do	
@@ -987,8 +990,17 @@ inline void		btDbvt::rayTestInternal(	const btDbvtNode* root,
 				{
 					if(depth>treshold)
 					{
-						stack.resize(stack.size()*2);
-						treshold=stack.size()-2;
+						if(stack==local_stack)
+						{
+							heap_stack.resize(DOUBLE_STACKSIZE*2);
+							for(int i=0;i<depth;++i) heap_stack[i]=local_stack[i];
+						}
+						else
+						{
+							heap_stack.resize(heap_stack.size()*2);
+						}
+						stack=&heap_stack[0];
+						treshold=heap_stack.size()-2;
 					}
 					stack[depth++]=node->childs[0];
 					stack[depth++]=node->childs[1];
@@ -1,10 +1,13 @@
 #include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL_timer.h>
 
 #include "core/vmath.h"
 #include "core/obb.h"
 #include "core/system.h"
 #include "core/console.h"
 #include "core/polygon.h"
+#include "core/thread_pool.h"
 #include "core/obb.h"
 #include "render/render.h"
 #include "script/script.h"
@@ -17,6 +20,7 @@
 #include "character_controller.h"
 #include "engine.h"
 #include "entity.h"
+#include "entity_grid.h"
 #include "skeletal_model.h"
 #include "resource.h"
 #include "engine_string.h"
@@ -27,6 +31,19 @@
 void Character_CollisionCallback(struct entity_s *ent, struct collision_node_s *cn);
 void Character_FixByBox(struct entity_s *ent);
 
+static struct
+{
+    float               budget;                 // ms per frame
+    float               used;                   // ms, current frame
+    uint32_t            frame;
+    ai_stats_t          current;
+    ai_stats_t          last_frame;
+} ai_scheduler = {AI_DEFAULT_BUDGET};
+
+static character_probes_stats_t probes_stats = {0};
+
+static void Character_ProbeHeight(struct entity_s *ent, float pos[3], struct height_info_s *fc, float v_offset);
+
 void Character_Create(struct entity_s *ent)
 {
     if(ent && !ent->character)
@@ -53,6 +70,19 @@ void Character_Create(struct entity_s *ent)
         ret->ragdoll = NULL;
         ret->ai_zone = 0;
         ret->ai_zone_type = ZONE_TYPE_ALL;
+        ret->think.frame = 0;
+        ret->think.deferred = 0;
+        ret->think.allowed = 0x00;
+        ret->think.sight = 0x00;
+        ret->think.sight_target = ENTITY_ID_NONE;
+        ret->probes.count = 0;
+        ret->probes.next = 0;
+        ret->probes.world_stamp = 0;
+        ret->probes.rooms_stamp = 0;
+        ret->probes.room = NULL;
+        ret->probes.sector = NULL;
+        ret->probes.steps_count = 0;
+        ret->probes.steps_frame = 0;
 
         ret->bone_head = 0x00;
         ret->bone_torso = 0x00;
@@ -201,7 +231,9 @@ void Character_Update(struct entity_s *ent)
 
         if(!is_player && !ent->character->state.dead && (ent->character->ai_zone >= 0))
         {
+            uint64_t start = SDL_GetPerformanceCounter();
             Character_UpdateAI(ent);
+            ai_scheduler.current.ai_time += 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
         }
         Character_ApplyCommands(ent);
 
@@ -229,6 +261,96 @@ void Character_Update(struct entity_s *ent)
 }
 
 
+/*
+ * AI SCHEDULER
+ * Expensive decisions (path replanning, sight tests) are done by enemy think
+ * rate: each frame for near enemies with target, every AI_FAR_INTERVAL /
+ * AI_IDLE_INTERVAL frames for far / idle ones, staggered by entity id. When
+ * frame budget is spent, decisions are deferred to the next frames (deferred
+ * enemies ignore the rate), after AI_MAX_DEFER frames they are done anyway.
+ */
+static int Character_AIThinkInterval(struct entity_s *ent)
+{
+    entity_p player = World_GetPlayer();
+    if(ent->character->target_id == ENTITY_ID_NONE)
+    {
+        return AI_IDLE_INTERVAL;
+    }
+    if(player && (vec3_dist_sq(player->transform.M4x4 + 12, ent->transform.M4x4 + 12) > AI_FAR_DISTANCE * AI_FAR_DISTANCE))
+    {
+        return AI_FAR_INTERVAL;
+    }
+    return 1;
+}
+
+
+static int Character_AICanThink(struct entity_s *ent)
+{
+    character_p ch = ent->character;
+    if(ch->think.frame == ai_scheduler.frame)
+    {
+        return ch->think.allowed;                                               // already decided for the frame
+    }
+
+    ch->think.frame = ai_scheduler.frame;
+    ch->think.allowed = 0x00;
+    if((ch->think.deferred == 0) && ((ai_scheduler.frame + ent->id) % Character_AIThinkInterval(ent) != 0))
+    {
+        ai_scheduler.current.skipped++;
+        return 0;
+    }
+    if((ai_scheduler.budget > 0.0f) && (ai_scheduler.used >= ai_scheduler.budget))
+    {
+        if(ch->think.deferred < AI_MAX_DEFER)
+        {
+            ch->think.deferred++;
+            ai_scheduler.current.deferred++;
+            return 0;
+        }
+        ai_scheduler.current.forced++;
+    }
+    ch->think.deferred = 0;
+    ch->think.allowed = 0x01;
+    return 1;
+}
+
+
+static void Character_AIThinkDone(uint64_t start)
+{
+    float ms = 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+    ai_scheduler.used += ms;
+    ai_scheduler.current.think_time += ms;
+    ai_scheduler.current.thinks++;
+}
+
+
+void Character_AIBeginFrame()
+{
+    ai_scheduler.last_frame = ai_scheduler.current;
+    memset(&ai_scheduler.current, 0x00, sizeof(ai_scheduler.current));
+    ai_scheduler.used = 0.0f;
+    ai_scheduler.frame++;
+}
+
+
+void Character_SetAIBudget(float ms)
+{
+    ai_scheduler.budget = ms;
+}
+
+
+float Character_GetAIBudget()
+{
+    return ai_scheduler.budget;
+}
+
+
+void Character_GetAIStats(ai_stats_p stats)
+{
+    *stats = ai_scheduler.last_frame;
+}
+
+
 void Character_UpdatePath(struct entity_s *ent, struct room_sector_s *target)
 {
     if(ent->character && ent->self->sector && ent->self->sector->box && target && target->box)
@@ -241,7 +363,7 @@ void Character_UpdatePath(struct entity_s *ent, struct room_sector_s *target)
         op.zone_alt = ent->self->room->is_swapped;
         op.step_up = (ent->character->max_step_up_height > ent->character->max_climb_height) ? (ent->character->max_step_up_height) : (ent->character->max_climb_height);
         op.step_down = ent->character->fall_down_height;
-        int dist = Room_FindPath(path, World_GetRoomBoxesCount(), ent->self->sector, target, &op);
+        int dist = Room_FindPathCached(path, World_GetRoomBoxesCount(), ent->self->sector, target, &op);
         const int max_dist = sizeof(ent->character->path) / sizeof(ent->character->path[0]);
         ent->character->path_dist = (dist > max_dist) ? (max_dist) : dist;
 
@@ -333,9 +455,11 @@ void Character_GoByPathToTarget(struct entity_s *ent, struct entity_s *target)
             return;
         }
 
-        if(ent->self->sector->box->id != ent->character->path[0]->id)
+        if((ent->self->sector->box->id != ent->character->path[0]->id) && Character_AICanThink(ent))
         {
+            uint64_t start = SDL_GetPerformanceCounter();
             Character_UpdatePath(ent, ent->character->path_target);
+            Character_AIThinkDone(start);
             if(ent->character->path_dist == 0)
             {
                 return;
@@ -434,6 +558,7 @@ void Character_GoByPathToTarget(struct entity_s *ent, struct entity_s *target)
 void Character_UpdateAI(struct entity_s *ent)
 {
     entity_p target = World_GetEntityByID(ent->character->target_id);
+    ai_scheduler.current.updates++;
     if(target)
     {
         if(target->character && target->character->state.dead)
@@ -443,10 +568,12 @@ void Character_UpdateAI(struct entity_s *ent)
             return;
         }
         Character_LookAtTarget(ent, target);
-        if(target->self->sector && (ent->character->path_target != target->self->sector))
+        if(target->self->sector && (ent->character->path_target != target->self->sector) && Character_AICanThink(ent))
         {
+            uint64_t start = SDL_GetPerformanceCounter();
             ent->character->path_target = target->self->sector;
             Character_UpdatePath(ent, ent->character->path_target);
+            Character_AIThinkDone(start);
         }
     }
 
@@ -511,21 +638,27 @@ void Character_UpdateCurrentSpeed(struct entity_s *ent, int zeroVz)
     ent->speed[2] = vz;
 }
 
+static void Character_GetCurrentHeightPos(struct entity_s *ent, float from[3])
+{
+    float *v = ent->bf->bone_tags[0].local_transform + 12;
+
+    Mat4_vec3_mul_macro(from, ent->transform.M4x4, v);
+    from[2] -= ent->speed[2] * engine_frame_time;
+    from[0] = ent->transform.M4x4[12 + 0];
+    from[1] = ent->transform.M4x4[12 + 1];
+}
+
+
 /**
  * Calculates next height info and information about next step
  * @param ent
  */
 void Character_UpdateCurrentHeight(struct entity_s *ent)
 {
-    float from[3], *v;
-    height_info_p hi = &ent->character->height_info;
+    float from[3];
 
-    v = ent->bf->bone_tags[0].local_transform + 12;
-    Mat4_vec3_mul_macro(from, ent->transform.M4x4, v);
-    from[2] -= ent->speed[2] * engine_frame_time;
-    from[0] = ent->transform.M4x4[12 + 0];
-    from[1] = ent->transform.M4x4[12 + 1];
-    Character_GetHeightInfo(from, hi, ent->character->height);
+    Character_GetCurrentHeightPos(ent, from);
+    Character_ProbeHeight(ent, from, &ent->character->height_info, ent->character->height);
 }
 
 /**
@@ -626,10 +759,9 @@ void Character_GetHeightInfo(float pos[3], struct height_info_s *fc, float v_off
  * @function calculates next floor info + fantom filter + returns step info.
  * Current height info must be calculated!
  */
-int Character_CheckNextStep(struct entity_s *ent, float offset[3], struct height_info_s *nfc)
+static int Character_CheckNextStepRaw(struct entity_s *ent, height_info_p fc, float offset[3], struct height_info_s *nfc)
 {
     float pos[3], from[3], to[3], delta;
-    height_info_p fc = &ent->character->height_info;
     int ret = CHARACTER_STEP_HORIZONTAL;
     ///penetration test?
 
@@ -766,7 +898,7 @@ void Character_GetMiddleHandsPos(const struct entity_s *ent, float pos[3])
  *    |             |
  * to *-------------*
  */
-void Character_CheckClimbability(struct entity_s *ent, struct climb_info_s *climb, float test_from[3], float test_to[3])
+static void Character_CheckClimbabilityRaw(struct entity_s *ent, struct climb_info_s *climb, float test_from[3], float test_to[3])
 {
     const float z_step = -0.66f * ent->character->climb_r;
     float from[3], to[3];
@@ -1012,7 +1144,7 @@ void Character_CheckClimbability(struct entity_s *ent, struct climb_info_s *clim
 }
 
 
-void Character_CheckWallsClimbability(struct entity_s *ent, struct climb_info_s *climb)
+static void Character_CheckWallsClimbabilityRaw(struct entity_s *ent, struct climb_info_s *climb)
 {
     float from[3], to[3], t;
     collision_result_t cb;
@@ -1051,7 +1183,7 @@ void Character_CheckWallsClimbability(struct entity_s *ent, struct climb_info_s
     to[1] += ent->transform.M4x4[4 + 1] * t;
 
     to[2] -= ent->character->min_step_up_height;
-    Character_CheckClimbability(ent, climb, from, to);
+    Character_CheckClimbabilityRaw(ent, climb, from, to);
     to[2] += ent->character->min_step_up_height;
     if(Physics_SphereTest(&cb, from, to, ent->character->climb_r, ent->self, COLLISION_FILTER_HEIGHT_TEST))
     {
@@ -1082,6 +1214,379 @@ void Character_CheckWallsClimbability(struct entity_s *ent, struct climb_info_s
 }
 
 
+/*
+ * Environment probes cache
+ */
+static uint32_t Character_ProbesRoomsStamp(struct room_s *room)
+{
+    uint32_t ret = 0;
+    if(room)
+    {
+        ret = room->collision_stamp;                                            // stamps only grow, so the sum changes with any of them
+        for(uint16_t i = 0; i < room->content->near_room_list_size; i++)
+        {
+            ret += room->content->near_room_list[i]->collision_stamp;
+        }
+    }
+    return ret;
+}
+
+
+static void Character_ProbesReset(struct entity_s *ent, uint32_t stamp, uint32_t rooms_stamp)
+{
+    character_probes_p cache = &ent->character->probes;
+
+    cache->world_stamp = stamp;
+    cache->rooms_stamp = rooms_stamp;
+    cache->room = ent->self->room;
+    cache->sector = ent->self->sector;
+    memcpy(cache->transform, ent->transform.M4x4, sizeof(cache->transform));
+    cache->count = 0;
+    cache->next = 0;
+}
+
+
+static void Character_ProbesValidate(struct entity_s *ent)
+{
+    character_probes_p cache = &ent->character->probes;
+    uint32_t stamp = Physics_GetWorldStamp();
+    uint32_t rooms_stamp = Character_ProbesRoomsStamp(ent->self->room);
+
+    if((cache->world_stamp != stamp) || (cache->rooms_stamp != rooms_stamp) || (cache->room != ent->self->room) || (cache->sector != ent->self->sector) ||
+       memcmp(cache->transform, ent->transform.M4x4, sizeof(cache->transform)))
+    {
+        if(cache->count > 0)
+        {
+            probes_stats.invalidations++;
+        }
+        Character_ProbesReset(ent, stamp, rooms_stamp);
+    }
+}
+
+
+static void Character_ProbeKey(character_probe_p key, uint16_t type, struct engine_container_s *self, const float offset[3], const float *a, const float *b)
+{
+    memset(key, 0, sizeof(character_probe_t));
+    key->type = type;
+    key->self = self;
+    key->offset[0] = (int32_t)(offset[0] * CHARACTER_PROBE_QUANT);
+    key->offset[1] = (int32_t)(offset[1] * CHARACTER_PROBE_QUANT);
+    key->offset[2] = (int32_t)(offset[2] * CHARACTER_PROBE_QUANT);
+    if(a)
+    {
+        vec3_copy(key->args, a);
+    }
+    if(b)
+    {
+        vec3_copy(key->args + 3, b);
+    }
+}
+
+
+static character_probe_p Character_FindProbe(struct entity_s *ent, character_probe_p key)
+{
+    character_probes_p cache = &ent->character->probes;
+
+    probes_stats.requested++;
+    Character_ProbesValidate(ent);
+    for(character_probe_p p = cache->probes; p < cache->probes + cache->count; ++p)
+    {
+        if((p->type != key->type) || (p->offset[0] != key->offset[0]) || (p->offset[1] != key->offset[1]) ||
+           (p->offset[2] != key->offset[2]) || (p->self != key->self) || memcmp(p->args, key->args, sizeof(p->args)))
+        {
+            continue;
+        }
+
+        switch(p->type)
+        {
+            case CHARACTER_PROBE_HEIGHT:
+            case CHARACTER_PROBE_NEXT_STEP:
+                // previous floor point is used only in quicksand, so it is the part of the key in that case
+                if(!p->fc.quicksand || (p->floor_z == key->floor_z))
+                {
+                    break;
+                }
+                continue;
+
+            case CHARACTER_PROBE_CLIMB:
+            case CHARACTER_PROBE_WALLS:
+                // probe rewrites the same fields for the same input, the others are kept
+                if(!memcmp(&key->climb_in, &p->climb_in, sizeof(climb_info_t)) ||
+                   !memcmp(&key->climb_in, &p->climb_out, sizeof(climb_info_t)))
+                {
+                    break;
+                }
+                continue;
+        };
+
+        if(p->prefetched)
+        {
+            probes_stats.prefetch_hits++;
+            p->prefetched = 0x00;
+        }
+        return p;
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Must be called right after the real probe, without cache validation:
+ * probe may move character to the other room, so the next request drops cache.
+ */
+static character_probe_p Character_StoreProbe(struct entity_s *ent, character_probe_p key)
+{
+    character_probes_p cache = &ent->character->probes;
+    character_probe_p p;
+
+    if(cache->count < CHARACTER_PROBES_CACHE_SIZE)
+    {
+        p = cache->probes + cache->count++;
+    }
+    else
+    {
+        p = cache->probes + cache->next;
+        cache->next = (cache->next + 1) % CHARACTER_PROBES_CACHE_SIZE;
+    }
+    *p = *key;
+
+    return p;
+}
+
+
+static character_probe_p Character_AddProbe(struct entity_s *ent, character_probe_p key)
+{
+    probes_stats.executed++;
+    return Character_StoreProbe(ent, key);
+}
+
+
+static void Character_CopyHeightInfo(height_info_p dst, height_info_p src)
+{
+    dst->floor_hit = src->floor_hit;
+    dst->ceiling_hit = src->ceiling_hit;
+    dst->transition_level = src->transition_level;
+    dst->water = src->water;
+    dst->quicksand = src->quicksand;
+}
+
+
+static void Character_HeightProbeKey(struct entity_s *ent, character_probe_p key, float pos[3], struct height_info_s *fc, float v_offset)
+{
+    float offset[3], a[3] = {v_offset, 0.0f, 0.0f};
+
+    vec3_sub(offset, pos, ent->transform.M4x4 + 12);
+    Character_ProbeKey(key, CHARACTER_PROBE_HEIGHT, fc->self, offset, pos, a);
+    key->floor_z = fc->floor_hit.point[2];
+}
+
+
+static void Character_ProbeHeight(struct entity_s *ent, float pos[3], struct height_info_s *fc, float v_offset)
+{
+    character_probe_t key;
+    character_probe_p p;
+
+    Character_HeightProbeKey(ent, &key, pos, fc, v_offset);
+    p = Character_FindProbe(ent, &key);
+    if(p)
+    {
+        Character_CopyHeightInfo(fc, &p->fc);
+        return;
+    }
+
+    Character_GetHeightInfo(pos, fc, v_offset);
+    p = Character_AddProbe(ent, &key);
+    Character_CopyHeightInfo(&p->fc, fc);
+}
+
+
+void Character_ProbeHeightInfo(struct entity_s *ent, float pos[3], struct height_info_s *fc)
+{
+    Character_ProbeHeight(ent, pos, fc, 0.0f);
+}
+
+
+static void Character_NextStepProbeKey(character_probe_p key, height_info_p fc, float offset[3], struct height_info_s *nfc)
+{
+    float floor[3] = {(float)fc->floor_hit.hit, fc->floor_hit.point[2], 0.0f};
+
+    Character_ProbeKey(key, CHARACTER_PROBE_NEXT_STEP, nfc->self, offset, offset, floor);
+    key->floor_z = nfc->floor_hit.point[2];
+}
+
+
+/*
+ * Remembers next step offset for the next frame prefetch.
+ */
+static void Character_RecordStep(struct entity_s *ent, float offset[3])
+{
+    character_probes_p cache = &ent->character->probes;
+
+    if(cache->steps_frame != ai_scheduler.frame)
+    {
+        cache->steps_frame = ai_scheduler.frame;
+        cache->steps_count = 0;
+    }
+    for(uint16_t i = 0; i < cache->steps_count; i++)
+    {
+        if(!memcmp(cache->steps[i], offset, 3 * sizeof(float)))
+        {
+            return;
+        }
+    }
+    if(cache->steps_count < CHARACTER_PREFETCH_STEPS)
+    {
+        vec3_copy(cache->steps[cache->steps_count], offset);
+        cache->steps_count++;
+    }
+}
+
+
+/**
+ * @function calculates next floor info + fantom filter + returns step info.
+ * Current height info must be calculated! Result is cached for the character.
+ */
+int Character_CheckNextStep(struct entity_s *ent, float offset[3], struct height_info_s *nfc)
+{
+    height_info_p fc = &ent->character->height_info;
+    character_probe_t key;
+    character_probe_p p;
+
+    Character_RecordStep(ent, offset);
+    Character_NextStepProbeKey(&key, fc, offset, nfc);
+    p = Character_FindProbe(ent, &key);
+    if(p)
+    {
+        Character_CopyHeightInfo(nfc, &p->fc);
+        return p->ret;
+    }
+
+    key.ret = Character_CheckNextStepRaw(ent, fc, offset, nfc);
+    p = Character_AddProbe(ent, &key);
+    Character_CopyHeightInfo(&p->fc, nfc);
+    return key.ret;
+}
+
+
+/**
+ * Cached for the character Character_CheckClimbabilityRaw, see above.
+ */
+void Character_CheckClimbability(struct entity_s *ent, struct climb_info_s *climb, float test_from[3], float test_to[3])
+{
+    character_probe_t key;
+    character_probe_p p;
+    float offset[3];
+
+    vec3_sub(offset, test_from, ent->transform.M4x4 + 12);
+    Character_ProbeKey(&key, CHARACTER_PROBE_CLIMB, ent->self, offset, test_from, test_to);
+    key.climb_in = *climb;
+    p = Character_FindProbe(ent, &key);
+    if(p)
+    {
+        *climb = p->climb_out;
+        test_to[2] = p->to_z;
+        return;
+    }
+
+    Character_CheckClimbabilityRaw(ent, climb, test_from, test_to);
+    p = Character_AddProbe(ent, &key);
+    p->climb_out = *climb;
+    p->to_z = test_to[2];
+}
+
+
+void Character_CheckWallsClimbability(struct entity_s *ent, struct climb_info_s *climb)
+{
+    height_info_p fc = &ent->character->height_info;
+    character_probe_t key;
+    character_probe_p p;
+    float hands[3], offset[3], flags[3] = {(float)fc->walls_climb, (float)fc->walls_climb_dir, 0.0f};
+
+    Character_GetMiddleHandsPos(ent, hands);
+    vec3_sub(offset, hands, ent->transform.M4x4 + 12);
+    Character_ProbeKey(&key, CHARACTER_PROBE_WALLS, ent->self, offset, hands, flags);
+    key.climb_in = *climb;
+    p = Character_FindProbe(ent, &key);
+    if(p)
+    {
+        *climb = p->climb_out;
+        return;
+    }
+
+    Character_CheckWallsClimbabilityRaw(ent, climb);
+    p = Character_AddProbe(ent, &key);
+    p->climb_out = *climb;
+}
+
+
+void Character_GetProbesStats(character_probes_stats_p stats)
+{
+    *stats = probes_stats;
+}
+
+
+void Character_ResetProbesStats()
+{
+    probes_stats.requested = 0;
+    probes_stats.executed = 0;
+    probes_stats.invalidations = 0;
+    probes_stats.prefetched = 0;
+    probes_stats.prefetch_hits = 0;
+}
+
+
+/*
+ * Runs on worker thread: only the own character cache is changed, collision
+ * world and rooms are only read; probes are the same as the serial ones.
+ */
+static void Character_PrefetchJob(void *data, int index, int /*thread_index*/)
+{
+    entity_p ent = ((entity_p*)data)[index];
+    character_probes_p cache = &ent->character->probes;
+    height_info_t fc = ent->character->height_info;
+    character_probe_t key;
+    character_probe_p p;
+    float from[3];
+
+    Character_ProbesReset(ent, Physics_GetWorldStamp(), Character_ProbesRoomsStamp(ent->self->room));
+    Character_GetCurrentHeightPos(ent, from);
+    Character_HeightProbeKey(ent, &key, from, &fc, ent->character->height);
+    Character_GetHeightInfo(from, &fc, ent->character->height);
+    Character_CopyHeightInfo(&key.fc, &fc);
+    key.prefetched = 0x01;
+    Character_StoreProbe(ent, &key);
+
+    // next steps of the previous frame, they are requested from just calculated current height
+    for(uint16_t i = 0; (cache->steps_frame + 1 >= ai_scheduler.frame) && (i < cache->steps_count); i++)
+    {
+        height_info_t nfc;
+        memset(&nfc, 0x00, sizeof(height_info_t));
+        nfc.self = ent->self;
+        Character_NextStepProbeKey(&key, &fc, cache->steps[i], &nfc);
+        key.ret = Character_CheckNextStepRaw(ent, &fc, cache->steps[i], &nfc);
+        key.prefetched = 0x01;
+        p = Character_StoreProbe(ent, &key);
+        Character_CopyHeightInfo(&p->fc, &nfc);
+    }
+}
+
+
+/*
+ * Two phase characters update: probes, requested by state control in previous
+ * frame, are executed in parallel for all frame characters before their logic,
+ * state control takes results from the probes cache.
+ */
+void Character_PrefetchProbes(struct entity_s **list, uint32_t count)
+{
+    ThreadPool_ParallelFor(Character_PrefetchJob, list, count);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        probes_stats.prefetched += list[i]->character->probes.count;
+    }
+}
+
+
 void Character_SetToJump(struct entity_s *ent, float v_vertical, float v_horizontal)
 {
     // Jump length is a speed value multiplied by global speed coefficient.
@@ -2289,6 +2794,10 @@ int Character_ChangeParam(struct entity_s *ent, int parameter, float value)
 }
 
 
+/*
+ * For AI characters sight test result is cached per target and is updated by
+ * the scheduler rate; facing check is done each call.
+ */
 int Character_IsTargetAccessible(struct entity_s *character, struct entity_s *target)
 {
     int ret = 0;
@@ -2299,7 +2808,22 @@ int Character_IsTargetAccessible(struct entity_s *character, struct entity_s *ta
         vec3_sub(dir, target->transform.M4x4 + 12, character->transform.M4x4 + 12);
         vec3_norm(dir, t);
         t = vec3_dot(character->transform.M4x4 + 4, dir);
-        ret = (t > 0.0f) && (!Physics_RayTest(&cs, character->obb->centre, target->obb->centre, character->self, COLLISION_FILTER_CHARACTER) || (cs.obj == target->self));
+        if(t > 0.0f)
+        {
+            character_p ch = (character != World_GetPlayer()) ? (character->character) : (NULL);
+            if(ch && (ch->think.sight_target == target->id) && !Character_AICanThink(character))
+            {
+                return ch->think.sight;
+            }
+            uint64_t start = SDL_GetPerformanceCounter();
+            ret = !World_LongRayTest(&cs, character->obb->centre, target->obb->centre, character->self, COLLISION_FILTER_CHARACTER) || (cs.obj == target->self);
+            if(ch)
+            {
+                Character_AIThinkDone(start);
+                ch->think.sight_target = target->id;
+                ch->think.sight = (ret) ? (0x01) : (0x00);
+            }
+        }
     }
 
     return ret;
@@ -2309,34 +2833,41 @@ int Character_IsTargetAccessible(struct entity_s *character, struct entity_s *ta
 struct entity_s *Character_FindTarget(struct entity_s *ent)
 {
     entity_p ret = NULL;
+    entity_p buf[64];
+    entity_p *candidates = buf;
     float max_dot = 0.0f;
     collision_result_t cs;
+    int count = EntityGrid_QueryCone(ent->self->room, ent->transform.M4x4 + 12, ent->transform.M4x4 + 4, 0.0f, DEFAULT_CHARACTER_TARGET_DISTANCE, candidates, 64);
 
-    for(int ri = -1; ri < ent->self->room->content->near_room_list_size; ++ri)
+    if(count > 64)
     {
-        room_p r = (ri >= 0) ? (ent->self->room->content->near_room_list[ri]) : (ent->self->room);
-        for(engine_container_p cont = r->containers; cont; cont = cont->next)
+        candidates = (entity_p*)Sys_GetTempMem(count * sizeof(entity_p));
+        EntityGrid_QueryCone(ent->self->room, ent->transform.M4x4 + 12, ent->transform.M4x4 + 4, 0.0f, DEFAULT_CHARACTER_TARGET_DISTANCE, candidates, count);
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        entity_p target = candidates[i];
+        if((target != ent) && (target->type_flags & ENTITY_TYPE_ACTOR) && (target->state_flags & ENTITY_STATE_ACTIVE) &&
+           (!target->character || (target->character->parameters.param[PARAM_HEALTH] > 0.0f)))
         {
-            if(cont->object_type == OBJECT_ENTITY)
+            float dir[3], t;
+            vec3_sub(dir, target->transform.M4x4 + 12, ent->transform.M4x4 + 12);
+            vec3_norm(dir, t);
+            t = vec3_dot(ent->transform.M4x4 + 4, dir);
+            if((t > max_dot) && (!World_LongRayTest(&cs, ent->obb->centre, target->obb->centre, ent->self, COLLISION_FILTER_CHARACTER) || (cs.obj == target->self)))
             {
-                entity_p target = (entity_p)cont->object;
-                if((target->type_flags & ENTITY_TYPE_ACTOR) && (target->state_flags & ENTITY_STATE_ACTIVE) &&
-                   (!target->character || (target->character->parameters.param[PARAM_HEALTH] > 0.0f)))
-                {
-                    float dir[3], t;
-                    vec3_sub(dir, target->transform.M4x4 + 12, ent->transform.M4x4 + 12);
-                    vec3_norm(dir, t);
-                    t = vec3_dot(ent->transform.M4x4 + 4, dir);
-                    if((t > max_dot) && (!Physics_RayTest(&cs, ent->obb->centre, target->obb->centre, ent->self, COLLISION_FILTER_CHARACTER) || (cs.obj == target->self)))
-                    {
-                        max_dot = t;
-                        ret = target;
-                    }
-                }
+                max_dot = t;
+                ret = target;
             }
         }
     }
 
+    if(candidates != buf)
+    {
+        Sys_ReturnTempMem(count * sizeof(entity_p));
+    }
+
     return ret;
 }
 
@@ -96,6 +96,14 @@
 #define DEFAULT_CHARACTER_WADE_DEPTH            (256.0)
 // If less than this much of Lara is looking out of the water, she goes from wading to swimming.
 #define DEFAULT_CHARACTER_SWIM_DEPTH            (100.0) ///@FIXME: Guess
+#define DEFAULT_CHARACTER_TARGET_DISTANCE       (8192.0f)                       // weapons lock on range, 8 sectors
+
+// AI scheduler: path replanning and sight tests are spread across frames
+#define AI_DEFAULT_BUDGET                       (1.0f)                          // ms per frame, <= 0 - unlimited
+#define AI_FAR_DISTANCE                         (8192.0f)                       // farther from player enemies think at reduced rate
+#define AI_FAR_INTERVAL                         (4)                             // frames between decisions of far enemies
+#define AI_IDLE_INTERVAL                        (8)                             // frames between decisions of enemies without target
+#define AI_MAX_DEFER                            (8)                             // frames, decision is done over budget after that
 
 // Speed limits
 
@@ -257,6 +265,78 @@ typedef struct character_stats_s
 }character_stats_t, *character_stats_p;
 
 
+typedef struct ai_stats_s
+{
+    uint32_t    updates;                // Character_UpdateAI calls
+    uint32_t    thinks;                 // path replans and sight tests done
+    uint32_t    skipped;                // not due by enemy think rate
+    uint32_t    deferred;               // due, but out of frame budget
+    uint32_t    forced;                 // done out of budget after AI_MAX_DEFER frames
+    float       ai_time;                // ms, whole AI update
+    float       think_time;             // ms, path replans and sight tests
+}ai_stats_t, *ai_stats_p;
+
+/*
+ * Environment probes cache: next step, climbability and walls climbability
+ * probes (and heights, requested through Character_ProbeHeightInfo) are reused
+ * if they are requested again with the same arguments (quantized offset from
+ * the character position is the fast key) and the same input structure; cache
+ * is dropped when character moves, collision world changes or height tests
+ * visible bodies move in character room or near rooms (characters moving by
+ * logic do not drop other characters caches).
+ * Character_PrefetchProbes fills caches of the frame characters before their
+ * logic update on worker threads (collision world is not changed there):
+ * current height and next steps, requested by state control in previous frame.
+ */
+#define CHARACTER_PROBES_CACHE_SIZE     (8)
+#define CHARACTER_PROBE_QUANT           (8.0f)          // quantized offset steps per unit
+#define CHARACTER_PREFETCH_STEPS        (4)             // next step probes recorded for prefetch
+
+#define CHARACTER_PROBE_HEIGHT          (0x00)
+#define CHARACTER_PROBE_NEXT_STEP       (0x01)
+#define CHARACTER_PROBE_CLIMB           (0x02)
+#define CHARACTER_PROBE_WALLS           (0x03)
+
+typedef struct character_probe_s
+{
+    uint16_t                    type;
+    int8_t                      ret;                    // next step result
+    uint8_t                     prefetched;             // done by Character_PrefetchProbes, not used yet
+    int32_t                     offset[3];              // quantized offset from character position
+    struct engine_container_s  *self;
+    float                       args[6];
+    float                       floor_z;                // input floor, used by quicksand test
+    float                       to_z;                   // climbability test_to[2] output
+    struct height_info_s        fc;
+    struct climb_info_s         climb_in;
+    struct climb_info_s         climb_out;
+}character_probe_t, *character_probe_p;
+
+typedef struct character_probes_s
+{
+    uint32_t                    world_stamp;
+    uint32_t                    rooms_stamp;            // sum of character room and near rooms collision stamps
+    struct room_s              *room;
+    struct room_sector_s       *sector;
+    float                       transform[16];
+    uint16_t                    count;
+    uint16_t                    next;                   // replaced one, when cache is full
+    uint16_t                    steps_count;
+    uint32_t                    steps_frame;            // AI frame, steps were recorded in
+    float                       steps[CHARACTER_PREFETCH_STEPS][3];     // next step offsets requested by state control
+    struct character_probe_s    probes[CHARACTER_PROBES_CACHE_SIZE];
+}character_probes_t, *character_probes_p;
+
+typedef struct character_probes_stats_s
+{
+    uint32_t    requested;
+    uint32_t    executed;
+    uint32_t    invalidations;          // caches dropped by character moving or collision world changes
+    uint32_t    prefetched;             // probes done by worker threads
+    uint32_t    prefetch_hits;          // prefetched probes used by state control
+}character_probes_stats_t, *character_probes_stats_p;
+
+
 typedef struct character_s
 {
     struct entity_s            *ent;                    // actor entity
@@ -276,6 +356,14 @@ typedef struct character_s
     struct room_sector_s       *path_target;
     int16_t                     ai_zone;
     uint16_t                    ai_zone_type;
+    struct
+    {
+        uint32_t                frame;                  // scheduler frame of the last decision check
+        uint16_t                deferred;               // frames waiting for budget
+        uint16_t                allowed : 1;            // decision check result for the frame
+        uint16_t                sight : 1;              // cached Character_IsTargetAccessible result
+        uint32_t                sight_target;
+    }                           think;
 
     uint16_t                    bone_head;
     uint16_t                    bone_torso;
@@ -310,6 +398,7 @@ typedef struct character_s
 
     struct height_info_s        height_info;
     struct climb_info_s         climb;
+    struct character_probes_s   probes;
 
     struct entity_s            *traversed_object;
 }character_t, *character_p;
@@ -320,13 +409,21 @@ void Character_Update(struct entity_s *ent);
 void Character_UpdatePath(struct entity_s *ent, struct room_sector_s *target);
 void Character_GoByPathToTarget(struct entity_s *ent, struct entity_s *target);
 void Character_UpdateAI(struct entity_s *ent);
+void Character_AIBeginFrame();
+void Character_SetAIBudget(float ms);
+float Character_GetAIBudget();
+void Character_GetAIStats(ai_stats_p stats);                                    // last frame
 
 void Character_GetHeightInfo(float pos[3], struct height_info_s *fc, float v_offset = 0.0);
+void Character_ProbeHeightInfo(struct entity_s *ent, float pos[3], struct height_info_s *fc);     // cached Character_GetHeightInfo
 int  Character_CheckNextStep(struct entity_s *ent, float offset[3], struct height_info_s *nfc);
 int  Character_HasStopSlant(struct entity_s *ent, height_info_p next_fc);
 void Character_GetMiddleHandsPos(const struct entity_s *ent, float pos[3]);
 void Character_CheckClimbability(struct entity_s *ent, struct climb_info_s *climb, float test_from[3], float test_to[3]);
 void Character_CheckWallsClimbability(struct entity_s *ent, struct climb_info_s *climb);
+void Character_GetProbesStats(character_probes_stats_p stats);
+void Character_ResetProbesStats();
+void Character_PrefetchProbes(struct entity_s **list, uint32_t count);
 
 void Character_UpdateCurrentSpeed(struct entity_s *ent, int zeroVz = 0);
 void Character_UpdateCurrentHeight(struct entity_s *ent);
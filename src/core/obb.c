@@ -12,18 +12,17 @@ obb_p OBB_Create()
     obb_p ret;
 
     ret = (obb_p)malloc(sizeof(obb_t));
-    for(int i = 0; i < 6; i++)
-    {
-        ret->base_polygons[i].vertex_count = 0;
-        ret->polygons[i].vertex_count = 0;
-        ret->base_polygons[i].vertices = NULL;
-        ret->polygons[i].vertices = NULL;
-        ret->base_polygons[i].next = NULL;
-        ret->polygons[i].next = NULL;
-        Polygon_Resize(ret->base_polygons + i, 4);
-        Polygon_Resize(ret->polygons + i, 4);
-    }
     ret->transform = NULL;
+    ret->radius = 0.0f;
+    vec3_set_zero(ret->base_centre);
+    vec3_set_zero(ret->centre);
+    vec3_set_zero(ret->extent);
+    vec3_set_zero(ret->axis[0]);
+    vec3_set_zero(ret->axis[1]);
+    vec3_set_zero(ret->axis[2]);
+    ret->axis[0][0] = ret->axis[1][1] = ret->axis[2][2] = 1.0f;
+    ret->polygons = NULL;
+    ret->polygons_valid = 0;
 
     return ret;
 }
@@ -33,10 +32,14 @@ void OBB_Delete(obb_p obb)
 {
     if(obb)
     {
-        for(int i = 0; i < 6; i++)
+        if(obb->polygons)
         {
-            Polygon_Clear(obb->polygons + i);
-            Polygon_Clear(obb->base_polygons + i);
+            for(int i = 0; i < 6; i++)
+            {
+                Polygon_Clear(obb->polygons + i);
+            }
+            free(obb->polygons);
+            obb->polygons = NULL;
         }
         free(obb);
     }
@@ -45,17 +48,42 @@ void OBB_Delete(obb_p obb)
 
 void OBB_Rebuild(obb_p obb, float bb_min[3], float bb_max[3])
 {
-    polygon_p p, p_up, p_down;
-    vertex_p v;
-
     vec3_sub(obb->extent, bb_max, bb_min);
     vec3_mul_scalar(obb->extent, obb->extent, 0.5f);
 
     vec3_add(obb->base_centre, bb_min, bb_max);
     vec3_mul_scalar(obb->base_centre, obb->base_centre, 0.5f);
     obb->radius = vec3_abs(obb->extent);
+    obb->polygons_valid = 0;
+}
+
+
+void OBB_Transform(obb_p obb)
+{
+    if(obb->transform != NULL)
+    {
+        vec3_copy(obb->axis[0], obb->transform + 0);
+        vec3_copy(obb->axis[1], obb->transform + 4);
+        vec3_copy(obb->axis[2], obb->transform + 8);
+        Mat4_vec3_mul_macro(obb->centre, obb->transform, obb->base_centre);
+    }
+    else
+    {
+        vec3_set_zero(obb->axis[0]);
+        vec3_set_zero(obb->axis[1]);
+        vec3_set_zero(obb->axis[2]);
+        obb->axis[0][0] = obb->axis[1][1] = obb->axis[2][2] = 1.0f;
+        vec3_copy(obb->centre, obb->base_centre);
+    }
+    obb->polygons_valid = 0;
+}
+
+
+static void OBB_FillPolygons(polygon_p p, float bb_min[3], float bb_max[3])
+{
+    polygon_p p_up, p_down;
+    vertex_p v;
 
-    p = obb->base_polygons;
     // UP
     p_up = p;
     v = p->vertices;
@@ -183,34 +211,49 @@ void OBB_Rebuild(obb_p obb, float bb_min[3], float bb_max[3])
 }
 
 
-void OBB_Transform(obb_p obb)
+struct polygon_s *OBB_GetPolygons(obb_p obb)
 {
-    if(obb->transform != NULL)
+    if(!obb->polygons)
     {
-        polygon_p p = obb->polygons;
-        polygon_p src_p = obb->base_polygons;
-        
-        for(int i = 0; i < 6; i++, p++, src_p++)
+        obb->polygons = (polygon_p)malloc(6 * sizeof(polygon_t));
+        for(int i = 0; i < 6; i++)
         {
-            vertex_p v = p->vertices;
-            vertex_p src_v = src_p->vertices;
-            Mat4_vec3_rot_macro(p->plane, obb->transform, src_p->plane);
-            for(uint16_t i = 0; i < 4; i++, v++, src_v++)
-            {
-                Mat4_vec3_mul_macro(v->position, obb->transform, src_v->position);
-            }
-            p->plane[3] = -vec3_dot(p->plane, p->vertices[0].position);
+            obb->polygons[i].vertex_count = 0;
+            obb->polygons[i].vertices = NULL;
+            obb->polygons[i].next = NULL;
+            Polygon_Resize(obb->polygons + i, 4);
         }
-        Mat4_vec3_mul_macro(obb->centre, obb->transform, obb->base_centre);
+        obb->polygons_valid = 0;
     }
-    else
+
+    if(!obb->polygons_valid)
     {
-        for(int i = 0; i < 6; i++)
+        float bb_min[3], bb_max[3];
+        vec3_sub(bb_min, obb->base_centre, obb->extent);
+        vec3_add(bb_max, obb->base_centre, obb->extent);
+        OBB_FillPolygons(obb->polygons, bb_min, bb_max);
+        if(obb->transform != NULL)
         {
-            Polygon_Copy(obb->polygons + i, obb->base_polygons + i);
+            polygon_p p = obb->polygons;
+            for(int i = 0; i < 6; i++, p++)
+            {
+                float plane[3];
+                vertex_p v = p->vertices;
+                vec3_copy(plane, p->plane);
+                Mat4_vec3_rot_macro(p->plane, obb->transform, plane);
+                for(uint16_t j = 0; j < 4; j++, v++)
+                {
+                    float pos[3];
+                    vec3_copy(pos, v->position);
+                    Mat4_vec3_mul_macro(v->position, obb->transform, pos);
+                }
+                p->plane[3] = -vec3_dot(p->plane, p->vertices[0].position);
+            }
         }
-        vec3_copy(obb->centre, obb->base_centre);
+        obb->polygons_valid = 1;
     }
+
+    return obb->polygons;
 }
 
 /*
@@ -226,9 +269,9 @@ int OBB_OBB_Test(obb_p obb1, obb_p obb2, float extend)
     
     vec3_sub(v, obb2->centre, obb1->centre);
     //translation, in A's frame
-    T[0] = vec3_dot(v, obb1->transform + 0);
-    T[1] = vec3_dot(v, obb1->transform + 4);
-    T[2] = vec3_dot(v, obb1->transform + 8);
+    T[0] = vec3_dot(v, obb1->axis[0]);
+    T[1] = vec3_dot(v, obb1->axis[1]);
+    T[2] = vec3_dot(v, obb1->axis[2]);
 
     a[0] = obb1->extent[0] + extend;
     a[1] = obb1->extent[1] + extend;
@@ -243,9 +286,7 @@ int OBB_OBB_Test(obb_p obb1, obb_p obb2, float extend)
     {
         for(k = 0 ; k < 3 ; k++)
         {
-            float *e1b = obb1->transform + 4 * i;
-            float *e2b = obb2->transform + 4 * k;
-            R[i][k] = vec3_dot(e1b, e2b);
+            R[i][k] = vec3_dot(obb1->axis[i], obb2->axis[k]);
         }
     }
 
@@ -374,3 +415,45 @@ int OBB_OBB_Test(obb_p obb1, obb_p obb2, float extend)
     the two boxes overlap */
     return 1;
 }
+
+
+/*
+ * Segment from -> to against box slabs; fraction of the first intersection
+ * (0 if from is inside of box).
+ */
+int OBB_RayTest(obb_p obb, const float from[3], const float to[3], float *fraction)
+{
+    float d[3], c[3], t_min = 0.0f, t_max = 1.0f;
+
+    vec3_sub(d, to, from);
+    vec3_sub(c, obb->centre, from);
+    for(int i = 0; i < 3; i++)
+    {
+        float e = vec3_dot(obb->axis[i], c);
+        float f = vec3_dot(obb->axis[i], d);
+        if(fabs(f) > 0.0001f)
+        {
+            float t1 = (e - obb->extent[i]) / f;
+            float t2 = (e + obb->extent[i]) / f;
+            if(t1 > t2)
+            {
+                float t = t1;
+                t1 = t2;
+                t2 = t;
+            }
+            t_min = (t1 > t_min) ? (t1) : (t_min);
+            t_max = (t2 < t_max) ? (t2) : (t_max);
+            if(t_min > t_max)
+            {
+                return 0;
+            }
+        }
+        else if(fabs(e) > obb->extent[i])
+        {
+            return 0;                                                           // parallel to slab and outside of it
+        }
+    }
+
+    *fraction = t_min;
+    return 1;
+}
@@ -18,21 +18,25 @@ extern "C" {
 #include "polygon.h"
 
 /*
- * In base_edges we safe the initial shape polygons
+ * Compact oriented box: centre, axes and half sizes are enough for culling
+ * and overlap tests. Faces polygons are generated only on demand
+ * (debug drawing, collision shape generation) by OBB_GetPolygons.
  */
 
 struct entity_s;
 
 typedef struct obb_s
 {
-    struct polygon_s     base_polygons[6];               // bv base surface
-    struct polygon_s     polygons[6];                    // bv world coordinate surface
     float               *transform;                      // Object transform matrix
     float                radius;
 
     float                base_centre[3];
     float                centre[3];
     float                extent[3];
+    float                axis[3][3];                     // world coordinate basis, filled by OBB_Transform
+
+    struct polygon_s    *polygons;                       // world coordinate surface, NULL until requested
+    int32_t              polygons_valid;
 } obb_t, *obb_p;
 
 obb_p OBB_Create();
@@ -40,7 +44,9 @@ void OBB_Delete(obb_p bv);
 
 void OBB_Rebuild(obb_p obb, float bb_min[3], float bb_max[3]);
 void OBB_Transform(obb_p obb);
+struct polygon_s *OBB_GetPolygons(obb_p obb);                                   // 6 faces; UP, DOWN, OX+, OX-, OY+, OY-
 int OBB_OBB_Test(obb_p obb1, obb_p obb2, float extend);
+int OBB_RayTest(obb_p obb, const float from[3], const float to[3], float *fraction);
 
 #ifdef	__cplusplus
 }
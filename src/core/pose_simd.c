@@ -0,0 +1,348 @@
+
+#include <SDL2/SDL_cpuinfo.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "vmath.h"
+#include "pose_simd.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define POSE_HAVE_SSE 1
+#include <emmintrin.h>
+#endif
+
+#if defined(POSE_HAVE_SSE) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define POSE_HAVE_AVX 1
+#include <immintrin.h>
+#define POSE_TARGET_AVX __attribute__((target("avx")))
+#endif
+
+
+typedef void (*pose_blend_func)(pose_batch_p batch);
+typedef void (*pose_mat4_mul_func)(float result[16], const float src1[16], const float src2[16]);
+
+static void Pose_BlendBatch_Scalar(pose_batch_p b);
+
+static int                  pose_simd_level = POSE_SIMD_SCALAR;
+static pose_blend_func      pose_blend = Pose_BlendBatch_Scalar;
+static pose_mat4_mul_func   pose_mat4_mul = Mat4_Mat4_mul;
+
+
+/*
+ * Reference path: exactly the same math as was used in SSBoneFrame_Update.
+ */
+static void Pose_BlendBatch_Scalar(pose_batch_p b)
+{
+    float t = 1.0f - b->offset_lerp;
+    for(int i = 0; i < POSE_BATCH_SIZE; i++)
+    {
+        float q0[4], q1[4], q[4];
+        for(int l = 0; l < 3; l++)
+        {
+            b->offset[l][i] = b->offset0[l][i] * t + b->offset1[l][i] * b->offset_lerp;
+        }
+        for(int l = 0; l < 4; l++)
+        {
+            q0[l] = b->q0[l][i];
+            q1[l] = b->q1[l][i];
+        }
+        vec4_slerp(q, q0, q1, b->lerp[i]);
+        for(int l = 0; l < 4; l++)
+        {
+            b->q[l][i] = q[l];
+        }
+        b->rot[0][i] = 1.0f - 2.0f * (q[1] * q[1] + q[2] * q[2]);
+        b->rot[1][i] =        2.0f * (q[0] * q[1] + q[3] * q[2]);
+        b->rot[2][i] =        2.0f * (q[0] * q[2] - q[3] * q[1]);
+        b->rot[3][i] =        2.0f * (q[0] * q[1] - q[3] * q[2]);
+        b->rot[4][i] = 1.0f - 2.0f * (q[0] * q[0] + q[2] * q[2]);
+        b->rot[5][i] =        2.0f * (q[1] * q[2] + q[3] * q[0]);
+        b->rot[6][i] =        2.0f * (q[0] * q[2] + q[3] * q[1]);
+        b->rot[7][i] =        2.0f * (q[1] * q[2] - q[3] * q[0]);
+        b->rot[8][i] = 1.0f - 2.0f * (q[0] * q[0] + q[1] * q[1]);
+    }
+}
+
+/*
+ * Vector kernel body; slerp is replaced by nlerp with corrected parameter
+ * (polynomial fit of slerp angle), so there are no per lane acos / sin calls.
+ * V_* macros must be defined for the vector type before usage.
+ */
+#define POSE_BLEND_BODY(b, base)\
+{\
+    V_TYPE one = V_SET1(1.0f);\
+    V_TYPE half = V_SET1(0.5f);\
+    V_TYPE two = V_SET1(2.0f);\
+    V_TYPE sign_bit = V_SET1(-0.0f);\
+    V_TYPE lo = V_SET1((b)->offset_lerp);\
+    V_TYPE lt = V_SUB(one, lo);\
+    V_TYPE t, d, ad, sign, A, B, th, k, k1, k2, x, y, z, w, inv;\
+    for(int l = 0; l < 3; l++)\
+    {\
+        V_STORE((b)->offset[l] + (base), V_ADD(V_MUL(V_LOAD((b)->offset0[l] + (base)), lt), V_MUL(V_LOAD((b)->offset1[l] + (base)), lo)));\
+    }\
+    t = V_LOAD((b)->lerp + (base));\
+    d = V_ADD(V_ADD(V_MUL(V_LOAD((b)->q0[0] + (base)), V_LOAD((b)->q1[0] + (base))),\
+                    V_MUL(V_LOAD((b)->q0[1] + (base)), V_LOAD((b)->q1[1] + (base)))),\
+              V_ADD(V_MUL(V_LOAD((b)->q0[2] + (base)), V_LOAD((b)->q1[2] + (base))),\
+                    V_MUL(V_LOAD((b)->q0[3] + (base)), V_LOAD((b)->q1[3] + (base)))));\
+    sign = V_AND(d, sign_bit);\
+    ad = V_ANDNOT(sign_bit, d);\
+    A = V_ADD(V_SET1(1.0904f), V_MUL(ad, V_ADD(V_SET1(-3.2452f), V_MUL(ad, V_SUB(V_SET1(3.55645f), V_MUL(ad, V_SET1(1.43519f)))))));\
+    B = V_ADD(V_SET1(0.848013f), V_MUL(ad, V_ADD(V_SET1(-1.06021f), V_MUL(ad, V_SET1(0.215638f)))));\
+    th = V_SUB(t, half);\
+    k = V_ADD(V_MUL(A, V_MUL(th, th)), B);\
+    k2 = V_ADD(t, V_MUL(V_MUL(t, th), V_MUL(V_SUB(t, one), k)));\
+    k1 = V_SUB(one, k2);\
+    k2 = V_XOR(k2, sign);\
+    x = V_ADD(V_MUL(k1, V_LOAD((b)->q0[0] + (base))), V_MUL(k2, V_LOAD((b)->q1[0] + (base))));\
+    y = V_ADD(V_MUL(k1, V_LOAD((b)->q0[1] + (base))), V_MUL(k2, V_LOAD((b)->q1[1] + (base))));\
+    z = V_ADD(V_MUL(k1, V_LOAD((b)->q0[2] + (base))), V_MUL(k2, V_LOAD((b)->q1[2] + (base))));\
+    w = V_ADD(V_MUL(k1, V_LOAD((b)->q0[3] + (base))), V_MUL(k2, V_LOAD((b)->q1[3] + (base))));\
+    inv = V_DIV(one, V_SQRT(V_ADD(V_ADD(V_MUL(x, x), V_MUL(y, y)), V_ADD(V_MUL(z, z), V_MUL(w, w)))));\
+    x = V_MUL(x, inv);\
+    y = V_MUL(y, inv);\
+    z = V_MUL(z, inv);\
+    w = V_MUL(w, inv);\
+    V_STORE((b)->q[0] + (base), x);\
+    V_STORE((b)->q[1] + (base), y);\
+    V_STORE((b)->q[2] + (base), z);\
+    V_STORE((b)->q[3] + (base), w);\
+    V_STORE((b)->rot[0] + (base), V_SUB(one, V_MUL(two, V_ADD(V_MUL(y, y), V_MUL(z, z)))));\
+    V_STORE((b)->rot[1] + (base), V_MUL(two, V_ADD(V_MUL(x, y), V_MUL(w, z))));\
+    V_STORE((b)->rot[2] + (base), V_MUL(two, V_SUB(V_MUL(x, z), V_MUL(w, y))));\
+    V_STORE((b)->rot[3] + (base), V_MUL(two, V_SUB(V_MUL(x, y), V_MUL(w, z))));\
+    V_STORE((b)->rot[4] + (base), V_SUB(one, V_MUL(two, V_ADD(V_MUL(x, x), V_MUL(z, z)))));\
+    V_STORE((b)->rot[5] + (base), V_MUL(two, V_ADD(V_MUL(y, z), V_MUL(w, x))));\
+    V_STORE((b)->rot[6] + (base), V_MUL(two, V_ADD(V_MUL(x, z), V_MUL(w, y))));\
+    V_STORE((b)->rot[7] + (base), V_MUL(two, V_SUB(V_MUL(y, z), V_MUL(w, x))));\
+    V_STORE((b)->rot[8] + (base), V_SUB(one, V_MUL(two, V_ADD(V_MUL(x, x), V_MUL(y, y)))));\
+}
+
+#ifdef POSE_HAVE_SSE
+#define V_TYPE          __m128
+#define V_SET1          _mm_set1_ps
+#define V_LOAD          _mm_loadu_ps
+#define V_STORE         _mm_storeu_ps
+#define V_ADD           _mm_add_ps
+#define V_SUB           _mm_sub_ps
+#define V_MUL           _mm_mul_ps
+#define V_DIV           _mm_div_ps
+#define V_SQRT          _mm_sqrt_ps
+#define V_AND           _mm_and_ps
+#define V_ANDNOT        _mm_andnot_ps
+#define V_XOR           _mm_xor_ps
+
+static void Pose_BlendBatch_SSE(pose_batch_p b)
+{
+    POSE_BLEND_BODY(b, 0);
+    POSE_BLEND_BODY(b, 4);
+}
+
+
+static void Pose_Mat4_mul_SSE(float result[16], const float src1[16], const float src2[16])
+{
+    __m128 c0 = _mm_loadu_ps(src1 + 0);
+    __m128 c1 = _mm_loadu_ps(src1 + 4);
+    __m128 c2 = _mm_loadu_ps(src1 + 8);
+    __m128 c3 = _mm_loadu_ps(src1 + 12);
+    __m128 r[4];
+
+    for(int j = 0; j < 4; j++)
+    {
+        const float *s = src2 + 4 * j;
+        r[j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(s[0])), _mm_mul_ps(c1, _mm_set1_ps(s[1]))),
+                          _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(s[2])), _mm_mul_ps(c3, _mm_set1_ps(s[3]))));
+    }
+    // stored at the end, so result may alias sources
+    _mm_storeu_ps(result + 0, r[0]);
+    _mm_storeu_ps(result + 4, r[1]);
+    _mm_storeu_ps(result + 8, r[2]);
+    _mm_storeu_ps(result + 12, r[3]);
+}
+
+#undef V_TYPE
+#undef V_SET1
+#undef V_LOAD
+#undef V_STORE
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_DIV
+#undef V_SQRT
+#undef V_AND
+#undef V_ANDNOT
+#undef V_XOR
+#endif
+
+#ifdef POSE_HAVE_AVX
+#define V_TYPE          __m256
+#define V_SET1          _mm256_set1_ps
+#define V_LOAD          _mm256_loadu_ps
+#define V_STORE         _mm256_storeu_ps
+#define V_ADD           _mm256_add_ps
+#define V_SUB           _mm256_sub_ps
+#define V_MUL           _mm256_mul_ps
+#define V_DIV           _mm256_div_ps
+#define V_SQRT          _mm256_sqrt_ps
+#define V_AND           _mm256_and_ps
+#define V_ANDNOT        _mm256_andnot_ps
+#define V_XOR           _mm256_xor_ps
+
+POSE_TARGET_AVX static void Pose_BlendBatch_AVX(pose_batch_p b)
+{
+    POSE_BLEND_BODY(b, 0);
+}
+
+#undef V_TYPE
+#undef V_SET1
+#undef V_LOAD
+#undef V_STORE
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_DIV
+#undef V_SQRT
+#undef V_AND
+#undef V_ANDNOT
+#undef V_XOR
+#endif
+
+
+static int Pose_SetSimdLevel(int simd_level)
+{
+    pose_blend = Pose_BlendBatch_Scalar;
+    pose_mat4_mul = Mat4_Mat4_mul;
+    pose_simd_level = POSE_SIMD_SCALAR;
+
+#ifdef POSE_HAVE_SSE
+    if((simd_level >= POSE_SIMD_SSE) && SDL_HasSSE2())
+    {
+        pose_blend = Pose_BlendBatch_SSE;
+        pose_mat4_mul = Pose_Mat4_mul_SSE;
+        pose_simd_level = POSE_SIMD_SSE;
+    }
+#endif
+#ifdef POSE_HAVE_AVX
+    if((simd_level >= POSE_SIMD_AVX) && SDL_HasAVX())
+    {
+        pose_blend = Pose_BlendBatch_AVX;
+        pose_simd_level = POSE_SIMD_AVX;
+    }
+#endif
+
+    return pose_simd_level;
+}
+
+
+void Pose_Init(int simd_level)
+{
+    Pose_SetSimdLevel((simd_level < 0) ? (POSE_SIMD_AVX) : (simd_level));
+    // vector kernels must give the same pose as the reference one
+    while((pose_simd_level > POSE_SIMD_SCALAR) && (Pose_TestSimd(pose_simd_level, 256) > POSE_SIMD_TOLERANCE))
+    {
+        Pose_SetSimdLevel(pose_simd_level - 1);
+    }
+}
+
+
+int  Pose_GetSimdLevel()
+{
+    return pose_simd_level;
+}
+
+
+static float Pose_TestRandom(uint32_t *seed)
+{
+    *seed = *seed * 1664525 + 1013904223;
+    return (float)(*seed >> 8) / (float)(1 << 24);
+}
+
+
+float Pose_TestSimd(int simd_level, int batches_count)
+{
+    pose_batch_t ref, test;
+    int old_level = pose_simd_level;
+    uint32_t seed = 0x1234567;
+    float max_diff = 0.0f;
+
+    Pose_SetSimdLevel(simd_level);
+    for(int n = 0; n < batches_count; n++)
+    {
+        ref.offset_lerp = Pose_TestRandom(&seed);
+        for(int i = 0; i < POSE_BATCH_SIZE; i++)
+        {
+            float q0[4], q1[4], t, k;
+            for(int l = 0; l < 3; l++)
+            {
+                ref.offset0[l][i] = 1024.0f * (Pose_TestRandom(&seed) - 0.5f);
+                ref.offset1[l][i] = 1024.0f * (Pose_TestRandom(&seed) - 0.5f);
+            }
+            for(int l = 0; l < 4; l++)
+            {
+                q0[l] = Pose_TestRandom(&seed) - 0.5f;
+                q1[l] = q0[l] + 0.5f * (Pose_TestRandom(&seed) - 0.5f);        // neighbour keyframes are close
+            }
+            t = vec4_abs(q0);
+            k = vec4_abs(q1);
+            for(int l = 0; l < 4; l++)
+            {
+                ref.q0[l][i] = q0[l] / t;
+                ref.q1[l][i] = q1[l] / k;
+            }
+            ref.lerp[i] = (i == 0) ? (0.0f) : ((i == 1) ? (1.0f) : (Pose_TestRandom(&seed)));
+        }
+        test = ref;
+        Pose_BlendBatch_Scalar(&ref);
+        pose_blend(&test);
+
+        for(int i = 0; i < POSE_BATCH_SIZE; i++)
+        {
+            float sign = (ref.q[0][i] * test.q[0][i] + ref.q[1][i] * test.q[1][i] +
+                          ref.q[2][i] * test.q[2][i] + ref.q[3][i] * test.q[3][i] < 0.0f) ? (-1.0f) : (1.0f);
+            for(int l = 0; l < 3; l++)
+            {
+                // offsets are compared relatively to their size
+                float d = fabs(ref.offset[l][i] - test.offset[l][i]) / 1024.0f;
+                max_diff = (d > max_diff) ? (d) : (max_diff);
+            }
+            for(int l = 0; l < 4; l++)
+            {
+                float d = fabs(ref.q[l][i] - sign * test.q[l][i]);
+                max_diff = (d > max_diff) ? (d) : (max_diff);
+            }
+            for(int l = 0; l < 9; l++)
+            {
+                float d = fabs(ref.rot[l][i] - test.rot[l][i]);
+                max_diff = (d > max_diff) ? (d) : (max_diff);
+            }
+        }
+    }
+    Pose_SetSimdLevel(old_level);
+
+    return max_diff;
+}
+
+
+void Pose_BlendBatch(pose_batch_p batch, int count)
+{
+    for(int i = count; i < POSE_BATCH_SIZE; i++)
+    {
+        // keep unused lanes finite
+        for(int l = 0; l < 3; l++)
+        {
+            batch->offset0[l][i] = batch->offset1[l][i] = 0.0f;
+            batch->q0[l][i] = batch->q1[l][i] = 0.0f;
+        }
+        batch->q0[3][i] = batch->q1[3][i] = 1.0f;
+        batch->lerp[i] = 0.0f;
+    }
+    pose_blend(batch);
+}
+
+
+void Pose_Mat4_mul(float result[16], const float src1[16], const float src2[16])
+{
+    pose_mat4_mul(result, src1, src2);
+}
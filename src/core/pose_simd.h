@@ -0,0 +1,60 @@
+/*
+ * File:   pose_simd.h
+ *
+ * Skeletal pose blending kernels. Bones are processed in structure of arrays
+ * batches: SSE takes 4 bones at a time, AVX takes 8, scalar path is a
+ * reference implementation (the same math as vec4_slerp / Mat4_set_qrotation).
+ */
+
+#ifndef POSE_SIMD_H
+#define POSE_SIMD_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define POSE_BATCH_SIZE         (8)
+
+#define POSE_SIMD_SCALAR        (0)
+#define POSE_SIMD_SSE           (1)
+#define POSE_SIMD_AVX           (2)
+
+#define POSE_SIMD_TOLERANCE     (0.002f)
+
+typedef struct pose_batch_s
+{
+    // input: keyframes pair
+    float       offset_lerp;                                                    // the same for all bones
+    float       offset0[3][POSE_BATCH_SIZE];
+    float       offset1[3][POSE_BATCH_SIZE];
+    float       q0[4][POSE_BATCH_SIZE];
+    float       q1[4][POSE_BATCH_SIZE];
+    float       lerp[POSE_BATCH_SIZE];                                          // rotation lerp, per bone (override anims)
+    // output
+    float       offset[3][POSE_BATCH_SIZE];
+    float       q[4][POSE_BATCH_SIZE];
+    float       rot[9][POSE_BATCH_SIZE];                                        // 3x3 column major rotation
+}pose_batch_t, *pose_batch_p;
+
+void Pose_Init(int simd_level);                                                 // simd_level < 0 means autodetect
+int  Pose_GetSimdLevel();
+/*
+ * Runs current kernel against scalar one on pseudo random batches,
+ * returns max component difference.
+ */
+float Pose_TestSimd(int simd_level, int batches_count);
+
+/*
+ * Blends first count bones of batch (count <= POSE_BATCH_SIZE),
+ * unused lanes are filled by the function.
+ */
+void Pose_BlendBatch(pose_batch_p batch, int count);
+void Pose_Mat4_mul(float result[16], const float src1[16], const float src2[16]);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* POSE_SIMD_H */
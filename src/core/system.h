@@ -20,6 +20,8 @@ enum debug_view_state_e
     room_objects,
     ai_boxes,
     bsp_info,
+    physics_info,
+    entities_info,
     model_view,
     debug_states_count
 };
@@ -0,0 +1,224 @@
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_mutex.h>
+#include <SDL2/SDL_atomic.h>
+#include <SDL2/SDL_cpuinfo.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "thread_pool.h"
+#include "system.h"
+
+
+static struct
+{
+    int                 threads_count;
+    int                 jobs_threads;               // threads, taking jobs; 0 - all
+    SDL_Thread        **threads;
+    SDL_mutex          *mutex;
+    SDL_cond           *cond_start;
+    SDL_cond           *cond_done;
+    SDL_TLSID           thread_index_tls;
+
+    uint32_t            generation;                 // changed on each job dispatch
+    int                 running;                    // workers still inside of current job
+    int                 quit;
+
+    thread_job_func     func;
+    void               *data;
+    int                 count;
+    int                 active;                     // threads, taking current job
+    SDL_atomic_t        next_index;
+    SDL_atomic_t        busy;
+} thread_pool = {0};
+
+
+static void ThreadPool_RunJobs(int thread_index)
+{
+    int index;
+    while((index = SDL_AtomicAdd(&thread_pool.next_index, 1)) < thread_pool.count)
+    {
+        thread_pool.func(thread_pool.data, index, thread_index);
+    }
+}
+
+
+static int ThreadPool_Worker(void *arg)
+{
+    int thread_index = (int)(intptr_t)arg;
+    uint32_t generation = 0;                        // pool always starts from generation 0
+    int active;
+
+    SDL_TLSSet(thread_pool.thread_index_tls, (void*)(intptr_t)(thread_index + 1), NULL);
+    SDL_LockMutex(thread_pool.mutex);
+    for(;;)
+    {
+        while(!thread_pool.quit && (generation == thread_pool.generation))
+        {
+            SDL_CondWait(thread_pool.cond_start, thread_pool.mutex);
+        }
+        if(thread_pool.quit)
+        {
+            break;
+        }
+        generation = thread_pool.generation;
+        active = thread_pool.active;
+        SDL_UnlockMutex(thread_pool.mutex);
+
+        if(thread_index < active)
+        {
+            ThreadPool_RunJobs(thread_index);
+        }
+
+        SDL_LockMutex(thread_pool.mutex);
+        if(--thread_pool.running == 0)
+        {
+            SDL_CondSignal(thread_pool.cond_done);
+        }
+    }
+    SDL_UnlockMutex(thread_pool.mutex);
+
+    return 0;
+}
+
+
+void ThreadPool_Init(int threads_count)
+{
+    ThreadPool_Destroy();
+
+    if(threads_count <= 0)
+    {
+        threads_count = SDL_GetCPUCount();
+    }
+    threads_count = (threads_count < 1) ? (1) : (threads_count);
+    threads_count = (threads_count > THREAD_POOL_MAX_THREADS) ? (THREAD_POOL_MAX_THREADS) : (threads_count);
+
+    thread_pool.threads_count = 1;
+    thread_pool.generation = 0;
+    thread_pool.running = 0;
+    thread_pool.quit = 0;
+    SDL_AtomicSet(&thread_pool.busy, 0);
+    if(!thread_pool.thread_index_tls)
+    {
+        thread_pool.thread_index_tls = SDL_TLSCreate();
+    }
+    SDL_TLSSet(thread_pool.thread_index_tls, (void*)(intptr_t)1, NULL);
+
+    if(threads_count > 1)
+    {
+        thread_pool.mutex = SDL_CreateMutex();
+        thread_pool.cond_start = SDL_CreateCond();
+        thread_pool.cond_done = SDL_CreateCond();
+        thread_pool.threads = (SDL_Thread**)calloc(threads_count, sizeof(SDL_Thread*));
+        for(int i = 1; i < threads_count; ++i)
+        {
+            thread_pool.threads[i] = SDL_CreateThread(ThreadPool_Worker, "engine_worker", (void*)(intptr_t)thread_pool.threads_count);
+            if(!thread_pool.threads[i])
+            {
+                Sys_Warn("Could not create worker thread: %s", SDL_GetError());
+                break;
+            }
+            thread_pool.threads_count++;
+        }
+    }
+}
+
+
+void ThreadPool_Destroy()
+{
+    if(thread_pool.threads)
+    {
+        SDL_LockMutex(thread_pool.mutex);
+        thread_pool.quit = 1;
+        SDL_CondBroadcast(thread_pool.cond_start);
+        SDL_UnlockMutex(thread_pool.mutex);
+
+        for(int i = 1; i < thread_pool.threads_count; ++i)
+        {
+            SDL_WaitThread(thread_pool.threads[i], NULL);
+        }
+        free(thread_pool.threads);
+        thread_pool.threads = NULL;
+    }
+
+    if(thread_pool.mutex)
+    {
+        SDL_DestroyCond(thread_pool.cond_done);
+        SDL_DestroyCond(thread_pool.cond_start);
+        SDL_DestroyMutex(thread_pool.mutex);
+        thread_pool.cond_done = NULL;
+        thread_pool.cond_start = NULL;
+        thread_pool.mutex = NULL;
+    }
+    thread_pool.threads_count = 1;
+}
+
+
+int  ThreadPool_GetThreadsCount()
+{
+    return (thread_pool.threads_count > 0) ? (thread_pool.threads_count) : (1);
+}
+
+
+void ThreadPool_SetJobsThreads(int threads_count)
+{
+    thread_pool.jobs_threads = (threads_count > 0) ? (threads_count) : (0);
+}
+
+
+int  ThreadPool_GetJobsThreads()
+{
+    return thread_pool.jobs_threads;
+}
+
+
+void ThreadPool_ParallelFor(thread_job_func func, void *data, int count)
+{
+    int active = thread_pool.threads_count;
+    if(count <= 0)
+    {
+        return;
+    }
+
+    if((thread_pool.jobs_threads > 0) && (thread_pool.jobs_threads < active))
+    {
+        active = thread_pool.jobs_threads;
+    }
+
+    if((active <= 1) || (count == 1) || !SDL_AtomicCAS(&thread_pool.busy, 0, 1))
+    {
+        // single threaded path or nested call from a job: run it inplace.
+        int thread_index = (int)(intptr_t)SDL_TLSGet(thread_pool.thread_index_tls);
+        thread_index = (thread_index > 0) ? (thread_index - 1) : (0);
+        for(int i = 0; i < count; ++i)
+        {
+            func(data, i, thread_index);
+        }
+        return;
+    }
+
+    SDL_LockMutex(thread_pool.mutex);
+    thread_pool.func = func;
+    thread_pool.data = data;
+    thread_pool.count = count;
+    thread_pool.active = active;
+    SDL_AtomicSet(&thread_pool.next_index, 0);
+    thread_pool.running = thread_pool.threads_count - 1;
+    thread_pool.generation++;
+    SDL_CondBroadcast(thread_pool.cond_start);
+    SDL_UnlockMutex(thread_pool.mutex);
+
+    ThreadPool_RunJobs(0);
+
+    SDL_LockMutex(thread_pool.mutex);
+    while(thread_pool.running > 0)
+    {
+        SDL_CondWait(thread_pool.cond_done, thread_pool.mutex);
+    }
+    thread_pool.func = NULL;
+    thread_pool.data = NULL;
+    SDL_UnlockMutex(thread_pool.mutex);
+
+    SDL_AtomicSet(&thread_pool.busy, 0);
+}
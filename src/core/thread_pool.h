@@ -0,0 +1,46 @@
+/*
+ * File:   thread_pool.h
+ *
+ * Engine owned worker threads. The calling thread always takes part in the
+ * job, so the pool keeps (threads_count - 1) additional SDL threads.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define THREAD_POOL_MAX_THREADS     (32)
+
+/*
+ * job callback: index is in [0, count), thread_index is in [0, threads_count)
+ * and is unique among all callbacks running at the same moment.
+ */
+typedef void (*thread_job_func)(void *data, int index, int thread_index);
+
+void ThreadPool_Init(int threads_count);                                        // threads_count <= 0 means autodetect.
+void ThreadPool_Destroy();
+
+int  ThreadPool_GetThreadsCount();
+/*
+ * Limits threads, taking part in following jobs, without the pool recreation
+ * (1 - serial, <= 0 - all pool threads); used by tests and benchmarks.
+ */
+void ThreadPool_SetJobsThreads(int threads_count);
+int  ThreadPool_GetJobsThreads();
+/*
+ * Runs func for every index in [0, count) and returns when all of them are done.
+ * Indices are fetched dynamically, so fast threads take over the rest of the work;
+ * nested calls (from inside of a job) are executed serially.
+ */
+void ThreadPool_ParallelFor(thread_job_func func, void *data, int count);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* THREAD_POOL_H */
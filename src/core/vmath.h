@@ -33,6 +33,14 @@ float    Spline_Get(spline_p spline, float t);
 #define M_PI_2      1.57079632679489661923
 #endif
 
+#ifndef M_SQRT2
+#define M_SQRT2     1.41421356237309504880
+#endif
+
+#ifndef M_SQRT1_2
+#define M_SQRT1_2   0.70710678118654752440
+#endif
+
 #define PLANE_X        (1)
 #define PLANE_Y        (2)
 #define PLANE_Z        (3)
@@ -21,6 +21,8 @@ extern "C" {
 #include "core/vmath.h"
 #include "core/polygon.h"
 #include "core/gl_text.h"
+#include "core/thread_pool.h"
+#include "core/pose_simd.h"
 #include "render/camera.h"
 #include "render/render.h"
 #include "render/shader_manager.h"
@@ -36,6 +38,8 @@ extern "C" {
 #include "mesh.h"
 #include "skeletal_model.h"
 #include "entity.h"
+#include "entity_grid.h"
+#include "room_grid.h"
 #include "gameflow.h"
 #include "room.h"
 #include "world.h"
@@ -213,6 +217,8 @@ void Engine_Shutdown(int val)
 
     Gameflow_Destroy();
     Physics_Destroy();
+    Game_Destroy();
+    ThreadPool_Destroy();
     Gui_Destroy();
     Con_Destroy();
     GLText_Destroy();
@@ -271,6 +277,7 @@ void Engine_InitDefaultGlobals()
     Controls_InitGlobals();
     Game_InitGlobals();
     Audio_InitGlobals();
+    Physics_InitGlobals();
 }
 
 // First stage of initialization.
@@ -297,12 +304,17 @@ void Engine_Init_Pre()
     engine_camera_state.shake_value = 0.0f;
     engine_camera_state.time = 0.0f;
     Mat4_E_macro(engine_camera_state.cutscene_tr);
-    Physics_Init();
 }
 
 // Second stage of initialization.
 void Engine_Init_Post()
 {
+    // Physics settings are known only after config loading.
+    ThreadPool_Init(physics_settings.threads);
+    Pose_Init(-1);
+    Physics_Init();
+    Con_Printf("Physics: %d solver threads, %d worker threads", (int)physics_settings.threads, ThreadPool_GetThreadsCount());
+
     Script_CallVoidFunc(engine_lua, "loadscript_post", true);
 
     Gui_Init();
@@ -495,6 +507,8 @@ void Engine_LoadConfig(const char *filename)
             Script_ParseRender(lua, &renderer.settings);
             Script_ParseAudio(lua, &audio_settings);
             Script_ParseControls(lua, &control_settings);
+            Script_ParsePhysics(lua, &physics_settings);
+            Script_ParseAnimation(lua, &animation_settings);
 
             if(0 < Script_ParseConsole(lua, &cp))
             {
@@ -915,6 +929,9 @@ void Engine_MainLoop()
         Engine_HandleFPS(time);
 
         Sys_ResetTempMem();
+        SSBoneFrame_ResetPaletteStats();
+        EntityGrid_ResetStats();
+        RoomGrid_ResetStats();
         Engine_PollSDLEvents();
         
         if(!engine_video.input)
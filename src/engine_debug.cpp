@@ -12,6 +12,7 @@
 #include "core/gl_text.h"
 #include "core/console.h"
 #include "core/vmath.h"
+#include "core/thread_pool.h"
 #include "render/camera.h"
 #include "render/render.h"
 #include "render/shader_manager.h"
@@ -22,10 +23,13 @@
 #include "mesh.h"
 #include "skeletal_model.h"
 #include "entity.h"
+#include "entity_grid.h"
+#include "room_grid.h"
 #include "character_controller.h"
 #include "room.h"
 #include "trigger.h"
 #include "world.h"
+#include "game.h"
 
 
 static ss_bone_frame_t  g_test_model = {0};
@@ -215,7 +219,7 @@ void ShowModelView(float time)
             qglUniform4fvARB(shader->light_ambient, 1, ambient_component);
             qglUniform1fARB(shader->dist_fog, 65536.0f);
         }
-        renderer.DrawSkeletalModel(shader, &g_test_model, subModelView, subModelViewProjection);
+        renderer.DrawSkeletalModel(shader, &g_test_model, subModelView, subModelViewProjection, NULL);
         renderer.debugDrawer->DrawAxis(4096.0f, tr.M4x4);
 
         for(int i = 0; i < g_test_model.bone_tag_count; ++i)
@@ -233,6 +237,20 @@ void ShowModelView(float time)
             GLText_OutTextXY(30.0f, y += dy, "anim: %d of %d", (int)g_test_model.animations.prev_animation, (int)sm->animation_count);
             GLText_OutTextXY(30.0f, y += dy, "frame: %d of %d, %d", (int)g_test_model.animations.prev_frame, (int)af->max_frame, (int)af->frames_count);
             GLText_OutTextXY(30.0f, y += dy, "next a: %d,next f: %d", (int)af->next_anim->id, (int)af->next_frame);
+            {
+                uint32_t expanded_size = 0;
+                uint32_t float_size = 0;
+                for(uint16_t i = 0; i < sm->animation_count; i++)
+                {
+                    expanded_size += sm->animations[i].frames_count * (sizeof(bone_frame_t) + sm->mesh_count * sizeof(bone_tag_t));
+                    float_size += sm->animations[i].keyframes_count * (sizeof(bone_frame_t) + sm->mesh_count * sizeof(bone_tag_t));
+                }
+                GLText_OutTextXY(30.0f, y += dy, "keyframes: %d, rate: %d; anim data = %d kb (expanded %d kb)", (int)af->keyframes_count, (int)af->frame_rate, (int)(sm->anim_data_size / 1024), (int)(expanded_size / 1024));
+                if(af->compressed)
+                {
+                    GLText_OutTextXY(30.0f, y += dy, "compressed: float data = %d kb; max error: rot = %.4f deg, offset = %.3f", (int)(float_size / 1024), sm->anim_rot_error, sm->anim_offset_error);
+                }
+            }
 
             for(animation_command_p cmd = af->commands; cmd; cmd = cmd->next)
             {
@@ -517,6 +535,50 @@ void ShowDebugInfo()
             }
             break;
 
+        case debug_view_state_e::physics_info:
+            {
+                physics_stats_t stats;
+                Physics_GetStats(&stats);
+                GLText_OutTextXY(30.0f, y += dy, "VIEW: Physics info");
+                GLText_OutTextXY(30.0f, y += dy, "threads = %d, solver batches = %d, islands = %d", (int)stats.threads, (int)stats.solver_batches, (int)stats.islands);
+                GLText_OutTextXY(30.0f, y += dy, "step = %.3f ms, solve = %.3f ms", stats.step_time, stats.solve_time);
+                GLText_OutTextXY(30.0f, y += dy, "dynamic bodies: active = %d, sleeping = %d, frozen = %d, baked = %d", (int)stats.bodies_active, (int)stats.bodies_sleeping, (int)stats.bodies_frozen, (int)stats.bodies_baked);
+                GLText_OutTextXY(30.0f, y += dy, "shared shapes = %d, refs = %d, memory = %d kb (unshared %d kb)", (int)stats.shapes_shared, (int)stats.shapes_refs, (int)(stats.shapes_memory / 1024), (int)(stats.shapes_memory_unshared / 1024));
+                GLText_OutTextXY(30.0f, y += dy, "hairs: full = %d, reduced = %d, kinematic = %d, lod and follow = %.3f ms", (int)stats.hairs_full, (int)stats.hairs_reduced, (int)stats.hairs_kinematic, stats.hair_time);
+            }
+            break;
+
+        case debug_view_state_e::entities_info:
+            {
+                uint32_t visited, entities, poses, active, sleeping;
+                uint32_t palette_builds, palette_reuses, mul_requested, mul_done;
+                entity_grid_stats_t grid_stats;
+                room_grid_stats_t room_grid_stats;
+                ai_stats_t ai_stats;
+                character_probes_stats_t probes_stats;
+                float logic_time, pose_time, probes_time, activation_time;
+                Game_GetUpdateStats(&visited, &entities, &poses, &logic_time, &pose_time, &probes_time);
+                SSBoneFrame_GetPaletteStats(&palette_builds, &palette_reuses, &mul_requested, &mul_done);
+                World_GetActivationStats(&active, &sleeping, &activation_time);
+                EntityGrid_GetStats(&grid_stats);
+                RoomGrid_GetStats(&room_grid_stats);
+                Character_GetAIStats(&ai_stats);
+                Character_GetProbesStats(&probes_stats);
+                GLText_OutTextXY(30.0f, y += dy, "VIEW: Entities update info");
+                GLText_OutTextXY(30.0f, y += dy, "activation depth = %d, active = %d, sleeping = %d, rebuild = %.3f ms", (int)World_GetActivationDepth(), (int)active, (int)sleeping, activation_time);
+                GLText_OutTextXY(30.0f, y += dy, "visited = %d, updated (dirty) = %d, poses = %d, threads = %d", (int)visited, (int)entities, (int)poses, ThreadPool_GetThreadsCount());
+                GLText_OutTextXY(30.0f, y += dy, "probes prefetch = %.3f ms, logic update = %.3f ms, poses update = %.3f ms", probes_time, logic_time, pose_time);
+                GLText_OutTextXY(30.0f, y += dy, "probes: prefetched = %d, used = %d, caches dropped = %d", (int)probes_stats.prefetched, (int)probes_stats.prefetch_hits, (int)probes_stats.invalidations);
+                GLText_OutTextXY(30.0f, y += dy, "bone palettes: built = %d, reused = %d, matrix muls = %d (uncached %d)", (int)palette_builds, (int)palette_reuses, (int)mul_done, (int)mul_requested);
+                GLText_OutTextXY(30.0f, y += dy, "entity grid: indexed = %d, relinks = %d, queries = %d, candidates = %d, found = %d", (int)grid_stats.indexed, (int)grid_stats.relinks, (int)grid_stats.queries, (int)grid_stats.candidates, (int)grid_stats.results);
+                GLText_OutTextXY(30.0f, y += dy, "room grid: cells = %d, rooms = %d (max %d), queries = %d, candidates = %d, full scans = %d",
+                                 (int)room_grid_stats.cells, (int)room_grid_stats.entries, (int)room_grid_stats.max_candidates, (int)room_grid_stats.queries, (int)room_grid_stats.candidates,
+                                 (int)room_grid_stats.fallback_scans);
+                GLText_OutTextXY(30.0f, y += dy, "ai: updates = %d, %.3f ms, thinks = %d, %.3f ms of %.3f, skipped = %d, deferred = %d, forced = %d", (int)ai_stats.updates, ai_stats.ai_time,
+                                 (int)ai_stats.thinks, ai_stats.think_time, Character_GetAIBudget(), (int)ai_stats.skipped, (int)ai_stats.deferred, (int)ai_stats.forced);
+            }
+            break;
+
         case debug_view_state_e::model_view:
             GLText_OutTextXY(30.0f, y += dy, "VIEW: MODELS ANIM (use o, p, [, ], w, s, space, v and arrows)");
             break;
@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 
 extern "C" {
 #include <lua.h>
@@ -7,6 +8,7 @@ extern "C" {
 #include <lauxlib.h>
 }
 
+#include "core/system.h"
 #include "core/console.h"
 #include "core/vmath.h"
 #include "core/obb.h"
@@ -19,6 +21,7 @@ extern "C" {
 #include "mesh.h"
 #include "skeletal_model.h"
 #include "entity.h"
+#include "entity_grid.h"
 #include "room.h"
 #include "world.h"
 #include "engine.h"
@@ -29,9 +32,107 @@ extern "C" {
 #include "engine_string.h"
 
 
+/*
+ * Entities are allocated from blocks of slots, so pointers stay valid while
+ * pool grows and neighbour entities share cache lines / pages. Each slot
+ * has generation counter, incremented on free: handle with old generation
+ * is not resolved anymore.
+ */
+static struct
+{
+    uint32_t            slots_count;
+    uint32_t            free_count;
+    uint32_t            used_count;
+    uint32_t            blocks_count;
+    entity_p           *blocks;
+    uint16_t           *generations;
+    uint32_t           *free_slots;                                             // stack of freed slots
+} entity_pool = {0};
+
+
+static entity_p Entity_AllocSlot()
+{
+    uint32_t slot;
+    entity_p ret;
+
+    if(entity_pool.free_count == 0)
+    {
+        uint32_t block = entity_pool.blocks_count++;
+        entity_pool.blocks = (entity_p*)realloc(entity_pool.blocks, entity_pool.blocks_count * sizeof(entity_p));
+        entity_pool.blocks[block] = (entity_p)malloc(ENTITY_POOL_BLOCK_SIZE * sizeof(entity_t));
+        if(entity_pool.slots_count < entity_pool.blocks_count * ENTITY_POOL_BLOCK_SIZE)
+        {
+            // generations are kept after pool release, to invalidate old handles
+            entity_pool.generations = (uint16_t*)realloc(entity_pool.generations, entity_pool.blocks_count * ENTITY_POOL_BLOCK_SIZE * sizeof(uint16_t));
+            memset(entity_pool.generations + entity_pool.slots_count, 0x00, ENTITY_POOL_BLOCK_SIZE * sizeof(uint16_t));
+            entity_pool.slots_count = entity_pool.blocks_count * ENTITY_POOL_BLOCK_SIZE;
+        }
+        entity_pool.free_slots = (uint32_t*)realloc(entity_pool.free_slots, entity_pool.blocks_count * ENTITY_POOL_BLOCK_SIZE * sizeof(uint32_t));
+        // lower slots are taken first
+        for(uint32_t i = ENTITY_POOL_BLOCK_SIZE; i > 0; i--)
+        {
+            entity_pool.free_slots[entity_pool.free_count++] = block * ENTITY_POOL_BLOCK_SIZE + i - 1;
+        }
+    }
+
+    slot = entity_pool.free_slots[--entity_pool.free_count];
+    ret = entity_pool.blocks[slot / ENTITY_POOL_BLOCK_SIZE] + slot % ENTITY_POOL_BLOCK_SIZE;
+    memset(ret, 0x00, sizeof(entity_t));
+    ret->handle = ((uint32_t)entity_pool.generations[slot] << ENTITY_HANDLE_SLOT_BITS) | slot;
+    entity_pool.used_count++;
+
+    return ret;
+}
+
+
+static void Entity_FreeSlot(entity_p entity)
+{
+    uint32_t slot = entity->handle & ENTITY_HANDLE_SLOT_MASK;
+
+    entity_pool.generations[slot] = (entity_pool.generations[slot] + 1) & ENTITY_HANDLE_GENERATION_MASK;
+    entity->handle = ENTITY_HANDLE_NONE;
+    entity_pool.free_slots[entity_pool.free_count++] = slot;
+    entity_pool.used_count--;
+
+    if(entity_pool.used_count == 0)
+    {
+        for(uint32_t i = 0; i < entity_pool.blocks_count; i++)
+        {
+            free(entity_pool.blocks[i]);
+        }
+        free(entity_pool.blocks);
+        free(entity_pool.free_slots);
+        entity_pool.blocks = NULL;
+        entity_pool.free_slots = NULL;
+        entity_pool.blocks_count = 0;
+        entity_pool.free_count = 0;
+    }
+}
+
+
+entity_p Entity_GetByHandle(uint32_t handle)
+{
+    uint32_t slot = handle & ENTITY_HANDLE_SLOT_MASK;
+    if((slot < entity_pool.blocks_count * ENTITY_POOL_BLOCK_SIZE) &&
+       (entity_pool.generations[slot] == (handle >> ENTITY_HANDLE_SLOT_BITS)))
+    {
+        entity_p ret = entity_pool.blocks[slot / ENTITY_POOL_BLOCK_SIZE] + slot % ENTITY_POOL_BLOCK_SIZE;
+        return (ret->handle == handle) ? (ret) : (NULL);
+    }
+    return NULL;
+}
+
+
+void Entity_GetPoolInfo(uint32_t *used, uint32_t *slots)
+{
+    *used = entity_pool.used_count;
+    *slots = entity_pool.blocks_count * ENTITY_POOL_BLOCK_SIZE;
+}
+
+
 entity_p Entity_Create()
 {
-    entity_p ret = (entity_p)calloc(1, sizeof(entity_t));
+    entity_p ret = Entity_AllocSlot();
 
     ret->move_type = MOVE_ON_FLOOR;
     Mat4_E(ret->transform.M4x4);
@@ -39,6 +140,8 @@ entity_p Entity_Create()
     vec3_set_one(ret->transform.scaling);
     
     ret->state_flags = ENTITY_STATE_ENABLED | ENTITY_STATE_ACTIVE | ENTITY_STATE_VISIBLE | ENTITY_STATE_COLLIDABLE;
+    ret->dirty_flags = ENTITY_DIRTY_ALL;
+    ret->last_update.animation = -1;
     ret->type_flags = ENTITY_TYPE_GENERIC;
     ret->callback_flags = 0x00000000;               // no callbacks by default
 
@@ -56,6 +159,7 @@ entity_p Entity_Create()
     ret->self->collision_mask = COLLISION_MASK_ALL;
     ret->obb = OBB_Create();
     ret->obb->transform = ret->transform.M4x4;
+    ret->grid.bucket = ENTITY_GRID_NONE;
 
     ret->no_fix_all = 0x00;
     ret->no_move = 0x00;
@@ -94,6 +198,7 @@ void Entity_InitActivationPoint(entity_p entity)
     entity->activation_point->direction[1] = 1.0f;
     entity->activation_point->direction[2] = 0.0f;
     entity->activation_point->direction[3] = 0.70f;
+    EntityGrid_Update(entity);                                                  // activators query reach
 }
 
 
@@ -101,6 +206,7 @@ void Entity_Delete(entity_p entity)
 {
     if(entity)
     {
+        EntityGrid_Remove(entity);
         if(entity->self->room)
         {
             Room_RemoveObject(entity->self->room, entity->self);
@@ -139,7 +245,7 @@ void Entity_Delete(entity_p entity)
             entity->bf = NULL;
         }
 
-        free(entity);
+        Entity_FreeSlot(entity);
     }
 }
 
@@ -176,6 +282,7 @@ void Entity_EnableCollision(entity_p ent)
         Physics_GenRigidBody(ent->physics, ent->bf);
     }
     ent->state_flags |= ENTITY_STATE_COLLIDABLE;
+    ent->dirty_flags |= ENTITY_DIRTY_PHYSICS;
 }
 
 
@@ -186,6 +293,7 @@ void Entity_DisableCollision(entity_p ent)
         Physics_DisableCollision(ent->physics);
     }
     ent->state_flags &= ~(uint16_t)ENTITY_STATE_COLLIDABLE;
+    ent->dirty_flags |= ENTITY_DIRTY_PHYSICS;
 }
 
 
@@ -228,6 +336,7 @@ void Entity_UpdateRoomPos(entity_p ent)
             ent->self->sector = new_sector;
         }
     }
+    EntityGrid_Update(ent);
 }
 
 
@@ -267,26 +376,77 @@ void Entity_UpdateTransform(entity_p entity)
 }
 
 
+static void Entity_GetDynamicTransform(struct entity_s *ent, float tr[16])
+{
+    Physics_GetBodyWorldTransform(ent->physics, tr, 0);
+    switch(ent->self->collision_shape)
+    {
+        case COLLISION_SHAPE_SINGLE_BOX:
+        case COLLISION_SHAPE_SINGLE_SPHERE:
+            {
+                float centre[3], offset[3];
+                centre[0] = 0.5f * (ent->bf->bb_min[0] + ent->bf->bb_max[0]);
+                centre[1] = 0.5f * (ent->bf->bb_min[1] + ent->bf->bb_max[1]);
+                centre[2] = 0.5f * (ent->bf->bb_min[2] + ent->bf->bb_max[2]);
+                Mat4_vec3_rot_macro(offset, tr, centre);
+                tr[12 + 0] -= offset[0];
+                tr[12 + 1] -= offset[1];
+                tr[12 + 2] -= offset[2];
+            }
+            break;
+    };
+}
+
+
+/*
+ * Settled bodies are not copied to the entity, so entity transform, that differs
+ * from the bodies one, was set from outside (script teleport): bodies are moved
+ * with the entity and woken up, else the next copy returns entity back.
+ */
+static void Entity_MoveSettledBodies(struct entity_s *ent)
+{
+    float old_tr[16];
+    Entity_GetDynamicTransform(ent, old_tr);
+    if(memcmp(old_tr, ent->transform.M4x4, sizeof(old_tr)))
+    {
+        int bodies_count = Physics_GetBodiesCount(ent->physics);
+        Physics_WakeUp(ent->physics);
+        for(int i = 0; i < bodies_count; i++)
+        {
+            float tr[16], local[16];
+            Mat4_Copy(tr, old_tr);
+            Physics_GetBodyWorldTransform(ent->physics, tr, i);
+            Mat4_inv_Mat4_affine_mul(local, old_tr, tr);
+            Mat4_Mat4_mul(tr, ent->transform.M4x4, local);
+            Physics_SetBodyWorldTransform(ent->physics, tr, i);
+        }
+    }
+}
+
+
 void Entity_UpdateRigidBody(struct entity_s *ent, int force)
 {
     if(ent->type_flags & ENTITY_TYPE_DYNAMIC)
     {
         float tr[16];
-        Physics_GetBodyWorldTransform(ent->physics, ent->transform.M4x4, 0);
+        if(force && (Physics_GetSleepState(ent->physics) != PHYSICS_SLEEP_STATE_ACTIVE))
+        {
+            Entity_MoveSettledBodies(ent);
+        }
+
+        // Sleep state is updated after the copy, so the last pose before sleeping is always taken.
+        if((Physics_GetSleepState(ent->physics) != PHYSICS_SLEEP_STATE_ACTIVE) &&
+           (Physics_UpdateSleepState(ent->physics) != PHYSICS_SLEEP_STATE_ACTIVE))
+        {
+            return;
+        }
+
+        Entity_GetDynamicTransform(ent, ent->transform.M4x4);
         switch(ent->self->collision_shape)
         {
             case COLLISION_SHAPE_SINGLE_BOX:
             case COLLISION_SHAPE_SINGLE_SPHERE:
-                {
-                    float centre[3], offset[3];
-                    centre[0] = 0.5f * (ent->bf->bb_min[0] + ent->bf->bb_max[0]);
-                    centre[1] = 0.5f * (ent->bf->bb_min[1] + ent->bf->bb_max[1]);
-                    centre[2] = 0.5f * (ent->bf->bb_min[2] + ent->bf->bb_max[2]);
-                    Mat4_vec3_rot_macro(offset, ent->transform.M4x4, centre);
-                    ent->transform.M4x4[12 + 0] -= offset[0];
-                    ent->transform.M4x4[12 + 1] -= offset[1];
-                    ent->transform.M4x4[12 + 2] -= offset[2];
-                }
+                Physics_UpdateSleepState(ent->physics);
                 return;
         };
         Mat4_E(ent->bf->bone_tags[0].current_transform);
@@ -311,6 +471,7 @@ void Entity_UpdateRigidBody(struct entity_s *ent, int force)
                 Mat4_Copy(ent->bf->bone_tags[i].local_transform, ent->bf->bone_tags[i].current_transform);
             }
         }
+        ent->bf->pose_stamp++;
 
         // recalculate visibility box
         if(ent->bf->bone_tag_count == 1)
@@ -361,6 +522,7 @@ void Entity_UpdateRigidBody(struct entity_s *ent, int force)
                 }
             }
         }
+        Physics_UpdateSleepState(ent->physics);
     }
     else
     {
@@ -395,16 +557,20 @@ void Entity_UpdateRigidBody(struct entity_s *ent, int force)
 
                 default:
                     {
-                        float tr[16];
-                        for(uint16_t i = 0; i < ent->bf->bone_tag_count; i++)
+                        const float *tr = SSBoneFrame_GetPalette(ent->bf);
+                        for(uint16_t i = 0; i < ent->bf->bone_tag_count; i++, tr += 16)
                         {
-                            Mat4_Mat4_mul(tr, ent->transform.M4x4, ent->bf->bone_tags[i].current_transform);
                             Physics_SetBodyWorldTransform(ent->physics, tr, i);
                             Physics_SetGhostWorldTransform(ent->physics, tr, i);
                         }
                     }
                     break;
             };
+
+            if(!ent->character)
+            {
+                Physics_WakeUpTouching(ent->physics);                           // characters walk over corpses without waking them
+            }
         }
     }
 
@@ -435,11 +601,12 @@ void Entity_GhostUpdate(struct entity_s *ent)
 
             default:
                 {
+                    const float *palette = SSBoneFrame_GetPalette(ent->bf);
                     uint16_t max_index = Physics_GetBodiesCount(ent->physics);
-                    for(uint16_t i = 0; i < max_index; i++)
+                    max_index = (max_index < ent->bf->bone_tag_count) ? (max_index) : (ent->bf->bone_tag_count);
+                    for(uint16_t i = 0; i < max_index; i++, palette += 16)
                     {
-                        Mat4_Mat4_mul(tr, ent->transform.M4x4, ent->bf->bone_tags[i].current_transform);
-                        Physics_SetGhostWorldTransform(ent->physics, tr, i);
+                        Physics_SetGhostWorldTransform(ent->physics, palette, i);
                     }
                 }
                 break;
@@ -1144,12 +1311,27 @@ void Entity_MoveToSink(entity_p entity, struct static_camera_sink_s *sink)
 
 
 void Entity_Frame(entity_p entity, float time)
+{
+    if(Entity_UpdateAnimations(entity, time))
+    {
+        SSBoneFrame_Update(entity->bf, time);
+    }
+}
+
+/**
+ * Animations logic part of Entity_Frame: frames switching, anim commands;
+ * returns 1 if pose (bone matrices) must be recalculated by SSBoneFrame_Update.
+ */
+int  Entity_UpdateAnimations(entity_p entity, float time)
 {
     if(entity && !(entity->type_flags & ENTITY_TYPE_DYNAMIC) && (entity->state_flags & ENTITY_STATE_ACTIVE)  && (entity->state_flags & ENTITY_STATE_ENABLED))
     {
         ss_animation_p ss_anim = &entity->bf->animations;
 
-        Entity_GhostUpdate(entity);
+        if(entity->dirty_flags & (ENTITY_DIRTY_TRANSFORM | ENTITY_DIRTY_PHYSICS))
+        {
+            Entity_GhostUpdate(entity);
+        }
 
         while(ss_anim)
         {
@@ -1206,8 +1388,68 @@ void Entity_Frame(entity_p entity, float time)
             ss_anim = ss_anim->next;
         }
 
-        SSBoneFrame_Update(entity->bf, time);
+        return 1;
     }
+
+    return 0;
+}
+
+/**
+ * Compares pose inputs (base animation frames pair and lerp) and transform
+ * with ones of the previous check, marks changed parts as dirty;
+ * returns all dirty flags of entity. Characters, overlay animations and
+ * targeted bones change pose every frame, so they are always dirty.
+ */
+uint16_t Entity_CheckDirty(entity_p ent)
+{
+    ss_animation_p ss_anim = &ent->bf->animations;
+    float lerp = ss_anim->lerp;
+
+    if(memcmp(ent->last_update.transform, ent->transform.M4x4, sizeof(ent->last_update.transform)))
+    {
+        memcpy(ent->last_update.transform, ent->transform.M4x4, sizeof(ent->last_update.transform));
+        ent->dirty_flags |= ENTITY_DIRTY_TRANSFORM;
+    }
+
+    if(ent->character)
+    {
+        ent->dirty_flags |= ENTITY_DIRTY_ALL;
+        return ent->dirty_flags;
+    }
+
+    for(ss_animation_p it = ss_anim->next; it; it = it->next)
+    {
+        if(it->enabled)
+        {
+            ent->dirty_flags |= ENTITY_DIRTY_POSE;
+            return ent->dirty_flags;
+        }
+    }
+
+    for(uint16_t i = 0; i < ent->bf->bone_tag_count; i++)
+    {
+        if(ent->bf->bone_tags[i].is_targeted)
+        {
+            ent->dirty_flags |= ENTITY_DIRTY_POSE;
+            return ent->dirty_flags;
+        }
+    }
+
+    // lerp between the same frames gives the same pose
+    lerp = ((ss_anim->prev_animation == ss_anim->current_animation) && (ss_anim->prev_frame == ss_anim->current_frame)) ? (0.0f) : (lerp);
+    if((ent->last_update.animation != ss_anim->current_animation) || (ent->last_update.frame != ss_anim->current_frame) ||
+       (ent->last_update.prev_animation != ss_anim->prev_animation) || (ent->last_update.prev_frame != ss_anim->prev_frame) ||
+       (ent->last_update.lerp != lerp))
+    {
+        ent->last_update.animation = ss_anim->current_animation;
+        ent->last_update.frame = ss_anim->current_frame;
+        ent->last_update.prev_animation = ss_anim->prev_animation;
+        ent->last_update.prev_frame = ss_anim->prev_frame;
+        ent->last_update.lerp = lerp;
+        ent->dirty_flags |= ENTITY_DIRTY_POSE;
+    }
+
+    return ent->dirty_flags;
 }
 
 /**
@@ -1317,41 +1559,51 @@ void Entity_CheckActivators(struct entity_s *ent)
 {
     if(ent && ent->self->room)
     {
-        for(int room_index = -1; room_index < ent->self->room->content->near_room_list_size; ++room_index)
+        entity_p buf[64];
+        entity_p *candidates = buf;
+        float reach = EntityGrid_GetActivationReach() + fabs(ent->bf->bb_max[1]);   // pickables are tested from the point in front of activator
+        int count = EntityGrid_QueryRadius(ent->self->room, ent->transform.M4x4 + 12, reach, candidates, 64);
+        if(count > 64)
+        {
+            candidates = (entity_p*)Sys_GetTempMem(count * sizeof(entity_p));
+            EntityGrid_QueryRadius(ent->self->room, ent->transform.M4x4 + 12, reach, candidates, count);
+        }
+
+        for(int i = 0; i < count; i++)
         {
-            room_p room = (room_index >= 0) ? (ent->self->room->content->near_room_list[room_index]) : (ent->self->room);
-            engine_container_p cont = room->containers;
-            for(; cont; cont = cont->next)
+            entity_p trigger = candidates[i];
+            if((trigger != ent) && trigger->activation_point)
             {
-                if((cont->object_type == OBJECT_ENTITY) && cont->object && (cont->object != ent) && ((entity_p)cont->object)->activation_point)
+                if((trigger->type_flags & ENTITY_TYPE_INTERACTIVE) && (trigger->state_flags & ENTITY_STATE_ENABLED))
                 {
-                    entity_p trigger = (entity_p)cont->object;
-                    if((trigger->type_flags & ENTITY_TYPE_INTERACTIVE) && (trigger->state_flags & ENTITY_STATE_ENABLED))
+                    if(Entity_CanTrigger(ent, trigger))
                     {
-                        if(Entity_CanTrigger(ent, trigger))
-                        {
-                            Script_ExecEntity(engine_lua, ENTITY_CALLBACK_ACTIVATE, trigger->id, ent->id);
-                        }
+                        Script_ExecEntity(engine_lua, ENTITY_CALLBACK_ACTIVATE, trigger->id, ent->id);
                     }
-                    else if((trigger->type_flags & ENTITY_TYPE_PICKABLE) && (trigger->state_flags & ENTITY_STATE_ENABLED) && (trigger->state_flags & ENTITY_STATE_VISIBLE))
+                }
+                else if((trigger->type_flags & ENTITY_TYPE_PICKABLE) && (trigger->state_flags & ENTITY_STATE_ENABLED) && (trigger->state_flags & ENTITY_STATE_VISIBLE))
+                {
+                    float ppos[3];
+                    float *v = trigger->transform.M4x4 + 12;
+                    float r = trigger->activation_point->offset[3];
+
+                    ppos[0] = ent->transform.M4x4[12 + 0] + ent->transform.M4x4[4 + 0] * ent->bf->bb_max[1];
+                    ppos[1] = ent->transform.M4x4[12 + 1] + ent->transform.M4x4[4 + 1] * ent->bf->bb_max[1];
+                    ppos[2] = ent->transform.M4x4[12 + 2] + ent->transform.M4x4[4 + 2] * ent->bf->bb_max[1];
+                    r *= r;
+                    if(((v[0] - ppos[0]) * (v[0] - ppos[0]) + (v[1] - ppos[1]) * (v[1] - ppos[1]) < r) &&
+                        (v[2] + 72.0f > ent->transform.M4x4[12 + 2] + ent->bf->bb_min[2]) && (v[2] - 32.0f < ent->transform.M4x4[12 + 2] + ent->bf->bb_max[2]))
                     {
-                        float ppos[3];
-                        float *v = trigger->transform.M4x4 + 12;
-                        float r = trigger->activation_point->offset[3];
-
-                        ppos[0] = ent->transform.M4x4[12 + 0] + ent->transform.M4x4[4 + 0] * ent->bf->bb_max[1];
-                        ppos[1] = ent->transform.M4x4[12 + 1] + ent->transform.M4x4[4 + 1] * ent->bf->bb_max[1];
-                        ppos[2] = ent->transform.M4x4[12 + 2] + ent->transform.M4x4[4 + 2] * ent->bf->bb_max[1];
-                        r *= r;
-                        if(((v[0] - ppos[0]) * (v[0] - ppos[0]) + (v[1] - ppos[1]) * (v[1] - ppos[1]) < r) &&
-                            (v[2] + 72.0f > ent->transform.M4x4[12 + 2] + ent->bf->bb_min[2]) && (v[2] - 32.0f < ent->transform.M4x4[12 + 2] + ent->bf->bb_max[2]))
-                        {
-                            Script_ExecEntity(engine_lua, ENTITY_CALLBACK_ACTIVATE, trigger->id, ent->id);
-                        }
+                        Script_ExecEntity(engine_lua, ENTITY_CALLBACK_ACTIVATE, trigger->id, ent->id);
                     }
                 }
             }
         }
+
+        if(candidates != buf)
+        {
+            Sys_ReturnTempMem(count * sizeof(entity_p));
+        }
     }
 }
 
@@ -1359,6 +1611,7 @@ void Entity_CheckActivators(struct entity_s *ent)
 int  Entity_Activate(struct entity_s *entity_object, struct entity_s *entity_activator, uint16_t trigger_mask, uint16_t trigger_op, uint16_t trigger_lock, uint16_t trigger_timer)
 {
     int activation_state = ENTITY_TRIGGERING_NOT_READY;
+    World_WakeEntity(entity_object, WORLD_ACTIVATION_WAKE_TIME);
     if((trigger_timer > 0) && (entity_object->timer > 0.0f) && (trigger_op != TRIGGER_OP_AND_INV))
     {
         entity_object->timer = trigger_timer;                                   // Engage timer.
@@ -1425,6 +1678,7 @@ int  Entity_Activate(struct entity_s *entity_object, struct entity_s *entity_act
 int  Entity_Deactivate(struct entity_s *entity_object, struct entity_s *entity_activator)
 {
     int activation_state = ENTITY_TRIGGERING_NOT_READY;
+    World_WakeEntity(entity_object, WORLD_ACTIVATION_WAKE_TIME);
     if(!((entity_object->trigger_layout & ENTITY_TLAYOUT_LOCK) >> 6))           // Ignore deactivation, if activity lock is set.
     {
         int activator_id = (entity_activator) ? (entity_activator->id) : (-1);
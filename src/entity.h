@@ -16,6 +16,11 @@ struct physics_data_s;
 struct inventory_node_s;
 
 #define ENTITY_ID_NONE                              (0xFFFFFFFF)
+#define ENTITY_HANDLE_NONE                          (0xFFFFFFFF)
+#define ENTITY_HANDLE_SLOT_BITS                     (20)
+#define ENTITY_HANDLE_SLOT_MASK                     ((1U << ENTITY_HANDLE_SLOT_BITS) - 1)
+#define ENTITY_HANDLE_GENERATION_MASK               (0x0FFF)
+#define ENTITY_POOL_BLOCK_SIZE                      (256)
 
 #define ENTITY_STATE_ENABLED                        (0x0001)    // Entity is enabled.
 #define ENTITY_STATE_ACTIVE                         (0x0002)    // Entity is animated.
@@ -24,6 +29,11 @@ struct inventory_node_s;
 #define ENTITY_STATE_NO_CAM_TARGETABLE              (0x0010)    // Disallow targeting by the camera.
 #define ENTITY_STATE_DELETED                        (0x1000)    // Will be deleted on update.
 
+#define ENTITY_DIRTY_POSE                           (0x0001)    // Animation frame / lerp changed, bone frame must be recalculated.
+#define ENTITY_DIRTY_TRANSFORM                      (0x0002)    // Moved: OBB, room and ghosts must be updated.
+#define ENTITY_DIRTY_PHYSICS                        (0x0004)    // Collision state changed: bodies must be placed again.
+#define ENTITY_DIRTY_ALL                            (0x0007)
+
 #define ENTITY_TYPE_GENERIC                         (0x0000)    // Just an animating.
 #define ENTITY_TYPE_INTERACTIVE                     (0x0001)    // Can respond to other entity's commands.
 #define ENTITY_TYPE_TRIGGER_ACTIVATOR               (0x0002)    // Can activate triggers.
@@ -138,6 +148,7 @@ typedef struct activation_point_s
 typedef struct entity_s
 {
     uint32_t                            id;                     // Unique entity ID
+    uint32_t                            handle;                 // pool slot + generation, see Entity_GetByHandle
     int32_t                             OCB;                    // Object code bit (since TR4)
     
     uint32_t                            trigger_layout : 8;     // Mask + once + event + sector status flags
@@ -148,9 +159,11 @@ typedef struct entity_s
     uint32_t                            no_anim_pos_autocorrection : 1;
     
     float                               timer;              // Set by "timer" trigger field
+    float                               awake_time;         // Stays active out of activation region while > 0
     uint32_t                            callback_flags;     // information about scripts callbacks
     uint16_t                            type_flags;
     uint16_t                            state_flags;
+    uint16_t                            dirty_flags;        // cleared by game frame update after processing
     
     float                               linear_speed;
     float                               anim_linear_speed;  // current linear speed from animation info
@@ -160,9 +173,25 @@ typedef struct entity_s
     struct ss_bone_frame_s             *bf;                 // current boneframe with full frame information
     struct physics_data_s              *physics;
     struct engine_transform_s           transform;
+    struct
+    {
+        int16_t                         animation;
+        int16_t                         frame;
+        int16_t                         prev_animation;
+        int16_t                         prev_frame;
+        float                           lerp;
+        float                           transform[16];
+    }                                   last_update;        // pose and transform of the last dirty check
     
     struct obb_s                       *obb;                // oriented bounding box
     struct engine_container_s          *self;
+    struct
+    {
+        uint16_t                        bucket;             // ENTITY_GRID_NONE if not indexed
+        int16_t                         cell[2];
+        struct entity_s                *next;
+        struct entity_s                *prev;
+    }                                   grid;               // spatial index links, see entity_grid.h
 
     struct activation_point_s          *activation_point;
     struct inventory_node_s            *inventory;
@@ -171,6 +200,8 @@ typedef struct entity_s
 
 
 entity_p Entity_Create();
+entity_p Entity_GetByHandle(uint32_t handle);
+void Entity_GetPoolInfo(uint32_t *used, uint32_t *slots);
 void Entity_InitActivationPoint(entity_p entity);
 void Entity_Delete(entity_p entity);
 void Entity_Enable(entity_p ent);
@@ -181,6 +212,8 @@ void Entity_UpdateRoomPos(entity_p ent);
 void Entity_MoveToRoom(entity_p entity, struct room_s *new_room);
 
 void Entity_Frame(entity_p entity, float time);  // process frame + trying to change state
+int  Entity_UpdateAnimations(entity_p entity, float time);
+uint16_t Entity_CheckDirty(entity_p ent);
 
 void Entity_RebuildBV(entity_p ent);
 void Entity_UpdateTransform(entity_p entity);
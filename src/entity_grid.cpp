@@ -0,0 +1,248 @@
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "core/gl_util.h"
+#include "core/vmath.h"
+#include "entity.h"
+#include "entity_grid.h"
+#include "room.h"
+
+
+static struct
+{
+    struct entity_s    *buckets[ENTITY_GRID_BUCKETS];
+    uint32_t            indexed;
+    uint32_t            room_stamp;
+    float               activation_reach;
+    entity_grid_stats_t current;
+    entity_grid_stats_t last_frame;
+} entity_grid = {0};
+
+
+static inline int16_t EntityGrid_Cell(float v)
+{
+    return (int16_t)floorf(v / ENTITY_GRID_CELL_SIZE);
+}
+
+
+static inline uint16_t EntityGrid_Bucket(int16_t x, int16_t y)
+{
+    return (uint16_t)(((uint32_t)x * 73856093u) ^ ((uint32_t)y * 19349663u)) & (ENTITY_GRID_BUCKETS - 1);
+}
+
+
+static void EntityGrid_Link(struct entity_s *ent, int16_t x, int16_t y)
+{
+    uint16_t bucket = EntityGrid_Bucket(x, y);
+    ent->grid.bucket = bucket;
+    ent->grid.cell[0] = x;
+    ent->grid.cell[1] = y;
+    ent->grid.prev = NULL;
+    ent->grid.next = entity_grid.buckets[bucket];
+    if(ent->grid.next)
+    {
+        ent->grid.next->grid.prev = ent;
+    }
+    entity_grid.buckets[bucket] = ent;
+}
+
+
+static inline void EntityGrid_UpdateReach(struct entity_s *ent)
+{
+    if(ent->activation_point)
+    {
+        float reach = vec3_abs(ent->activation_point->offset) + ent->activation_point->offset[3];
+        entity_grid.activation_reach = (reach > entity_grid.activation_reach) ? (reach) : (entity_grid.activation_reach);
+    }
+}
+
+
+static void EntityGrid_Unlink(struct entity_s *ent)
+{
+    if(ent->grid.prev)
+    {
+        ent->grid.prev->grid.next = ent->grid.next;
+    }
+    else
+    {
+        entity_grid.buckets[ent->grid.bucket] = ent->grid.next;
+    }
+    if(ent->grid.next)
+    {
+        ent->grid.next->grid.prev = ent->grid.prev;
+    }
+    ent->grid.bucket = ENTITY_GRID_NONE;
+    ent->grid.next = NULL;
+    ent->grid.prev = NULL;
+}
+
+
+void EntityGrid_Clear()
+{
+    for(uint32_t i = 0; i < ENTITY_GRID_BUCKETS; i++)
+    {
+        for(struct entity_s *ent = entity_grid.buckets[i]; ent;)
+        {
+            struct entity_s *next = ent->grid.next;
+            ent->grid.bucket = ENTITY_GRID_NONE;
+            ent->grid.next = NULL;
+            ent->grid.prev = NULL;
+            ent = next;
+        }
+        entity_grid.buckets[i] = NULL;
+    }
+    entity_grid.indexed = 0;
+    entity_grid.activation_reach = 0.0f;
+}
+
+
+void EntityGrid_Add(struct entity_s *ent)
+{
+    float *pos = ent->transform.M4x4 + 12;
+    if(ent->grid.bucket != ENTITY_GRID_NONE)
+    {
+        EntityGrid_Update(ent);
+        return;
+    }
+    EntityGrid_Link(ent, EntityGrid_Cell(pos[0]), EntityGrid_Cell(pos[1]));
+    EntityGrid_UpdateReach(ent);
+    entity_grid.indexed++;
+}
+
+
+void EntityGrid_Update(struct entity_s *ent)
+{
+    if(ent->grid.bucket != ENTITY_GRID_NONE)
+    {
+        float *pos = ent->transform.M4x4 + 12;
+        int16_t x = EntityGrid_Cell(pos[0]);
+        int16_t y = EntityGrid_Cell(pos[1]);
+        if((x != ent->grid.cell[0]) || (y != ent->grid.cell[1]))
+        {
+            EntityGrid_Unlink(ent);
+            EntityGrid_Link(ent, x, y);
+            entity_grid.current.relinks++;
+        }
+        EntityGrid_UpdateReach(ent);
+    }
+}
+
+
+void EntityGrid_Remove(struct entity_s *ent)
+{
+    if(ent->grid.bucket != ENTITY_GRID_NONE)
+    {
+        EntityGrid_Unlink(ent);
+        entity_grid.indexed--;
+    }
+}
+
+
+/*
+ * Visits buckets of cells covered by the query square; if square is bigger
+ * than buckets table, all buckets are visited without cells checks (each
+ * entity is stored in one bucket only, so there are no duplicates). Rooms
+ * filter is a stamp check: room and near rooms are marked once per query.
+ */
+static int EntityGrid_Query(struct room_s *room, const float pos[3], const float dir[3], float cos_angle, float radius, struct entity_s **result, int max_count)
+{
+    int16_t x0, x1, y0, y1;
+    int all_buckets;
+    int count = 0;
+    float radius_sq = radius * radius;
+
+    if(room)
+    {
+        room->grid_stamp = ++entity_grid.room_stamp;
+        for(uint16_t i = 0; i < room->content->near_room_list_size; i++)
+        {
+            room->content->near_room_list[i]->grid_stamp = entity_grid.room_stamp;
+        }
+    }
+
+    x0 = EntityGrid_Cell(pos[0] - radius);
+    x1 = EntityGrid_Cell(pos[0] + radius);
+    y0 = EntityGrid_Cell(pos[1] - radius);
+    y1 = EntityGrid_Cell(pos[1] + radius);
+    all_buckets = ((int32_t)(x1 - x0 + 1) * (int32_t)(y1 - y0 + 1) > ENTITY_GRID_BUCKETS);
+    entity_grid.current.queries++;
+    if(all_buckets)
+    {
+        x1 = x0;
+        y1 = y0 + ENTITY_GRID_BUCKETS - 1;
+    }
+
+    for(int32_t x = x0; x <= x1; x++)
+    {
+        for(int32_t y = y0; y <= y1; y++)
+        {
+            uint16_t bucket = (all_buckets) ? (y - y0) : (EntityGrid_Bucket(x, y));
+            for(struct entity_s *ent = entity_grid.buckets[bucket]; ent; ent = ent->grid.next)
+            {
+                float v[3];
+                if(!all_buckets && ((ent->grid.cell[0] != x) || (ent->grid.cell[1] != y)))
+                {
+                    continue;
+                }
+                entity_grid.current.candidates++;
+                vec3_sub(v, ent->transform.M4x4 + 12, pos);
+                if(v[0] * v[0] + v[1] * v[1] > radius_sq)
+                {
+                    continue;
+                }
+                if(room && (!ent->self->room || (ent->self->room->grid_stamp != entity_grid.room_stamp)))
+                {
+                    continue;
+                }
+                if(dir && (vec3_dot(v, dir) <= cos_angle * vec3_abs(v)))
+                {
+                    continue;
+                }
+                if(count < max_count)
+                {
+                    result[count] = ent;
+                }
+                count++;
+            }
+        }
+    }
+    entity_grid.current.results += count;
+
+    return count;
+}
+
+
+int EntityGrid_QueryRadius(struct room_s *room, const float pos[3], float radius, struct entity_s **result, int max_count)
+{
+    return EntityGrid_Query(room, pos, NULL, 0.0f, radius, result, max_count);
+}
+
+
+int EntityGrid_QueryCone(struct room_s *room, const float pos[3], const float dir[3], float cos_angle, float radius, struct entity_s **result, int max_count)
+{
+    return EntityGrid_Query(room, pos, dir, cos_angle, radius, result, max_count);
+}
+
+
+float EntityGrid_GetActivationReach()
+{
+    return entity_grid.activation_reach;
+}
+
+
+void EntityGrid_GetStats(entity_grid_stats_p stats)
+{
+    *stats = entity_grid.last_frame;
+    stats->indexed = entity_grid.indexed;
+}
+
+
+void EntityGrid_ResetStats()
+{
+    entity_grid.last_frame = entity_grid.current;
+    entity_grid.current.relinks = 0;
+    entity_grid.current.queries = 0;
+    entity_grid.current.candidates = 0;
+    entity_grid.current.results = 0;
+}
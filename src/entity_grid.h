@@ -0,0 +1,47 @@
+
+#ifndef ENTITY_GRID_H
+#define ENTITY_GRID_H
+
+/*
+ * Spatial index of active entities: uniform XY grid of cells, hashed into a
+ * fixed buckets table. Index is rebuilt with the active entities list
+ * (sleeping entities are not indexed) and is updated incrementally on entity
+ * move (Entity_UpdateRoomPos), so proximity queries do not scan rooms
+ * containers lists.
+ */
+
+#include <stdint.h>
+
+#define ENTITY_GRID_CELL_SIZE       (2048.0f)                                   // 2 sectors
+#define ENTITY_GRID_BUCKETS         (1024)                                      // power of 2
+#define ENTITY_GRID_NONE            (0xFFFF)                                    // entity is not indexed
+
+struct entity_s;
+struct room_s;
+
+typedef struct entity_grid_stats_s
+{
+    uint32_t                indexed;
+    uint32_t                relinks;                                            // cell changes
+    uint32_t                queries;
+    uint32_t                candidates;                                         // entities tested by queries
+    uint32_t                results;
+}entity_grid_stats_t, *entity_grid_stats_p;
+
+void EntityGrid_Clear();
+void EntityGrid_Add(struct entity_s *ent);
+void EntityGrid_Update(struct entity_s *ent);                                   // only for indexed entities
+void EntityGrid_Remove(struct entity_s *ent);
+/*
+ * Queries return count of all found entities, result keeps first max_count of
+ * them, so caller repeats the query with bigger buffer if count > max_count.
+ * Radius is horizontal (XY); room (may be NULL) limits result to entities of
+ * the room and its near rooms, as rooms containers scan gives.
+ */
+int  EntityGrid_QueryRadius(struct room_s *room, const float pos[3], float radius, struct entity_s **result, int max_count);
+int  EntityGrid_QueryCone(struct room_s *room, const float pos[3], const float dir[3], float cos_angle, float radius, struct entity_s **result, int max_count);   // dir - normalized
+float EntityGrid_GetActivationReach();                                          // max distance of indexed entities activation points reach
+void EntityGrid_GetStats(entity_grid_stats_p stats);                            // last frame counters
+void EntityGrid_ResetStats();
+
+#endif //ENTITY_GRID_H
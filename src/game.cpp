@@ -1,6 +1,8 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL_timer.h>
 
 extern "C" {
 #include <lua.h>
@@ -13,9 +15,11 @@ extern "C" {
 #include "core/vmath.h"
 #include "core/polygon.h"
 #include "core/obb.h"
+#include "core/thread_pool.h"
 #include "render/camera.h"
 #include "render/frustum.h"
 #include "render/render.h"
+#include "physics/physics.h"
 #include "gui/gui.h"
 #include "gui/gui_inventory.h"
 #include "script/script.h"
@@ -24,6 +28,7 @@ extern "C" {
 #include "engine.h"
 #include "controls.h"
 #include "room.h"
+#include "room_zones.h"
 #include "world.h"
 #include "game.h"
 #include "skeletal_model.h"
@@ -40,6 +45,76 @@ extern lua_State *engine_lua;
 int Game_ProcessMenu(entity_p player);
 int Save_Entity(entity_p ent, void *data);
 
+/*
+ * Entities updated in current frame. Logic (scripts, state control, anim
+ * frames switching) is single threaded, then poses of all listed entities
+ * are evaluated on worker threads, then rigid bodies and rooms are updated.
+ * Only dirty entities (see Entity_CheckDirty) are listed.
+ */
+static struct
+{
+    uint32_t        size;
+    uint32_t        visited;
+    float           logic_time;                                                 // ms, last frame
+    uint32_t        count;
+    uint32_t        pose_count;
+    entity_p       *entities;
+    entity_p       *pose_entities;
+    float           pose_time;                                                  // ms, last frame
+    uint32_t        characters_size;
+    uint32_t        characters_count;
+    entity_p       *characters;                                                 // logic updated characters, probes are prefetched for
+    float           probes_time;                                                // ms, last frame
+} game_update_list = {0};
+
+
+static void Game_UpdateListAdd(entity_p ent, int need_pose)
+{
+    if(game_update_list.count >= game_update_list.size)
+    {
+        game_update_list.size = (game_update_list.size) ? (2 * game_update_list.size) : (64);
+        game_update_list.entities = (entity_p*)realloc(game_update_list.entities, game_update_list.size * sizeof(entity_p));
+        game_update_list.pose_entities = (entity_p*)realloc(game_update_list.pose_entities, game_update_list.size * sizeof(entity_p));
+    }
+    game_update_list.entities[game_update_list.count++] = ent;
+    if(need_pose)
+    {
+        game_update_list.pose_entities[game_update_list.pose_count++] = ent;
+    }
+}
+
+
+static int Game_CollectCharacter(entity_p ent, void * /*data*/)
+{
+    const uint16_t mask = ENTITY_STATE_ENABLED | ENTITY_STATE_ACTIVE;
+    if(ent && ent->character && (ent != World_GetPlayer()) && (!ent->self->room || (ent->self->room == ent->self->room->real_room)) &&
+       (mask == (ent->state_flags & mask)) && !(ent->type_flags & ENTITY_TYPE_DYNAMIC))
+    {
+        if(game_update_list.characters_count >= game_update_list.characters_size)
+        {
+            game_update_list.characters_size = (game_update_list.characters_size) ? (2 * game_update_list.characters_size) : (64);
+            game_update_list.characters = (entity_p*)realloc(game_update_list.characters, game_update_list.characters_size * sizeof(entity_p));
+        }
+        game_update_list.characters[game_update_list.characters_count++] = ent;
+    }
+
+    return 0;
+}
+
+
+static void Game_UpdatePoseJob(void *data, int index, int /*thread_index*/)
+{
+    entity_p ent = game_update_list.pose_entities[index];
+    SSBoneFrame_Update(ent->bf, *((float*)data));
+}
+
+
+void Game_UpdatePoses(float time)
+{
+    ThreadPool_ParallelFor(Game_UpdatePoseJob, &time, game_update_list.pose_count);
+}
+
+
 int lua_mlook(lua_State * lua)
 {
     if(lua_gettop(lua) == 0)
@@ -100,6 +175,135 @@ int lua_noclip(lua_State * lua)
 }
 
 
+int lua_phys_threads(lua_State * lua)
+{
+    if(lua_gettop(lua) > 0)
+    {
+        Physics_SetThreadsCount(lua_tointeger(lua, 1));
+    }
+
+    Con_Printf("phys_threads = %d", (int)physics_settings.threads);
+    return 0;
+}
+
+
+int lua_entity_activation(lua_State * lua)
+{
+    uint32_t active, sleeping;
+    float update_time;
+
+    if(lua_gettop(lua) > 0)
+    {
+        World_SetActivationDepth(lua_tointeger(lua, 1));
+    }
+
+    World_GetActivationStats(&active, &sleeping, &update_time);
+    Con_Printf("entity_activation = %d, active = %d, sleeping = %d, last rebuild = %.3f ms", (int)World_GetActivationDepth(), (int)active, (int)sleeping, update_time);
+    return 0;
+}
+
+
+int lua_room_collision_stats(lua_State * lua)
+{
+    const char *mode_names[2] = {"trimesh", "simplified"};
+    for(int mode = PHYSICS_ROOM_COLLISION_TRIMESH; mode <= PHYSICS_ROOM_COLLISION_SIMPLIFIED; mode++)
+    {
+        room_collision_stats_t stats;
+        World_GetRoomCollisionStats(mode, &stats);
+        Con_Printf("%s: rooms = %d, triangles = %d, boxes = %d, memory = %d kb", mode_names[mode], (int)stats.rooms, (int)stats.triangles, (int)stats.boxes, (int)(stats.memory / 1024));
+        Con_Printf("%s: rays = %d, %.3f ms, %.3f us per ray", mode_names[mode], (int)stats.rays, stats.rays_time, (stats.rays > 0) ? (1000.0f * stats.rays_time / (float)stats.rays) : (0.0f));
+    }
+    Con_Printf("room_collision = %d", (int)physics_settings.room_collision);
+    return 0;
+}
+
+
+int lua_path_cache(lua_State * lua)
+{
+    path_cache_stats_t stats;
+    if(lua_gettop(lua) > 0)
+    {
+        Room_SetPathCacheEnabled(lua_tointeger(lua, 1));
+    }
+    Room_GetPathCacheStats(&stats);
+    Con_Printf("path_cache = %d", Room_IsPathCacheEnabled());
+    Con_Printf("lookups = %d, hits = %d, repairs = %d, searches = %d, invalidations = %d, hit rate = %.1f%%", (int)stats.lookups, (int)stats.hits,
+               (int)stats.repairs, (int)stats.searches, (int)stats.invalidations, (stats.lookups > 0) ? (100.0f * (float)(stats.hits + stats.repairs) / (float)stats.lookups) : (0.0f));
+    return 0;
+}
+
+
+int lua_path_zones(lua_State * lua)
+{
+    zones_stats_t stats;
+    Zones_GetStats(&stats);
+    Con_Printf("zones tables = %d, clusters = %d, memory = %d kb, build time = %.3f ms", (int)stats.tables, (int)stats.clusters, (int)(stats.memory / 1024), stats.build_time);
+    Con_Printf("labels builds = %d, distances builds = %d, relabels = %d", (int)stats.labels_builds, (int)stats.distances_builds, (int)stats.relabels);
+    Con_Printf("reachability queries = %d, rejected without search = %d", (int)stats.queries, (int)stats.rejects);
+    return 0;
+}
+
+
+int lua_ai_budget(lua_State * lua)
+{
+    ai_stats_t stats;
+    if(lua_gettop(lua) > 0)
+    {
+        Character_SetAIBudget(lua_tonumber(lua, 1));
+    }
+    Character_GetAIStats(&stats);
+    Con_Printf("ai budget = %.3f ms (<= 0 - unlimited)", Character_GetAIBudget());
+    Con_Printf("last frame: updates = %d, ai = %.3f ms, thinks = %d, %.3f ms", (int)stats.updates, stats.ai_time, (int)stats.thinks, stats.think_time);
+    Con_Printf("skipped by rate = %d, deferred = %d, forced = %d", (int)stats.skipped, (int)stats.deferred, (int)stats.forced);
+    return 0;
+}
+
+
+int lua_character_probes(lua_State * lua)
+{
+    character_probes_stats_t stats;
+    Character_GetProbesStats(&stats);
+    Con_Printf("character probes: requested = %d, executed = %d, hit rate = %.1f%%", (int)stats.requested, (int)stats.executed,
+               (stats.requested > 0) ? (100.0f * (stats.requested - stats.executed) / stats.requested) : (0.0f));
+    Con_Printf("caches dropped by moving / world changes = %d", (int)stats.invalidations);
+    Con_Printf("prefetched = %d, used = %d", (int)stats.prefetched, (int)stats.prefetch_hits);
+    if((lua_gettop(lua) > 0) && lua_toboolean(lua, 1))
+    {
+        Character_ResetProbesStats();
+    }
+    return 0;
+}
+
+
+void Game_Destroy()
+{
+    free(game_update_list.entities);
+    free(game_update_list.pose_entities);
+    free(game_update_list.characters);
+    memset(&game_update_list, 0x00, sizeof(game_update_list));
+}
+
+
+void Game_GetUpdateStats(uint32_t *visited, uint32_t *entities, uint32_t *poses, float *logic_time, float *pose_time, float *probes_time)
+{
+    *visited = game_update_list.visited;
+    *logic_time = game_update_list.logic_time;
+    *entities = game_update_list.count;
+    *poses = game_update_list.pose_count;
+    *pose_time = game_update_list.pose_time;
+    *probes_time = game_update_list.probes_time;
+}
+
+
+void Game_GetUpdateLists(entity_p **pose_entities, uint32_t *pose_count, entity_p **characters, uint32_t *characters_count)
+{
+    *pose_entities = game_update_list.pose_entities;
+    *pose_count = game_update_list.pose_count;
+    *characters = game_update_list.characters;
+    *characters_count = game_update_list.characters_count;
+}
+
+
 void Game_InitGlobals()
 {
     control_states.free_look_speed = 3000.0;
@@ -118,7 +322,16 @@ void Game_RegisterLuaFunctions(struct lua_State *lua)
         lua_register(lua, "freelook", lua_freelook);
         lua_register(lua, "cam_distance", lua_cam_distance);
         lua_register(lua, "noclip", lua_noclip);
+        lua_register(lua, "phys_threads", lua_phys_threads);
+        lua_register(lua, "room_collision_stats", lua_room_collision_stats);
+        lua_register(lua, "entity_activation", lua_entity_activation);
+        lua_register(lua, "path_cache", lua_path_cache);
+        lua_register(lua, "path_zones", lua_path_zones);
+        lua_register(lua, "ai_budget", lua_ai_budget);
+        lua_register(lua, "character_probes", lua_character_probes);
     }
+
+    Game_RegisterBenchFunctions(lua);
 }
 
 
@@ -624,9 +837,14 @@ int Game_UpdateEntity(entity_p ent, void *data)
             Entity_ProcessSector(ent);
             Script_LoopEntity(engine_lua, ent);
         }
-        Entity_Frame(ent, engine_frame_time);
-        Entity_UpdateRigidBody(ent, ent->character != NULL);
-        Entity_UpdateRoomPos(ent);
+        // pose, rigid body and room are updated after all entities logic
+        Entity_CheckDirty(ent);                                                 // moved by scripts since the last frame
+        int need_pose = Entity_UpdateAnimations(ent, engine_frame_time);
+        game_update_list.visited++;
+        if(Entity_CheckDirty(ent) || (ent->type_flags & ENTITY_TYPE_DYNAMIC))
+        {
+            Game_UpdateListAdd(ent, need_pose && (ent->dirty_flags & ENTITY_DIRTY_POSE));
+        }
     }
 
     return 0;
@@ -813,7 +1031,39 @@ void Game_Frame(float time)
         }
     }
 
-    World_IterateAllEntities(Game_UpdateEntity, NULL);
+    game_update_list.visited = 0;
+    game_update_list.count = 0;
+    game_update_list.pose_count = 0;
+    game_update_list.characters_count = 0;
+    World_UpdateActiveEntities(engine_frame_time);
+    Character_AIBeginFrame();
+    {
+        uint64_t start = SDL_GetPerformanceCounter();
+        World_IterateActiveEntities(Game_CollectCharacter, NULL);
+        Character_PrefetchProbes(game_update_list.characters, game_update_list.characters_count);
+        game_update_list.probes_time = 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+    }
+    {
+        uint64_t start = SDL_GetPerformanceCounter();
+        World_IterateActiveEntities(Game_UpdateEntity, NULL);
+        game_update_list.logic_time = 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+    }
+    {
+        uint64_t start = SDL_GetPerformanceCounter();
+        Game_UpdatePoses(engine_frame_time);
+        game_update_list.pose_time = 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+    }
+    for(uint32_t i = 0; i < game_update_list.count; i++)
+    {
+        entity_p ent = game_update_list.entities[i];
+        Entity_UpdateRigidBody(ent, ent->character != NULL);
+        if(!(ent->type_flags & ENTITY_TYPE_DYNAMIC))
+        {
+            Entity_GhostUpdate(ent);                                            // ghosts follow bones, so after the pose pass
+        }
+        Entity_UpdateRoomPos(ent);
+        ent->dirty_flags = 0x00;
+    }
     Physics_StepSimulation(time);
     renderer.UpdateAnimTextures();
 }
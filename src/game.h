@@ -14,11 +14,16 @@ struct camera_s;
 struct entity_s;
 
 void Game_InitGlobals();
+void Game_Destroy();
+void Game_GetUpdateStats(uint32_t *visited, uint32_t *entities, uint32_t *poses, float *logic_time, float *pose_time, float *probes_time);
+void Game_GetUpdateLists(struct entity_s ***pose_entities, uint32_t *pose_count, struct entity_s ***characters, uint32_t *characters_count);
 void Game_RegisterLuaFunctions(struct lua_State *lua);
+void Game_RegisterBenchFunctions(struct lua_State *lua);
 int Game_Load(const char* name);
 int Game_Save(const char* name);
 
 void Game_Frame(float time);
+void Game_UpdatePoses(float time);
 
 void Game_Prepare();
 
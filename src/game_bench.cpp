@@ -0,0 +1,832 @@
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL_timer.h>
+
+extern "C" {
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+#include "core/system.h"
+#include "core/console.h"
+#include "core/avl.h"
+#include "core/vmath.h"
+#include "core/obb.h"
+#include "core/pose_simd.h"
+#include "core/thread_pool.h"
+#include "physics/physics.h"
+#include "vt/tr_versions.h"
+#include "room.h"
+#include "room_grid.h"
+#include "world.h"
+#include "game.h"
+#include "skeletal_model.h"
+#include "entity.h"
+#include "character_controller.h"
+
+/*
+ * Console tests and benchmarks: optimized engine paths are checked against
+ * the reference ones on current level data and measured. Nothing here is
+ * called by the game itself.
+ */
+
+typedef void (*bench_run_func)(void *data);
+typedef void (*bench_snapshot_func)(void *data, uint8_t *buffer);             // fills elements_count * element_size bytes
+
+
+static float Bench_Ms(uint64_t ticks)
+{
+    return 1000.0f * (float)ticks / (float)SDL_GetPerformanceFrequency();
+}
+
+
+static int Bench_GetCount(lua_State * lua, int default_count)
+{
+    int count = (lua_gettop(lua) > 0) ? (lua_tointeger(lua, 1)) : (default_count);
+    return (count > 0) ? (count) : (1);
+}
+
+
+static uint32_t Bench_Random(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+
+static void Bench_PrintQueries(const char *name1, uint64_t time1, const char *name2, uint64_t time2, int count)
+{
+    double freq = (double)SDL_GetPerformanceFrequency();
+    Con_Printf("%s: %.3f ms, %.0f q/s; %s: %.3f ms, %.0f q/s", name1, Bench_Ms(time1), (time1 > 0) ? ((double)count * freq / time1) : (0.0),
+               name2, Bench_Ms(time2), (time2 > 0) ? ((double)count * freq / time2) : (0.0));
+}
+
+
+/*
+ * Checks that worker threads give the same results as serial run (elements
+ * of results snapshots are compared) and measures run with 1..N threads of
+ * the engine pool; pool is not recreated, only threads taking jobs are limited.
+ */
+static void Bench_ThreadsTest(const char *name, bench_run_func run, bench_snapshot_func snapshot, uint32_t elements_count, size_t element_size, void *data, int iterations)
+{
+    int threads_count = ThreadPool_GetThreadsCount();
+    int jobs_threads = ThreadPool_GetJobsThreads();                             // configured limit is restored after the test
+    uint8_t *ref = (uint8_t*)malloc(2 * elements_count * element_size);
+    uint8_t *cur = ref + elements_count * element_size;
+    uint32_t mismatches = 0;
+
+    run(data);                                                                  // the first run may change state, that later runs keep
+    ThreadPool_SetJobsThreads(1);
+    run(data);
+    snapshot(data, ref);
+    ThreadPool_SetJobsThreads(0);
+    run(data);
+    snapshot(data, cur);
+    for(uint32_t i = 0; i < elements_count; i++)
+    {
+        mismatches += (memcmp(ref + i * element_size, cur + i * element_size, element_size)) ? (1) : (0);
+    }
+    free(ref);
+    Con_Printf("%s determinism: elements = %d, threads = %d, mismatches = %d", name, (int)elements_count, threads_count, (int)mismatches);
+
+    for(int t = 1; t <= threads_count; t++)
+    {
+        uint64_t start;
+        ThreadPool_SetJobsThreads(t);
+        start = SDL_GetPerformanceCounter();
+        for(int i = 0; i < iterations; i++)
+        {
+            run(data);
+        }
+        Con_Printf("%s threads = %d: %.3f ms per run", name, t, Bench_Ms(SDL_GetPerformanceCounter() - start) / (float)iterations);
+    }
+    ThreadPool_SetJobsThreads(jobs_threads);
+}
+
+
+int lua_pose_simd(lua_State * lua)
+{
+    const char *level_names[3] = {"scalar", "sse", "avx"};
+    if(lua_gettop(lua) > 0)
+    {
+        Pose_Init(lua_tointeger(lua, 1));
+    }
+
+    for(int level = POSE_SIMD_SSE; level <= POSE_SIMD_AVX; level++)
+    {
+        Con_Printf("%s vs scalar: max difference = %f", level_names[level], Pose_TestSimd(level, 1024));
+    }
+    Con_Printf("pose_simd = %s", level_names[Pose_GetSimdLevel()]);
+    return 0;
+}
+
+
+static void Bench_UpdatePoses(void * /*data*/)
+{
+    Game_UpdatePoses(0.0f);                                                     // zero time step keeps targeted bones state
+}
+
+
+static void Bench_PosesSnapshot(void * /*data*/, uint8_t *buffer)
+{
+    entity_p *entities, *characters;
+    uint32_t count, characters_count;
+
+    Game_GetUpdateLists(&entities, &count, &characters, &characters_count);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        ss_bone_frame_p bf = entities[i]->bf;
+        for(uint16_t j = 0; j < bf->bone_tag_count; j++, buffer += 16 * sizeof(float))
+        {
+            memcpy(buffer, bf->bone_tags[j].current_transform, 16 * sizeof(float));
+        }
+    }
+}
+
+/*
+ * Poses update of current frame entities: bones matrices are compared.
+ */
+int lua_anim_threads_test(lua_State * lua)
+{
+    entity_p *entities, *characters;
+    uint32_t count, characters_count, bones_count = 0;
+
+    Game_GetUpdateLists(&entities, &count, &characters, &characters_count);
+    if(count == 0)
+    {
+        Con_Printf("anim_threads_test: no animated entities");
+        return 0;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        bones_count += entities[i]->bf->bone_tag_count;
+    }
+    Bench_ThreadsTest("anim", Bench_UpdatePoses, Bench_PosesSnapshot, bones_count, 16 * sizeof(float), NULL, Bench_GetCount(lua, 100));
+
+    return 0;
+}
+
+
+int lua_anim_dispatch_test(lua_State * lua)
+{
+    skeletal_model_p models;
+    uint32_t models_count, checks = 0, mismatches = 0, anims = 0;
+
+    World_GetSkeletalModelsInfo(&models, &models_count);
+    for(uint32_t i = 0; i < models_count; i++)
+    {
+        for(uint16_t j = 0; j < models[i].animation_count; j++)
+        {
+            uint32_t m = Anim_CheckStateChangeLUT(models[i].animations + j, &checks);
+            if(m > 0)
+            {
+                Con_Printf("model %d, anim %d: %d mismatches", (int)models[i].id, (int)j, (int)m);
+            }
+            mismatches += m;
+            anims++;
+        }
+    }
+    Con_Printf("anim dispatch lookup: models = %d, anims = %d, checks = %d, mismatches = %d", (int)models_count, (int)anims, (int)checks, (int)mismatches);
+    return 0;
+}
+
+
+static int Bench_EntityTreeAdd(entity_p ent, void *data)
+{
+    AVL_InsertReplace((avl_header_p)data, ent->id, ent);
+    return 0;
+}
+
+
+static int Bench_EntityCount(entity_p ent, void *data)
+{
+    *((uint32_t*)data) += ent->state_flags & ENTITY_STATE_ENABLED;
+    return 0;
+}
+
+/*
+ * Compares entities pool (ids table + handles) with AVL tree storage,
+ * that was used before: lookup by id of all entities and full iteration;
+ * measures entities bounding volumes update.
+ */
+int lua_entity_storage_test(lua_State * lua)
+{
+    int iterations = Bench_GetCount(lua, 1000);
+    uint64_t avl_lookup, pool_lookup, avl_iterate, pool_iterate, obb_update, start;
+    uint32_t used, slots, found = 0, enabled = 0;
+    avl_header_t tree;
+
+    AVL_Init(&tree);
+    World_IterateAllEntities(Bench_EntityTreeAdd, &tree);
+    if(tree.nodes_count == 0)
+    {
+        Con_Printf("entity storage test: no entities");
+        return 0;
+    }
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < iterations; i++)
+    {
+        for(avl_node_p p = tree.list; p; p = p->next)
+        {
+            avl_node_p n = AVL_SearchNode(&tree, p->key);
+            found += (n != NULL);
+        }
+    }
+    avl_lookup = SDL_GetPerformanceCounter() - start;
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < iterations; i++)
+    {
+        for(avl_node_p p = tree.list; p; p = p->next)
+        {
+            found += (World_GetEntityByID(p->key) != NULL);
+        }
+    }
+    pool_lookup = SDL_GetPerformanceCounter() - start;
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < iterations; i++)
+    {
+        for(avl_node_p p = tree.list; p; p = p->next)
+        {
+            Bench_EntityCount((entity_p)p->data, &enabled);
+        }
+    }
+    avl_iterate = SDL_GetPerformanceCounter() - start;
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < iterations; i++)
+    {
+        World_IterateAllEntities(Bench_EntityCount, &enabled);
+    }
+    pool_iterate = SDL_GetPerformanceCounter() - start;
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < iterations; i++)
+    {
+        for(avl_node_p p = tree.list; p; p = p->next)
+        {
+            Entity_RebuildBV((entity_p)p->data);
+        }
+    }
+    obb_update = SDL_GetPerformanceCounter() - start;
+
+    Entity_GetPoolInfo(&used, &slots);
+    Con_Printf("entities = %d, pool slots = %d / %d, checks = %d", (int)tree.nodes_count, (int)used, (int)slots, (int)(found + enabled));
+    Con_Printf("obb: %d bytes, rebuild + transform = %.3f ms", (int)sizeof(obb_t), Bench_Ms(obb_update));
+    Con_Printf("lookup: avl = %.3f ms, pool = %.3f ms", Bench_Ms(avl_lookup), Bench_Ms(pool_lookup));
+    Con_Printf("iterate: avl = %.3f ms, pool = %.3f ms", Bench_Ms(avl_iterate), Bench_Ms(pool_iterate));
+    AVL_MakeEmpty(&tree);                                                       // tree does not own entities
+
+    return 0;
+}
+
+
+/*
+ * Old frontier search over boxes, A* search reference.
+ */
+static int Bench_FindPathFrontier(room_box_p *path_buf, uint32_t max_boxes, room_sector_p from, room_sector_p to, box_validition_options_p op)
+{
+    int ret = 0;
+    if(from->box && to->box)
+    {
+        if(from->box->id != to->box->id)
+        {
+            float pt_from[3], pt_to[3];
+            const int buf_size = sizeof(room_box_p) * max_boxes;
+            room_box_p *current_front = (room_box_p*)Sys_GetTempMem(3 * buf_size);
+            room_box_p *next_front = current_front + max_boxes;
+            room_box_p *parents = next_front + max_boxes;
+            int32_t *weights = (int32_t*)Sys_GetTempMem(max_boxes * sizeof(int32_t));
+            size_t current_front_size = 1;
+            size_t next_front_size = 0;
+
+            current_front[0] = from->box;
+            weights[current_front[0]->id] = 0;
+            memset(parents, 0x00, buf_size);
+
+            while(current_front_size > 0)
+            {
+                for(size_t i = 0; i < current_front_size; ++i)
+                {
+                    room_box_p current_box = current_front[i];
+                    box_overlap_p ov = current_box->overlaps;
+                    if(parents[current_box->id])
+                    {
+                        Room_GetOverlapCenter(parents[current_box->id], current_box, pt_from);
+                    }
+                    else
+                    {
+                        vec3_copy(pt_from, from->pos);
+                    }
+
+                    while(ov)
+                    {
+                        room_box_p next_box = World_GetRoomBoxByID(ov->box);
+                        Room_GetOverlapCenter(current_box, next_box, pt_to);
+                        int32_t weight = (fabs(pt_to[0] - pt_from[0]) + fabs(pt_to[1] - pt_from[1]) + 1.0f) / TR_METERING_STEP;
+                        if((next_box->id != from->box->id) && Room_IsBoxForPath(current_box, next_box, op) &&
+                           (!parents[to->box->id] || (weights[current_box->id] + weight < weights[to->box->id])))
+                        {
+                            if(!parents[next_box->id])
+                            {
+                                next_front[next_front_size++] = next_box;
+                                parents[next_box->id] = current_box;
+                                weights[next_box->id] = weights[current_box->id] + weight;
+                            }
+                            else if(weights[next_box->id] > weights[current_box->id] + weight)
+                            {
+                                bool not_in_front = true;
+                                parents[next_box->id] = current_box;
+                                weights[next_box->id] = weights[current_box->id] + weight;
+                                for(size_t j = 0; j < next_front_size; ++j)
+                                {
+                                    if(next_front[j]->id == next_box->id)
+                                    {
+                                        not_in_front = false;
+                                        break;
+                                    }
+                                }
+
+                                if(not_in_front)
+                                {
+                                    next_front[next_front_size++] = next_box;
+                                }
+                            }
+                        }
+
+                        if(ov->end)
+                        {
+                            break;
+                        }
+                        ov++;
+                    }
+                }
+
+                ///SWAP FRONTS HERE
+                {
+                    room_box_p *tn = current_front;
+                    current_front = next_front;
+                    current_front_size = next_front_size;
+                    next_front = tn;
+                    next_front_size = 0;
+                }
+            }
+
+            if(parents[to->box->id])
+            {
+                room_box_p p = to->box;
+                while(p)
+                {
+                    path_buf[ret++] = p;
+                    p = parents[p->id];
+                }
+            }
+
+            Sys_ReturnTempMem(3 * buf_size + max_boxes * sizeof(int32_t));
+        }
+        else
+        {
+            path_buf[0] = from->box;
+            ret = 1;
+        }
+    }
+
+    return ret;
+}
+
+
+static float Bench_PathCost(room_box_p *path, int count, const float from_pos[3], box_validition_options_p op, int *valid)
+{
+    float cost = 0.0f, pt_from[3], pt_to[3];
+    vec3_copy(pt_from, from_pos);
+    for(int i = count - 1; i > 0; i--)
+    {
+        room_box_p curr_box = path[i];
+        room_box_p next_box = path[i - 1];
+        bool overlapped = false;
+        for(box_overlap_p ov = curr_box->overlaps; ov; ov++)
+        {
+            if(ov->box == next_box->id)
+            {
+                overlapped = true;
+                break;
+            }
+            if(ov->end)
+            {
+                break;
+            }
+        }
+        if(!overlapped || !Room_IsBoxForPath(curr_box, next_box, op))
+        {
+            *valid = 0;
+        }
+        Room_GetOverlapCenter(curr_box, next_box, pt_to);
+        cost += fabs(pt_to[0] - pt_from[0]) + fabs(pt_to[1] - pt_from[1]);
+        vec3_copy(pt_from, pt_to);
+    }
+    return cost;
+}
+
+
+/*
+ * Compares A* box search with the old frontier search on pseudo random
+ * box pairs of current level for each zone type: reachability, path
+ * validity (overlaps, zone and step rules) and cost.
+ */
+int lua_path_search_test(lua_State * lua)
+{
+    int pairs = Bench_GetCount(lua, 1000);
+    uint32_t boxes_count = World_GetRoomBoxesCount();
+    const uint16_t zone_types[5] = {ZONE_TYPE_1, ZONE_TYPE_2, ZONE_TYPE_3, ZONE_TYPE_4, ZONE_TYPE_FLY};
+    const float steps[5] = {TR_METERING_STEP, 2 * TR_METERING_STEP, 4 * TR_METERING_STEP, 8 * TR_METERING_STEP, 0};
+
+    if(boxes_count < 2)
+    {
+        Con_Printf("path search test: level has no boxes");
+        return 0;
+    }
+
+    room_box_p *path_astar = (room_box_p*)malloc(2 * boxes_count * sizeof(room_box_p));
+    room_box_p *path_bfs = path_astar + boxes_count;
+    uint32_t seed = 0x1234567;
+    for(int z = 0; z < 5; z++)
+    {
+        uint32_t found = 0, reach_mismatch = 0, invalid = 0, bfs_invalid = 0, cheaper = 0, costlier = 0;
+        uint64_t astar_time = 0, bfs_time = 0, start;
+        box_validition_options_t op;
+        room_sector_t from, to;
+
+        memset(&from, 0x00, sizeof(from));
+        memset(&to, 0x00, sizeof(to));
+        op.zone = 0;
+        op.zone_type = zone_types[z];
+        op.zone_alt = 0;
+        op.step_up = steps[z];
+        op.step_down = 2 * steps[z];
+        for(int i = 0; i < pairs; i++)
+        {
+            int astar_count, bfs_count;
+            from.box = World_GetRoomBoxByID(Bench_Random(&seed) % boxes_count);
+            to.box = World_GetRoomBoxByID(Bench_Random(&seed) % boxes_count);
+            from.pos[0] = 0.5f * (from.box->bb_min[0] + from.box->bb_max[0]);
+            from.pos[1] = 0.5f * (from.box->bb_min[1] + from.box->bb_max[1]);
+            from.pos[2] = from.box->bb_min[2];
+            vec3_copy(to.pos, to.box->bb_min);
+
+            start = SDL_GetPerformanceCounter();
+            astar_count = Room_FindPath(path_astar, boxes_count, &from, &to, &op);
+            astar_time += SDL_GetPerformanceCounter() - start;
+            start = SDL_GetPerformanceCounter();
+            bfs_count = Bench_FindPathFrontier(path_bfs, boxes_count, &from, &to, &op);
+            bfs_time += SDL_GetPerformanceCounter() - start;
+
+            if((astar_count > 0) != (bfs_count > 0))
+            {
+                reach_mismatch++;
+            }
+            else if(astar_count > 0)
+            {
+                int astar_valid = (path_astar[astar_count - 1] == from.box) && (path_astar[0] == to.box);
+                int bfs_valid = (path_bfs[bfs_count - 1] == from.box) && (path_bfs[0] == to.box);
+                float astar_cost = Bench_PathCost(path_astar, astar_count, from.pos, &op, &astar_valid);
+                float bfs_cost = Bench_PathCost(path_bfs, bfs_count, from.pos, &op, &bfs_valid);
+                found++;
+                invalid += !astar_valid;
+                bfs_invalid += !bfs_valid;
+                cheaper += (astar_cost + 1.0f < bfs_cost);
+                costlier += (astar_cost > bfs_cost + 1.0f);
+            }
+        }
+        Con_Printf("zone type %d: pairs = %d, found = %d, reach mismatches = %d, invalid = %d (frontier = %d), cheaper = %d, costlier = %d",
+                   (int)zone_types[z], pairs, (int)found, (int)reach_mismatch, (int)invalid, (int)bfs_invalid, (int)cheaper, (int)costlier);
+        Con_Printf("zone type %d: A* = %.3f ms, frontier = %.3f ms", (int)zone_types[z], Bench_Ms(astar_time), Bench_Ms(bfs_time));
+    }
+    free(path_astar);
+
+    return 0;
+}
+
+
+static int Bench_RandomSectorPoint(room_p room, uint32_t *seed, float pos[3])
+{
+    for(int i = 0; i < 8; i++)
+    {
+        room_sector_p rs = room->content->sectors + Bench_Random(seed) % room->sectors_count;
+        if(!rs->portal_to_room && (rs->floor != TR_METERING_WALLHEIGHT) && (rs->ceiling != TR_METERING_WALLHEIGHT))
+        {
+            vec3_copy(pos, rs->pos);
+            pos[2] = 0.5f * (rs->floor_corners[0][2] + rs->ceiling_corners[0][2]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Line of sight benchmark: pseudo random sector points pairs in the same or
+ * near rooms, World_LongRayTest vs Physics_RayTest; agreement is the same
+ * hit state and close hit points.
+ */
+int lua_long_ray_test(lua_State * lua)
+{
+    int count = Bench_GetCount(lua, 1000);
+    uint64_t start, long_time, bullet_time;
+    uint32_t rooms_count, seed = 0x1234567, queries, geometry_hits, refines, fallbacks;
+    int pairs = 0, long_hits = 0, bullet_hits = 0, agree = 0;
+    room_p rooms;
+
+    World_GetRoomInfo(&rooms, &rooms_count);
+    if(rooms_count == 0)
+    {
+        Con_Printf("long ray test: no rooms");
+        return 0;
+    }
+
+    float *points = (float*)malloc(6 * count * sizeof(float));
+    uint8_t *long_hit = (uint8_t*)malloc(2 * count * sizeof(uint8_t));
+    uint8_t *bullet_hit = long_hit + count;
+    float *long_point = (float*)malloc(6 * count * sizeof(float));
+    float *bullet_point = long_point + 3 * count;
+    for(int i = 0; (pairs < count) && (i < 4 * count); i++)
+    {
+        room_p r0 = rooms[Bench_Random(&seed) % rooms_count].real_room;
+        room_p r1 = r0;
+        uint32_t near_index = Bench_Random(&seed);
+        if(r0->content->near_room_list_size > 0)
+        {
+            r1 = r0->content->near_room_list[near_index % r0->content->near_room_list_size]->real_room;
+        }
+        if((r0->sectors_count > 0) && (r1->sectors_count > 0) &&
+           Bench_RandomSectorPoint(r0, &seed, points + 6 * pairs) && Bench_RandomSectorPoint(r1, &seed, points + 6 * pairs + 3))
+        {
+            pairs++;
+        }
+    }
+
+    World_GetLongRayStats(&queries, &geometry_hits, &refines, &fallbacks);
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < pairs; i++)
+    {
+        collision_result_t cs;
+        long_hit[i] = World_LongRayTest(&cs, points + 6 * i, points + 6 * i + 3, NULL, COLLISION_FILTER_CHARACTER);
+        vec3_copy(long_point + 3 * i, cs.point);
+    }
+    long_time = SDL_GetPerformanceCounter() - start;
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < pairs; i++)
+    {
+        collision_result_t cs;
+        bullet_hit[i] = Physics_RayTest(&cs, points + 6 * i, points + 6 * i + 3, NULL, COLLISION_FILTER_CHARACTER);
+        vec3_copy(bullet_point + 3 * i, cs.point);
+    }
+    bullet_time = SDL_GetPerformanceCounter() - start;
+
+    for(int i = 0; i < pairs; i++)
+    {
+        long_hits += long_hit[i];
+        bullet_hits += bullet_hit[i];
+        if((long_hit[i] == bullet_hit[i]) && (!long_hit[i] || (vec3_dist(long_point + 3 * i, bullet_point + 3 * i) < TR_METERING_SECTORSIZE / 4)))
+        {
+            agree++;
+        }
+    }
+
+    {
+        uint32_t q, g, r, f;
+        World_GetLongRayStats(&q, &g, &r, &f);
+        queries = q - queries;
+        geometry_hits = g - geometry_hits;
+        refines = r - refines;
+        fallbacks = f - fallbacks;
+    }
+    free(points);
+    free(long_hit);
+    free(long_point);
+
+    Con_Printf("long ray test: pairs = %d, hits: long = %d, bullet = %d, agree = %d", pairs, long_hits, bullet_hits, agree);
+    Bench_PrintQueries("long", long_time, "bullet", bullet_time, pairs);
+    Con_Printf("long: geometry hits = %d, tail bullet rays = %d, fallbacks = %d of %d", (int)geometry_hits, (int)refines, (int)fallbacks, (int)queries);
+
+    return 0;
+}
+
+
+/*
+ * Comparable part of probe result, probes cache slots are compared.
+ */
+typedef struct bench_probe_s
+{
+    int32_t                     type;                   // -1 - empty slot
+    int32_t                     ret;
+    struct engine_container_s  *floor_obj;
+    int32_t                     floor_hit;
+    int32_t                     ceiling_hit;
+    float                       floor_point[3];
+    float                       ceiling_point[3];
+    float                       transition_level;
+    int32_t                     water;
+    int32_t                     quicksand;
+}bench_probe_t, *bench_probe_p;
+
+
+typedef struct bench_characters_s
+{
+    uint32_t                    count;
+    uint32_t                    size;
+    entity_p                   *list;
+}bench_characters_t, *bench_characters_p;
+
+
+static int Bench_CharacterAdd(entity_p ent, void *data)
+{
+    bench_characters_p chars = (bench_characters_p)data;
+    if(ent->character && ent->self->room && (ent != World_GetPlayer()) && !(ent->type_flags & ENTITY_TYPE_DYNAMIC))
+    {
+        if(chars->count >= chars->size)
+        {
+            chars->size = (chars->size) ? (2 * chars->size) : (64);
+            chars->list = (entity_p*)realloc(chars->list, chars->size * sizeof(entity_p));
+        }
+        chars->list[chars->count++] = ent;
+    }
+    return 0;
+}
+
+
+static void Bench_PrefetchProbes(void *data)
+{
+    bench_characters_p chars = (bench_characters_p)data;
+    Character_PrefetchProbes(chars->list, chars->count);
+}
+
+
+static void Bench_ProbesSnapshot(void *data, uint8_t *buffer)
+{
+    bench_characters_p chars = (bench_characters_p)data;
+    bench_probe_p p = (bench_probe_p)buffer;
+
+    memset(buffer, 0x00, chars->count * CHARACTER_PROBES_CACHE_SIZE * sizeof(bench_probe_t));
+    for(uint32_t i = 0; i < chars->count; i++)
+    {
+        character_probes_p cache = &chars->list[i]->character->probes;
+        for(uint16_t j = 0; j < CHARACTER_PROBES_CACHE_SIZE; j++, p++)
+        {
+            character_probe_p probe = cache->probes + j;
+            p->type = -1;
+            if(j < cache->count)
+            {
+                p->type = probe->type;
+                p->ret = probe->ret;
+                p->floor_obj = probe->fc.floor_hit.obj;
+                p->floor_hit = probe->fc.floor_hit.hit;
+                p->ceiling_hit = probe->fc.ceiling_hit.hit;
+                vec3_copy(p->floor_point, probe->fc.floor_hit.point);
+                vec3_copy(p->ceiling_point, probe->fc.ceiling_hit.point);
+                p->transition_level = probe->fc.transition_level;
+                p->water = probe->fc.water;
+                p->quicksand = probe->fc.quicksand;
+            }
+        }
+    }
+}
+
+/*
+ * Probes prefetch of all level characters (sleeping ones too), so the scene
+ * does not depend on the player position and current frame; run it on the
+ * heavy levels: probes cache slots are compared.
+ */
+int lua_probes_threads_test(lua_State * lua)
+{
+    bench_characters_t chars = {0};
+
+    World_IterateAllEntities(Bench_CharacterAdd, &chars);
+    if(chars.count == 0)
+    {
+        Con_Printf("probes_threads_test: no characters");
+        return 0;
+    }
+
+    Con_Printf("probes_threads_test: characters = %d", (int)chars.count);
+    Bench_ThreadsTest("probes", Bench_PrefetchProbes, Bench_ProbesSnapshot, chars.count * CHARACTER_PROBES_CACHE_SIZE, sizeof(bench_probe_t), &chars, Bench_GetCount(lua, 100));
+    Character_ResetProbesStats();                                               // test prefetches are not the game ones
+    free(chars.list);
+
+    return 0;
+}
+
+
+/*
+ * Compares rooms grid search with the full rooms scan on pseudo random
+ * points of current level rooms (the same room is expected).
+ */
+int lua_room_grid_test(lua_State * lua)
+{
+    int count = Bench_GetCount(lua, 10000);
+    uint64_t start, grid_time, scan_time;
+    uint32_t rooms_count, seed = 0x1234567;
+    int points_count = 0, rooms_mismatches = 0;
+    room_p rooms, *grid_rooms, *scan_rooms;
+    float *points;
+
+    World_GetRoomInfo(&rooms, &rooms_count);
+    if((rooms_count == 0) || !RoomGrid_IsBuilt())
+    {
+        Con_Printf("room grid test: no rooms");
+        return 0;
+    }
+
+    points = (float*)malloc(3 * count * sizeof(float));
+    grid_rooms = (room_p*)malloc(2 * count * sizeof(room_p));
+    scan_rooms = grid_rooms + count;
+    for(int i = 0; (points_count < count) && (i < 4 * count); i++)
+    {
+        room_p r = rooms[Bench_Random(&seed) % rooms_count].real_room;
+        if((r->sectors_count > 0) && Bench_RandomSectorPoint(r, &seed, points + 3 * points_count))
+        {
+            float *pos = points + 3 * points_count;
+            pos[0] += (float)(Bench_Random(&seed) % 1024) - 512.0f;
+            pos[1] += (float)(Bench_Random(&seed) % 1024) - 512.0f;
+            pos[2] += (float)(Bench_Random(&seed) % 2048) - 1024.0f;
+            points_count++;
+        }
+    }
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < points_count; i++)
+    {
+        grid_rooms[i] = RoomGrid_FindRoom(points + 3 * i);
+    }
+    grid_time = SDL_GetPerformanceCounter() - start;
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < points_count; i++)
+    {
+        scan_rooms[i] = World_FindRoomByPosScan(points + 3 * i);
+    }
+    scan_time = SDL_GetPerformanceCounter() - start;
+
+    for(int i = 0; i < points_count; i++)
+    {
+        rooms_mismatches += (grid_rooms[i] != scan_rooms[i]) ? (1) : (0);
+    }
+    free(points);
+    free(grid_rooms);
+
+    Con_Printf("room grid test: points = %d, rooms mismatches = %d", points_count, rooms_mismatches);
+    Bench_PrintQueries("grid", grid_time, "full scan", scan_time, points_count);
+
+    return 0;
+}
+
+
+/*
+ * Player hairs are simulated alone with LOD disabled and with LOD, chosen by
+ * current camera (near camera they must be the same), and with every forced
+ * LOD, so simulation cost of the hair is measured, not only LOD bookkeeping.
+ */
+int lua_hair_lod_test(lua_State * lua)
+{
+    entity_p player = World_GetPlayer();
+    int steps = Bench_GetCount(lua, 300);
+
+    if(!player || !player->character || (player->character->hair_count == 0))
+    {
+        Con_Printf("hair lod test: no player hairs");
+        return 0;
+    }
+
+    for(int h = 0; h < player->character->hair_count; h++)
+    {
+        hair_lod_test_t test;
+        Hair_TestLod(player->character->hairs[h], player->physics, steps, &test);
+        Con_Printf("hair %d: steps = %d, camera lod = %d, mismatches with lod disabled = %d", h, steps, (int)test.camera_lod, (int)test.mismatches);
+        Con_Printf("hair %d: no lod = %.4f ms, camera lod = %.4f ms; full = %.4f ms, reduced = %.4f ms, kinematic = %.4f ms per step", h,
+                   test.no_lod_time, test.camera_lod_time, test.lod_time[HAIR_LOD_FULL], test.lod_time[HAIR_LOD_REDUCED], test.lod_time[HAIR_LOD_KINEMATIC]);
+    }
+
+    return 0;
+}
+
+
+void Game_RegisterBenchFunctions(struct lua_State *lua)
+{
+    if(lua != NULL)
+    {
+        lua_register(lua, "pose_simd", lua_pose_simd);
+        lua_register(lua, "anim_threads_test", lua_anim_threads_test);
+        lua_register(lua, "anim_dispatch_test", lua_anim_dispatch_test);
+        lua_register(lua, "entity_storage_test", lua_entity_storage_test);
+        lua_register(lua, "path_search_test", lua_path_search_test);
+        lua_register(lua, "long_ray_test", lua_long_ray_test);
+        lua_register(lua, "probes_threads_test", lua_probes_threads_test);
+        lua_register(lua, "room_grid_test", lua_room_grid_test);
+        lua_register(lua, "hair_lod_test", lua_hair_lod_test);
+    }
+}
@@ -134,13 +134,13 @@ void Gui_RenderItem(struct ss_bone_frame_s *bf, float size, const float *mvMatri
 
         // Render with scaled model view projection matrix
         // Use original modelview matrix, as that is used for normals whose size shouldn't change.
-        renderer.DrawSkeletalModel(shader, bf, mvMatrix, mvpMatrix);
+        renderer.DrawSkeletalModel(shader, bf, mvMatrix, mvpMatrix, NULL);
     }
     else
     {
         float mvpMatrix[16];
         Mat4_Mat4_mul(mvpMatrix, guiProjectionMatrix, mvMatrix);
-        renderer.DrawSkeletalModel(shader, bf, mvMatrix, mvpMatrix);
+        renderer.DrawSkeletalModel(shader, bf, mvMatrix, mvpMatrix, NULL);
     }
 }
 
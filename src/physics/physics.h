@@ -16,6 +16,9 @@
 // that is wrong for slide state checking.
 #define COLLISION_MARGIN_DEFAULT           (0.0f)
 
+#define PHYSICS_ROOM_COLLISION_TRIMESH      (0)     // floors, ceilings and tweens in one BVH trimesh
+#define PHYSICS_ROOM_COLLISION_SIMPLIFIED   (1)     // flat sector regions are boxes, the rest is trimesh
+
 
 typedef struct collision_node_s
 {
@@ -50,13 +53,66 @@ typedef struct ghost_shape_s
 }ghost_shape_t, *ghost_shape_p;
 
 
+typedef struct physics_settings_s
+{
+    int16_t     threads;                // engine worker threads and constraint solver batches; 0 - autodetect, 1 - native single threaded solver
+    uint16_t    ragdoll_bake : 1;       // remove ragdoll bodies after settling, pose stays in bone frame
+    float       ragdoll_linear_sleep;   // bodies sleeping thresholds
+    float       ragdoll_angular_sleep;
+    float       ragdoll_settle_time;    // time below thresholds before ragdoll is frozen
+    int16_t     room_collision;         // rooms collision mode, applied on level loading
+    uint16_t    hair_lod : 1;           // hair simulation level of detail
+    float       hair_lod_distance;      // full quality hair simulation distance
+    float       hair_lod_screen_size;   // hair smaller than that part of screen height is not simulated
+}physics_settings_t, *physics_settings_p;
+
+
+typedef struct physics_stats_s
+{
+    uint16_t    threads;                // engine thread pool size
+    uint16_t    solver_batches;
+    uint32_t    islands;                // awake islands solved by batches
+    float       step_time;              // ms
+    float       solve_time;             // ms
+    uint32_t    bodies_active;          // dynamic bodies simulated in last step
+    uint32_t    bodies_sleeping;        // dynamic bodies deactivated by bullet
+    uint32_t    bodies_frozen;          // settled ragdoll bodies, simulation disabled
+    uint32_t    bodies_baked;           // settled ragdoll bodies, removed from world
+    uint32_t    shapes_shared;          // unique mesh based collision shapes
+    uint32_t    shapes_refs;            // bodies and ghosts that use shared shapes
+    uint32_t    shapes_memory;          // bytes, shared shapes meshes and BVH
+    uint32_t    shapes_memory_unshared; // bytes, the same without sharing
+    uint16_t    hairs_full;             // hairs updated in last frame by LOD
+    uint16_t    hairs_reduced;
+    uint16_t    hairs_kinematic;
+    float       hair_time;              // ms, hairs LOD choice and kinematic follow, simulation is in step time
+}physics_stats_t, *physics_stats_p;
+
+
+typedef struct room_collision_stats_s
+{
+    uint32_t    rooms;
+    uint32_t    triangles;
+    uint32_t    boxes;
+    uint32_t    memory;                 // bytes, meshes, BVH and compound trees
+    uint32_t    rays;
+    float       rays_time;              // ms, for all test rays
+}room_collision_stats_t, *room_collision_stats_p;
+
+
 struct physics_data_s;
 struct physics_object_s;
 
+extern physics_settings_t physics_settings;
+
 /* Common physics functions */
+void Physics_InitGlobals();
 void Physics_Init();
 void Physics_Destroy();
+void Physics_SetThreadsCount(int threads);
 void Physics_StepSimulation(float time);
+void Physics_GetStats(struct physics_stats_s *stats);
+uint32_t Physics_GetWorldStamp();                                               // changes on bodies adding, removing, filters changes and simulation step; moves - see room_s::collision_stamp
 void Physics_DebugDrawWorld();
 void Physics_CleanUpObjects();
 
@@ -71,13 +127,18 @@ int  Physics_RayTestFiltered(struct collision_result_s *result, float from[3], f
 int  Physics_SphereTest(struct collision_result_s *result, float from[3], float to[3], float R, struct engine_container_s *cont, int16_t filter);
 
 /* Physics object manipulation functions */
+#define PHYSICS_SLEEP_STATE_ACTIVE      (0)
+#define PHYSICS_SLEEP_STATE_SLEEPING    (1)     // all bodies are deactivated, any contact wakes them up
+#define PHYSICS_SLEEP_STATE_FROZEN      (2)     // settled ragdoll, simulation is disabled
+#define PHYSICS_SLEEP_STATE_BAKED       (3)     // settled ragdoll, bodies and joints are out of world
+
 int  Physics_IsBodyesInited(struct physics_data_s *physics);
 int  Physics_IsGhostsInited(struct physics_data_s *physics);
 int  Physics_GetBodiesCount(struct physics_data_s *physics);
 void Physics_GetBodyWorldTransform(struct physics_data_s *physics, float tr[16], uint16_t index);
-void Physics_SetBodyWorldTransform(struct physics_data_s *physics, float tr[16], uint16_t index);
+void Physics_SetBodyWorldTransform(struct physics_data_s *physics, const float tr[16], uint16_t index);
 void Physics_GetGhostWorldTransform(struct physics_data_s *physics, float tr[16], uint16_t index);
-void Physics_SetGhostWorldTransform(struct physics_data_s *physics, float tr[16], uint16_t index);
+void Physics_SetGhostWorldTransform(struct physics_data_s *physics, const float tr[16], uint16_t index);
 ghost_shape_p Physics_GetGhostShapeInfo(struct physics_data_s *physics, uint16_t index);
 collision_node_p Physics_GetGhostCurrentCollision(struct physics_data_s *physics, uint16_t index, int16_t filter);
 
@@ -87,6 +148,7 @@ void Physics_CreateGhosts(struct physics_data_s *physics, struct ss_bone_frame_s
 void Physics_SetGhostCollisionShape(struct physics_data_s *physics, struct ss_bone_frame_s *bf, uint16_t index, struct ghost_shape_s *shape_info);
 void Physics_GenStaticMeshRigidBody(struct static_mesh_s *smesh);
 struct physics_object_s* Physics_GenRoomRigidBody(struct room_s *room, struct room_sector_s *heightmap, uint32_t sectors_count, struct sector_tween_s *tweens, int num_tweens);
+void Physics_GetRoomCollisionStats(struct room_s *room, struct room_sector_s *heightmap, uint32_t sectors_count, struct sector_tween_s *tweens, int num_tweens, int mode, struct room_collision_stats_s *stats);
 void Physics_SetOwnerObject(struct physics_object_s *obj, struct engine_container_s *self);
 void Physics_DeleteObject(struct physics_object_s *obj);
 void Physics_EnableObject(struct physics_object_s *obj);
@@ -100,6 +162,10 @@ void Physics_SetCollisionScale(struct physics_data_s *physics, float scaling[3])
 void Physics_SetBodyMass(struct physics_data_s *physics, float mass, uint16_t index);
 void Physics_PushBody(struct physics_data_s *physics, float speed[3], uint16_t index);
 void Physics_SetLinearFactor(struct physics_data_s *physics, float factor[3], uint16_t index);
+int  Physics_GetSleepState(struct physics_data_s *physics);
+int  Physics_UpdateSleepState(struct physics_data_s *physics);
+void Physics_WakeUp(struct physics_data_s *physics);
+void Physics_WakeUpTouching(struct physics_data_s *physics);                    // wakes frozen ragdolls in moved bodies boxes
 
 
 /* Ragdoll interface */
@@ -139,6 +205,19 @@ bool Ragdoll_Delete(struct physics_data_s *physics);
 #define HAIR_DISCARD_ROOT_FACE 0
 #define HAIR_DISCARD_TAIL_FACE 5
 
+#define HAIR_LOD_FULL       (0)     // full simulation
+#define HAIR_LOD_REDUCED    (1)     // simulation with constraint iterations reduced by distance
+#define HAIR_LOD_KINEMATIC  (2)     // not simulated, follows the head in the last simulated pose
+
+typedef struct hair_lod_test_s
+{
+    uint8_t     camera_lod;             // LOD, chosen for current camera
+    uint32_t    mismatches;             // elements, that differ from simulation with LOD disabled
+    float       no_lod_time;            // ms per step, LOD disabled
+    float       camera_lod_time;        // ms per step, LOD by current camera
+    float       lod_time[3];            // ms per step, by forced LOD
+}hair_lod_test_t, *hair_lod_test_p;
+
 struct hair_s;
 struct hair_setup_s;
 
@@ -151,6 +230,9 @@ void Hair_Delete(struct hair_s *hair);
 
 void Hair_Update(struct hair_s *hair, struct physics_data_s *physics);
 
+// Simulates hair alone from its current state with and without LOD; game state is restored after.
+void Hair_TestLod(struct hair_s *hair, struct physics_data_s *physics, int steps, struct hair_lod_test_s *result);
+
 int Hair_GetElementsCount(struct hair_s *hair);
 
 void Hair_GetElementInfo(struct hair_s *hair, int element, struct base_mesh_s **mesh, float tr[16]);
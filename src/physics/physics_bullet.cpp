@@ -1,6 +1,8 @@
 
+#include <SDL2/SDL_timer.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include <btBulletCollisionCommon.h>
@@ -11,6 +13,8 @@
 #include <BulletCollision/CollisionDispatch/btGhostObject.h>
 #include <BulletCollision/BroadphaseCollision/btCollisionAlgorithm.h>
 #include <BulletCollision/NarrowPhaseCollision/btRaycastCallback.h>
+#include <BulletCollision/CollisionDispatch/btSimulationIslandManager.h>
+#include <LinearMath/btHashMap.h>
 
 #include "../core/gl_util.h"
 #include "../core/gl_font.h"
@@ -18,6 +22,9 @@
 #include "../core/console.h"
 #include "../core/vmath.h"
 #include "../core/obb.h"
+#include "../core/system.h"
+#include "../core/thread_pool.h"
+#include "../render/camera.h"
 #include "../render/render.h"
 #include "../script/script.h"
 #include "../engine.h"
@@ -235,6 +242,324 @@ struct bt_engine_OverlapFilterCallback : public btOverlapFilterCallback
 } bt_engine_overlap_filter_callback;
 
 
+/*
+ * Dynamics world that solves simulation islands on the engine thread pool.
+ * Bullet 2.83 has no btDiscreteDynamicsWorldMt, so awake islands are gathered here
+ * and split into a fixed number of batches; every batch owns its own solver.
+ * Islands that touch the same kinematic body always go to the same batch, because
+ * solver writes velocities and companion id into kinematic bodies too.
+ * Batches are built in island order only, so result does not depend on threads timings.
+ */
+class bt_engine_DynamicsWorldMt : public btDiscreteDynamicsWorld
+{
+public:
+    bt_engine_DynamicsWorldMt(btDispatcher *dispatcher, btBroadphaseInterface *pairCache, btConstraintSolver *constraintSolver, btCollisionConfiguration *collisionConfiguration) :
+        btDiscreteDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration),
+        m_batches_count(1),
+        m_islands_count(0),
+        m_solve_time(0.0f),
+        m_solver_info(NULL)
+    {
+        for(int i = 0; i < THREAD_POOL_MAX_THREADS; ++i)
+        {
+            m_batches[i].solver = NULL;
+        }
+    }
+
+    virtual ~bt_engine_DynamicsWorldMt()
+    {
+        SetBatchesCount(1);
+    }
+
+    void SetBatchesCount(int count)
+    {
+        count = (count < 1) ? (1) : (count);
+        count = (count > THREAD_POOL_MAX_THREADS) ? (THREAD_POOL_MAX_THREADS) : (count);
+        for(int i = 0; i < THREAD_POOL_MAX_THREADS; ++i)
+        {
+            if((i < count) && (count > 1) && !m_batches[i].solver)
+            {
+                m_batches[i].solver = new btSequentialImpulseConstraintSolver();
+            }
+            else if(((i >= count) || (count == 1)) && m_batches[i].solver)
+            {
+                delete m_batches[i].solver;
+                m_batches[i].solver = NULL;
+            }
+        }
+        m_batches_count = count;
+    }
+
+    int GetBatchesCount() const
+    {
+        return m_batches_count;
+    }
+
+    int GetIslandsCount() const
+    {
+        return m_islands_count;
+    }
+
+    float GetSolveTime() const
+    {
+        return m_solve_time;
+    }
+
+    void CountDynamicBodies(uint32_t *active, uint32_t *sleeping, uint32_t *frozen) const
+    {
+        *active = 0;
+        *sleeping = 0;
+        *frozen = 0;
+        for(int i = 0; i < m_nonStaticRigidBodies.size(); ++i)
+        {
+            btRigidBody *body = m_nonStaticRigidBodies[i];
+            if(body->getInvMass() > 0.0f)
+            {
+                switch(body->getActivationState())
+                {
+                    case DISABLE_SIMULATION:
+                        (*frozen)++;
+                        break;
+
+                    case ISLAND_SLEEPING:
+                        (*sleeping)++;
+                        break;
+
+                    default:
+                        (*active)++;
+                        break;
+                };
+            }
+        }
+    }
+
+protected:
+    struct island_s
+    {
+        int         body_first;
+        int         body_count;
+        int         manifold_first;
+        int         manifold_count;
+        int         constraint_first;
+        int         constraint_count;
+        int         island_id;
+        int         parent;                 // union of islands with shared kinematic bodies
+        int         batch;
+    };
+
+    struct batch_s
+    {
+        btSequentialImpulseConstraintSolver        *solver;
+        btAlignedObjectArray<btCollisionObject*>    bodies;
+        btAlignedObjectArray<btPersistentManifold*> manifolds;
+        btAlignedObjectArray<btTypedConstraint*>    constraints;
+        int                                         cost;
+    };
+
+    class IslandCollector : public btSimulationIslandManager::IslandCallback
+    {
+    public:
+        IslandCollector(bt_engine_DynamicsWorldMt *world) : m_world(world) {}
+
+        virtual void processIsland(btCollisionObject **bodies, int numBodies, btPersistentManifold **manifolds, int numManifolds, int islandId) override
+        {
+            island_s island;
+            island.body_first = m_world->m_bodies.size();
+            island.body_count = numBodies;
+            island.manifold_first = m_world->m_manifolds.size();
+            island.manifold_count = numManifolds;
+            island.constraint_first = 0;
+            island.constraint_count = 0;
+            island.island_id = islandId;
+            island.parent = m_world->m_islands.size();
+            island.batch = 0;
+            for(int i = 0; i < numBodies; ++i)
+            {
+                m_world->m_bodies.push_back(bodies[i]);
+            }
+            for(int i = 0; i < numManifolds; ++i)
+            {
+                m_world->m_manifolds.push_back(manifolds[i]);
+            }
+            m_world->m_islands.push_back(island);
+        }
+
+    private:
+        bt_engine_DynamicsWorldMt *m_world;
+    };
+
+    static void SolveBatch(void *data, int index, int /*thread_index*/)
+    {
+        bt_engine_DynamicsWorldMt *world = (bt_engine_DynamicsWorldMt*)data;
+        batch_s *batch = world->m_batches + index;
+        if(batch->bodies.size() > 0)
+        {
+            batch->solver->solveGroup(&batch->bodies[0], batch->bodies.size(),
+                                      batch->manifolds.size() ? &batch->manifolds[0] : NULL, batch->manifolds.size(),
+                                      batch->constraints.size() ? &batch->constraints[0] : NULL, batch->constraints.size(),
+                                      *world->m_solver_info, NULL, world->getDispatcher());
+        }
+    }
+
+    int FindIslandRoot(int i)
+    {
+        while(m_islands[i].parent != i)
+        {
+            m_islands[i].parent = m_islands[m_islands[i].parent].parent;
+            i = m_islands[i].parent;
+        }
+        return i;
+    }
+
+    void UniteByKinematicBody(const btCollisionObject *obj, int island_index)
+    {
+        if(obj && obj->isKinematicObject())
+        {
+            int *owner = m_kinematic_owners.find(btHashPtr(obj));
+            if(owner)
+            {
+                int a = FindIslandRoot(*owner);
+                int b = FindIslandRoot(island_index);
+                m_islands[(a > b) ? (a) : (b)].parent = (a < b) ? (a) : (b);
+            }
+            else
+            {
+                m_kinematic_owners.insert(btHashPtr(obj), island_index);
+            }
+        }
+    }
+
+    virtual void solveConstraints(btContactSolverInfo &solverInfo) override
+    {
+        uint64_t start = SDL_GetPerformanceCounter();
+
+        if(m_batches_count <= 1)
+        {
+            btDiscreteDynamicsWorld::solveConstraints(solverInfo);
+            m_islands_count = 0;
+            m_solve_time = 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+            return;
+        }
+
+        IslandCollector collector(this);
+        m_islands.resize(0);
+        m_bodies.resize(0);
+        m_manifolds.resize(0);
+        m_constraints_sorted.resize(0);
+        m_island_index_by_id.clear();
+        m_kinematic_owners.clear();
+        m_islandManager->buildAndProcessIslands(getDispatcher(), getCollisionWorld(), &collector);
+        m_islands_count = m_islands.size();
+
+        // Constraints are bound to islands in m_constraints order; it is stable, unlike quickSort in base class.
+        for(int i = 0; i < m_islands.size(); ++i)
+        {
+            m_island_index_by_id.insert(m_islands[i].island_id, i);
+        }
+        btAlignedObjectArray<int> constraint_island;
+        constraint_island.resize(m_constraints.size());
+        for(int i = 0; i < m_constraints.size(); ++i)
+        {
+            const btCollisionObject &a = m_constraints[i]->getRigidBodyA();
+            const btCollisionObject &b = m_constraints[i]->getRigidBodyB();
+            int island_id = (a.getIslandTag() >= 0) ? (a.getIslandTag()) : (b.getIslandTag());
+            int *index = (island_id >= 0) ? (m_island_index_by_id.find(island_id)) : (NULL);
+            constraint_island[i] = (index) ? (*index) : (-1);
+            if(index)
+            {
+                m_islands[*index].constraint_count++;
+            }
+        }
+        for(int i = 0, first = 0; i < m_islands.size(); ++i)
+        {
+            m_islands[i].constraint_first = first;
+            first += m_islands[i].constraint_count;
+            m_islands[i].constraint_count = 0;
+        }
+        m_constraints_sorted.resize(m_constraints.size());
+        for(int i = 0; i < m_constraints.size(); ++i)
+        {
+            if(constraint_island[i] >= 0)
+            {
+                island_s *island = &m_islands[constraint_island[i]];
+                m_constraints_sorted[island->constraint_first + island->constraint_count++] = m_constraints[i];
+                UniteByKinematicBody(&m_constraints[i]->getRigidBodyA(), constraint_island[i]);
+                UniteByKinematicBody(&m_constraints[i]->getRigidBodyB(), constraint_island[i]);
+            }
+        }
+        for(int i = 0; i < m_islands.size(); ++i)
+        {
+            for(int j = 0; j < m_islands[i].manifold_count; ++j)
+            {
+                btPersistentManifold *manifold = m_manifolds[m_islands[i].manifold_first + j];
+                UniteByKinematicBody(manifold->getBody0(), i);
+                UniteByKinematicBody(manifold->getBody1(), i);
+            }
+        }
+
+        // Greedy balancing: each group goes to the least loaded batch, ties go to the lower index.
+        for(int i = 0; i < m_batches_count; ++i)
+        {
+            m_batches[i].bodies.resize(0);
+            m_batches[i].manifolds.resize(0);
+            m_batches[i].constraints.resize(0);
+            m_batches[i].cost = 0;
+        }
+        for(int i = 0; i < m_islands.size(); ++i)
+        {
+            island_s *island = &m_islands[i];
+            int root = FindIslandRoot(i);
+            if(root == i)
+            {
+                int best = 0;
+                for(int j = 1; j < m_batches_count; ++j)
+                {
+                    best = (m_batches[j].cost < m_batches[best].cost) ? (j) : (best);
+                }
+                island->batch = best;
+            }
+            else
+            {
+                island->batch = m_islands[root].batch;
+            }
+
+            batch_s *batch = m_batches + island->batch;
+            batch->cost += island->body_count + island->manifold_count + island->constraint_count;
+            for(int j = 0; j < island->body_count; ++j)
+            {
+                batch->bodies.push_back(m_bodies[island->body_first + j]);
+            }
+            for(int j = 0; j < island->manifold_count; ++j)
+            {
+                batch->manifolds.push_back(m_manifolds[island->manifold_first + j]);
+            }
+            for(int j = 0; j < island->constraint_count; ++j)
+            {
+                batch->constraints.push_back(m_constraints_sorted[island->constraint_first + j]);
+            }
+        }
+
+        m_solver_info = &solverInfo;
+        ThreadPool_ParallelFor(SolveBatch, this, m_batches_count);
+        m_solver_info = NULL;
+        m_solve_time = 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+    }
+
+    int                                         m_batches_count;
+    int                                         m_islands_count;
+    float                                       m_solve_time;
+    batch_s                                     m_batches[THREAD_POOL_MAX_THREADS];
+    btContactSolverInfo                        *m_solver_info;
+
+    btAlignedObjectArray<island_s>              m_islands;
+    btAlignedObjectArray<btCollisionObject*>    m_bodies;
+    btAlignedObjectArray<btPersistentManifold*> m_manifolds;
+    btAlignedObjectArray<btTypedConstraint*>    m_constraints_sorted;
+    btHashMap<btHashInt, int>                   m_island_index_by_id;
+    btHashMap<btHashPtr, int>                   m_kinematic_owners;
+};
+
+
 struct physics_object_s
 {
     btRigidBody    *bt_body;
@@ -262,6 +587,7 @@ typedef struct physics_data_s
 
     int16_t                             collision_group;
     int16_t                             collision_mask;
+    uint8_t                             sleep_state;            // PHYSICS_SLEEP_STATE_*
     struct engine_container_s          *cont;
 }physics_data_t, *physics_data_p;
 
@@ -320,7 +646,45 @@ btCollisionDispatcher                   *bt_engine_dispatcher = NULL;
 btGhostPairCallback                     *bt_engine_ghostPairCallback = NULL;
 btBroadphaseInterface                   *bt_engine_overlappingPairCache = NULL;
 btSequentialImpulseConstraintSolver     *bt_engine_solver = NULL;
-btDiscreteDynamicsWorld                 *bt_engine_dynamicsWorld = NULL;
+bt_engine_DynamicsWorldMt               *bt_engine_dynamicsWorld = NULL;
+
+physics_settings_t                       physics_settings;
+static physics_stats_t                   physics_stats = {0};
+static uint32_t                          bt_engine_baked_bodies = 0;
+static uint32_t                          bt_engine_world_stamp = 0;               // changed on any collision world modification
+static struct
+{
+    uint32_t                             hairs[3];          // per LOD, updated since last step
+    uint64_t                             time;
+}                                        bt_engine_hair_stats = {{0}};
+
+/*
+ * Collision shapes cache: mesh based shapes are built only once per base mesh and
+ * shape kind, bodies and ghosts that use the same mesh share one shape (and BVH).
+ * Cached shapes are reference counted, so all engine owned shapes have to be
+ * released by BT_DeleteShape() instead of delete.
+ */
+#define BT_SHAPE_CACHE_CONVEX       (0)
+#define BT_SHAPE_CACHE_BVH          (1)
+#define BT_SHAPE_CACHE_BOX          (2)
+
+typedef struct bt_shape_cache_entry_s
+{
+    struct base_mesh_s                 *mesh;
+    int                                 kind;
+    btScalar                            bb_min[3];
+    btScalar                            bb_max[3];
+    btCollisionShape                   *shape;
+    uint32_t                            refs;
+    uint32_t                            memory;
+    struct bt_shape_cache_entry_s      *next;
+}bt_shape_cache_entry_t, *bt_shape_cache_entry_p;
+
+static btHashMap<btHashPtr, bt_shape_cache_entry_p>  bt_shape_cache;
+static uint32_t                                      bt_shape_cache_entries = 0;
+static uint32_t                                      bt_shape_cache_refs = 0;
+static uint32_t                                      bt_shape_cache_memory = 0;
+static uint32_t                                      bt_shape_cache_memory_unshared = 0;
 
 CBulletDebugDrawer                       bt_debug_drawer;
 
@@ -328,11 +692,19 @@ CBulletDebugDrawer                       bt_debug_drawer;
 btCollisionShape* BT_CSfromBBox(btScalar *bb_min, btScalar *bb_max);
 btCollisionShape* BT_CSfromMesh(struct base_mesh_s *mesh, bool useCompression, bool buildBvh, bool is_static = true);
 btCollisionShape* BT_CSfromHeightmap(struct room_sector_s *heightmap, uint32_t sectors_count, struct sector_tween_s *tweens, uint32_t tweens_count, bool useCompression, bool buildBvh);
+btCollisionShape* BT_CSfromRoomSectors(struct room_sector_s *heightmap, uint32_t sectors_x, uint32_t sectors_y, struct sector_tween_s *tweens, uint32_t tweens_count);
+btCollisionShape* BT_SharedCSfromMesh(struct base_mesh_s *mesh, bool is_static);
+btCollisionShape* BT_SharedCSfromBBox(struct base_mesh_s *mesh, btScalar *bb_min, btScalar *bb_max);
+btCollisionShape* BT_GetScaledShape(btCollisionShape *shape, const btVector3 &scaling);
+void BT_DeleteShape(btCollisionShape *shape);
 
 uint32_t BT_AddFloorAndCeilingToTrimesh(btTriangleMesh *trimesh, struct room_sector_s *sector);
+uint32_t BT_AddFloorToTrimesh(btTriangleMesh *trimesh, struct room_sector_s *sector);
+uint32_t BT_AddCeilingToTrimesh(btTriangleMesh *trimesh, struct room_sector_s *sector);
 uint32_t BT_AddSectorTweenToTrimesh(btTriangleMesh *trimesh, struct sector_tween_s *tween);
 
 void Physics_DeleteRigidBody(struct physics_data_s *physics);                   // only for internal usage
+static void Physics_WakeUpByContacts();
 
 btScalar getInnerBBRadius(btScalar bb_min[3], btScalar bb_max[3])
 {
@@ -343,6 +715,11 @@ btScalar getInnerBBRadius(btScalar bb_min[3], btScalar bb_max[3])
     return ((t > r) && (r != 0.0f)) ? (0.5f * r) : (0.5f * t);
 }
 
+static int Physics_GetBatchesCount()
+{
+    return (physics_settings.threads > 0) ? (physics_settings.threads) : (ThreadPool_GetThreadsCount());
+}
+
 // Bullet Physics initialization.
 void Physics_Init()
 {
@@ -360,7 +737,8 @@ void Physics_Init()
     ///the default constraint solver. For parallel processing you can use a different solver (see Extras/BulletMultiThreaded)
     bt_engine_solver = new btSequentialImpulseConstraintSolver;
 
-    bt_engine_dynamicsWorld = new btDiscreteDynamicsWorld(bt_engine_dispatcher, bt_engine_overlappingPairCache, bt_engine_solver, bt_engine_collisionConfiguration);
+    bt_engine_dynamicsWorld = new bt_engine_DynamicsWorldMt(bt_engine_dispatcher, bt_engine_overlappingPairCache, bt_engine_solver, bt_engine_collisionConfiguration);
+    bt_engine_dynamicsWorld->SetBatchesCount(Physics_GetBatchesCount());
     bt_engine_dynamicsWorld->getPairCache()->setOverlapFilterCallback(&bt_engine_overlap_filter_callback);
     bt_engine_dynamicsWorld->setGravity(btVector3(0, 0, -4500.0));
 
@@ -389,10 +767,80 @@ void Physics_Destroy()
 }
 
 
+void Physics_InitGlobals()
+{
+    physics_settings.threads = 1;
+    physics_settings.ragdoll_bake = 0;
+    physics_settings.ragdoll_linear_sleep = RD_DEFAULT_SLEEPING_THRESHOLD;
+    physics_settings.ragdoll_angular_sleep = RD_DEFAULT_SLEEPING_THRESHOLD;
+    physics_settings.ragdoll_settle_time = 2.0f;
+    physics_settings.room_collision = PHYSICS_ROOM_COLLISION_TRIMESH;
+    physics_settings.hair_lod = 1;
+    physics_settings.hair_lod_distance = 4096.0f;
+    physics_settings.hair_lod_screen_size = 0.02f;
+}
+
+
+/*
+ * Engine pool is created with configured threads count on engine init; in game
+ * only threads, taking jobs, are limited (pool is not recreated).
+ */
+void Physics_SetThreadsCount(int threads)
+{
+    physics_settings.threads = (threads < 0) ? (0) : (threads);
+    physics_settings.threads = (physics_settings.threads > THREAD_POOL_MAX_THREADS) ? (THREAD_POOL_MAX_THREADS) : (physics_settings.threads);
+    ThreadPool_SetJobsThreads(physics_settings.threads);
+    if(bt_engine_dynamicsWorld)
+    {
+        bt_engine_dynamicsWorld->SetBatchesCount(Physics_GetBatchesCount());
+    }
+}
+
+
 void Physics_StepSimulation(float time)
 {
+    bt_engine_world_stamp++;
+    uint64_t start = SDL_GetPerformanceCounter();
     time = (time < 0.1f) ? (time) : (0.0f);
     bt_engine_dynamicsWorld->stepSimulation(time, 0);
+    bt_engine_dynamicsWorld->CountDynamicBodies(&physics_stats.bodies_active, &physics_stats.bodies_sleeping, &physics_stats.bodies_frozen);
+    if(physics_stats.bodies_frozen > 0)
+    {
+        Physics_WakeUpByContacts();
+    }
+    physics_stats.bodies_baked = bt_engine_baked_bodies;
+    physics_stats.hairs_full = bt_engine_hair_stats.hairs[HAIR_LOD_FULL];
+    physics_stats.hairs_reduced = bt_engine_hair_stats.hairs[HAIR_LOD_REDUCED];
+    physics_stats.hairs_kinematic = bt_engine_hair_stats.hairs[HAIR_LOD_KINEMATIC];
+    physics_stats.hair_time = 1000.0f * (float)bt_engine_hair_stats.time / (float)SDL_GetPerformanceFrequency();
+    memset(&bt_engine_hair_stats, 0x00, sizeof(bt_engine_hair_stats));
+    physics_stats.step_time = 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+}
+
+
+uint32_t Physics_GetWorldStamp()
+{
+    return bt_engine_world_stamp;
+}
+
+
+void Physics_GetStats(struct physics_stats_s *stats)
+{
+    physics_stats.threads = ThreadPool_GetThreadsCount();
+    physics_stats.solver_batches = 0;
+    physics_stats.islands = 0;
+    physics_stats.solve_time = 0.0f;
+    if(bt_engine_dynamicsWorld)
+    {
+        physics_stats.solver_batches = bt_engine_dynamicsWorld->GetBatchesCount();
+        physics_stats.islands = bt_engine_dynamicsWorld->GetIslandsCount();
+        physics_stats.solve_time = bt_engine_dynamicsWorld->GetSolveTime();
+    }
+    physics_stats.shapes_shared = bt_shape_cache_entries;
+    physics_stats.shapes_refs = bt_shape_cache_refs;
+    physics_stats.shapes_memory = bt_shape_cache_memory;
+    physics_stats.shapes_memory_unshared = bt_shape_cache_memory_unshared;
+    *stats = physics_stats;
 }
 
 void Physics_DebugDrawWorld()
@@ -402,6 +850,7 @@ void Physics_DebugDrawWorld()
 
 void Physics_CleanUpObjects()
 {
+    bt_engine_world_stamp++;
     if(bt_engine_dynamicsWorld != NULL)
     {
         int num_obj = bt_engine_dynamicsWorld->getNumCollisionObjects();
@@ -424,7 +873,7 @@ void Physics_CleanUpObjects()
 
                     if(body->getCollisionShape())
                     {
-                        delete body->getCollisionShape();
+                        BT_DeleteShape(body->getCollisionShape());
                         body->setCollisionShape(NULL);
                     }
 
@@ -453,6 +902,7 @@ struct physics_data_s *Physics_CreatePhysicsData(struct engine_container_s *cont
     ret->collision_track = NULL;
     ret->collision_group = btBroadphaseProxy::KinematicFilter;
     ret->collision_mask = btBroadphaseProxy::AllFilter;
+    ret->sleep_state = PHYSICS_SLEEP_STATE_ACTIVE;
     ret->cont = cont;
 
     return ret;
@@ -461,6 +911,7 @@ struct physics_data_s *Physics_CreatePhysicsData(struct engine_container_s *cont
 
 void Physics_DeletePhysicsData(struct physics_data_s *physics)
 {
+    bt_engine_world_stamp++;
     if(physics)
     {
         for(collision_node_p cn = physics->collision_track; cn;)
@@ -477,6 +928,11 @@ void Physics_DeletePhysicsData(struct physics_data_s *physics)
             physics->bt_info = NULL;
         }
 
+        if(physics->sleep_state == PHYSICS_SLEEP_STATE_BAKED)
+        {
+            bt_engine_baked_bodies -= physics->objects_count;
+        }
+
         if(physics->bt_joints)
         {
             for(uint32_t i = 0; i < physics->bt_joint_count; i++)
@@ -501,7 +957,7 @@ void Physics_DeletePhysicsData(struct physics_data_s *physics)
                 physics->ghost_objects[i]->setUserPointer(NULL);
                 if(physics->ghost_objects[i]->getCollisionShape())
                 {
-                    delete physics->ghost_objects[i]->getCollisionShape();
+                    BT_DeleteShape(physics->ghost_objects[i]->getCollisionShape());
                     physics->ghost_objects[i]->setCollisionShape(NULL);
                 }
                 bt_engine_dynamicsWorld->removeCollisionObject(physics->ghost_objects[i]);
@@ -681,11 +1137,20 @@ void Physics_GetBodyWorldTransform(struct physics_data_s *physics, float tr[16],
 }
 
 
-void Physics_SetBodyWorldTransform(struct physics_data_s *physics, float tr[16], uint16_t index)
+void Physics_SetBodyWorldTransform(struct physics_data_s *physics, const float tr[16], uint16_t index)
 {
     if(physics->bt_body[index])
     {
         physics->bt_body[index]->getWorldTransform().setFromOpenGLMatrix(tr);
+        // moves out of rooms change the global stamp, in rooms - the room one, only for bodies seen by height tests
+        if(!physics->cont || !physics->cont->room)
+        {
+            bt_engine_world_stamp++;
+        }
+        else if(physics->cont->collision_group & COLLISION_FILTER_HEIGHT_TEST)
+        {
+            physics->cont->room->collision_stamp++;
+        }
     }
 }
 
@@ -705,7 +1170,7 @@ void Physics_GetGhostWorldTransform(struct physics_data_s *physics, float tr[16]
 }
 
 
-void Physics_SetGhostWorldTransform(struct physics_data_s *physics, float tr[16], uint16_t index)
+void Physics_SetGhostWorldTransform(struct physics_data_s *physics, const float tr[16], uint16_t index)
 {
     if(physics->ghost_objects && physics->ghost_objects[index])
     {
@@ -822,16 +1287,256 @@ collision_node_p Physics_GetGhostCurrentCollision(struct physics_data_s *physics
 }
 
 
+static uint32_t BT_GetShapeMemory(btCollisionShape *shape)
+{
+    btStridingMeshInterface *mesh_interface = NULL;
+    uint32_t ret = 0;
+
+    if(shape->getShapeType() == TRIANGLE_MESH_SHAPE_PROXYTYPE)
+    {
+        btBvhTriangleMeshShape *bvh_shape = (btBvhTriangleMeshShape*)shape;
+        mesh_interface = bvh_shape->getMeshInterface();
+        ret += sizeof(btBvhTriangleMeshShape);
+        if(bvh_shape->getOptimizedBvh())
+        {
+            ret += bvh_shape->getOptimizedBvh()->calculateSerializeBufferSize();
+        }
+    }
+    else if(shape->getShapeType() == CONVEX_TRIANGLEMESH_SHAPE_PROXYTYPE)
+    {
+        mesh_interface = ((btConvexTriangleMeshShape*)shape)->getMeshInterface();
+        ret += sizeof(btConvexTriangleMeshShape);
+    }
+    else if(shape->getShapeType() == COMPOUND_SHAPE_PROXYTYPE)
+    {
+        btCompoundShape *compound = (btCompoundShape*)shape;
+        ret += sizeof(btCompoundShape) + compound->getNumChildShapes() * (sizeof(btCompoundShapeChild) + 2 * sizeof(btDbvtNode));
+        for(int i = 0; i < compound->getNumChildShapes(); i++)
+        {
+            ret += BT_GetShapeMemory(compound->getChildShape(i));
+        }
+    }
+    else if(shape->getShapeType() == BOX_SHAPE_PROXYTYPE)
+    {
+        ret += sizeof(btBoxShape);
+    }
+
+    if(mesh_interface)
+    {
+        IndexedMeshArray &meshes = ((btTriangleIndexVertexArray*)mesh_interface)->getIndexedMeshArray();
+        ret += sizeof(btTriangleMesh);
+        for(int i = 0; i < meshes.size(); i++)
+        {
+            ret += meshes[i].m_numVertices * meshes[i].m_vertexStride;
+            ret += meshes[i].m_numTriangles * meshes[i].m_triangleIndexStride;
+        }
+    }
+
+    return ret;
+}
+
+
+static btCollisionShape *BT_GetCachedShape(struct base_mesh_s *mesh, int kind, btScalar *bb_min, btScalar *bb_max)
+{
+    btHashPtr key(mesh);
+    bt_shape_cache_entry_p *head = bt_shape_cache.find(key);
+    bt_shape_cache_entry_p entry = (head) ? (*head) : (NULL);
+
+    for(; entry; entry = entry->next)
+    {
+        if((entry->kind == kind) &&
+           ((kind != BT_SHAPE_CACHE_BOX) || ((vec3_dist_sq(entry->bb_min, bb_min) == 0.0f) && (vec3_dist_sq(entry->bb_max, bb_max) == 0.0f))))
+        {
+            entry->refs++;
+            bt_shape_cache_refs++;
+            bt_shape_cache_memory_unshared += entry->memory;
+            return entry->shape;
+        }
+    }
+
+    btCollisionShape *shape = NULL;
+    switch(kind)
+    {
+        case BT_SHAPE_CACHE_BOX:
+            shape = BT_CSfromBBox(bb_min, bb_max);
+            break;
+
+        case BT_SHAPE_CACHE_BVH:
+            shape = BT_CSfromMesh(mesh, true, true, true);
+            break;
+
+        default:
+            shape = BT_CSfromMesh(mesh, true, true, false);
+            break;
+    };
+
+    if(shape)
+    {
+        entry = (bt_shape_cache_entry_p)malloc(sizeof(bt_shape_cache_entry_t));
+        entry->mesh = mesh;
+        entry->kind = kind;
+        if(kind == BT_SHAPE_CACHE_BOX)
+        {
+            vec3_copy(entry->bb_min, bb_min);
+            vec3_copy(entry->bb_max, bb_max);
+        }
+        entry->shape = shape;
+        entry->refs = 1;
+        entry->memory = BT_GetShapeMemory(shape);
+        entry->next = (head) ? (*head) : (NULL);
+        bt_shape_cache.insert(key, entry);
+        shape->setUserPointer(entry);
+
+        bt_shape_cache_entries++;
+        bt_shape_cache_refs++;
+        bt_shape_cache_memory += entry->memory;
+        bt_shape_cache_memory_unshared += entry->memory;
+    }
+
+    return shape;
+}
+
+
+btCollisionShape *BT_SharedCSfromMesh(struct base_mesh_s *mesh, bool is_static)
+{
+    return (mesh) ? (BT_GetCachedShape(mesh, (is_static) ? (BT_SHAPE_CACHE_BVH) : (BT_SHAPE_CACHE_CONVEX), NULL, NULL)) : (NULL);
+}
+
+
+btCollisionShape *BT_SharedCSfromBBox(struct base_mesh_s *mesh, btScalar *bb_min, btScalar *bb_max)
+{
+    return (mesh) ? (BT_GetCachedShape(mesh, BT_SHAPE_CACHE_BOX, bb_min, bb_max)) : (BT_CSfromBBox(bb_min, bb_max));
+}
+
+
+static void BT_ReleaseCachedShape(bt_shape_cache_entry_p entry)
+{
+    bt_shape_cache_refs--;
+    bt_shape_cache_memory_unshared -= entry->memory;
+    if(--entry->refs > 0)
+    {
+        return;
+    }
+
+    btHashPtr key(entry->mesh);
+    bt_shape_cache_entry_p *head = bt_shape_cache.find(key);
+    if(head && (*head == entry))
+    {
+        if(entry->next)
+        {
+            bt_shape_cache.insert(key, entry->next);
+        }
+        else
+        {
+            bt_shape_cache.remove(key);
+        }
+    }
+    else if(head)
+    {
+        for(bt_shape_cache_entry_p prev = *head; prev; prev = prev->next)
+        {
+            if(prev->next == entry)
+            {
+                prev->next = entry->next;
+                break;
+            }
+        }
+    }
+
+    bt_shape_cache_entries--;
+    bt_shape_cache_memory -= entry->memory;
+    entry->shape->setUserPointer(NULL);
+    BT_DeleteShape(entry->shape);
+    free(entry);
+}
+
+
+void BT_DeleteShape(btCollisionShape *shape)
+{
+    btStridingMeshInterface *mesh_interface = NULL;
+
+    if(!shape)
+    {
+        return;
+    }
+
+    if(shape->getUserPointer())
+    {
+        BT_ReleaseCachedShape((bt_shape_cache_entry_p)shape->getUserPointer());
+        return;
+    }
+
+    switch(shape->getShapeType())
+    {
+        case SCALED_TRIANGLE_MESH_SHAPE_PROXYTYPE:
+            BT_DeleteShape(((btScaledBvhTriangleMeshShape*)shape)->getChildShape());
+            break;
+
+        case COMPOUND_SHAPE_PROXYTYPE:
+            for(int i = ((btCompoundShape*)shape)->getNumChildShapes() - 1; i >= 0; i--)
+            {
+                BT_DeleteShape(((btCompoundShape*)shape)->getChildShape(i));
+            }
+            break;
+
+        case TRIANGLE_MESH_SHAPE_PROXYTYPE:
+            mesh_interface = ((btBvhTriangleMeshShape*)shape)->getMeshInterface();
+            break;
+
+        case CONVEX_TRIANGLEMESH_SHAPE_PROXYTYPE:
+            mesh_interface = ((btConvexTriangleMeshShape*)shape)->getMeshInterface();
+            break;
+    };
+
+    delete shape;
+    if(mesh_interface)
+    {
+        delete mesh_interface;
+    }
+}
+
+
+/*
+ * Shared shapes must not be scaled inplace: BVH shapes are wrapped by
+ * scaled shape (BVH is still shared), convex ones are copied.
+ */
+btCollisionShape *BT_GetScaledShape(btCollisionShape *shape, const btVector3 &scaling)
+{
+    bt_shape_cache_entry_p entry;
+
+    entry = (bt_shape_cache_entry_p)shape->getUserPointer();
+    if(entry && (entry->kind == BT_SHAPE_CACHE_BVH))
+    {
+        // wrapper takes over the reference to the shared shape
+        btCollisionShape *new_shape = new btScaledBvhTriangleMeshShape((btBvhTriangleMeshShape*)shape, scaling);
+        new_shape->setMargin(shape->getMargin());
+        return new_shape;
+    }
+    else if(entry)
+    {
+        btCollisionShape *new_shape = (entry->kind == BT_SHAPE_CACHE_BOX) ? (BT_CSfromBBox(entry->bb_min, entry->bb_max)) : (BT_CSfromMesh(entry->mesh, true, true, false));
+        new_shape->setMargin(shape->getMargin());
+        new_shape->setLocalScaling(scaling);
+        BT_DeleteShape(shape);
+        return new_shape;
+    }
+
+    shape->setLocalScaling(scaling);
+    return shape;
+}
+
+
 btCollisionShape *BT_CSfromBBox(btScalar *bb_min, btScalar *bb_max)
 {
     obb_p obb = OBB_Create();
-    polygon_p p = obb->base_polygons;
+    polygon_p p;
     btTriangleMesh *trimesh = new btTriangleMesh;
     btVector3 v0, v1, v2;
     btCollisionShape* ret;
     int cnt = 0;
 
     OBB_Rebuild(obb, bb_min, bb_max);
+    p = OBB_GetPolygons(obb);                                                   // no transform: local coordinates
     for(uint32_t i = 0; i < 6; i++, p++)
     {
         if(!Polygon_IsBroken(p))
@@ -905,6 +1610,12 @@ btCollisionShape *BT_CSfromMesh(struct base_mesh_s *mesh, bool useCompression, b
 
 
 uint32_t BT_AddFloorAndCeilingToTrimesh(btTriangleMesh *trimesh, struct room_sector_s *sector)
+{
+    return BT_AddFloorToTrimesh(trimesh, sector) + BT_AddCeilingToTrimesh(trimesh, sector);
+}
+
+
+uint32_t BT_AddFloorToTrimesh(btTriangleMesh *trimesh, struct room_sector_s *sector)
 {
     uint32_t cnt = 0;
     float *v0, *v1, *v2, *v3;
@@ -959,6 +1670,15 @@ uint32_t BT_AddFloorAndCeilingToTrimesh(btTriangleMesh *trimesh, struct room_sec
         }
     }
 
+    return cnt;
+}
+
+
+uint32_t BT_AddCeilingToTrimesh(btTriangleMesh *trimesh, struct room_sector_s *sector)
+{
+    uint32_t cnt = 0;
+    float *v0, *v1, *v2, *v3;
+
     v0 = sector->ceiling_corners[0];
     v1 = sector->ceiling_corners[1];
     v2 = sector->ceiling_corners[2];
@@ -1159,23 +1879,149 @@ uint32_t BT_AddSectorTweenToTrimesh(btTriangleMesh *trimesh, struct sector_tween
                                      true);
                 cnt += 2;
             }
-            break;
-    };
+            break;
+    };
+
+    return cnt;
+}
+
+
+btCollisionShape *BT_CSfromHeightmap(struct room_sector_s *heightmap, uint32_t sectors_count, struct sector_tween_s *tweens, uint32_t tweens_count, bool useCompression, bool buildBvh)
+{
+    uint32_t cnt = 0;
+    btTriangleMesh *trimesh = new btTriangleMesh;
+    btCollisionShape* ret = NULL;
+
+    for(uint32_t i = 0; i < sectors_count; i++)
+    {
+        cnt += BT_AddFloorAndCeilingToTrimesh(trimesh, heightmap + i);
+    }
+
+    for(uint32_t i = 0; i < tweens_count; i++)
+    {
+        cnt += BT_AddSectorTweenToTrimesh(trimesh, tweens + i);
+    }
+
+    if(cnt == 0)
+    {
+        delete trimesh;
+        return NULL;
+    }
+
+    ret = new btBvhTriangleMeshShape(trimesh, useCompression, buildBvh);
+    return ret;
+}
+
+
+#define ROOM_COLLISION_BOX_HALF_DEPTH   (16.0f)
+
+static inline float *BT_GetSectorCorners(struct room_sector_s *sector, bool ceiling)
+{
+    return (ceiling) ? (sector->ceiling_corners[0]) : (sector->floor_corners[0]);
+}
+
+
+static bool BT_IsSectorFlat(struct room_sector_s *sector, bool ceiling)
+{
+    uint8_t penetration_config = (ceiling) ? (sector->ceiling_penetration_config) : (sector->floor_penetration_config);
+    float *v = BT_GetSectorCorners(sector, ceiling);
+    return (penetration_config == TR_PENETRATION_CONFIG_SOLID) &&
+           (v[0 * 3 + 2] == v[1 * 3 + 2]) && (v[0 * 3 + 2] == v[2 * 3 + 2]) && (v[0 * 3 + 2] == v[3 * 3 + 2]);
+}
+
+
+/*
+ * Merges flat floor (or ceiling) sectors with the same height into rectangles,
+ * every rectangle becomes one thin box under the floor (over the ceiling).
+ * Merged sectors are marked in flat[], they do not go to trimesh.
+ */
+static uint32_t BT_AddFlatSectorsToCompound(btCompoundShape *compound, struct room_sector_s *heightmap, uint32_t sectors_x, uint32_t sectors_y, uint8_t *flat, bool ceiling)
+{
+    uint32_t cnt = 0;
+
+    memset(flat, 0x00, sectors_x * sectors_y);
+    for(uint32_t x = 0; x < sectors_x; x++)
+    {
+        for(uint32_t y = 0; y < sectors_y; y++)
+        {
+            struct room_sector_s *sector = heightmap + x * sectors_y + y;
+            if(flat[x * sectors_y + y] || !BT_IsSectorFlat(sector, ceiling))
+            {
+                continue;
+            }
+
+            float z = BT_GetSectorCorners(sector, ceiling)[2];
+            uint32_t x1, y1;
+            for(y1 = y + 1; y1 < sectors_y; y1++)
+            {
+                struct room_sector_s *next = heightmap + x * sectors_y + y1;
+                if(flat[x * sectors_y + y1] || !BT_IsSectorFlat(next, ceiling) || (BT_GetSectorCorners(next, ceiling)[2] != z))
+                {
+                    break;
+                }
+            }
+
+            for(x1 = x + 1; x1 < sectors_x; x1++)
+            {
+                uint32_t yy = y;
+                for(; yy < y1; yy++)
+                {
+                    struct room_sector_s *next = heightmap + x1 * sectors_y + yy;
+                    if(flat[x1 * sectors_y + yy] || !BT_IsSectorFlat(next, ceiling) || (BT_GetSectorCorners(next, ceiling)[2] != z))
+                    {
+                        break;
+                    }
+                }
+                if(yy < y1)
+                {
+                    break;
+                }
+            }
+
+            for(uint32_t i = x; i < x1; i++)
+            {
+                memset(flat + i * sectors_y + y, 0x01, y1 - y);
+            }
+
+            btVector3 half_extents(0.5f * TR_METERING_SECTORSIZE * (x1 - x), 0.5f * TR_METERING_SECTORSIZE * (y1 - y), ROOM_COLLISION_BOX_HALF_DEPTH);
+            btTransform tr;
+            tr.setIdentity();
+            tr.setOrigin(btVector3(TR_METERING_SECTORSIZE * x + half_extents.m_floats[0],
+                                   TR_METERING_SECTORSIZE * y + half_extents.m_floats[1],
+                                   (ceiling) ? (z + ROOM_COLLISION_BOX_HALF_DEPTH) : (z - ROOM_COLLISION_BOX_HALF_DEPTH)));
+            btCollisionShape *box = new btBoxShape(half_extents);
+            box->setMargin(COLLISION_MARGIN_DEFAULT);
+            compound->addChildShape(tr, box);
+            cnt++;
+        }
+    }
 
     return cnt;
 }
 
 
-btCollisionShape *BT_CSfromHeightmap(struct room_sector_s *heightmap, uint32_t sectors_count, struct sector_tween_s *tweens, uint32_t tweens_count, bool useCompression, bool buildBvh)
+/*
+ * Simplified room collision: regular flat regions are boxes,
+ * only sloped / diagonal / door sectors and tweens are left in BVH trimesh.
+ */
+btCollisionShape *BT_CSfromRoomSectors(struct room_sector_s *heightmap, uint32_t sectors_x, uint32_t sectors_y, struct sector_tween_s *tweens, uint32_t tweens_count)
 {
-    uint32_t cnt = 0;
+    uint32_t cnt = 0, boxes = 0;
+    size_t buf_size = sectors_x * sectors_y * 2;
+    uint8_t *flat_floor = (uint8_t*)Sys_GetTempMem(buf_size);
+    uint8_t *flat_ceiling = flat_floor + sectors_x * sectors_y;
+    btCompoundShape *compound = new btCompoundShape(true);
     btTriangleMesh *trimesh = new btTriangleMesh;
-    btCollisionShape* ret = NULL;
 
-    for(uint32_t i = 0; i < sectors_count; i++)
+    boxes += BT_AddFlatSectorsToCompound(compound, heightmap, sectors_x, sectors_y, flat_floor, false);
+    boxes += BT_AddFlatSectorsToCompound(compound, heightmap, sectors_x, sectors_y, flat_ceiling, true);
+
+    for(uint32_t i = 0; i < sectors_x * sectors_y; i++)
     {
-        cnt += BT_AddFloorAndCeilingToTrimesh(trimesh, heightmap + i);
+        cnt += (flat_floor[i]) ? (0) : (BT_AddFloorToTrimesh(trimesh, heightmap + i));
+        cnt += (flat_ceiling[i]) ? (0) : (BT_AddCeilingToTrimesh(trimesh, heightmap + i));
     }
+    Sys_ReturnTempMem(buf_size);
 
     for(uint32_t i = 0; i < tweens_count; i++)
     {
@@ -1185,11 +2031,25 @@ btCollisionShape *BT_CSfromHeightmap(struct room_sector_s *heightmap, uint32_t s
     if(cnt == 0)
     {
         delete trimesh;
-        return NULL;
+        trimesh = NULL;
     }
 
-    ret = new btBvhTriangleMeshShape(trimesh, useCompression, buildBvh);
-    return ret;
+    if(boxes == 0)
+    {
+        delete compound;
+        return (trimesh) ? (new btBvhTriangleMeshShape(trimesh, true, true)) : (NULL);
+    }
+
+    if(trimesh)
+    {
+        btTransform tr;
+        tr.setIdentity();
+        btCollisionShape *bvh = new btBvhTriangleMeshShape(trimesh, true, true);
+        bvh->setMargin(COLLISION_MARGIN_DEFAULT);
+        compound->addChildShape(tr, bvh);
+    }
+
+    return compound;
 }
 
 /*
@@ -1198,6 +2058,7 @@ btCollisionShape *BT_CSfromHeightmap(struct room_sector_s *heightmap, uint32_t s
 
 void Physics_GenRigidBody(struct physics_data_s *physics, struct ss_bone_frame_s *bf)
 {
+    bt_engine_world_stamp++;
     btVector3 localInertia(0, 0, 0);
     btTransform startTransform;
     btCollisionShape *cshape = NULL;
@@ -1270,20 +2131,20 @@ void Physics_GenRigidBody(struct physics_data_s *physics, struct ss_bone_frame_s
                     switch(physics->cont->collision_shape)
                     {
                         case COLLISION_SHAPE_TRIMESH_CONVEX:
-                            cshape = BT_CSfromMesh(mesh, true, true, false);
+                            cshape = BT_SharedCSfromMesh(mesh, false);
                             break;
 
                         case COLLISION_SHAPE_TRIMESH:
-                            cshape = BT_CSfromMesh(mesh, true, true, true);
+                            cshape = BT_SharedCSfromMesh(mesh, true);
                             break;
 
                         case COLLISION_SHAPE_BOX:
-                            cshape = BT_CSfromBBox(mesh->bb_min, mesh->bb_max);
+                            cshape = BT_SharedCSfromBBox(mesh, mesh->bb_min, mesh->bb_max);
                             break;
 
                             ///@TODO: add other shapes implementation; may be change default;
                         default:
-                             cshape = BT_CSfromMesh(mesh, true, true, true);
+                             cshape = BT_SharedCSfromMesh(mesh, true);
                              break;
                     };
 
@@ -1328,7 +2189,7 @@ void Physics_DeleteRigidBody(struct physics_data_s *physics)
                 }
                 if(body->getCollisionShape())
                 {
-                    delete body->getCollisionShape();
+                    BT_DeleteShape(body->getCollisionShape());
                     body->setCollisionShape(NULL);
                 }
 
@@ -1438,7 +2299,7 @@ void Physics_CreateGhosts(struct physics_data_s *physics, struct ss_bone_frame_s
 
                                 default:
                                     vec3_set_zero(physics->ghosts_info[i].offset);
-                                    physics->ghost_objects[i]->setCollisionShape(BT_CSfromMesh(b_tag->mesh_base, true, true, false));
+                                    physics->ghost_objects[i]->setCollisionShape(BT_SharedCSfromMesh(b_tag->mesh_base, false));
                                     break;
                             };
                         }
@@ -1448,7 +2309,7 @@ void Physics_CreateGhosts(struct physics_data_s *physics, struct ss_bone_frame_s
                             vec3_copy(physics->ghosts_info[i].bb_max, b_tag->mesh_base->bb_max);
                             vec3_copy(physics->ghosts_info[i].bb_min, b_tag->mesh_base->bb_min);
                             vec3_set_zero(physics->ghosts_info[i].offset);
-                            physics->ghost_objects[i]->setCollisionShape(BT_CSfromMesh(b_tag->mesh_base, true, true, false));
+                            physics->ghost_objects[i]->setCollisionShape(BT_SharedCSfromMesh(b_tag->mesh_base, false));
                         }
                         physics->ghosts_info[i].radius = getInnerBBRadius(physics->ghosts_info[i].bb_min, physics->ghosts_info[i].bb_max);
                         physics->ghost_objects[i]->getCollisionShape()->setMargin(COLLISION_MARGIN_DEFAULT);
@@ -1486,7 +2347,7 @@ void Physics_SetGhostCollisionShape(struct physics_data_s *physics, struct ss_bo
                 break;
 
             case COLLISION_SHAPE_TRIMESH:
-                new_shape = BT_CSfromMesh(bf->bone_tags[index].mesh_base, true, true, false);
+                new_shape = BT_SharedCSfromMesh(bf->bone_tags[index].mesh_base, false);
                 break;
 
             case COLLISION_NONE:
@@ -1506,7 +2367,7 @@ void Physics_SetGhostCollisionShape(struct physics_data_s *physics, struct ss_bo
             }
             if(old_shape)
             {
-                delete old_shape;
+                BT_DeleteShape(old_shape);
             }
         }
     }
@@ -1526,19 +2387,19 @@ void Physics_GenStaticMeshRigidBody(struct static_mesh_s *smesh)
     switch(smesh->self->collision_shape)
     {
         case COLLISION_SHAPE_BOX:
-            cshape = BT_CSfromBBox(smesh->cbb_min, smesh->cbb_max);
+            cshape = BT_SharedCSfromBBox(smesh->mesh, smesh->cbb_min, smesh->cbb_max);
             break;
 
         case COLLISION_SHAPE_BOX_BASE:
-            cshape = BT_CSfromBBox(smesh->mesh->bb_min, smesh->mesh->bb_max);
+            cshape = BT_SharedCSfromBBox(smesh->mesh, smesh->mesh->bb_min, smesh->mesh->bb_max);
             break;
 
         case COLLISION_SHAPE_TRIMESH:
-            cshape = BT_CSfromMesh(smesh->mesh, true, true, true);
+            cshape = BT_SharedCSfromMesh(smesh->mesh, true);
             break;
 
         case COLLISION_SHAPE_TRIMESH_CONVEX:
-            cshape = BT_CSfromMesh(smesh->mesh, true, true, false);
+            cshape = BT_SharedCSfromMesh(smesh->mesh, false);
             break;
 
         default:
@@ -1563,9 +2424,115 @@ void Physics_GenStaticMeshRigidBody(struct static_mesh_s *smesh)
 }
 
 
+static btCollisionShape *BT_CSfromRoom(struct room_s *room, struct room_sector_s *heightmap, uint32_t sectors_count, struct sector_tween_s *tweens, int num_tweens, int mode)
+{
+    if((mode == PHYSICS_ROOM_COLLISION_SIMPLIFIED) && heightmap && (sectors_count == room->sectors_x * room->sectors_y))
+    {
+        return BT_CSfromRoomSectors(heightmap, room->sectors_x, room->sectors_y, tweens, num_tweens);
+    }
+    return BT_CSfromHeightmap(heightmap, sectors_count, tweens, num_tweens, true, true);
+}
+
+
+static void BT_CountShapePrimitives(btCollisionShape *shape, uint32_t *triangles, uint32_t *boxes)
+{
+    switch(shape->getShapeType())
+    {
+        case TRIANGLE_MESH_SHAPE_PROXYTYPE:
+            {
+                IndexedMeshArray &meshes = ((btTriangleIndexVertexArray*)((btBvhTriangleMeshShape*)shape)->getMeshInterface())->getIndexedMeshArray();
+                for(int i = 0; i < meshes.size(); i++)
+                {
+                    *triangles += meshes[i].m_numTriangles;
+                }
+            }
+            break;
+
+        case COMPOUND_SHAPE_PROXYTYPE:
+            for(int i = 0; i < ((btCompoundShape*)shape)->getNumChildShapes(); i++)
+            {
+                BT_CountShapePrimitives(((btCompoundShape*)shape)->getChildShape(i), triangles, boxes);
+            }
+            break;
+
+        case BOX_SHAPE_PROXYTYPE:
+            (*boxes)++;
+            break;
+    };
+}
+
+
+/*
+ * Builds room shape in the given mode (without adding it to the world) and
+ * measures it: primitives, memory and the cost of vertical rays through every
+ * sector center and horizontal rays along every sectors row and column.
+ */
+void Physics_GetRoomCollisionStats(struct room_s *room, struct room_sector_s *heightmap, uint32_t sectors_count, struct sector_tween_s *tweens, int num_tweens, int mode, struct room_collision_stats_s *stats)
+{
+    btCollisionShape *cshape = BT_CSfromRoom(room, heightmap, sectors_count, tweens, num_tweens, mode);
+
+    if(cshape)
+    {
+        btCollisionObject obj;
+        btTransform tr, from, to;
+        btVector3 aabb_min, aabb_max;
+        uint64_t start;
+
+        cshape->setMargin(COLLISION_MARGIN_DEFAULT);
+        obj.setCollisionShape(cshape);
+        tr.setIdentity();
+        from.setIdentity();
+        to.setIdentity();
+        cshape->getAabb(tr, aabb_min, aabb_max);
+        aabb_min -= btVector3(1.0f, 1.0f, 1.0f);
+        aabb_max += btVector3(1.0f, 1.0f, 1.0f);
+
+        stats->rooms++;
+        BT_CountShapePrimitives(cshape, &stats->triangles, &stats->boxes);
+        stats->memory += BT_GetShapeMemory(cshape);
+
+        start = SDL_GetPerformanceCounter();
+        for(uint16_t x = 0; x < room->sectors_x; x++)
+        {
+            btScalar px = TR_METERING_SECTORSIZE * (0.5f + x);
+            for(uint16_t y = 0; y < room->sectors_y; y++)
+            {
+                btScalar py = TR_METERING_SECTORSIZE * (0.5f + y);
+                btCollisionWorld::ClosestRayResultCallback cb(btVector3(px, py, aabb_max.m_floats[2]), btVector3(px, py, aabb_min.m_floats[2]));
+                from.setOrigin(cb.m_rayFromWorld);
+                to.setOrigin(cb.m_rayToWorld);
+                btCollisionWorld::rayTestSingle(from, to, &obj, cshape, tr, cb);
+                stats->rays++;
+            }
+
+            btScalar pz = 0.5f * (aabb_min.m_floats[2] + aabb_max.m_floats[2]);
+            btCollisionWorld::ClosestRayResultCallback cb(btVector3(px, aabb_min.m_floats[1], pz), btVector3(px, aabb_max.m_floats[1], pz));
+            from.setOrigin(cb.m_rayFromWorld);
+            to.setOrigin(cb.m_rayToWorld);
+            btCollisionWorld::rayTestSingle(from, to, &obj, cshape, tr, cb);
+            stats->rays++;
+        }
+
+        for(uint16_t y = 0; y < room->sectors_y; y++)
+        {
+            btScalar py = TR_METERING_SECTORSIZE * (0.5f + y);
+            btScalar pz = 0.5f * (aabb_min.m_floats[2] + aabb_max.m_floats[2]);
+            btCollisionWorld::ClosestRayResultCallback cb(btVector3(aabb_min.m_floats[0], py, pz), btVector3(aabb_max.m_floats[0], py, pz));
+            from.setOrigin(cb.m_rayFromWorld);
+            to.setOrigin(cb.m_rayToWorld);
+            btCollisionWorld::rayTestSingle(from, to, &obj, cshape, tr, cb);
+            stats->rays++;
+        }
+        stats->rays_time += 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+
+        BT_DeleteShape(cshape);
+    }
+}
+
+
 struct physics_object_s* Physics_GenRoomRigidBody(struct room_s *room, struct room_sector_s *heightmap, uint32_t sectors_count, struct sector_tween_s *tweens, int num_tweens)
 {
-    btCollisionShape *cshape = BT_CSfromHeightmap(heightmap, sectors_count, tweens, num_tweens, true, true);
+    btCollisionShape *cshape = BT_CSfromRoom(room, heightmap, sectors_count, tweens, num_tweens, physics_settings.room_collision);
     struct physics_object_s *ret = NULL;
 
     if(cshape)
@@ -1599,6 +2566,7 @@ void Physics_SetOwnerObject(struct physics_object_s *obj, struct engine_containe
 
 void Physics_DeleteObject(struct physics_object_s *obj)
 {
+    bt_engine_world_stamp++;
     if(obj)
     {
         obj->bt_body->setUserPointer(NULL);
@@ -1609,7 +2577,7 @@ void Physics_DeleteObject(struct physics_object_s *obj)
         }
         if(obj->bt_body->getCollisionShape())
         {
-            delete obj->bt_body->getCollisionShape();
+            BT_DeleteShape(obj->bt_body->getCollisionShape());
             obj->bt_body->setCollisionShape(NULL);
         }
 
@@ -1622,6 +2590,7 @@ void Physics_DeleteObject(struct physics_object_s *obj)
 
 void Physics_EnableObject(struct physics_object_s *obj)
 {
+    bt_engine_world_stamp++;
     if(obj->bt_body && !obj->bt_body->isInWorld())
     {
         bt_engine_dynamicsWorld->addRigidBody(obj->bt_body, btBroadphaseProxy::StaticFilter, btBroadphaseProxy::AllFilter);
@@ -1631,6 +2600,7 @@ void Physics_EnableObject(struct physics_object_s *obj)
 
 void Physics_DisableObject(struct physics_object_s *obj)
 {
+    bt_engine_world_stamp++;
     if(obj->bt_body && obj->bt_body->isInWorld())
     {
         bt_engine_dynamicsWorld->removeRigidBody(obj->bt_body);
@@ -1645,6 +2615,7 @@ void Physics_DisableObject(struct physics_object_s *obj)
  */
 void Physics_EnableCollision(struct physics_data_s *physics)
 {
+    bt_engine_world_stamp++;
     if(physics->bt_body)
     {
         for(uint32_t i = 0; i < physics->objects_count; i++)
@@ -1667,6 +2638,7 @@ void Physics_EnableCollision(struct physics_data_s *physics)
 
 void Physics_DisableCollision(struct physics_data_s *physics)
 {
+    bt_engine_world_stamp++;
     if(physics->bt_body != NULL)
     {
         for(uint32_t i = 0; i < physics->objects_count; i++)
@@ -1704,6 +2676,7 @@ void Physics_SetBoneCollision(struct physics_data_s *physics, int bone_index, in
 
 void Physics_SetCollisionGroupAndMask(struct physics_data_s *physics, int16_t group, int16_t mask)
 {
+    bt_engine_world_stamp++;
     if(physics->bt_body != NULL)
     {
         physics->collision_group = (group & (COLLISION_GROUP_STATIC_OBLECT | COLLISION_GROUP_STATIC_ROOM)) ? (btBroadphaseProxy::StaticFilter) : 0x0000;
@@ -1733,10 +2706,12 @@ void Physics_SetCollisionGroupAndMask(struct physics_data_s *physics, int16_t gr
 
 void Physics_SetCollisionScale(struct physics_data_s *physics, float scaling[3])
 {
+    bt_engine_world_stamp++;
     for(int i = 0; i < physics->objects_count; i++)
     {
         bt_engine_dynamicsWorld->removeRigidBody(physics->bt_body[i]);
-            physics->bt_body[i]->getCollisionShape()->setLocalScaling(btVector3(scaling[0], scaling[1], scaling[2]));
+            btCollisionShape *cshape = physics->bt_body[i]->getCollisionShape();
+            physics->bt_body[i]->setCollisionShape(BT_GetScaledShape(cshape, btVector3(scaling[0], scaling[1], scaling[2])));
         bt_engine_dynamicsWorld->addRigidBody(physics->bt_body[i]);
 
         physics->bt_body[i]->activate();
@@ -1747,6 +2722,7 @@ void Physics_SetCollisionScale(struct physics_data_s *physics, float scaling[3])
 void Physics_SetBodyMass(struct physics_data_s *physics, float mass, uint16_t index)
 {
     btVector3 inertia (0.0, 0.0, 0.0);
+    Physics_WakeUp(physics);
     bt_engine_dynamicsWorld->removeRigidBody(physics->bt_body[index]);
 
         physics->bt_body[index]->getCollisionShape()->calculateLocalInertia(mass, inertia);
@@ -1768,6 +2744,7 @@ void Physics_SetBodyMass(struct physics_data_s *physics, float mass, uint16_t in
 
 void Physics_PushBody(struct physics_data_s *physics, float speed[3], uint16_t index)
 {
+    Physics_WakeUp(physics);
     physics->bt_body[index]->setLinearVelocity(btVector3(speed[0], speed[1], speed[2]));
 }
 
@@ -1778,6 +2755,191 @@ void Physics_SetLinearFactor(struct physics_data_s *physics, float factor[3], ui
 }
 
 
+int  Physics_GetSleepState(struct physics_data_s *physics)
+{
+    return (physics) ? (physics->sleep_state) : (PHYSICS_SLEEP_STATE_ACTIVE);
+}
+
+/*
+ * Settle-then-freeze policy: dynamic bodies are allowed to sleep as usual (contacts wake them),
+ * but ragdoll that stays below sleeping thresholds for ragdoll_settle_time gets its simulation
+ * disabled, so kinematic characters walking over the corpse do not wake it up again.
+ * With ragdoll_bake enabled, settled ragdoll bodies and joints are removed from the world;
+ * the last pose stays in bone frame, because it was copied there before settling.
+ */
+int  Physics_UpdateSleepState(struct physics_data_s *physics)
+{
+    if(!physics || !physics->bt_body || (physics->sleep_state >= PHYSICS_SLEEP_STATE_FROZEN))
+    {
+        return (physics) ? (physics->sleep_state) : (PHYSICS_SLEEP_STATE_ACTIVE);
+    }
+
+    bool all_sleeping = true;
+    bool all_settled = true;
+    for(uint16_t i = 0; i < physics->objects_count; i++)
+    {
+        btRigidBody *body = physics->bt_body[i];
+        if(body && (body->getInvMass() > 0.0f) && body->isActive())
+        {
+            all_sleeping = false;
+            all_settled &= (body->getDeactivationTime() >= physics_settings.ragdoll_settle_time);
+        }
+    }
+
+    physics->sleep_state = (all_sleeping) ? (PHYSICS_SLEEP_STATE_SLEEPING) : (PHYSICS_SLEEP_STATE_ACTIVE);
+    if(all_settled && (physics->bt_joint_count > 0))
+    {
+        if(physics_settings.ragdoll_bake)
+        {
+            for(uint16_t i = 0; i < physics->bt_joint_count; i++)
+            {
+                if(physics->bt_joints[i])
+                {
+                    bt_engine_dynamicsWorld->removeConstraint(physics->bt_joints[i]);
+                    delete physics->bt_joints[i];
+                    physics->bt_joints[i] = NULL;
+                }
+            }
+            for(uint16_t i = 0; i < physics->objects_count; i++)
+            {
+                if(physics->bt_body[i] && physics->bt_body[i]->isInWorld())
+                {
+                    bt_engine_dynamicsWorld->removeRigidBody(physics->bt_body[i]);
+                }
+            }
+            bt_engine_baked_bodies += physics->objects_count;
+            physics->sleep_state = PHYSICS_SLEEP_STATE_BAKED;
+        }
+        else
+        {
+            for(uint16_t i = 0; i < physics->objects_count; i++)
+            {
+                if(physics->bt_body[i])
+                {
+                    physics->bt_body[i]->setLinearVelocity(btVector3(0.0, 0.0, 0.0));
+                    physics->bt_body[i]->setAngularVelocity(btVector3(0.0, 0.0, 0.0));
+                    physics->bt_body[i]->forceActivationState(DISABLE_SIMULATION);
+                }
+            }
+            physics->sleep_state = PHYSICS_SLEEP_STATE_FROZEN;
+        }
+    }
+
+    return physics->sleep_state;
+}
+
+
+void Physics_WakeUp(struct physics_data_s *physics)
+{
+    if(physics && physics->bt_body && (physics->sleep_state != PHYSICS_SLEEP_STATE_ACTIVE))
+    {
+        if(physics->sleep_state == PHYSICS_SLEEP_STATE_BAKED)
+        {
+            // joints are lost, so body returns to the world as a free one.
+            for(uint16_t i = 0; i < physics->objects_count; i++)
+            {
+                if(physics->bt_body[i] && !physics->bt_body[i]->isInWorld())
+                {
+                    bt_engine_dynamicsWorld->addRigidBody(physics->bt_body[i], btBroadphaseProxy::CharacterFilter, btBroadphaseProxy::CharacterFilter | btBroadphaseProxy::StaticFilter | btBroadphaseProxy::KinematicFilter);
+                }
+            }
+            bt_engine_baked_bodies -= physics->objects_count;
+        }
+
+        for(uint16_t i = 0; i < physics->objects_count; i++)
+        {
+            if(physics->bt_body[i])
+            {
+                physics->bt_body[i]->forceActivationState(ACTIVE_TAG);
+                physics->bt_body[i]->setDeactivationTime(0.0f);
+            }
+        }
+        physics->sleep_state = PHYSICS_SLEEP_STATE_ACTIVE;
+    }
+}
+
+
+static void Physics_WakeUpFrozenBody(const btCollisionObject *obj, struct engine_container_s *other)
+{
+    engine_container_p cont = (engine_container_p)obj->getUserPointer();
+    if((obj->getActivationState() == DISABLE_SIMULATION) && cont && (cont != other) && (cont->object_type == OBJECT_ENTITY))
+    {
+        entity_p ent = (entity_p)cont->object;
+        if(ent->physics && (ent->physics->sleep_state == PHYSICS_SLEEP_STATE_FROZEN))
+        {
+            Physics_WakeUp(ent->physics);
+        }
+    }
+}
+
+
+/*
+ * Frozen bodies still collide, but as immovable ones: so dynamic body, that
+ * touches frozen ragdoll (falling object, other ragdoll), wakes it up.
+ * Kinematic characters are not checked, walking over corpse keeps it frozen.
+ */
+static void Physics_WakeUpByContacts()
+{
+    btDispatcher *dispatcher = bt_engine_dynamicsWorld->getDispatcher();
+    int manifolds_count = dispatcher->getNumManifolds();
+    for(int i = 0; i < manifolds_count; i++)
+    {
+        btPersistentManifold *manifold = dispatcher->getManifoldByIndexInternal(i);
+        if(manifold->getNumContacts() > 0)
+        {
+            const btCollisionObject *obj0 = manifold->getBody0();
+            const btCollisionObject *obj1 = manifold->getBody1();
+            if(!obj1->isStaticOrKinematicObject() && obj1->isActive())
+            {
+                Physics_WakeUpFrozenBody(obj0, (engine_container_p)obj1->getUserPointer());
+            }
+            if(!obj0->isStaticOrKinematicObject() && obj0->isActive())
+            {
+                Physics_WakeUpFrozenBody(obj1, (engine_container_p)obj0->getUserPointer());
+            }
+        }
+    }
+}
+
+
+struct bt_engine_WakeUpCallback : public btBroadphaseAabbCallback
+{
+    struct engine_container_s *cont;
+
+    virtual bool process(const btBroadphaseProxy *proxy)
+    {
+        Physics_WakeUpFrozenBody((const btCollisionObject*)proxy->m_clientObject, cont);
+        return true;
+    }
+};
+
+
+/*
+ * Entity bodies are moved by transform setting (animation, scripts), without
+ * contacts, so frozen ragdolls in moved bodies boxes are woken up explicitly.
+ * Baked ragdolls are out of collision world: they are kept as a decoration
+ * (that is the point of ragdoll_bake) and woken up only by the own setters.
+ */
+void Physics_WakeUpTouching(struct physics_data_s *physics)
+{
+    if(physics && physics->bt_body && (physics_stats.bodies_frozen > 0))
+    {
+        bt_engine_WakeUpCallback cb;
+        cb.cont = physics->cont;
+        for(uint16_t i = 0; i < physics->objects_count; i++)
+        {
+            btRigidBody *body = physics->bt_body[i];
+            if(body && body->isInWorld())
+            {
+                btVector3 aabb_min, aabb_max;
+                body->getCollisionShape()->getAabb(body->getWorldTransform(), aabb_min, aabb_max);
+                bt_engine_overlappingPairCache->aabbTest(aabb_min, aabb_max, cb);
+            }
+        }
+    }
+}
+
+
 /* *****************************************************************************
  * ************************  HAIR DATA  ****************************************
  * ****************************************************************************/
@@ -1788,6 +2950,7 @@ typedef struct hair_element_s
     btCollisionShape           *shape;             // Pointer to collision shape.
     btRigidBody                *body;              // Pointer to dynamic body.
     btGeneric6DofConstraint    *joint;             // Array of joints.
+    btTransform                 local_transform;   // Transform relative to owner body, for kinematic follow.
 }hair_element_t, *hair_element_p;
 
 
@@ -1800,6 +2963,8 @@ typedef struct hair_s
     uint8_t                   tail_index;         // Index of "tail" element.
 
     uint8_t                   element_count;      // Overall amount of elements.
+    uint8_t                   lod;                // Current simulation level of detail.
+    btScalar                  length;             // Full hair length, for screen size calculation.
     hair_element_s           *elements;           // Array of elements.
 
     uint8_t                   vertex_map_count;
@@ -1863,12 +3028,13 @@ struct hair_s *Hair_Create(struct hair_setup_s *setup, struct physics_data_s *ph
         // Point to corresponding mesh.
 
         hair->elements[i].mesh = model->mesh_tree[i].mesh_base;
+        hair->length += fabs(hair->elements[i].mesh->bb_max[1] - hair->elements[i].mesh->bb_min[1]);
 
         // Begin creating ACTUAL physical hair mesh.
         btVector3   localInertia(0, 0, 0);
 
         // Make collision shape out of mesh.
-        hair->elements[i].shape = BT_CSfromMesh(hair->elements[i].mesh, true, true, false);
+        hair->elements[i].shape = BT_SharedCSfromMesh(hair->elements[i].mesh, false);
         hair->elements[i].shape->calculateLocalInertia((current_weight * setup->hair_inertia), localInertia);
         hair->elements[i].joint = NULL;
 
@@ -2018,7 +3184,7 @@ void Hair_Delete(struct hair_s *hair)
             }
             if(hair->elements[i].shape)
             {
-                delete hair->elements[i].shape;
+                BT_DeleteShape(hair->elements[i].shape);
                 hair->elements[i].shape = NULL;
             }
         }
@@ -2040,12 +3206,287 @@ void Hair_Delete(struct hair_s *hair)
 }
 
 
+static void Hair_FollowOwner(struct hair_s *hair, btRigidBody *owner_body)
+{
+    const btTransform &owner_tr = owner_body->getWorldTransform();
+    for(int i = 0; i < hair->element_count; i++)
+    {
+        btTransform tr = owner_tr * hair->elements[i].local_transform;
+        hair->elements[i].body->setWorldTransform(tr);
+        hair->elements[i].body->setInterpolationWorldTransform(tr);
+        hair->elements[i].body->getMotionState()->setWorldTransform(tr);
+    }
+}
+
+
+static void Hair_SetLod(struct hair_s *hair, btRigidBody *owner_body, uint8_t lod, btScalar iterations_scale)
+{
+    if(lod == HAIR_LOD_KINEMATIC)
+    {
+        if(hair->lod != HAIR_LOD_KINEMATIC)
+        {
+            // Remember current pose relative to the head, hair keeps it while not simulated.
+            btTransform inv_owner = owner_body->getWorldTransform().inverse();
+            for(int i = 0; i < hair->element_count; i++)
+            {
+                hair->elements[i].local_transform = inv_owner * hair->elements[i].body->getWorldTransform();
+                hair->elements[i].joint->setEnabled(false);
+                hair->elements[i].body->forceActivationState(DISABLE_SIMULATION);
+            }
+        }
+    }
+    else
+    {
+        if(hair->lod == HAIR_LOD_KINEMATIC)
+        {
+            for(int i = 0; i < hair->element_count; i++)
+            {
+                hair->elements[i].body->setLinearVelocity(owner_body->getLinearVelocity());
+                hair->elements[i].body->setAngularVelocity(btVector3(0.0f, 0.0f, 0.0f));
+                hair->elements[i].body->forceActivationState(DISABLE_DEACTIVATION);
+                hair->elements[i].joint->setEnabled(true);
+            }
+        }
+
+        // Full LOD restores exactly the same iterations as were set on creation.
+        for(int i = 0; i < hair->element_count; i++)
+        {
+            int iterations = (i == 0) ? (100) : (-1);
+            if(lod == HAIR_LOD_REDUCED)
+            {
+                iterations = (i == 0) ? (100 * iterations_scale) : (bt_engine_dynamicsWorld->getSolverInfo().m_numIterations * iterations_scale);
+                iterations = (iterations < 1) ? (1) : (iterations);
+            }
+            hair->elements[i].joint->setOverrideNumSolverIterations(iterations);
+        }
+    }
+    hair->lod = lod;
+}
+
+
 void Hair_Update(struct hair_s *hair, struct physics_data_s *physics)
 {
     if(hair && (hair->element_count > 0))
     {
+        uint64_t start = SDL_GetPerformanceCounter();
+        btRigidBody *owner_body = physics->bt_body[hair->owner_body];
+        uint8_t lod = HAIR_LOD_FULL;
+        btScalar iterations_scale = 1.0f;
+
         hair->container->room = physics->cont->room;
+        if(physics_settings.hair_lod && owner_body)
+        {
+            btVector3 cam_pos(engine_camera.transform.M4x4[12], engine_camera.transform.M4x4[13], engine_camera.transform.M4x4[14]);
+            btScalar dist = cam_pos.distance(owner_body->getWorldTransform().getOrigin());
+            bool visible = hair->container->room && hair->container->room->is_in_r_list;
+            // projected hair length in parts of screen height
+            btScalar screen_size = (dist > 1.0f) ? (0.5f * hair->length * engine_camera.f / dist) : (1.0f);
+
+            if(!visible || (screen_size < physics_settings.hair_lod_screen_size))
+            {
+                lod = HAIR_LOD_KINEMATIC;
+            }
+            else if(dist > physics_settings.hair_lod_distance)
+            {
+                lod = HAIR_LOD_REDUCED;
+                iterations_scale = physics_settings.hair_lod_distance / dist;
+                iterations_scale = (iterations_scale < 0.1f) ? (0.1f) : (iterations_scale);
+            }
+        }
+
+        if((lod != hair->lod) || (lod == HAIR_LOD_REDUCED))
+        {
+            Hair_SetLod(hair, owner_body, lod, iterations_scale);
+        }
+
+        if(hair->lod == HAIR_LOD_KINEMATIC)
+        {
+            Hair_FollowOwner(hair, owner_body);
+        }
+
+        bt_engine_hair_stats.hairs[hair->lod]++;
+        bt_engine_hair_stats.time += SDL_GetPerformanceCounter() - start;
+    }
+}
+
+
+typedef struct hair_test_state_s
+{
+    btTransform                 transform;
+    btTransform                 local_transform;
+    btVector3                   linear_velocity;
+    btVector3                   angular_velocity;
+    int                         activation_state;
+    int                         iterations;
+    bool                        joint_enabled;
+    short                       group;
+    short                       mask;
+}hair_test_state_t, *hair_test_state_p;
+
+
+static void Hair_TestResetState(struct hair_s *hair, hair_test_state_p state)
+{
+    for(int i = 0; i < hair->element_count; i++, state++)
+    {
+        btRigidBody *body = hair->elements[i].body;
+        body->setWorldTransform(state->transform);
+        body->setInterpolationWorldTransform(state->transform);
+        body->getMotionState()->setWorldTransform(state->transform);
+        body->setLinearVelocity(state->linear_velocity);
+        body->setAngularVelocity(state->angular_velocity);
+        body->setInterpolationLinearVelocity(state->linear_velocity);
+        body->setInterpolationAngularVelocity(state->angular_velocity);
+        body->clearForces();
+        hair->elements[i].local_transform = state->local_transform;
+    }
+}
+
+
+/*
+ * Simulates hair from the saved state in the private world; lod < 0 - LOD
+ * is chosen by Hair_Update every step, as in game. Returns ms per step.
+ */
+static float Hair_TestRun(struct hair_s *hair, struct physics_data_s *physics, btDiscreteDynamicsWorld *world, hair_test_state_p state, int lod, int steps, btTransform *result)
+{
+    btRigidBody *owner_body = physics->bt_body[hair->owner_body];
+    uint64_t start;
+
+    Hair_SetLod(hair, owner_body, HAIR_LOD_FULL, 1.0f);                      // restores joints and activation
+    Hair_TestResetState(hair, state);
+    if(lod > HAIR_LOD_FULL)
+    {
+        Hair_SetLod(hair, owner_body, lod, 0.5f);
+    }
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < steps; i++)
+    {
+        if(lod < 0)
+        {
+            Hair_Update(hair, physics);
+        }
+        else if(lod == HAIR_LOD_KINEMATIC)
+        {
+            Hair_FollowOwner(hair, owner_body);
+        }
+        world->stepSimulation(1.0f / 60.0f, 0);
+    }
+    start = SDL_GetPerformanceCounter() - start;
+
+    for(int i = 0; i < hair->element_count; i++)
+    {
+        result[i] = hair->elements[i].body->getWorldTransform();
+    }
+
+    return 1000.0f * (float)start / ((float)SDL_GetPerformanceFrequency() * (float)steps);
+}
+
+
+/*
+ * Hair with the owner body is moved to the private world (no rooms and other
+ * bodies there), so simulation cost of the hair itself is measured: for LOD,
+ * chosen by current camera, for LOD disabled, and for every forced LOD, all
+ * from the same state. Hair state, LOD and world membership are restored
+ * after the test; hair contacts are rebuilt by the next game step.
+ */
+void Hair_TestLod(struct hair_s *hair, struct physics_data_s *physics, int steps, struct hair_lod_test_s *result)
+{
+    btRigidBody *owner_body = (hair && physics && physics->bt_body) ? (physics->bt_body[hair->owner_body]) : (NULL);
+
+    memset(result, 0x00, sizeof(struct hair_lod_test_s));
+    if(!owner_body || !owner_body->isInWorld() || (hair->element_count == 0) || (steps < 1))
+    {
+        return;
     }
+
+    btDefaultCollisionConfiguration config;
+    btCollisionDispatcher dispatcher(&config);
+    btDbvtBroadphase broadphase;
+    btSequentialImpulseConstraintSolver solver;
+    btDiscreteDynamicsWorld world(&dispatcher, &broadphase, &solver, &config);
+    btAlignedObjectArray<hair_test_state_t> states;
+    btAlignedObjectArray<btTransform> transforms;
+    states.resize(hair->element_count + 1);
+    transforms.resize(2 * hair->element_count);
+    hair_test_state_p state = &states[0];
+    hair_test_state_p owner_state = state + hair->element_count;
+    btTransform *tr_ref = &transforms[0];
+    btTransform *tr_lod = tr_ref + hair->element_count;
+    uint8_t saved_lod = hair->lod;
+    uint16_t saved_hair_lod = physics_settings.hair_lod;
+    uint32_t saved_stats_hairs[3];
+    uint64_t saved_stats_time = bt_engine_hair_stats.time;
+
+    memcpy(saved_stats_hairs, bt_engine_hair_stats.hairs, sizeof(saved_stats_hairs));
+    world.setGravity(bt_engine_dynamicsWorld->getGravity());
+    world.getSolverInfo() = bt_engine_dynamicsWorld->getSolverInfo();
+
+    // save state and move hair into the private world
+    for(int i = 0; i < hair->element_count; i++)
+    {
+        btRigidBody *body = hair->elements[i].body;
+        state[i].transform = body->getWorldTransform();
+        state[i].local_transform = hair->elements[i].local_transform;
+        state[i].linear_velocity = body->getLinearVelocity();
+        state[i].angular_velocity = body->getAngularVelocity();
+        state[i].activation_state = body->getActivationState();
+        state[i].iterations = hair->elements[i].joint->getOverrideNumSolverIterations();
+        state[i].joint_enabled = hair->elements[i].joint->isEnabled();
+        state[i].group = body->getBroadphaseHandle()->m_collisionFilterGroup;
+        state[i].mask = body->getBroadphaseHandle()->m_collisionFilterMask;
+        bt_engine_dynamicsWorld->removeConstraint(hair->elements[i].joint);
+        bt_engine_dynamicsWorld->removeRigidBody(body);
+    }
+    owner_state->group = owner_body->getBroadphaseHandle()->m_collisionFilterGroup;
+    owner_state->mask = owner_body->getBroadphaseHandle()->m_collisionFilterMask;
+    bt_engine_dynamicsWorld->removeRigidBody(owner_body);
+
+    world.addRigidBody(owner_body, owner_state->group, owner_state->mask);
+    for(int i = 0; i < hair->element_count; i++)
+    {
+        world.addRigidBody(hair->elements[i].body, state[i].group, state[i].mask);
+        world.addConstraint(hair->elements[i].joint, true);
+    }
+
+    physics_settings.hair_lod = 0;
+    result->no_lod_time = Hair_TestRun(hair, physics, &world, state, -1, steps, tr_ref);
+    physics_settings.hair_lod = 1;
+    result->camera_lod_time = Hair_TestRun(hair, physics, &world, state, -1, steps, tr_lod);
+    result->camera_lod = hair->lod;
+    for(int i = 0; i < hair->element_count; i++)
+    {
+        result->mismatches += (tr_ref[i] == tr_lod[i]) ? (0) : (1);
+    }
+    for(int lod = HAIR_LOD_FULL; lod <= HAIR_LOD_KINEMATIC; lod++)
+    {
+        result->lod_time[lod] = Hair_TestRun(hair, physics, &world, state, lod, steps, tr_lod);
+    }
+
+    // return hair into the game world with the saved state
+    Hair_SetLod(hair, owner_body, HAIR_LOD_FULL, 1.0f);
+    Hair_TestResetState(hair, state);
+    for(int i = 0; i < hair->element_count; i++)
+    {
+        world.removeConstraint(hair->elements[i].joint);
+        world.removeRigidBody(hair->elements[i].body);
+    }
+    world.removeRigidBody(owner_body);
+
+    bt_engine_dynamicsWorld->addRigidBody(owner_body, owner_state->group, owner_state->mask);
+    for(int i = 0; i < hair->element_count; i++)
+    {
+        btRigidBody *body = hair->elements[i].body;
+        bt_engine_dynamicsWorld->addRigidBody(body, state[i].group, state[i].mask);
+        bt_engine_dynamicsWorld->addConstraint(hair->elements[i].joint, true);
+        body->forceActivationState(state[i].activation_state);
+        hair->elements[i].joint->setEnabled(state[i].joint_enabled);
+        hair->elements[i].joint->setOverrideNumSolverIterations(state[i].iterations);
+    }
+    hair->lod = saved_lod;
+    physics_settings.hair_lod = saved_hair_lod;
+    memcpy(bt_engine_hair_stats.hairs, saved_stats_hairs, sizeof(saved_stats_hairs));
+    bt_engine_hair_stats.time = saved_stats_time;
+    bt_engine_world_stamp++;
 }
 
 int Hair_GetElementsCount(struct hair_s *hair)
@@ -2083,6 +3524,7 @@ bool Ragdoll_Create(struct physics_data_s *physics, struct ss_bone_frame_s *bf,
     }
 
     // Setup bodies.
+    Physics_WakeUp(physics);
     physics->bt_joint_count = 0;
     // update current character animation and full fix body to avoid starting ragdoll partially inside the wall or floor...
     for(uint32_t i = 0; i < setup->body_count; i++)
@@ -2112,7 +3554,7 @@ bool Ragdoll_Create(struct physics_data_s *physics, struct ss_bone_frame_s *bf,
         physics->bt_body[i]->setDamping(setup->body_setup[i].damping[0], setup->body_setup[i].damping[1]);
         physics->bt_body[i]->setRestitution(setup->body_setup[i].restitution);
         physics->bt_body[i]->setFriction(setup->body_setup[i].friction);
-        physics->bt_body[i]->setSleepingThresholds(RD_DEFAULT_SLEEPING_THRESHOLD, RD_DEFAULT_SLEEPING_THRESHOLD);
+        physics->bt_body[i]->setSleepingThresholds(physics_settings.ragdoll_linear_sleep, physics_settings.ragdoll_angular_sleep);
 
         if(bf->bone_tags[i].parent == NULL)
         {
@@ -2214,6 +3656,8 @@ bool Ragdoll_Delete(struct physics_data_s *physics)
         return false;
     }
 
+    Physics_WakeUp(physics);
+
     for(uint32_t i = 0; i < physics->bt_joint_count; i++)
     {
         if(physics->bt_joints[i])
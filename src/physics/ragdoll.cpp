@@ -277,10 +277,12 @@ struct rd_setup_s *Ragdoll_AutoCreateSetup(struct skeletal_model_s *model, uint1
     struct rd_setup_s *setup = NULL;
     if(model && (anim < model->animation_count) && (frame < model->animations[anim].frames_count))
     {
-        bone_frame_p bf = model->animations[anim].frames + frame;
+        bone_frame_t frame_data = {0};
+        bone_frame_p bf = &frame_data;
         rd_joint_setup_p js;
         float tr[16], t;
         setup = (rd_setup_p)malloc(sizeof(rd_setup_t));
+        Anim_GetFrame(model->animations + anim, frame, bf);
 
         setup->body_count  = model->mesh_count;
         setup->joint_count = model->mesh_count - 1;
@@ -392,6 +394,7 @@ struct rd_setup_s *Ragdoll_AutoCreateSetup(struct skeletal_model_s *model, uint1
                 js++;
             }
         }
+        free(frame_data.bone_tags);
     }
 
     return setup;
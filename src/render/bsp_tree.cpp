@@ -234,7 +234,7 @@ CDynamicBSP::~CDynamicBSP()
 }
 
 
-void CDynamicBSP::AddNewPolygonList(struct polygon_s *p, float transform[16], struct frustum_s *f)
+void CDynamicBSP::AddNewPolygonList(struct polygon_s *p, const float transform[16], struct frustum_s *f)
 {
     for( ; p && (!m_realloc_state); p = p->next)
     {
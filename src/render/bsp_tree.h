@@ -65,7 +65,7 @@ public:
     CDynamicBSP(uint32_t size);
    ~CDynamicBSP();
    
-    void AddNewPolygonList(struct polygon_s *p, float transform[16], struct frustum_s *f);
+    void AddNewPolygonList(struct polygon_s *p, const float transform[16], struct frustum_s *f);
     void Reset(struct anim_seq_s *seq);
     
     struct vertex_s *GetVertexArray()
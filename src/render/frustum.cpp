@@ -653,26 +653,29 @@ bool Frustum_IsAABBVisible(float bbmin[3], float bbmax[3], struct frustum_s *fru
 }
 
 
+/*
+ * Box is projected to each clip plane normal (centre distance vs projected
+ * radius), so no faces are needed. Test is conservative: box that is out of
+ * frustum near it's corner may be reported as visible.
+ */
 bool Frustum_IsOBBVisible(struct obb_s *obb, struct frustum_s *frustum)
 {
-    bool inside = true;
-    float t;
-    polygon_p p = obb->polygons;
+    float *n = frustum->planes;
 
-    for(int i = 0; i < 6; i++, p++)
+    for(uint16_t i = 0; i <= frustum->vertex_count; i++, n += 4)
     {
-        t = vec3_plane_dist(p->plane, frustum->cam_pos);
-        if((t >= 0.0f) && Frustum_IsPolyVisible(p, frustum, true))
-        {
-            return true;
-        }
-        if(inside && (t > 0.0f))
+        float r;
+        n = (i < frustum->vertex_count) ? (n) : (frustum->norm);
+        r = obb->extent[0] * fabs(vec3_dot(n, obb->axis[0])) +
+            obb->extent[1] * fabs(vec3_dot(n, obb->axis[1])) +
+            obb->extent[2] * fabs(vec3_dot(n, obb->axis[2]));
+        if(vec3_plane_dist(n, obb->centre) < -r)
         {
-            inside = false;
+            return false;
         }
     }
 
-    return inside;
+    return true;
 }
 
 bool Frustum_IsOBBVisibleInFrustumList(struct obb_s *obb, struct frustum_s *frustum)
@@ -385,13 +385,12 @@ void CRender::DrawList()
                     entity_p ent = (entity_p)cont->object;
                     if((ent->state_flags & ENTITY_STATE_VISIBLE) && ent->bf->animations.model && (ent->bf->animations.model->transparency_flags == MESH_HAS_TRANSPARENCY) && Frustum_IsOBBVisibleInFrustumList(ent->obb, (r->frustum) ? (r->frustum) : (m_camera->frustum)))
                     {
-                        float tr[16];
+                        const float *palette = SSBoneFrame_GetPalette(ent->bf);
                         for(uint16_t j = 0; j < ent->bf->bone_tag_count; j++)
                         {
                             if(ent->bf->bone_tags[j].mesh_base->transparency_polygons != NULL)
                             {
-                                Mat4_Mat4_mul(tr, ent->transform.M4x4, ent->bf->bone_tags[j].current_transform);
-                                dynamicBSP->AddNewPolygonList(ent->bf->bone_tags[j].mesh_base->transparency_polygons, tr, m_camera->frustum);
+                                dynamicBSP->AddNewPolygonList(ent->bf->bone_tags[j].mesh_base->transparency_polygons, palette + 16 * j, m_camera->frustum);
                             }
                         }
                     }
@@ -441,12 +440,11 @@ void CRender::DrawListDebugLines()
         if((r_flags & R_DRAW_NORMALS) && skybox)
         {
             GLfloat tr[16];
-            float *p;
+            bone_tag_t btag;
             Mat4_E_macro(tr);
-            p = skybox->animations->frames->bone_tags->offset;
-            vec3_add(tr + 12, m_camera->transform.M4x4 + 12, p);
-            p = skybox->animations->frames->bone_tags->qrotate;
-            Mat4_set_qrotation(tr, p);
+            Anim_GetKeyframeBoneTag(skybox->animations, 0, 0, &btag);
+            vec3_add(tr + 12, m_camera->transform.M4x4 + 12, btag.offset);
+            Mat4_set_qrotation(tr, btag.qrotate);
             debugDrawer->DrawMeshDebugLines(skybox->mesh_tree->mesh_base, tr, NULL, NULL);
         }
 
@@ -835,13 +833,12 @@ void CRender::DrawSkyBox(const float modelViewProjectionMatrix[16])
     if((r_flags & R_DRAW_SKYBOX) && (skybox = World_GetSkybox()))
     {
         float tr[16];
-        float *p;
+        bone_tag_t btag;
         qglDepthMask(GL_FALSE);
         tr[15] = 1.0;
-        p = skybox->animations->frames->bone_tags->offset;
-        vec3_add(tr + 12, m_camera->transform.M4x4 + 12, p);
-        p = skybox->animations->frames->bone_tags->qrotate;
-        Mat4_set_qrotation(tr, p);
+        Anim_GetKeyframeBoneTag(skybox->animations, 0, 0, &btag);
+        vec3_add(tr + 12, m_camera->transform.M4x4 + 12, btag.offset);
+        Mat4_set_qrotation(tr, btag.qrotate);
         float fullView[16];
         Mat4_Mat4_mul(fullView, modelViewProjectionMatrix, tr);
 
@@ -861,22 +858,24 @@ void CRender::DrawSkyBox(const float modelViewProjectionMatrix[16])
 /**
  * skeletal model drawing
  */
-void CRender::DrawSkeletalModel(const lit_shader_description *shader, struct ss_bone_frame_s *bframe, const float mvMatrix[16], const float mvpMatrix[16])
+void CRender::DrawSkeletalModel(const lit_shader_description *shader, struct ss_bone_frame_s *bframe, const float mvMatrix[16], const float mvpMatrix[16], const float *palette)
 {
     ss_bone_tag_p btag = bframe->bone_tags;
     float mvTransform[16];
     float mvpTransform[16];
     //mvMatrix = modelViewMatrix x entity->transform
     //mvpMatrix = modelViewProjectionMatrix x entity->transform
+    //if palette is used, mvMatrix and mvpMatrix are taken without entity->transform
 
     for(uint16_t i = 0; i < bframe->bone_tag_count; i++, btag++)
     {
         if(!btag->is_hidden)
         {
-            Mat4_Mat4_mul(mvTransform, mvMatrix, btag->current_transform);
+            const float *bone_transform = (palette) ? (palette + 16 * i) : (btag->current_transform);
+            Mat4_Mat4_mul(mvTransform, mvMatrix, bone_transform);
             qglUniformMatrix4fvARB(shader->model_view, 1, false, mvTransform);
 
-            Mat4_Mat4_mul(mvpTransform, mvpMatrix, btag->current_transform);
+            Mat4_Mat4_mul(mvpTransform, mvpMatrix, bone_transform);
             qglUniformMatrix4fvARB(shader->model_view_projection, 1, false, mvpTransform);
 
             this->DrawMesh((btag->mesh_replace) ? (btag->mesh_replace) : (btag->mesh_base), NULL, NULL);
@@ -913,15 +912,13 @@ void CRender::DrawEntity(struct entity_s *entity, const float modelViewMatrix[16
             Mat4_Scale(scaledTransform, entity->transform.scaling[0], entity->transform.scaling[1], entity->transform.scaling[2]);
             Mat4_Mat4_mul(subModelView, modelViewMatrix, scaledTransform);
             Mat4_Mat4_mul(subModelViewProjection, modelViewProjectionMatrix, scaledTransform);
+            this->DrawSkeletalModel(shader, entity->bf, subModelView, subModelViewProjection, NULL);
         }
         else
         {
-            Mat4_Mat4_mul(subModelView, modelViewMatrix, entity->transform.M4x4);
-            Mat4_Mat4_mul(subModelViewProjection, modelViewProjectionMatrix, entity->transform.M4x4);
+            this->DrawSkeletalModel(shader, entity->bf, modelViewMatrix, modelViewProjectionMatrix, SSBoneFrame_GetPalette(entity->bf));
         }
 
-        this->DrawSkeletalModel(shader, entity->bf, subModelView, subModelViewProjection);
-
         if(entity->character && entity->character->hair_count)
         {
             base_mesh_p mesh;
@@ -294,7 +294,7 @@ void CRenderDebugDrawer::DrawBBox(float bb_min[3], float bb_max[3], float *trans
 void CRenderDebugDrawer::DrawOBB(struct obb_s *obb)
 {
     struct vertex_s *v, *v0;
-    polygon_p p = obb->polygons;
+    polygon_p p = OBB_GetPolygons(obb);
 
     if(m_lines + 12 >= m_max_lines)
     {
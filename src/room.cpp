@@ -16,11 +16,57 @@
 #include "mesh.h"
 #include "trigger.h"
 #include "room.h"
+#include "room_zones.h"
 #include "world.h"
 
 
 #define ROOM_LIST_SIZE_ALIGN    (8)
 
+#define PATH_BIT_SET(bits, i)   ((bits)[(i) >> 5] |= (1u << ((i) & 31)))
+#define PATH_BIT_TEST(bits, i)  ((bits)[(i) >> 5] & (1u << ((i) & 31)))
+#define PATH_BIT_CLEAR(bits, i) ((bits)[(i) >> 5] &= ~(1u << ((i) & 31)))
+
+typedef struct path_node_s
+{
+    float       f;                                                              // weight + heuristic
+    uint32_t    box;
+}path_node_t, *path_node_p;
+
+static struct
+{
+    uint32_t            boxes_count;                                            // reserved boxes count
+    float              *weights;
+    room_box_p         *parents;
+    uint32_t           *open_bits;
+    uint32_t           *closed_bits;
+    uint32_t            heap_size;
+    uint32_t            heap_count;
+    path_node_p         heap;
+} path_search = {0};
+
+#define PATH_CACHE_SIZE         (64)
+#define PATH_CACHE_MAX_LENGTH   (64)
+
+typedef struct path_cache_entry_s
+{
+    uint32_t    options;                                                        // packed zone options, 0 = empty entry
+    uint32_t    last_use;
+    uint16_t    step_up;
+    uint16_t    step_down;
+    uint16_t    from_box;
+    uint16_t    to_box;
+    uint16_t    count;
+    uint16_t    boxes[PATH_CACHE_MAX_LENGTH];                                   // from start to goal
+}path_cache_entry_t, *path_cache_entry_p;
+
+static struct
+{
+    int                 enabled;
+    uint32_t            use_counter;
+    path_cache_stats_t  stats;
+    path_cache_entry_t  entries[PATH_CACHE_SIZE];
+} path_cache = {1};
+
 
 void Room_Clear(struct room_s *room)
 {
@@ -290,6 +336,7 @@ int  Room_RemoveObject(struct room_s *room, struct engine_container_s *cont)
 void Room_SetActiveContent(struct room_s *room, struct room_s *room_with_content_from)
 {
     engine_container_p cont = room->containers;
+    Room_InvalidatePathCache();
     room->containers = NULL;
     room->content = room_with_content_from->original_content;
     Physics_SetOwnerObject(room->content->physics_body, room->self);
@@ -322,6 +369,7 @@ void Room_DoFlip(struct room_s *room1, struct room_s *room2)
 {
     if(room1 && room2 && (room1 != room2))
     {
+        Room_InvalidatePathCache();
         room1->frustum = NULL;
         room2->frustum = NULL;
 
@@ -782,8 +830,204 @@ int Sectors_SimilarCeiling(room_sector_p s1, room_sector_p s2, int ignore_doors)
 }
 
 
+/*
+ * Long ray test against rooms geometry: 2D DDA over sectors grid, portals and
+ * rooms above / below are followed, sector column is limited by lowest floor
+ * corner and highest ceiling corner (optimistic on slopes). Visited rooms are
+ * collected for dynamic objects tests; hit_room is start room on input and
+ * room of the hit (or of the segment end) on output.
+ */
+static void Room_LongRayAddRoom(struct room_s *room, struct room_s **rooms, int *rooms_count, int max_rooms)
+{
+    for(int i = 0; i < *rooms_count; i++)
+    {
+        if(rooms[i] == room)
+        {
+            return;
+        }
+    }
+    if(*rooms_count < max_rooms)
+    {
+        rooms[(*rooms_count)++] = room;
+    }
+}
+
+
+static float Sector_LowestFloorZ(room_sector_p rs)
+{
+    float ret = rs->floor_corners[0][2];
+    for(int i = 1; i < 4; i++)
+    {
+        ret = (rs->floor_corners[i][2] < ret) ? (rs->floor_corners[i][2]) : (ret);
+    }
+    return ret;
+}
+
+
+static float Sector_HighestCeilingZ(room_sector_p rs)
+{
+    float ret = rs->ceiling_corners[0][2];
+    for(int i = 1; i < 4; i++)
+    {
+        ret = (rs->ceiling_corners[i][2] > ret) ? (rs->ceiling_corners[i][2]) : (ret);
+    }
+    return ret;
+}
+
+
+int Room_LongRayTest(struct room_s **hit_room, const float from[3], const float to[3], float *fraction, struct room_s **rooms, int *rooms_count, int max_rooms)
+{
+    struct room_s *room = (*hit_room) ? ((*hit_room)->real_room) : (NULL);
+    float dir[3], t = 0.0f, t_delta[2], t_next[2];
+    int32_t cell[2], last_cell[2], step[2], cells_left;
+
+    vec3_sub(dir, to, from);
+    *rooms_count = 0;
+    *fraction = 0.0f;
+    if(!room)
+    {
+        return 1;
+    }
+
+    for(int i = 0; i < 2; i++)
+    {
+        cell[i] = floorf(from[i] / TR_METERING_SECTORSIZE);
+        last_cell[i] = floorf(to[i] / TR_METERING_SECTORSIZE);
+        if(dir[i] > 0.0f)
+        {
+            step[i] = 1;
+            t_delta[i] = TR_METERING_SECTORSIZE / dir[i];
+            t_next[i] = ((cell[i] + 1) * TR_METERING_SECTORSIZE - from[i]) / dir[i];
+        }
+        else if(dir[i] < 0.0f)
+        {
+            step[i] = -1;
+            t_delta[i] = -TR_METERING_SECTORSIZE / dir[i];
+            t_next[i] = (cell[i] * TR_METERING_SECTORSIZE - from[i]) / dir[i];
+        }
+        else
+        {
+            step[i] = 0;
+            t_delta[i] = 2.0f;
+            t_next[i] = 2.0f;
+        }
+    }
+
+    cells_left = abs(last_cell[0] - cell[0]) + abs(last_cell[1] - cell[1]) + 1;
+    Room_LongRayAddRoom(room, rooms, rooms_count, max_rooms);
+    while(cells_left-- > 0)
+    {
+        room_sector_p rs, low, high;
+        struct room_s *low_room;
+        float t_exit = (t_next[0] < t_next[1]) ? (t_next[0]) : (t_next[1]);
+        float pos[3], z0, z1, z_min, z_max, floor_z, ceiling_z;
+
+        t_exit = (t_exit < 1.0f) ? (t_exit) : (1.0f);
+        pos[0] = (cell[0] + 0.5f) * TR_METERING_SECTORSIZE;
+        pos[1] = (cell[1] + 0.5f) * TR_METERING_SECTORSIZE;
+        pos[2] = 0.0f;
+        z0 = from[2] + dir[2] * t;
+        z1 = from[2] + dir[2] * t_exit;
+        z_min = (z0 < z1) ? (z0) : (z1);
+        z_max = (z0 > z1) ? (z0) : (z1);
+
+        rs = Room_GetSectorRaw(room, pos);
+        for(int i = 0; rs && rs->portal_to_room && (i < 4); i++)
+        {
+            room = rs->portal_to_room->real_room;
+            Room_LongRayAddRoom(room, rooms, rooms_count, max_rooms);
+            rs = Room_GetSectorRaw(room, pos);
+        }
+        if(!rs || rs->portal_to_room)
+        {
+            *hit_room = room;
+            *fraction = t;
+            return 1;
+        }
+
+        low = rs;
+        low_room = room;
+        while(low->room_below && (z_min < Sector_LowestFloorZ(low)))
+        {
+            room_sector_p next = Room_GetSectorRaw(low->room_below->real_room, low->pos);
+            if(!next)
+            {
+                break;
+            }
+            low_room = low->room_below->real_room;
+            Room_LongRayAddRoom(low_room, rooms, rooms_count, max_rooms);
+            low = next;
+        }
+        high = rs;
+        while(high->room_above && (z_max > Sector_HighestCeilingZ(high)))
+        {
+            room_sector_p next = Room_GetSectorRaw(high->room_above->real_room, high->pos);
+            if(!next)
+            {
+                break;
+            }
+            Room_LongRayAddRoom(high->room_above->real_room, rooms, rooms_count, max_rooms);
+            high = next;
+        }
+
+        floor_z = Sector_LowestFloorZ(low);
+        ceiling_z = Sector_HighestCeilingZ(high);
+        if((low->floor == TR_METERING_WALLHEIGHT) || (high->ceiling == TR_METERING_WALLHEIGHT) ||
+           (z_min < floor_z) || (z_max > ceiling_z))
+        {
+            float t_hit = t;
+            if((low->floor != TR_METERING_WALLHEIGHT) && (high->ceiling != TR_METERING_WALLHEIGHT) && (z1 != z0))
+            {
+                float limit_z = (z1 < floor_z) ? (floor_z) : (ceiling_z);
+                if((z0 >= floor_z) && (z0 <= ceiling_z))
+                {
+                    t_hit = t + (t_exit - t) * (limit_z - z0) / (z1 - z0);
+                }
+            }
+            *hit_room = low_room;
+            *fraction = t_hit;
+            return 1;
+        }
+
+        /* the next cell starts from the room that contains ray exit point */
+        rs = low;
+        room = low_room;
+        while(rs->room_above && (z1 > Sector_HighestCeilingZ(rs)))
+        {
+            room_sector_p next = Room_GetSectorRaw(rs->room_above->real_room, rs->pos);
+            if(!next)
+            {
+                break;
+            }
+            room = rs->room_above->real_room;
+            rs = next;
+        }
+
+        if(t_exit >= 1.0f)
+        {
+            break;
+        }
+        t = t_exit;
+        if(t_next[0] < t_next[1])
+        {
+            cell[0] += step[0];
+            t_next[0] += t_delta[0];
+        }
+        else
+        {
+            cell[1] += step[1];
+            t_next[1] += t_delta[1];
+        }
+    }
+
+    *hit_room = room;
+    *fraction = 1.0f;
+    return 0;
+}
+
+
 /////////////////////////////////////////
-static bool Room_IsBoxForPath(room_box_p curr_box, room_box_p next_box, box_validition_options_p op)
+bool Room_IsBoxForPath(room_box_p curr_box, room_box_p next_box, box_validition_options_p op)
 {
     if(next_box && !next_box->is_blocked)
     {
@@ -817,6 +1061,17 @@ static bool Room_IsBoxForPath(room_box_p curr_box, room_box_p next_box, box_vali
 }
 
 
+void Room_SetBoxBlocked(room_box_p box, int value)
+{
+    if(box->is_blockable && (box->is_blocked != (value != 0)))
+    {
+        box->is_blocked = (value != 0);
+        Room_InvalidatePathCache();
+        Zones_UpdateBox(box);
+    }
+}
+
+
 int  Room_IsInBox(room_box_p box, float pos[3])
 {
     return (box->bb_min[0] <= pos[0]) && (pos[0] <= box->bb_max[0]) &&
@@ -824,6 +1079,122 @@ int  Room_IsInBox(room_box_p box, float pos[3])
 }
 
 
+static inline float Room_PathHeuristic(const float pos[3], room_box_p goal)
+{
+    float dx = (pos[0] < goal->bb_min[0]) ? (goal->bb_min[0] - pos[0]) : ((pos[0] > goal->bb_max[0]) ? (pos[0] - goal->bb_max[0]) : (0.0f));
+    float dy = (pos[1] < goal->bb_min[1]) ? (goal->bb_min[1] - pos[1]) : ((pos[1] > goal->bb_max[1]) ? (pos[1] - goal->bb_max[1]) : (0.0f));
+    return dx + dy;
+}
+
+
+static void Room_PathHeapPush(float f, uint32_t box)
+{
+    uint32_t i;
+    if(path_search.heap_count >= path_search.heap_size)
+    {
+        path_search.heap_size = (path_search.heap_size) ? (2 * path_search.heap_size) : (256);
+        path_search.heap = (path_node_p)realloc(path_search.heap, path_search.heap_size * sizeof(path_node_t));
+    }
+
+    i = path_search.heap_count++;
+    while(i > 0)
+    {
+        uint32_t parent = (i - 1) / 2;
+        if(path_search.heap[parent].f <= f)
+        {
+            break;
+        }
+        path_search.heap[i] = path_search.heap[parent];
+        i = parent;
+    }
+    path_search.heap[i].f = f;
+    path_search.heap[i].box = box;
+}
+
+
+static uint32_t Room_PathHeapPop()
+{
+    uint32_t ret = path_search.heap[0].box;
+    path_node_t last = path_search.heap[--path_search.heap_count];
+    uint32_t i = 0;
+
+    for(;;)
+    {
+        uint32_t child = 2 * i + 1;
+        if(child >= path_search.heap_count)
+        {
+            break;
+        }
+        if((child + 1 < path_search.heap_count) && (path_search.heap[child + 1].f < path_search.heap[child].f))
+        {
+            child++;
+        }
+        if(last.f <= path_search.heap[child].f)
+        {
+            break;
+        }
+        path_search.heap[i] = path_search.heap[child];
+        i = child;
+    }
+    if(path_search.heap_count > 0)
+    {
+        path_search.heap[i] = last;
+    }
+
+    return ret;
+}
+
+
+static void Room_PathSearchReserve(uint32_t boxes_count)
+{
+    if(path_search.boxes_count < boxes_count)
+    {
+        uint32_t words = (boxes_count + 31) / 32;
+        path_search.boxes_count = boxes_count;
+        path_search.weights = (float*)realloc(path_search.weights, boxes_count * sizeof(float));
+        path_search.parents = (room_box_p*)realloc(path_search.parents, boxes_count * sizeof(room_box_p));
+        path_search.open_bits = (uint32_t*)realloc(path_search.open_bits, words * sizeof(uint32_t));
+        path_search.closed_bits = (uint32_t*)realloc(path_search.closed_bits, words * sizeof(uint32_t));
+    }
+}
+
+
+void Room_ClearPathSearch()
+{
+    Room_InvalidatePathCache();
+    memset(&path_cache.stats, 0x00, sizeof(path_cache.stats));
+    free(path_search.weights);
+    free(path_search.parents);
+    free(path_search.open_bits);
+    free(path_search.closed_bits);
+    free(path_search.heap);
+    memset(&path_search, 0x00, sizeof(path_search));
+}
+
+
+static inline float Room_PathZonesHeuristic(box_zones_info_p zones, room_box_p box, room_box_p goal)
+{
+    if(zones->clusters_count)
+    {
+        uint16_t c1 = zones->clusters[box->id];
+        uint16_t c2 = zones->clusters[goal->id];
+        if((c1 != ZONES_NO_CLUSTER) && (c2 != ZONES_NO_CLUSTER))
+        {
+            return zones->distances[c1 * zones->clusters_count + c2];
+        }
+    }
+    return 0.0f;
+}
+
+
+/*
+ * A* over boxes: box is entered at the overlap centre with its parent, edge
+ * cost is XY manhattan distance between entry points, heuristic is maximum of
+ * manhattan distance to the goal box rectangle and clusters lower bound
+ * distance (both are admissible). The maximum is not consistent, so closed box
+ * is reopened, when a cheaper way to it is found. Unreachable goals are
+ * rejected by zones connectivity tables without search.
+ */
 int  Room_FindPath(room_box_p *path_buf, uint32_t max_boxes, room_sector_p from, room_sector_p to, box_validition_options_p op)
 {
     int ret = 0;
@@ -831,98 +1202,88 @@ int  Room_FindPath(room_box_p *path_buf, uint32_t max_boxes, room_sector_p from,
     {
         if(from->box->id != to->box->id)
         {
+            room_box_p goal = to->box;
+            uint32_t boxes_count = World_GetRoomBoxesCount();
+            uint32_t words = (boxes_count + 31) / 32;
             float pt_from[3], pt_to[3];
-            const int buf_size = sizeof(room_box_p) * max_boxes;
-            room_box_p *current_front = (room_box_p*)Sys_GetTempMem(3 * buf_size);
-            room_box_p *next_front = current_front + max_boxes;
-            room_box_p *parents = next_front + max_boxes;
-            int32_t *weights = (int32_t*)Sys_GetTempMem(max_boxes * sizeof(int32_t));
-            size_t current_front_size = 1;
-            size_t next_front_size = 0;
-
-            current_front[0] = from->box;
-            weights[current_front[0]->id] = 0;
-            memset(parents, 0x00, buf_size);
-
-            while(current_front_size > 0)
+            box_zones_info_t zones;
+
+            if(!Zones_IsBoxReachable(from->box, goal, op) || !Zones_GetInfo(op, &zones))
             {
-                for(size_t i = 0; i < current_front_size; ++i)
+                return 0;
+            }
+
+            Room_PathSearchReserve(boxes_count);
+            memset(path_search.open_bits, 0x00, words * sizeof(uint32_t));
+            memset(path_search.closed_bits, 0x00, words * sizeof(uint32_t));
+            path_search.heap_count = 0;
+
+            PATH_BIT_SET(path_search.open_bits, from->box->id);
+            path_search.weights[from->box->id] = 0.0f;
+            path_search.parents[from->box->id] = NULL;
+            Room_PathHeapPush(Room_PathHeuristic(from->pos, goal), from->box->id);
+
+            while(path_search.heap_count > 0)
+            {
+                uint32_t id = Room_PathHeapPop();
+                room_box_p current_box, parent;
+                box_overlap_p ov;
+
+                if(PATH_BIT_TEST(path_search.closed_bits, id))
                 {
-                    room_box_p current_box = current_front[i];
-                    box_overlap_p ov = current_box->overlaps;
-                    if(parents[current_box->id])
-                    {
-                        Room_GetOverlapCenter(parents[current_box->id], current_box, pt_from);
-                    }
-                    else
-                    {
-                        vec3_copy(pt_from, from->pos);
-                    }
+                    continue;                                                   // outdated heap entry
+                }
+                PATH_BIT_SET(path_search.closed_bits, id);
+                if(id == goal->id)
+                {
+                    break;
+                }
+
+                current_box = World_GetRoomBoxByID(id);
+                parent = path_search.parents[id];
+                if(parent)
+                {
+                    Room_GetOverlapCenter(parent, current_box, pt_from);
+                }
+                else
+                {
+                    vec3_copy(pt_from, from->pos);
+                }
 
-                    while(ov)
+                for(ov = current_box->overlaps; ov; ov++)
+                {
+                    room_box_p next_box = World_GetRoomBoxByID(ov->box);
+                    if(next_box && Room_IsBoxForPath(current_box, next_box, op))
                     {
-                        room_box_p next_box = World_GetRoomBoxByID(ov->box);
+                        float weight;
                         Room_GetOverlapCenter(current_box, next_box, pt_to);
-                        int32_t weight = (fabs(pt_to[0] - pt_from[0]) + fabs(pt_to[1] - pt_from[1]) + 1.0f) / TR_METERING_STEP;
-                        if((next_box->id != from->box->id) && Room_IsBoxForPath(current_box, next_box, op) &&
-                           (!parents[to->box->id] || (weights[current_box->id] + weight < weights[to->box->id])))
-                        {
-                            if(!parents[next_box->id])
-                            {
-                                next_front[next_front_size++] = next_box;
-                                parents[next_box->id] = current_box;
-                                weights[next_box->id] = weights[current_box->id] + weight;
-                            }
-                            else if(weights[next_box->id] > weights[current_box->id] + weight)
-                            {
-                                bool not_in_front = true;
-                                parents[next_box->id] = current_box;
-                                weights[next_box->id] = weights[current_box->id] + weight;
-                                for(size_t j = 0; j < next_front_size; ++j)
-                                {
-                                    if(next_front[j]->id == next_box->id)
-                                    {
-                                        not_in_front = false;
-                                        break;
-                                    }
-                                }
-
-                                if(not_in_front)
-                                {
-                                    next_front[next_front_size++] = next_box;
-                                }
-                            }
-                        }
-
-                        if(ov->end)
+                        weight = path_search.weights[id] + fabs(pt_to[0] - pt_from[0]) + fabs(pt_to[1] - pt_from[1]);
+                        if(!PATH_BIT_TEST(path_search.open_bits, next_box->id) || (weight < path_search.weights[next_box->id]))
                         {
-                            break;
+                            PATH_BIT_SET(path_search.open_bits, next_box->id);
+                            PATH_BIT_CLEAR(path_search.closed_bits, next_box->id);   // reopen
+                            path_search.weights[next_box->id] = weight;
+                            path_search.parents[next_box->id] = current_box;
+                            float h = Room_PathHeuristic(pt_to, goal);
+                            float hz = Room_PathZonesHeuristic(&zones, next_box, goal);
+                            Room_PathHeapPush(weight + ((hz > h) ? (hz) : (h)), next_box->id);
                         }
-                        ov++;
                     }
-                }
 
-                ///SWAP FRONTS HERE
-                {
-                    room_box_p *tn = current_front;
-                    current_front = next_front;
-                    current_front_size = next_front_size;
-                    next_front = tn;
-                    next_front_size = 0;
+                    if(ov->end)
+                    {
+                        break;
+                    }
                 }
             }
 
-            if(parents[to->box->id])
+            if(PATH_BIT_TEST(path_search.closed_bits, goal->id))
             {
-                room_box_p p = to->box;
-                while(p)
+                for(room_box_p p = goal; p && ((uint32_t)ret < max_boxes); p = path_search.parents[p->id])
                 {
                     path_buf[ret++] = p;
-                    p = parents[p->id];
                 }
             }
-
-            Sys_ReturnTempMem(3 * buf_size + max_boxes * sizeof(int32_t));
         }
         else
         {
@@ -935,6 +1296,190 @@ int  Room_FindPath(room_box_p *path_buf, uint32_t max_boxes, room_sector_p from,
 }
 
 
+static inline uint32_t Room_PathCacheOptions(box_validition_options_p op)
+{
+    return 0x00000001 | ((uint32_t)op->zone_type << 1) | ((uint32_t)op->zone_alt << 16);   // never 0
+}
+
+
+static inline int Room_PathCacheMatch(path_cache_entry_p e, uint32_t options, box_validition_options_p op)
+{
+    return (e->options == options) && (e->step_up == op->step_up) && (e->step_down == op->step_down);
+}
+
+
+static int Room_IsBoxesOverlapped(room_box_p b1, room_box_p b2)
+{
+    for(box_overlap_p ov = b1->overlaps; ov; ov++)
+    {
+        if(ov->box == b2->id)
+        {
+            return 1;
+        }
+        if(ov->end)
+        {
+            break;
+        }
+    }
+    return 0;
+}
+
+
+static int Room_PathCacheOut(room_box_p *path_buf, uint32_t max_boxes, path_cache_entry_p e, uint16_t first)
+{
+    int ret = 0;
+    e->last_use = ++path_cache.use_counter;
+    for(int i = e->count - 1; (i >= first) && ((uint32_t)ret < max_boxes); i--)
+    {
+        path_buf[ret++] = World_GetRoomBoxByID(e->boxes[i]);
+    }
+    return ret;
+}
+
+
+static path_cache_entry_p Room_PathCacheGetFree()
+{
+    path_cache_entry_p ret = path_cache.entries;
+    for(path_cache_entry_p e = path_cache.entries; e < path_cache.entries + PATH_CACHE_SIZE; e++)
+    {
+        if(!e->options)
+        {
+            return e;
+        }
+        if(e->last_use < ret->last_use)
+        {
+            ret = e;
+        }
+    }
+    return ret;
+}
+
+
+void Room_InvalidatePathCache()
+{
+    for(int i = 0; i < PATH_CACHE_SIZE; i++)
+    {
+        path_cache.entries[i].options = 0;
+    }
+    path_cache.stats.invalidations++;
+}
+
+
+void Room_SetPathCacheEnabled(int enabled)
+{
+    path_cache.enabled = enabled;
+    Room_InvalidatePathCache();
+}
+
+
+int  Room_IsPathCacheEnabled()
+{
+    return path_cache.enabled;
+}
+
+
+void Room_GetPathCacheStats(path_cache_stats_p stats)
+{
+    *stats = path_cache.stats;
+}
+
+
+/*
+ * Paths are shared by all AI with the same validation options. Start box
+ * may be any box of a cached path to the same goal (enemies that follow a
+ * path hit the cache on each next box). If goal moved to a box next to the
+ * cached one, path is repaired by one step instead of a new search.
+ * Entry point of start box is not a part of the key.
+ */
+int  Room_FindPathCached(room_box_p *path_buf, uint32_t max_boxes, room_sector_p from, room_sector_p to, box_validition_options_p op)
+{
+    uint32_t options;
+    path_cache_entry_p e;
+    int ret;
+
+    if(!path_cache.enabled || !from->box || !to->box || (from->box->id == to->box->id))
+    {
+        path_cache.stats.searches += (from->box && to->box && (from->box->id != to->box->id));
+        return Room_FindPath(path_buf, max_boxes, from, to, op);
+    }
+
+    options = Room_PathCacheOptions(op);
+    path_cache.stats.lookups++;
+    for(e = path_cache.entries; e < path_cache.entries + PATH_CACHE_SIZE; e++)
+    {
+        if(Room_PathCacheMatch(e, options, op) && (e->to_box == to->box->id))
+        {
+            for(uint16_t i = 0; i < e->count; i++)
+            {
+                if(e->boxes[i] == from->box->id)
+                {
+                    path_cache.stats.hits++;
+                    return Room_PathCacheOut(path_buf, max_boxes, e, i);
+                }
+            }
+        }
+    }
+
+    for(e = path_cache.entries; e < path_cache.entries + PATH_CACHE_SIZE; e++)
+    {
+        if(Room_PathCacheMatch(e, options, op) && (e->from_box == from->box->id))
+        {
+            room_box_p old_goal = World_GetRoomBoxByID(e->to_box);
+            if(Room_IsBoxesOverlapped(old_goal, to->box) && Room_IsBoxForPath(old_goal, to->box, op))
+            {
+                path_cache_entry_p repaired = Room_PathCacheGetFree();
+                uint16_t count = e->count;
+                for(uint16_t i = 1; i < e->count; i++)
+                {
+                    if(e->boxes[i] == to->box->id)
+                    {
+                        count = i;                                              // goal moved back along the path
+                        break;
+                    }
+                }
+                if((count == e->count) && (count >= PATH_CACHE_MAX_LENGTH))
+                {
+                    continue;
+                }
+                if(repaired != e)
+                {
+                    memcpy(repaired->boxes, e->boxes, count * sizeof(uint16_t));
+                }
+                repaired->boxes[count] = to->box->id;
+                repaired->count = count + 1;
+                repaired->options = options;
+                repaired->step_up = op->step_up;
+                repaired->step_down = op->step_down;
+                repaired->from_box = from->box->id;
+                repaired->to_box = to->box->id;
+                path_cache.stats.repairs++;
+                return Room_PathCacheOut(path_buf, max_boxes, repaired, 0);
+            }
+        }
+    }
+
+    path_cache.stats.searches++;
+    ret = Room_FindPath(path_buf, max_boxes, from, to, op);
+    if((ret > 0) && (ret <= PATH_CACHE_MAX_LENGTH))
+    {
+        e = Room_PathCacheGetFree();
+        e->options = options;
+        e->step_up = op->step_up;
+        e->step_down = op->step_down;
+        e->from_box = from->box->id;
+        e->to_box = to->box->id;
+        e->count = ret;
+        for(int i = 0; i < ret; i++)
+        {
+            e->boxes[i] = path_buf[ret - i - 1]->id;
+        }
+        e->last_use = ++path_cache.use_counter;
+    }
+
+    return ret;
+}
+
+
 void Room_GetOverlapCenter(room_box_p b1, room_box_p b2, float pos[3])
 {
     pos[0] = (b1->bb_min[0] > b2->bb_min[0]) ? (b1->bb_min[0]) : (b2->bb_min[0]);
@@ -161,6 +161,16 @@ typedef struct box_validition_options_s
 }box_validition_options_t, *box_validition_options_p;
 
 
+typedef struct path_cache_stats_s
+{
+    uint32_t                lookups;
+    uint32_t                hits;                                               // exact or start box on a cached path
+    uint32_t                repairs;                                            // goal moved to an adjacent box
+    uint32_t                searches;                                           // full A* searches
+    uint32_t                invalidations;
+}path_cache_stats_t, *path_cache_stats_p;
+
+
 typedef struct room_sector_s
 {
     uint32_t                    trig_index; // Trigger function index.
@@ -288,6 +298,8 @@ typedef struct room_s
     struct room_content_s      *original_content;
 
     struct engine_container_s  *self;
+    uint32_t                    grid_stamp;                                     // entity grid query rooms filter mark
+    uint32_t                    collision_stamp;                                // changes on height tests visible bodies moving in room
 }room_t, *room_p;
 
 
@@ -324,9 +336,18 @@ void Sector_LowestCeilingCorner(room_sector_p rs, float v[3]);
 
 int Sectors_SimilarFloor(room_sector_p s1, room_sector_p s2, int ignore_doors);
 int Sectors_SimilarCeiling(room_sector_p s1, room_sector_p s2, int ignore_doors);
+int Room_LongRayTest(struct room_s **hit_room, const float from[3], const float to[3], float *fraction, struct room_s **rooms, int *rooms_count, int max_rooms);
 
+void Room_SetBoxBlocked(room_box_p box, int value);
 int  Room_IsInBox(room_box_p box, float pos[3]);
+bool Room_IsBoxForPath(room_box_p curr_box, room_box_p next_box, box_validition_options_p op);
 int  Room_FindPath(room_box_p *path_buf, uint32_t max_boxes, room_sector_p from, room_sector_p to, box_validition_options_p op);
+void Room_ClearPathSearch();
+int  Room_FindPathCached(room_box_p *path_buf, uint32_t max_boxes, room_sector_p from, room_sector_p to, box_validition_options_p op);
+void Room_InvalidatePathCache();                                                // flips, boxes blocking
+void Room_SetPathCacheEnabled(int enabled);
+int  Room_IsPathCacheEnabled();
+void Room_GetPathCacheStats(path_cache_stats_p stats);
 void Room_GetOverlapCenter(room_box_p b1, room_box_p b2, float pos[3]);
 
 #endif //ROOM_H
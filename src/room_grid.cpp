@@ -0,0 +1,245 @@
+
+#include <stdlib.h>
+#include <math.h>
+#include <SDL2/SDL_atomic.h>
+
+#include "core/gl_util.h"
+#include "room.h"
+#include "room_grid.h"
+
+/*
+ * Rooms may be searched from the worker threads (characters probes prefetch),
+ * so current frame counters are atomic; they are moved to last_frame by
+ * RoomGrid_ResetStats on the main thread, when no jobs are running.
+ */
+typedef struct room_grid_counters_s
+{
+    SDL_atomic_t        queries;
+    SDL_atomic_t        candidates;
+    SDL_atomic_t        fallback_scans;
+}room_grid_counters_t;
+
+static struct
+{
+    int32_t             min_x;
+    int32_t             min_y;
+    int32_t             size_x;
+    int32_t             size_y;
+    uint32_t           *cells;                                                  // size_x * size_y + 1 offsets in entries
+    struct room_s     **entries;                                                // cells rooms lists
+    uint32_t            entries_count;
+    uint16_t            max_candidates;
+    room_grid_counters_t current;
+    room_grid_stats_t   last_frame;
+} room_grid = {0};
+
+
+static inline int32_t RoomGrid_Cell(float v)
+{
+    return (int32_t)floorf(v / ROOM_GRID_CELL_SIZE);
+}
+
+
+/*
+ * Cells, covered by room sectors or by room box (it is not bigger normally).
+ */
+static void RoomGrid_GetRoomCells(struct room_s *room, int32_t *x0, int32_t *x1, int32_t *y0, int32_t *y1)
+{
+    float min_x = room->transform[12 + 0];
+    float min_y = room->transform[12 + 1];
+    float max_x = min_x + room->sectors_x * ROOM_GRID_CELL_SIZE;
+    float max_y = min_y + room->sectors_y * ROOM_GRID_CELL_SIZE;
+
+    min_x = (room->bb_min[0] < min_x) ? (room->bb_min[0]) : (min_x);
+    min_y = (room->bb_min[1] < min_y) ? (room->bb_min[1]) : (min_y);
+    max_x = (room->bb_max[0] > max_x) ? (room->bb_max[0]) : (max_x);
+    max_y = (room->bb_max[1] > max_y) ? (room->bb_max[1]) : (max_y);
+
+    *x0 = RoomGrid_Cell(min_x);
+    *y0 = RoomGrid_Cell(min_y);
+    *x1 = RoomGrid_Cell(max_x);
+    *y1 = RoomGrid_Cell(max_y);
+    *x1 -= ((float)*x1 * ROOM_GRID_CELL_SIZE < max_x) ? (0) : (1);              // max bound is excluded
+    *y1 -= ((float)*y1 * ROOM_GRID_CELL_SIZE < max_y) ? (0) : (1);
+}
+
+
+void RoomGrid_Clear()
+{
+    free(room_grid.cells);
+    free(room_grid.entries);
+    room_grid.cells = NULL;
+    room_grid.entries = NULL;
+    room_grid.entries_count = 0;
+    room_grid.max_candidates = 0;
+    room_grid.min_x = 0;
+    room_grid.min_y = 0;
+    room_grid.size_x = 0;
+    room_grid.size_y = 0;
+}
+
+
+void RoomGrid_Build(struct room_s *rooms, uint32_t rooms_count)
+{
+    int32_t min_x = 0, min_y = 0, max_x = -1, max_y = -1;
+    uint32_t cells_count;
+
+    RoomGrid_Clear();
+    for(uint32_t i = 0; i < rooms_count; i++)
+    {
+        room_p r = rooms + i;
+        int32_t x0, x1, y0, y1;
+        if(r != r->real_room)
+        {
+            continue;
+        }
+        RoomGrid_GetRoomCells(r, &x0, &x1, &y0, &y1);
+        if(max_x < min_x)
+        {
+            min_x = x0;
+            min_y = y0;
+            max_x = x1;
+            max_y = y1;
+        }
+        min_x = (x0 < min_x) ? (x0) : (min_x);
+        min_y = (y0 < min_y) ? (y0) : (min_y);
+        max_x = (x1 > max_x) ? (x1) : (max_x);
+        max_y = (y1 > max_y) ? (y1) : (max_y);
+    }
+
+    if(max_x < min_x)
+    {
+        return;
+    }
+
+    room_grid.min_x = min_x;
+    room_grid.min_y = min_y;
+    room_grid.size_x = max_x - min_x + 1;
+    room_grid.size_y = max_y - min_y + 1;
+    cells_count = room_grid.size_x * room_grid.size_y;
+    room_grid.cells = (uint32_t*)calloc(cells_count + 1, sizeof(uint32_t));
+
+    // count candidates, then fill cells in rooms order
+    for(uint32_t i = 0; i < rooms_count; i++)
+    {
+        room_p r = rooms + i;
+        int32_t x0, x1, y0, y1;
+        if(r == r->real_room)
+        {
+            RoomGrid_GetRoomCells(r, &x0, &x1, &y0, &y1);
+            for(int32_t x = x0; x <= x1; x++)
+            {
+                for(int32_t y = y0; y <= y1; y++)
+                {
+                    room_grid.cells[(x - min_x) * room_grid.size_y + (y - min_y) + 1]++;
+                }
+            }
+        }
+    }
+    for(uint32_t i = 0; i < cells_count; i++)
+    {
+        uint16_t count = room_grid.cells[i + 1];
+        room_grid.max_candidates = (count > room_grid.max_candidates) ? (count) : (room_grid.max_candidates);
+        room_grid.cells[i + 1] += room_grid.cells[i];
+    }
+    room_grid.entries_count = room_grid.cells[cells_count];
+    room_grid.entries = (struct room_s**)malloc(room_grid.entries_count * sizeof(struct room_s*));
+
+    {
+        uint32_t *fill = (uint32_t*)malloc(cells_count * sizeof(uint32_t));
+        for(uint32_t i = 0; i < cells_count; i++)
+        {
+            fill[i] = room_grid.cells[i];
+        }
+        for(uint32_t i = 0; i < rooms_count; i++)
+        {
+            room_p r = rooms + i;
+            int32_t x0, x1, y0, y1;
+            if(r == r->real_room)
+            {
+                RoomGrid_GetRoomCells(r, &x0, &x1, &y0, &y1);
+                for(int32_t x = x0; x <= x1; x++)
+                {
+                    for(int32_t y = y0; y <= y1; y++)
+                    {
+                        uint32_t cell = (x - min_x) * room_grid.size_y + (y - min_y);
+                        room_grid.entries[fill[cell]++] = r;
+                    }
+                }
+            }
+        }
+        free(fill);
+    }
+}
+
+
+int RoomGrid_IsBuilt()
+{
+    return room_grid.cells != NULL;
+}
+
+
+static struct room_s **RoomGrid_GetCell(int32_t x, int32_t y, uint16_t *count)
+{
+    x -= room_grid.min_x;
+    y -= room_grid.min_y;
+    if(room_grid.cells && (x >= 0) && (x < room_grid.size_x) && (y >= 0) && (y < room_grid.size_y))
+    {
+        uint32_t *cell = room_grid.cells + x * room_grid.size_y + y;
+        *count = cell[1] - cell[0];
+        return room_grid.entries + cell[0];
+    }
+
+    *count = 0;
+    return NULL;
+}
+
+
+struct room_s *RoomGrid_FindRoom(float pos[3])
+{
+    const float z_margin = ROOM_GRID_CELL_SIZE / 2.0f;
+    uint16_t count;
+    struct room_s **entry = RoomGrid_GetCell(RoomGrid_Cell(pos[0]), RoomGrid_Cell(pos[1]), &count);
+    room_p ret = NULL;
+    int candidates = 0;                                                         // counted once per query, counters are shared with the worker threads
+
+    for(uint16_t i = 0; (i < count) && !ret; i++, entry++)
+    {
+        room_p r = *entry;
+        candidates++;
+        if((pos[0] >= r->bb_min[0]) && (pos[0] < r->bb_max[0]) &&
+           (pos[1] >= r->bb_min[1]) && (pos[1] < r->bb_max[1]) &&
+           (pos[2] >= r->bb_min[2] - z_margin) && (pos[2] < r->bb_max[2]))
+        {
+            room_sector_p orig_sector = Room_GetSectorRaw(r, pos);
+            ret = (orig_sector && orig_sector->portal_to_room) ? (orig_sector->portal_to_room->real_room) : (r);
+        }
+    }
+    SDL_AtomicAdd(&room_grid.current.queries, 1);
+    SDL_AtomicAdd(&room_grid.current.candidates, candidates);
+
+    return ret;
+}
+
+
+void RoomGrid_CountFallbackScan()
+{
+    SDL_AtomicAdd(&room_grid.current.fallback_scans, 1);
+}
+
+
+void RoomGrid_GetStats(room_grid_stats_p stats)
+{
+    *stats = room_grid.last_frame;
+    stats->cells = room_grid.size_x * room_grid.size_y;
+    stats->entries = room_grid.entries_count;
+    stats->max_candidates = room_grid.max_candidates;
+}
+
+
+void RoomGrid_ResetStats()
+{
+    room_grid.last_frame.queries = SDL_AtomicSet(&room_grid.current.queries, 0);
+    room_grid.last_frame.candidates = SDL_AtomicSet(&room_grid.current.candidates, 0);
+    room_grid.last_frame.fallback_scans = SDL_AtomicSet(&room_grid.current.fallback_scans, 0);
+}
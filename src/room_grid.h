@@ -0,0 +1,38 @@
+
+#ifndef ROOM_GRID_H
+#define ROOM_GRID_H
+
+/*
+ * Global rooms index: uniform XY grid of sector sized cells over the level,
+ * each cell keeps the real rooms, which sectors cover it (in rooms order, so
+ * the first matched room is the same as in the full rooms scan). Grid is built
+ * after level rooms are loaded; rooms flips swap only rooms content, so cells
+ * stay valid. Sectors columns are not cached: Sector_GetLowest / GetHighest
+ * chains are short and cheaper than a cell lookup.
+ */
+
+#include <stdint.h>
+
+#define ROOM_GRID_CELL_SIZE         (1024.0f)                                   // TR_METERING_SECTORSIZE
+
+struct room_s;
+
+typedef struct room_grid_stats_s
+{
+    uint32_t                cells;
+    uint32_t                entries;
+    uint16_t                max_candidates;                                     // the biggest cell rooms list
+    uint32_t                queries;
+    uint32_t                candidates;                                         // rooms tested by queries
+    uint32_t                fallback_scans;                                     // full rooms scans (grid is not built)
+}room_grid_stats_t, *room_grid_stats_p;
+
+void RoomGrid_Clear();
+void RoomGrid_Build(struct room_s *rooms, uint32_t rooms_count);
+int  RoomGrid_IsBuilt();
+struct room_s *RoomGrid_FindRoom(float pos[3]);                                 // the same as World_FindRoomByPos
+void RoomGrid_CountFallbackScan();
+void RoomGrid_GetStats(room_grid_stats_p stats);                                // last frame counters
+void RoomGrid_ResetStats();
+
+#endif //ROOM_GRID_H
@@ -0,0 +1,605 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL_timer.h>
+
+#include "core/system.h"
+#include "core/vmath.h"
+#include "room.h"
+#include "room_zones.h"
+#include "world.h"
+
+
+typedef struct zones_table_s
+{
+    uint32_t            options;                                                // 0 = empty table
+    uint16_t            step_up;
+    uint16_t            step_down;
+    uint32_t            last_use;
+    uint32_t            distances_valid;
+    uint16_t           *labels;
+    uint16_t           *clusters;
+    uint16_t            clusters_count;
+    float              *distances;
+}zones_table_t, *zones_table_p;
+
+typedef struct zones_gate_s
+{
+    uint16_t            from;
+    uint16_t            to;
+    float               rect[4];                                                // min x, min y, max x, max y
+}zones_gate_t, *zones_gate_p;
+
+typedef struct zones_heap_node_s
+{
+    float               dist;
+    uint32_t            gate;
+}zones_heap_node_t, *zones_heap_node_p;
+
+static struct
+{
+    uint32_t            boxes_count;
+    uint32_t            use_counter;
+    zones_stats_t       stats;
+    zones_table_t       tables[ZONES_TABLES_COUNT];
+} zones = {0};
+
+
+static inline uint32_t Zones_Options(box_validition_options_p op)
+{
+    return 0x00000001 | ((uint32_t)op->zone_type << 1) | ((uint32_t)op->zone_alt << 16);   // never 0
+}
+
+
+static inline int Zones_IsWeakEdge(room_box_p b1, room_box_p b2, box_validition_options_p op)
+{
+    return Room_IsBoxForPath(b1, b2, op) || Room_IsBoxForPath(b2, b1, op);
+}
+
+
+static uint16_t Zones_FindRoot(uint16_t *parents, uint16_t i)
+{
+    while(parents[i] != i)
+    {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+
+static void Zones_Union(uint16_t *parents, uint16_t i, uint16_t j)
+{
+    i = Zones_FindRoot(parents, i);
+    j = Zones_FindRoot(parents, j);
+    if(i != j)
+    {
+        // smaller root id wins, so label is the same for any edges order
+        if(i < j)
+        {
+            parents[j] = i;
+        }
+        else
+        {
+            parents[i] = j;
+        }
+    }
+}
+
+
+static float Zones_RectsGap(const float r1[4], const float r2[4])
+{
+    float dx = (r1[0] > r2[2]) ? (r1[0] - r2[2]) : ((r2[0] > r1[2]) ? (r2[0] - r1[2]) : (0.0f));
+    float dy = (r1[1] > r2[3]) ? (r1[1] - r2[3]) : ((r2[1] > r1[3]) ? (r2[1] - r1[3]) : (0.0f));
+    return dx + dy;
+}
+
+
+/*
+ * Relabels boxes with marked labels (or all boxes if mark is NULL).
+ */
+static void Zones_BuildLabels(zones_table_p t, box_validition_options_p op, const uint8_t *marked_labels)
+{
+    uint16_t *parents = t->labels;
+    uint8_t *members = NULL;
+
+    if(marked_labels)
+    {
+        members = (uint8_t*)malloc(zones.boxes_count);
+        for(uint32_t i = 0; i < zones.boxes_count; i++)
+        {
+            members[i] = marked_labels[parents[i]];
+        }
+    }
+
+    for(uint32_t i = 0; i < zones.boxes_count; i++)
+    {
+        if(!members || members[i])
+        {
+            parents[i] = i;
+        }
+    }
+
+    for(uint32_t i = 0; i < zones.boxes_count; i++)
+    {
+        room_box_p box = World_GetRoomBoxByID(i);
+        if(members && !members[i])
+        {
+            continue;
+        }
+        for(box_overlap_p ov = box->overlaps; ov; ov++)
+        {
+            room_box_p next_box = World_GetRoomBoxByID(ov->box);
+            if(next_box && (!members || members[next_box->id]) && Zones_IsWeakEdge(box, next_box, op))
+            {
+                Zones_Union(parents, i, next_box->id);
+            }
+            if(ov->end)
+            {
+                break;
+            }
+        }
+    }
+
+    for(uint32_t i = 0; i < zones.boxes_count; i++)
+    {
+        parents[i] = Zones_FindRoot(parents, i);
+    }
+    free(members);
+}
+
+
+static void Zones_BuildClusters(zones_table_p t, box_validition_options_p op)
+{
+    uint16_t *queue = (uint16_t*)malloc(zones.boxes_count * sizeof(uint16_t));
+    uint16_t *sizes = (uint16_t*)calloc(zones.boxes_count, sizeof(uint16_t));
+    uint32_t big_boxes = 0, cluster_size;
+
+    for(uint32_t i = 0; i < zones.boxes_count; i++)
+    {
+        sizes[t->labels[i]]++;
+    }
+    for(uint32_t i = 0; i < zones.boxes_count; i++)
+    {
+        big_boxes += (sizes[t->labels[i]] > 1);
+        t->clusters[i] = ZONES_NO_CLUSTER;
+    }
+    cluster_size = big_boxes / (ZONES_MAX_CLUSTERS / 2) + 1;
+    cluster_size = (cluster_size < ZONES_MIN_CLUSTER_SIZE) ? (ZONES_MIN_CLUSTER_SIZE) : (cluster_size);
+
+    t->clusters_count = 0;
+    for(uint32_t i = 0; i < zones.boxes_count; i++)
+    {
+        if((t->clusters[i] == ZONES_NO_CLUSTER) && (sizes[t->labels[i]] > 1))
+        {
+            uint32_t head = 0, tail = 0, count = 0;
+            if(t->clusters_count >= ZONES_MAX_CLUSTERS)
+            {
+                t->clusters_count = 0;                                          // too fragmented level, labels only
+                for(uint32_t j = 0; j < zones.boxes_count; j++)
+                {
+                    t->clusters[j] = ZONES_NO_CLUSTER;
+                }
+                break;
+            }
+
+            t->clusters[i] = t->clusters_count;
+            queue[tail++] = i;
+            count++;
+            while((head < tail) && (count < cluster_size))
+            {
+                room_box_p box = World_GetRoomBoxByID(queue[head++]);
+                for(box_overlap_p ov = box->overlaps; ov && (count < cluster_size); ov++)
+                {
+                    room_box_p next_box = World_GetRoomBoxByID(ov->box);
+                    if(next_box && (t->clusters[next_box->id] == ZONES_NO_CLUSTER) &&
+                       (t->labels[next_box->id] == t->labels[i]) && Zones_IsWeakEdge(box, next_box, op))
+                    {
+                        t->clusters[next_box->id] = t->clusters_count;
+                        queue[tail++] = next_box->id;
+                        count++;
+                    }
+                    if(ov->end)
+                    {
+                        break;
+                    }
+                }
+            }
+            t->clusters_count++;
+        }
+    }
+
+    free(sizes);
+    free(queue);
+}
+
+
+static void Zones_HeapPush(zones_heap_node_p heap, uint32_t *count, float dist, uint32_t gate)
+{
+    uint32_t i = (*count)++;
+    while(i > 0)
+    {
+        uint32_t parent = (i - 1) / 2;
+        if(heap[parent].dist <= dist)
+        {
+            break;
+        }
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i].dist = dist;
+    heap[i].gate = gate;
+}
+
+
+static zones_heap_node_t Zones_HeapPop(zones_heap_node_p heap, uint32_t *count)
+{
+    zones_heap_node_t ret = heap[0];
+    zones_heap_node_t last = heap[--(*count)];
+    uint32_t i = 0;
+
+    for(;;)
+    {
+        uint32_t child = 2 * i + 1;
+        if(child >= *count)
+        {
+            break;
+        }
+        if((child + 1 < *count) && (heap[child + 1].dist < heap[child].dist))
+        {
+            child++;
+        }
+        if(last.dist <= heap[child].dist)
+        {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    if(*count > 0)
+    {
+        heap[i] = last;
+    }
+
+    return ret;
+}
+
+
+/*
+ * Gate is a directed clusters pair with box step allowed from one to other;
+ * path crosses gates at boxes overlap centres, those are inside of clusters
+ * rectangles intersection. Cost of cluster crossing between two gates is not
+ * less than manhattan gap between gates rectangles, so Dijkstra over gates
+ * gives lower bound distances. Walk inside of start and goal clusters is
+ * counted as zero.
+ */
+static void Zones_BuildDistances(zones_table_p t, box_validition_options_p op)
+{
+    uint32_t n = t->clusters_count;
+    uint32_t gates_count = 0, gates_size = 0;
+    zones_gate_p gates = NULL;
+    uint32_t *first_gate;
+    float *rects, *gate_dist;
+    zones_heap_node_p heap;
+    uint32_t heap_size;
+
+    free(t->distances);
+    t->distances = NULL;
+    t->distances_valid = 1;
+    if(n == 0)
+    {
+        return;
+    }
+
+    rects = (float*)malloc(4 * n * sizeof(float));
+    for(uint32_t c = 0; c < n; c++)
+    {
+        rects[4 * c + 0] = rects[4 * c + 1] = 1.0e+30f;
+        rects[4 * c + 2] = rects[4 * c + 3] = -1.0e+30f;
+    }
+    for(uint32_t i = 0; i < zones.boxes_count; i++)
+    {
+        uint16_t c = t->clusters[i];
+        if(c != ZONES_NO_CLUSTER)
+        {
+            room_box_p box = World_GetRoomBoxByID(i);
+            float *r = rects + 4 * c;
+            r[0] = (box->bb_min[0] < r[0]) ? (box->bb_min[0]) : (r[0]);
+            r[1] = (box->bb_min[1] < r[1]) ? (box->bb_min[1]) : (r[1]);
+            r[2] = (box->bb_max[0] > r[2]) ? (box->bb_max[0]) : (r[2]);
+            r[3] = (box->bb_max[1] > r[3]) ? (box->bb_max[1]) : (r[3]);
+        }
+    }
+
+    // gates, grouped by source cluster
+    first_gate = (uint32_t*)calloc(n + 1, sizeof(uint32_t));
+    for(uint32_t c = 0; c < n; c++)
+    {
+        first_gate[c] = gates_count;
+        for(uint32_t i = 0; i < zones.boxes_count; i++)
+        {
+            room_box_p box;
+            if(t->clusters[i] != c)
+            {
+                continue;
+            }
+            box = World_GetRoomBoxByID(i);
+            for(box_overlap_p ov = box->overlaps; ov; ov++)
+            {
+                room_box_p next_box = World_GetRoomBoxByID(ov->box);
+                uint16_t nc = (next_box) ? (t->clusters[next_box->id]) : (ZONES_NO_CLUSTER);
+                if((nc != ZONES_NO_CLUSTER) && (nc != c) && Room_IsBoxForPath(box, next_box, op))
+                {
+                    uint32_t g = first_gate[c];
+                    for(; (g < gates_count) && (gates[g].to != nc); g++);
+                    if(g == gates_count)
+                    {
+                        const float *r1 = rects + 4 * c;
+                        const float *r2 = rects + 4 * nc;
+                        if(gates_count >= gates_size)
+                        {
+                            gates_size = (gates_size) ? (2 * gates_size) : (256);
+                            gates = (zones_gate_p)realloc(gates, gates_size * sizeof(zones_gate_t));
+                        }
+                        gates[g].from = c;
+                        gates[g].to = nc;
+                        gates[g].rect[0] = (r1[0] > r2[0]) ? (r1[0]) : (r2[0]);
+                        gates[g].rect[1] = (r1[1] > r2[1]) ? (r1[1]) : (r2[1]);
+                        gates[g].rect[2] = (r1[2] < r2[2]) ? (r1[2]) : (r2[2]);
+                        gates[g].rect[3] = (r1[3] < r2[3]) ? (r1[3]) : (r2[3]);
+                        gates_count++;
+                    }
+                }
+                if(ov->end)
+                {
+                    break;
+                }
+            }
+        }
+    }
+    first_gate[n] = gates_count;
+
+    t->distances = (float*)malloc(n * n * sizeof(float));
+    gate_dist = (float*)malloc((gates_count + 1) * sizeof(float));
+    heap_size = 4 * (gates_count + 1);
+    heap = (zones_heap_node_p)malloc(heap_size * sizeof(zones_heap_node_t));
+    for(uint32_t src = 0; src < n; src++)
+    {
+        float *row = t->distances + src * n;
+        uint32_t heap_count = 0;
+        for(uint32_t c = 0; c < n; c++)
+        {
+            row[c] = ZONES_INF_DISTANCE;
+        }
+        for(uint32_t g = 0; g < gates_count; g++)
+        {
+            gate_dist[g] = ZONES_INF_DISTANCE;
+        }
+        row[src] = 0.0f;
+
+        for(uint32_t g = first_gate[src]; g < first_gate[src + 1]; g++)
+        {
+            gate_dist[g] = 0.0f;
+            Zones_HeapPush(heap, &heap_count, 0.0f, g);
+        }
+        while(heap_count > 0)
+        {
+            zones_heap_node_t node = Zones_HeapPop(heap, &heap_count);
+            zones_gate_p in = gates + node.gate;
+            if(node.dist > gate_dist[node.gate])
+            {
+                continue;                                                       // outdated heap entry
+            }
+            if(node.dist < row[in->to])
+            {
+                row[in->to] = node.dist;
+            }
+            for(uint32_t g = first_gate[in->to]; g < first_gate[in->to + 1]; g++)
+            {
+                float d = node.dist + Zones_RectsGap(in->rect, gates[g].rect);
+                if(d < gate_dist[g])
+                {
+                    gate_dist[g] = d;
+                    if(heap_count >= heap_size)
+                    {
+                        heap_size *= 2;
+                        heap = (zones_heap_node_p)realloc(heap, heap_size * sizeof(zones_heap_node_t));
+                    }
+                    Zones_HeapPush(heap, &heap_count, d, g);
+                }
+            }
+        }
+    }
+
+    free(heap);
+    free(gate_dist);
+    free(first_gate);
+    free(gates);
+    free(rects);
+}
+
+
+static void Zones_FreeTable(zones_table_p t)
+{
+    free(t->labels);
+    free(t->clusters);
+    free(t->distances);
+    memset(t, 0x00, sizeof(zones_table_t));
+}
+
+
+static zones_table_p Zones_GetTable(box_validition_options_p op)
+{
+    uint32_t options = Zones_Options(op);
+    zones_table_p t = NULL;
+    uint64_t start;
+
+    if(zones.boxes_count != World_GetRoomBoxesCount())
+    {
+        Zones_Clear();
+        zones.boxes_count = World_GetRoomBoxesCount();
+    }
+    if(zones.boxes_count == 0)
+    {
+        return NULL;
+    }
+
+    for(zones_table_p p = zones.tables; p < zones.tables + ZONES_TABLES_COUNT; p++)
+    {
+        if((p->options == options) && (p->step_up == op->step_up) && (p->step_down == op->step_down))
+        {
+            p->last_use = ++zones.use_counter;
+            if(!p->distances_valid)
+            {
+                start = SDL_GetPerformanceCounter();
+                Zones_BuildClusters(p, op);
+                Zones_BuildDistances(p, op);
+                zones.stats.distances_builds++;
+                zones.stats.build_time += 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+            }
+            return p;
+        }
+    }
+
+    for(zones_table_p p = zones.tables; p < zones.tables + ZONES_TABLES_COUNT; p++)
+    {
+        if(!p->options)
+        {
+            t = p;
+            break;
+        }
+        if(!t || (p->last_use < t->last_use))
+        {
+            t = p;                                                              // least recently used
+        }
+    }
+
+    start = SDL_GetPerformanceCounter();
+    Zones_FreeTable(t);
+    t->options = options;
+    t->step_up = op->step_up;
+    t->step_down = op->step_down;
+    t->last_use = ++zones.use_counter;
+    t->labels = (uint16_t*)malloc(zones.boxes_count * sizeof(uint16_t));
+    t->clusters = (uint16_t*)malloc(zones.boxes_count * sizeof(uint16_t));
+    Zones_BuildLabels(t, op, NULL);
+    Zones_BuildClusters(t, op);
+    Zones_BuildDistances(t, op);
+    zones.stats.labels_builds++;
+    zones.stats.distances_builds++;
+    zones.stats.build_time += 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+
+    return t;
+}
+
+
+void Zones_Clear()
+{
+    for(int i = 0; i < ZONES_TABLES_COUNT; i++)
+    {
+        Zones_FreeTable(zones.tables + i);
+    }
+    zones.boxes_count = 0;
+    zones.use_counter = 0;
+    memset(&zones.stats, 0x00, sizeof(zones.stats));
+}
+
+
+int  Zones_GetInfo(struct box_validition_options_s *op, box_zones_info_p info)
+{
+    zones_table_p t = Zones_GetTable(op);
+    if(t)
+    {
+        info->labels = t->labels;
+        info->clusters = t->clusters;
+        info->distances = t->distances;
+        info->clusters_count = (t->distances) ? (t->clusters_count) : (0);
+        return 1;
+    }
+    return 0;
+}
+
+
+int  Zones_IsBoxReachable(struct room_box_s *from, struct room_box_s *to, struct box_validition_options_s *op)
+{
+    zones_table_p t = Zones_GetTable(op);
+    zones.stats.queries++;
+    if(t && (from != to))
+    {
+        uint16_t c1 = t->clusters[from->id];
+        uint16_t c2 = t->clusters[to->id];
+        if((t->labels[from->id] != t->labels[to->id]) ||
+           (t->distances && (c1 != ZONES_NO_CLUSTER) && (c2 != ZONES_NO_CLUSTER) &&
+            (t->distances[c1 * t->clusters_count + c2] >= ZONES_INF_DISTANCE)))
+        {
+            zones.stats.rejects++;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/*
+ * Box blocking changes edges to that box only: boxes of components of box
+ * and its neighbours are relabeled, other labels stay. Distances are rebuilt
+ * lazily on the next table use.
+ */
+void Zones_UpdateBox(struct room_box_s *box)
+{
+    uint8_t *marked = NULL;
+    for(zones_table_p t = zones.tables; t < zones.tables + ZONES_TABLES_COUNT; t++)
+    {
+        if(t->options)
+        {
+            box_validition_options_t op;
+            op.zone = 0;
+            op.zone_type = (t->options >> 1) & 0x7FFF;
+            op.zone_alt = (t->options >> 16) & 0x01;
+            op.step_up = t->step_up;
+            op.step_down = t->step_down;
+
+            if(!marked)
+            {
+                marked = (uint8_t*)malloc(zones.boxes_count);
+            }
+            memset(marked, 0x00, zones.boxes_count);
+            marked[t->labels[box->id]] = 0x01;
+            for(box_overlap_p ov = box->overlaps; ov; ov++)
+            {
+                room_box_p next_box = World_GetRoomBoxByID(ov->box);
+                if(next_box)
+                {
+                    marked[t->labels[next_box->id]] = 0x01;
+                }
+                if(ov->end)
+                {
+                    break;
+                }
+            }
+            Zones_BuildLabels(t, &op, marked);
+            t->distances_valid = 0;
+            zones.stats.relabels++;
+        }
+    }
+    free(marked);
+}
+
+
+void Zones_GetStats(zones_stats_p stats)
+{
+    *stats = zones.stats;
+    stats->tables = 0;
+    stats->clusters = 0;
+    stats->memory = 0;
+    for(zones_table_p t = zones.tables; t < zones.tables + ZONES_TABLES_COUNT; t++)
+    {
+        if(t->options)
+        {
+            stats->tables++;
+            stats->clusters += t->clusters_count;
+            stats->memory += 2 * zones.boxes_count * sizeof(uint16_t);
+            stats->memory += (t->distances) ? (t->clusters_count * t->clusters_count * sizeof(float)) : (0);
+        }
+    }
+}
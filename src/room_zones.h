@@ -0,0 +1,54 @@
+
+#ifndef ROOM_ZONES_H
+#define ROOM_ZONES_H
+
+/*
+ * Boxes connectivity tables, built on demand for each used set of box
+ * validation options (zone type, alternate zone, step up / down):
+ * - labels: weakly connected components (box is reachable from other in any
+ *   direction); different labels means path does not exist;
+ * - clusters: components are split on clusters of neighbour boxes, table of
+ *   directed lower bound distances between clusters is stored (manhattan gaps
+ *   between clusters gates along the best clusters chain). Infinite distance
+ *   means path does not exist, finite one is admissible A* heuristic.
+ */
+
+#include <stdint.h>
+
+#define ZONES_TABLES_COUNT          (8)
+#define ZONES_MAX_CLUSTERS          (256)
+#define ZONES_MIN_CLUSTER_SIZE      (16)
+#define ZONES_NO_CLUSTER            (0xFFFF)
+#define ZONES_INF_DISTANCE          (1.0e+30f)
+
+struct room_box_s;
+struct box_validition_options_s;
+
+typedef struct box_zones_info_s
+{
+    const uint16_t         *labels;                                             // per box
+    const uint16_t         *clusters;                                           // per box, ZONES_NO_CLUSTER for single box components
+    const float            *distances;                                          // clusters_count x clusters_count, from * count + to
+    uint16_t                clusters_count;
+}box_zones_info_t, *box_zones_info_p;
+
+typedef struct zones_stats_s
+{
+    uint32_t                tables;
+    uint32_t                labels_builds;
+    uint32_t                distances_builds;
+    uint32_t                relabels;                                           // incremental updates on boxes blocking
+    uint32_t                queries;
+    uint32_t                rejects;                                            // unreachable goals found without search
+    uint32_t                clusters;                                           // summary for all tables
+    uint32_t                memory;
+    float                   build_time;                                         // ms, summary for all builds
+}zones_stats_t, *zones_stats_p;
+
+void Zones_Clear();
+int  Zones_GetInfo(struct box_validition_options_s *op, box_zones_info_p info);
+int  Zones_IsBoxReachable(struct room_box_s *from, struct room_box_s *to, struct box_validition_options_s *op);
+void Zones_UpdateBox(struct room_box_s *box);                                   // box blocking was changed
+void Zones_GetStats(zones_stats_p stats);
+
+#endif //ROOM_ZONES_H
@@ -43,6 +43,8 @@ int Script_ParseRender(lua_State *lua, struct render_settings_s *rs);
 int Script_ParseAudio(lua_State *lua, struct audio_settings_s *as);
 int Script_ParseConsole(lua_State *lua, struct console_params_s *cp);
 int Script_ParseControls(lua_State *lua, struct control_settings_s *cs);
+int Script_ParsePhysics(lua_State *lua, struct physics_settings_s *ps);
+int Script_ParseAnimation(lua_State *lua, struct animation_settings_s *as);
 
 bool Script_GetOverridedSamplesInfo(lua_State *lua, int *num_samples, int *num_sounds, char *sample_name_mask);
 bool Script_GetOverridedSample(lua_State *lua, int sound_id, int *first_sample_number, int *samples_count);
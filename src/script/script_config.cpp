@@ -16,6 +16,8 @@ extern "C" {
 #include "../render/camera.h"
 #include "../render/render.h"
 #include "../audio/audio.h"
+#include "../physics/physics.h"
+#include "../skeletal_model.h"
 
 /*
  * Game structures parse
@@ -315,6 +317,82 @@ int Script_ParseConsole(lua_State *lua, struct console_params_s *cp)
     return -1;
 }
 
+int Script_ParsePhysics(lua_State *lua, struct physics_settings_s *ps)
+{
+    if(lua)
+    {
+        int top = lua_gettop(lua);
+
+        lua_getglobal(lua, "physics");
+        if(lua_istable(lua, -1))
+        {
+            lua_getfield(lua, -1, "threads");
+            ps->threads = (lua_isnumber(lua, -1)) ? (lua_tointeger(lua, -1)) : (ps->threads);
+            lua_pop(lua, 1);
+
+            lua_getfield(lua, -1, "ragdoll_linear_sleep");
+            ps->ragdoll_linear_sleep = (lua_isnumber(lua, -1)) ? (lua_tonumber(lua, -1)) : (ps->ragdoll_linear_sleep);
+            lua_pop(lua, 1);
+
+            lua_getfield(lua, -1, "ragdoll_angular_sleep");
+            ps->ragdoll_angular_sleep = (lua_isnumber(lua, -1)) ? (lua_tonumber(lua, -1)) : (ps->ragdoll_angular_sleep);
+            lua_pop(lua, 1);
+
+            lua_getfield(lua, -1, "ragdoll_settle_time");
+            ps->ragdoll_settle_time = (lua_isnumber(lua, -1)) ? (lua_tonumber(lua, -1)) : (ps->ragdoll_settle_time);
+            lua_pop(lua, 1);
+
+            lua_getfield(lua, -1, "ragdoll_bake");
+            ps->ragdoll_bake = (lua_isnumber(lua, -1)) ? (lua_tointeger(lua, -1) != 0) : (ps->ragdoll_bake);
+            lua_pop(lua, 1);
+
+            lua_getfield(lua, -1, "room_collision");
+            ps->room_collision = (lua_isnumber(lua, -1)) ? (lua_tointeger(lua, -1)) : (ps->room_collision);
+            lua_pop(lua, 1);
+
+            lua_getfield(lua, -1, "hair_lod");
+            ps->hair_lod = (lua_isnumber(lua, -1)) ? (lua_tointeger(lua, -1) != 0) : (ps->hair_lod);
+            lua_pop(lua, 1);
+
+            lua_getfield(lua, -1, "hair_lod_distance");
+            ps->hair_lod_distance = (lua_isnumber(lua, -1)) ? (lua_tonumber(lua, -1)) : (ps->hair_lod_distance);
+            lua_pop(lua, 1);
+
+            lua_getfield(lua, -1, "hair_lod_screen_size");
+            ps->hair_lod_screen_size = (lua_isnumber(lua, -1)) ? (lua_tonumber(lua, -1)) : (ps->hair_lod_screen_size);
+            lua_pop(lua, 1);
+        }
+
+        ps->threads = (ps->threads < 0) ? (0) : (ps->threads);
+
+        lua_settop(lua, top);
+        return 1;
+    }
+
+    return -1;
+}
+
+int Script_ParseAnimation(lua_State *lua, struct animation_settings_s *as)
+{
+    if(lua)
+    {
+        int top = lua_gettop(lua);
+
+        lua_getglobal(lua, "animation");
+        if(lua_istable(lua, -1))
+        {
+            lua_getfield(lua, -1, "compression");
+            as->compression = (lua_isnumber(lua, -1)) ? (lua_tointeger(lua, -1) != 0) : (as->compression);
+            lua_pop(lua, 1);
+        }
+
+        lua_settop(lua, top);
+        return 1;
+    }
+
+    return -1;
+}
+
 
 void Script_LuaRegisterConfigFuncs(lua_State *lua)
 {
@@ -390,6 +468,22 @@ void Script_ExportConfig(const char *path)
         fprintf(f, "    joy_look_deadzone = %d;\n", (int)control_settings.joy_look_deadzone);
         fprintf(f, "}\n\n");
 
+        fprintf(f, "physics =\n{\n");
+        fprintf(f, "    threads = %d;\n", (int)physics_settings.threads);
+        fprintf(f, "    ragdoll_linear_sleep = %.2f;\n", physics_settings.ragdoll_linear_sleep);
+        fprintf(f, "    ragdoll_angular_sleep = %.2f;\n", physics_settings.ragdoll_angular_sleep);
+        fprintf(f, "    ragdoll_settle_time = %.2f;\n", physics_settings.ragdoll_settle_time);
+        fprintf(f, "    ragdoll_bake = %d;\n", (int)physics_settings.ragdoll_bake);
+        fprintf(f, "    room_collision = %d;\n", (int)physics_settings.room_collision);
+        fprintf(f, "    hair_lod = %d;\n", (int)physics_settings.hair_lod);
+        fprintf(f, "    hair_lod_distance = %.2f;\n", physics_settings.hair_lod_distance);
+        fprintf(f, "    hair_lod_screen_size = %.3f;\n", physics_settings.hair_lod_screen_size);
+        fprintf(f, "}\n\n");
+
+        fprintf(f, "animation =\n{\n");
+        fprintf(f, "    compression = %d;\n", (int)animation_settings.compression);
+        fprintf(f, "}\n\n");
+
         {
             console_params_t cp = { 0 };
             Con_GetParams(&cp);
@@ -23,6 +23,7 @@ extern "C" {
 #include "../gui/gui_inventory.h"
 #include "../inventory.h"
 #include "../entity.h"
+#include "../entity_grid.h"
 #include "../world.h"
 #include "../engine.h"
 
@@ -332,6 +333,25 @@ int lua_EnableEntity(lua_State *lua)
 }
 
 
+int lua_WakeEntity(lua_State *lua)
+{
+    if(lua_gettop(lua) >= 1)
+    {
+        entity_p ent = World_GetEntityByID(lua_tointeger(lua, 1));
+        if(ent)
+        {
+            World_WakeEntity(ent, (lua_gettop(lua) >= 2) ? (lua_tonumber(lua, 2)) : (WORLD_ACTIVATION_WAKE_TIME));
+        }
+    }
+    else
+    {
+        Con_Warning("wakeEntity: expecting arguments (entity_id, (time))");
+    }
+
+    return 0;
+}
+
+
 int lua_DisableEntity(lua_State *lua)
 {
     if(lua_gettop(lua) >= 1)
@@ -470,6 +490,7 @@ int lua_SetEntityActivationOffset(lua_State *lua)
             {
                 ent->activation_point->offset[3] = lua_tonumber(lua, 5);
             }
+            EntityGrid_Update(ent);
         }
         else
         {
@@ -810,6 +831,7 @@ int lua_SetEntityAngles(lua_State *lua)
             ent->transform.angles[1] = lua_tonumber(lua, 3);
             ent->transform.angles[2] = lua_tonumber(lua, 4);
             Entity_UpdateTransform(ent);
+            Entity_UpdateRigidBody(ent, 1);
         }
         else
         {
@@ -2652,6 +2674,7 @@ void Script_LuaRegisterEntityFuncs(lua_State *lua)
     lua_register(lua, "entityMoveToTriggerActivationPoint", lua_EntityMoveToTriggerActivationPoint);
     lua_register(lua, "enableEntity", lua_EnableEntity);
     lua_register(lua, "disableEntity", lua_DisableEntity);
+    lua_register(lua, "wakeEntity", lua_WakeEntity);
 
     lua_register(lua, "activateEntity", lua_ActivateEntity);
     lua_register(lua, "deactivateEntity", lua_DeactivateEntity);
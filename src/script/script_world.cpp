@@ -312,6 +312,40 @@ int lua_GetSectorHeight(lua_State *lua)
 }
 
 
+int lua_LongRayTest(lua_State *lua)
+{
+    int top = lua_gettop(lua);
+
+    if(top >= 6)
+    {
+        int16_t filter = (top >= 7) ? (lua_tointeger(lua, 7)) : (COLLISION_FILTER_CHARACTER);
+        float from[3], to[3];
+        collision_result_t cs;
+
+        from[0] = lua_tonumber(lua, 1);
+        from[1] = lua_tonumber(lua, 2);
+        from[2] = lua_tonumber(lua, 3);
+        to[0] = lua_tonumber(lua, 4);
+        to[1] = lua_tonumber(lua, 5);
+        to[2] = lua_tonumber(lua, 6);
+
+        bool result = World_LongRayTest(&cs, from, to, NULL, filter);
+        lua_pushboolean(lua, result);
+        lua_pushnumber(lua, cs.fraction);
+        lua_pushnumber(lua, cs.point[0]);
+        lua_pushnumber(lua, cs.point[1]);
+        lua_pushnumber(lua, cs.point[2]);
+        return 5;
+    }
+    else
+    {
+        Con_Warning("longRayTest: expecting arguments (fx, fy, fz, tx, ty, tz, (filter))");
+    }
+
+    return 0;
+}
+
+
 int lua_SectorTriggerClear(lua_State *lua)
 {
     if(lua_gettop(lua) >= 3)
@@ -675,7 +709,7 @@ int lua_DeleteEntity(lua_State *lua)
     int top = lua_gettop(lua);
     if(top >= 1)
     {
-        World_DeleteEntity(lua_tointeger(lua, 1));
+        World_MarkEntityDeleted(lua_tointeger(lua, 1));
     }
     else
     {
@@ -938,9 +972,9 @@ int lua_SetBoxBlocked(lua_State *lua)
     if(lua_gettop(lua) == 2)
     {
         room_box_p box = World_GetRoomBoxByID(lua_tointeger(lua, 1));
-        if(box && box->is_blockable)
+        if(box)
         {
-            box->is_blocked = lua_toboolean(lua, 2);
+            Room_SetBoxBlocked(box, lua_toboolean(lua, 2));
         }
     }
     else
@@ -1227,6 +1261,7 @@ void Script_LuaRegisterWorldFuncs(lua_State *lua)
     lua_register(lua, "sameRoom", lua_SameRoom);
     lua_register(lua, "similarSector", lua_SimilarSector);
     lua_register(lua, "getSectorHeight", lua_GetSectorHeight);
+    lua_register(lua, "longRayTest", lua_LongRayTest);
     lua_register(lua, "sectorTriggerClear", lua_SectorTriggerClear);
     lua_register(lua, "sectorAddTrigger", lua_SectorAddTrigger);
     lua_register(lua, "sectorAddTriggerCommand", lua_SectorAddTriggerCommand);
@@ -7,12 +7,34 @@
 #include "core/vmath.h"
 #include "core/polygon.h"
 #include "core/obb.h"
+#include "core/pose_simd.h"
 #include "mesh.h"
 #include "skeletal_model.h"
 
 
 void SSBoneFrame_InitSSAnim(struct ss_animation_s *ss_anim, skeletal_model_p model, uint32_t anim_type_id);
 void Anim_Clear(struct animation_frame_s *anim);
+static void Anim_RebaseKeyframes(struct animation_frame_s *anim, void *old_base, void *new_base);
+static int  Anim_GetDispatchCase(struct animation_frame_s *anim, uint32_t id, int frame);
+
+#define ANIM_DATA_ALIGN(size) (((size) + 7) & ~((size_t)7))
+#define ANIM_DATA_REBASE(ptr, old_base, new_base) ((void*)((char*)(new_base) + ((char*)(ptr) - (char*)(old_base))))
+
+animation_settings_t animation_settings = {0};
+
+typedef struct palette_counters_s
+{
+    uint32_t    builds;
+    uint32_t    reuses;
+    uint32_t    mul_requested;                                                  // multiplications consumers would do without palette
+    uint32_t    mul_done;
+}palette_counters_t;
+
+static struct
+{
+    palette_counters_t  current;
+    palette_counters_t  last_frame;
+} palette_stats = {0};
 
 
 void SkeletalModel_Clear(skeletal_model_p model)
@@ -42,6 +64,13 @@ void SkeletalModel_Clear(skeletal_model_p model)
             free(model->animations);
             model->animations = NULL;
         }
+
+        if(model->anim_data)
+        {
+            free(model->anim_data);
+            model->anim_data = NULL;
+            model->anim_data_size = 0;
+        }
     }
 }
 
@@ -130,7 +159,17 @@ void SkeletalModel_CopyAnims(skeletal_model_p dst, skeletal_model_p src)
     animation_frame_p new_anims = (animation_frame_p)calloc(src->animation_count, sizeof(animation_frame_t));
     animation_frame_p dst_a = new_anims;
     animation_frame_p src_a = src->animations;
-    
+    void *old_anim_data = dst->anim_data;
+
+    /*
+     * keyframes block (float or compressed) is copied as is and rebased
+     */
+    dst->anim_data_size = src->anim_data_size;
+    dst->anim_data = malloc(src->anim_data_size);
+    memcpy(dst->anim_data, src->anim_data, src->anim_data_size);
+    dst->anim_rot_error = src->anim_rot_error;
+    dst->anim_offset_error = src->anim_offset_error;
+
     for(uint16_t i = 0; i < src->animation_count; ++i, ++dst_a, ++src_a)
     {
         animation_command_p *last_cmd = &dst_a->commands;
@@ -144,14 +183,11 @@ void SkeletalModel_CopyAnims(skeletal_model_p dst, skeletal_model_p src)
         }
 
         dst_a->frames_count = src_a->frames_count;
-        dst_a->frames = (bone_frame_p)calloc(src_a->frames_count, sizeof(bone_frame_t));
-        for(uint16_t i = 0; i < src_a->frames_count; ++i)
-        {
-            size_t sz = src_a->frames[i].bone_tag_count * sizeof(bone_tag_t);
-            dst_a->frames[i] = src_a->frames[i];
-            dst_a->frames[i].bone_tags = (bone_tag_p)malloc(sz);
-            memcpy(dst_a->frames[i].bone_tags, src_a->frames[i].bone_tags, sz);
-        }
+        dst_a->keyframes_count = src_a->keyframes_count;
+        dst_a->frame_rate = src_a->frame_rate;
+        dst_a->frames = src_a->frames;
+        dst_a->compressed = src_a->compressed;
+        Anim_RebaseKeyframes(dst_a, src->anim_data, dst->anim_data);
         
         dst_a->state_change_count = src_a->state_change_count;
         dst_a->state_change = (state_change_p)calloc(src_a->state_change_count, sizeof(state_change_t));
@@ -160,8 +196,11 @@ void SkeletalModel_CopyAnims(skeletal_model_p dst, skeletal_model_p src)
             size_t sz = src_a->state_change[i].anim_dispatch_count * sizeof(anim_dispatch_t);
             dst_a->state_change[i] = src_a->state_change[i];
             dst_a->state_change[i].anim_dispatch = (anim_dispatch_p)malloc(sz);
+            dst_a->state_change[i].ranges = NULL;
+            dst_a->state_change[i].dispatch_by_high = NULL;
             memcpy(dst_a->state_change[i].anim_dispatch, src_a->state_change[i].anim_dispatch, sz);
         }
+        Anim_BuildStateChangeLUT(dst_a);
         
         dst_a->id = src_a->id;
         dst_a->state_id = src_a->state_id;
@@ -183,11 +222,312 @@ void SkeletalModel_CopyAnims(skeletal_model_p dst, skeletal_model_p src)
         Anim_Clear(dst->animations + i);
     }
     free(dst->animations);
+    free(old_anim_data);
     dst->animations = new_anims;
     dst->animation_count = src->animation_count;
 }
 
 
+/*
+ * Keyframes of all model's animations are stored in one block:
+ * bone frames array followed by their bone tags.
+ */
+struct bone_frame_s *SkeletalModel_AllocAnimData(skeletal_model_p model, uint32_t keyframes_count)
+{
+    bone_frame_p frames;
+    bone_tag_p bone_tags;
+
+    model->anim_data_size = keyframes_count * (sizeof(bone_frame_t) + model->mesh_count * sizeof(bone_tag_t));
+    model->anim_data = calloc(1, model->anim_data_size);
+    frames = (bone_frame_p)model->anim_data;
+    bone_tags = (bone_tag_p)(frames + keyframes_count);
+    for(uint32_t i = 0; i < keyframes_count; i++)
+    {
+        frames[i].bone_tag_count = model->mesh_count;
+        frames[i].bone_tags = bone_tags + i * model->mesh_count;
+    }
+
+    return frames;
+}
+
+
+static void Quat_EncodeSmallestThree(uint16_t out[3], const float q[4])
+{
+    int largest = 0;
+    float sign, v[3];
+
+    for(int i = 1; i < 4; i++)
+    {
+        if(fabs(q[i]) > fabs(q[largest]))
+        {
+            largest = i;
+        }
+    }
+
+    // q and -q are the same rotation, so the largest component is always positive
+    sign = (q[largest] < 0.0f) ? (-1.0f) : (1.0f);
+    for(int i = 0, j = 0; i < 4; i++)
+    {
+        if(i != largest)
+        {
+            // other components are in [-1 / sqrt(2), 1 / sqrt(2)]
+            v[j] = 0.5f * (sign * q[i] * M_SQRT2 + 1.0f);
+            v[j] = (v[j] < 0.0f) ? (0.0f) : ((v[j] > 1.0f) ? (1.0f) : (v[j]));
+            j++;
+        }
+    }
+
+    // 15 + 15 + 16 bits of components, 2 bits of the largest component index
+    out[0] = (((uint16_t)(v[0] * 32767.0f + 0.5f)) << 1) | (largest & 0x01);
+    out[1] = (((uint16_t)(v[1] * 32767.0f + 0.5f)) << 1) | ((largest >> 1) & 0x01);
+    out[2] = (uint16_t)(v[2] * 65535.0f + 0.5f);
+}
+
+
+static void Quat_DecodeSmallestThree(float q[4], const uint16_t in[3])
+{
+    int largest = (in[0] & 0x01) | ((in[1] & 0x01) << 1);
+    float v[3], sq;
+
+    v[0] = (float)(in[0] >> 1) / 32767.0f;
+    v[1] = (float)(in[1] >> 1) / 32767.0f;
+    v[2] = (float)in[2] / 65535.0f;
+    sq = 1.0f;
+    for(int i = 0; i < 3; i++)
+    {
+        v[i] = (2.0f * v[i] - 1.0f) * M_SQRT1_2;
+        sq -= v[i] * v[i];
+    }
+
+    for(int i = 0, j = 0; i < 4; i++)
+    {
+        q[i] = (i == largest) ? (sqrtf((sq > 0.0f) ? (sq) : (0.0f))) : (v[j++]);
+    }
+}
+
+
+static int Anim_IsConstOffsetTrack(struct animation_frame_s *anim, uint16_t bone)
+{
+    const float *offset = anim->frames->bone_tags[bone].offset;
+    for(uint16_t i = 1; i < anim->keyframes_count; i++)
+    {
+        if(vec3_dist_sq(anim->frames[i].bone_tags[bone].offset, offset) != 0.0f)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+static void Anim_DecodeBoneTag(struct animation_frame_s *anim, int key, uint16_t bone, bone_tag_p btag)
+{
+    anim_compressed_p c = anim->compressed;
+    uint16_t bones_count = anim->frames->bone_tag_count;
+    uint16_t track = c->offset_track[bone];
+
+    Quat_DecodeSmallestThree(btag->qrotate, c->rotations + 3 * (key * bones_count + bone));
+    if(track == ANIM_CONST_OFFSET_TRACK)
+    {
+        vec3_copy(btag->offset, c->const_offsets + 3 * bone);
+    }
+    else
+    {
+        const uint16_t *q = c->offsets + 3 * (key * c->offset_tracks_count + track);
+        btag->offset[0] = c->offset_min[0] + c->offset_step[0] * (float)q[0];
+        btag->offset[1] = c->offset_min[1] + c->offset_step[1] * (float)q[1];
+        btag->offset[2] = c->offset_min[2] + c->offset_step[2] * (float)q[2];
+    }
+}
+
+
+static void Anim_RebaseKeyframes(struct animation_frame_s *anim, void *old_base, void *new_base)
+{
+    anim->frames = (bone_frame_p)ANIM_DATA_REBASE(anim->frames, old_base, new_base);
+    for(uint16_t i = 0; i < anim->keyframes_count; i++)
+    {
+        if(anim->frames[i].bone_tags)
+        {
+            anim->frames[i].bone_tags = (bone_tag_p)ANIM_DATA_REBASE(anim->frames[i].bone_tags, old_base, new_base);
+        }
+    }
+
+    if(anim->compressed)
+    {
+        anim_compressed_p c = (anim_compressed_p)ANIM_DATA_REBASE(anim->compressed, old_base, new_base);
+        anim->compressed = c;
+        c->offset_track = (uint16_t*)ANIM_DATA_REBASE(c->offset_track, old_base, new_base);
+        c->const_offsets = (float*)ANIM_DATA_REBASE(c->const_offsets, old_base, new_base);
+        c->offsets = (uint16_t*)ANIM_DATA_REBASE(c->offsets, old_base, new_base);
+        c->rotations = (uint16_t*)ANIM_DATA_REBASE(c->rotations, old_base, new_base);
+    }
+}
+
+/*
+ * Replaces float keyframes by compressed ones, block layout is:
+ * bone frames (without bone tags), compressed animations headers, then per
+ * animation constant offsets, offset track indexes, animated offsets and rotations.
+ * Max decoding error against float data is stored in model.
+ */
+int  SkeletalModel_CompressAnims(skeletal_model_p model)
+{
+    uint32_t keyframes_count = 0;
+    size_t size;
+    char *data, *ptr;
+    bone_frame_p frames;
+    anim_compressed_p compressed;
+    animation_frame_p anim;
+    uint16_t bones_count = model->mesh_count;
+
+    if(!model->anim_data || !model->animation_count || model->animations->compressed)
+    {
+        return 0;
+    }
+
+    for(uint16_t i = 0; i < model->animation_count; i++)
+    {
+        keyframes_count += model->animations[i].keyframes_count;
+    }
+    if(keyframes_count < 2)
+    {
+        return 0;                                                               // static models (skyboxes, etc.) have nothing to gain
+    }
+
+    size = ANIM_DATA_ALIGN(keyframes_count * sizeof(bone_frame_t));
+    size += ANIM_DATA_ALIGN(model->animation_count * sizeof(anim_compressed_t));
+    anim = model->animations;
+    for(uint16_t i = 0; i < model->animation_count; i++, anim++)
+    {
+        uint16_t tracks_count = 0;
+        for(uint16_t k = 0; k < bones_count; k++)
+        {
+            tracks_count += (Anim_IsConstOffsetTrack(anim, k)) ? (0) : (1);
+        }
+        size += ANIM_DATA_ALIGN(3 * bones_count * sizeof(float));
+        size += ANIM_DATA_ALIGN((bones_count + 3 * anim->keyframes_count * (tracks_count + bones_count)) * sizeof(uint16_t));
+    }
+
+    if(size >= model->anim_data_size)
+    {
+        return 0;
+    }
+
+    data = (char*)calloc(1, size);
+    frames = (bone_frame_p)data;
+    compressed = (anim_compressed_p)(data + ANIM_DATA_ALIGN(keyframes_count * sizeof(bone_frame_t)));
+    ptr = (char*)compressed + ANIM_DATA_ALIGN(model->animation_count * sizeof(anim_compressed_t));
+    anim = model->animations;
+    for(uint16_t i = 0; i < model->animation_count; i++, anim++)
+    {
+        anim_compressed_p c = compressed + i;
+        float offset_max[3];
+        int has_range = 0;
+
+        c->const_offsets = (float*)ptr;
+        ptr += ANIM_DATA_ALIGN(3 * bones_count * sizeof(float));
+        c->offset_track = (uint16_t*)ptr;
+        c->offset_tracks_count = 0;
+        for(uint16_t k = 0; k < bones_count; k++)
+        {
+            if(Anim_IsConstOffsetTrack(anim, k))
+            {
+                c->offset_track[k] = ANIM_CONST_OFFSET_TRACK;
+                vec3_copy(c->const_offsets + 3 * k, anim->frames->bone_tags[k].offset);
+                continue;
+            }
+
+            c->offset_track[k] = c->offset_tracks_count++;
+            for(uint16_t j = 0; j < anim->keyframes_count; j++)
+            {
+                const float *offset = anim->frames[j].bone_tags[k].offset;
+                if(!has_range)
+                {
+                    vec3_copy(c->offset_min, offset);
+                    vec3_copy(offset_max, offset);
+                    has_range = 1;
+                }
+                for(int l = 0; l < 3; l++)
+                {
+                    c->offset_min[l] = (offset[l] < c->offset_min[l]) ? (offset[l]) : (c->offset_min[l]);
+                    offset_max[l] = (offset[l] > offset_max[l]) ? (offset[l]) : (offset_max[l]);
+                }
+            }
+        }
+        for(int l = 0; l < 3; l++)
+        {
+            c->offset_step[l] = (has_range) ? ((offset_max[l] - c->offset_min[l]) / 65535.0f) : (0.0f);
+        }
+        c->offsets = c->offset_track + bones_count;
+        c->rotations = c->offsets + 3 * anim->keyframes_count * c->offset_tracks_count;
+        ptr += ANIM_DATA_ALIGN((bones_count + 3 * anim->keyframes_count * (c->offset_tracks_count + bones_count)) * sizeof(uint16_t));
+
+        for(uint16_t j = 0; j < anim->keyframes_count; j++)
+        {
+            bone_tag_p btag = anim->frames[j].bone_tags;
+            uint16_t *q = c->offsets + 3 * j * c->offset_tracks_count;
+            for(uint16_t k = 0; k < bones_count; k++, btag++)
+            {
+                Quat_EncodeSmallestThree(c->rotations + 3 * (j * bones_count + k), btag->qrotate);
+                if(c->offset_track[k] != ANIM_CONST_OFFSET_TRACK)
+                {
+                    for(int l = 0; l < 3; l++, q++)
+                    {
+                        *q = (c->offset_step[l] > 0.0f) ? ((uint16_t)((btag->offset[l] - c->offset_min[l]) / c->offset_step[l] + 0.5f)) : (0);
+                    }
+                }
+            }
+        }
+    }
+
+    /*
+     * error report against float keyframes
+     */
+    model->anim_rot_error = 0.0f;
+    model->anim_offset_error = 0.0f;
+    anim = model->animations;
+    for(uint16_t i = 0; i < model->animation_count; i++, anim++)
+    {
+        anim->compressed = compressed + i;
+        for(uint16_t j = 0; j < anim->keyframes_count; j++)
+        {
+            bone_tag_p btag = anim->frames[j].bone_tags;
+            for(uint16_t k = 0; k < bones_count; k++, btag++)
+            {
+                bone_tag_t decoded;
+                float d, t;
+                Anim_DecodeBoneTag(anim, j, k, &decoded);
+                d = fabs(vec4_dot(decoded.qrotate, btag->qrotate));
+                t = 360.0f * acosf((d < 1.0f) ? (d) : (1.0f)) / M_PI;
+                model->anim_rot_error = (t > model->anim_rot_error) ? (t) : (model->anim_rot_error);
+                t = vec3_dist(decoded.offset, btag->offset);
+                model->anim_offset_error = (t > model->anim_offset_error) ? (t) : (model->anim_offset_error);
+            }
+        }
+        anim->compressed = NULL;
+    }
+
+    /*
+     * swap blocks
+     */
+    anim = model->animations;
+    for(uint16_t i = 0; i < model->animation_count; i++, anim++)
+    {
+        for(uint16_t j = 0; j < anim->keyframes_count; j++, frames++)
+        {
+            *frames = anim->frames[j];
+            frames->bone_tags = NULL;
+        }
+        anim->frames = frames - anim->keyframes_count;
+        anim->compressed = compressed + i;
+    }
+    free(model->anim_data);
+    model->anim_data = data;
+    model->anim_data_size = size;
+
+    return 1;
+}
+
+
 void BoneFrame_Copy(bone_frame_p dst, const bone_frame_p src)
 {
     if(dst->bone_tag_count < src->bone_tag_count)
@@ -213,6 +553,9 @@ void SSBoneFrame_CreateFromModel(ss_bone_frame_p bf, skeletal_model_p model)
     bf->flags = 0x0000;
     bf->bone_tag_count = 0;
     bf->bone_tags = NULL;
+    bf->pose_stamp = 0;
+    bf->palette.pose_stamp = 0xFFFFFFFF;
+    bf->palette.matrices = NULL;
     
     SSBoneFrame_InitSSAnim(&bf->animations, model, ANIM_TYPE_BASE);
     bf->animations.model = model;
@@ -220,6 +563,7 @@ void SSBoneFrame_CreateFromModel(ss_bone_frame_p bf, skeletal_model_p model)
     {
         bf->bone_tag_count = model->mesh_count;
         bf->bone_tags = (ss_bone_tag_p)malloc(bf->bone_tag_count * sizeof(ss_bone_tag_t));
+        bf->palette.matrices = (float*)malloc(bf->bone_tag_count * 16 * sizeof(float));
         bf->bone_tags[0].parent = NULL;                                         // root
         for(uint16_t i = 0; i < bf->bone_tag_count; i++)
         {
@@ -277,11 +621,11 @@ void SSBoneFrame_InitSSAnim(struct ss_animation_s *ss_anim, skeletal_model_p mod
         size_t sz = model->mesh_count * sizeof(bone_tag_t);
         ss_anim->prev_bf.bone_tag_count = model->mesh_count;
         ss_anim->prev_bf.bone_tags = (bone_tag_p)malloc(sz);
-        BoneFrame_Copy(&ss_anim->prev_bf, model->animations->frames);
+        Anim_GetFrame(model->animations, 0, &ss_anim->prev_bf);
         
         ss_anim->current_bf.bone_tag_count = model->mesh_count;
         ss_anim->current_bf.bone_tags = (bone_tag_p)malloc(sz);
-        BoneFrame_Copy(&ss_anim->current_bf, model->animations->frames);
+        Anim_GetFrame(model->animations, 0, &ss_anim->current_bf);
     }
     
     ss_anim->model = model;
@@ -319,6 +663,13 @@ void SSBoneFrame_Clear(ss_bone_frame_p bf)
         bf->bone_tags = NULL;
     }
 
+    if(bf->palette.matrices)
+    {
+        free(bf->palette.matrices);
+        bf->palette.matrices = NULL;
+    }
+    bf->palette.pose_stamp = 0xFFFFFFFF;
+
     for(ss_animation_p ss_anim = bf->animations.next; ss_anim;)
     {
         ss_animation_p ss_anim_next = ss_anim->next;
@@ -425,57 +776,91 @@ void SSBoneFrame_UpdateChangeDirCommand(struct ss_bone_frame_s *bf)
 void SSBoneFrame_Update(struct ss_bone_frame_s *bf, float time)
 {
     float t = 1.0f - bf->animations.lerp;
-    ss_bone_tag_p btag = bf->bone_tags;
-    bone_tag_p src_btag, next_btag;
     bone_frame_p prev_bf = &bf->animations.prev_bf;
     bone_frame_p curr_bf = &bf->animations.current_bf;
-    
+    ss_bone_tag_p btag;
+    pose_batch_t batch;
+
     vec3_interpolate_macro(bf->bb_max, prev_bf->bb_max, curr_bf->bb_max, bf->animations.lerp, t);
     vec3_interpolate_macro(bf->bb_min, prev_bf->bb_min, curr_bf->bb_min, bf->animations.lerp, t);
     vec3_interpolate_macro(bf->centre, prev_bf->centre, curr_bf->centre, bf->animations.lerp, t);
     vec3_interpolate_macro(bf->pos, prev_bf->pos, curr_bf->pos, bf->animations.lerp, t);
-    
-    next_btag = curr_bf->bone_tags;
-    src_btag = prev_bf->bone_tags;
-    for(uint16_t k = 0; k < prev_bf->bone_tag_count; k++, btag++, src_btag++, next_btag++)
+
+    /*
+     * local transforms: bones are gathered to SoA batches and blended by SIMD kernel
+     */
+    batch.offset_lerp = bf->animations.lerp;
+    for(uint16_t base = 0; base < prev_bf->bone_tag_count; base += POSE_BATCH_SIZE)
     {
-        vec3_interpolate_macro(btag->offset, src_btag->offset, next_btag->offset, bf->animations.lerp, t);
-        vec3_copy(btag->local_transform + 12, btag->offset);
-        btag->local_transform[15] = 1.0f;
-        if(k == 0)
-        {
-            vec3_add(btag->local_transform + 12, btag->local_transform + 12, bf->pos);
-            vec4_slerp(btag->qrotate, src_btag->qrotate, next_btag->qrotate, bf->animations.lerp);
-        }
-        else
+        int count = prev_bf->bone_tag_count - base;
+        count = (count < POSE_BATCH_SIZE) ? (count) : (POSE_BATCH_SIZE);
+        for(int i = 0; i < count; i++)
         {
+            uint16_t k = base + i;
+            bone_tag_p src_btag = prev_bf->bone_tags + k;
+            bone_tag_p next_btag = curr_bf->bone_tags + k;
             bone_tag_p ov_src_btag = src_btag;
             bone_tag_p ov_next_btag = next_btag;
             float ov_lerp = bf->animations.lerp;
-            if(btag->alt_anim && btag->alt_anim->model && btag->alt_anim->enabled && (btag->alt_anim->model->mesh_tree[k].replace_anim != 0))
+
+            btag = bf->bone_tags + k;
+            if((k > 0) && btag->alt_anim && btag->alt_anim->model && btag->alt_anim->enabled && (btag->alt_anim->model->mesh_tree[k].replace_anim != 0))
             {
-                bone_frame_p ov_curr_bf = &btag->alt_anim->prev_bf;
-                bone_frame_p ov_next_bf = &btag->alt_anim->current_bf;
                 ov_lerp = btag->alt_anim->lerp;
-                ov_src_btag = ov_curr_bf->bone_tags + k;
-                ov_next_btag = ov_next_bf->bone_tags + k;
+                ov_src_btag = btag->alt_anim->prev_bf.bone_tags + k;
+                ov_next_btag = btag->alt_anim->current_bf.bone_tags + k;
+            }
+            for(int l = 0; l < 3; l++)
+            {
+                batch.offset0[l][i] = src_btag->offset[l];
+                batch.offset1[l][i] = next_btag->offset[l];
+            }
+            for(int l = 0; l < 4; l++)
+            {
+                batch.q0[l][i] = ov_src_btag->qrotate[l];
+                batch.q1[l][i] = ov_next_btag->qrotate[l];
+            }
+            batch.lerp[i] = ov_lerp;
+        }
+
+        Pose_BlendBatch(&batch, count);
+
+        for(int i = 0; i < count; i++)
+        {
+            float *m;
+            btag = bf->bone_tags + base + i;
+            m = btag->local_transform;
+            for(int l = 0; l < 3; l++)
+            {
+                btag->offset[l] = batch.offset[l][i];
+                m[l + 0] = batch.rot[l + 0][i];
+                m[l + 4] = batch.rot[l + 3][i];
+                m[l + 8] = batch.rot[l + 6][i];
+            }
+            for(int l = 0; l < 4; l++)
+            {
+                btag->qrotate[l] = batch.q[l][i];
             }
-            vec4_slerp(btag->qrotate, ov_src_btag->qrotate, ov_next_btag->qrotate, ov_lerp);
+            m[3] = m[7] = m[11] = 0.0f;
+            vec3_copy(m + 12, btag->offset);
+            m[15] = 1.0f;
         }
-        Mat4_set_qrotation(btag->local_transform, btag->qrotate);
     }
+    vec3_add(bf->bone_tags->local_transform + 12, bf->bone_tags->local_transform + 12, bf->pos);
 
     /*
-     * build absolute coordinate matrix system
+     * build absolute coordinate matrix system; parents are always placed
+     * before their children, so one pass in array order resolves hierarchy
      */
     btag = bf->bone_tags;
     Mat4_Copy(btag->current_transform, btag->local_transform);
     btag++;
     for(uint16_t k = 1; k < prev_bf->bone_tag_count; k++, btag++)
     {
-        Mat4_Mat4_mul(btag->current_transform, btag->parent->current_transform, btag->local_transform);
+        Pose_Mat4_mul(btag->current_transform, btag->parent->current_transform, btag->local_transform);
         SSBoneFrame_TargetBoneToSlerp(bf, btag, time);
     }
+    bf->pose_stamp++;
 }
 
 
@@ -500,6 +885,7 @@ void SSBoneFrame_RotateBone(struct ss_bone_frame_s *bf, const float q_rotate[4],
             Mat4_Copy(btag->current_transform, btag->local_transform);
         }
     }
+    bf->pose_stamp++;
 }
 
 
@@ -730,6 +1116,11 @@ void Anim_Clear(struct animation_frame_s *anim)
             anim->state_change[j].anim_dispatch_count = 0;
             free(anim->state_change[j].anim_dispatch);
             anim->state_change[j].anim_dispatch = NULL;
+            anim->state_change[j].ranges_count = 0;
+            free(anim->state_change[j].ranges);
+            anim->state_change[j].ranges = NULL;
+            free(anim->state_change[j].dispatch_by_high);
+            anim->state_change[j].dispatch_by_high = NULL;
             anim->state_change[j].id = 0;
         }
         anim->state_change_count = 0;
@@ -737,22 +1128,17 @@ void Anim_Clear(struct animation_frame_s *anim)
         anim->state_change = NULL;
     }
 
-    if(anim->frames_count)
-    {
-        for(uint16_t j = 0; j < anim->frames_count; j++)
-        {
-            if(anim->frames[j].bone_tag_count)
-            {
-                anim->frames[j].bone_tag_count = 0;
-                free(anim->frames[j].bone_tags);
-                anim->frames[j].bone_tags = NULL;
-            }
-        }
-        anim->frames_count = 0;
-        anim->max_frame = 0;
-        free(anim->frames);
-        anim->frames = NULL;
-    }
+    free(anim->state_change_lut);
+    anim->state_change_lut = NULL;
+    anim->state_change_lut_count = 0;
+    anim->state_change_lut_min = 0;
+
+    // keyframes are owned by model's anim_data
+    anim->frames_count = 0;
+    anim->keyframes_count = 0;
+    anim->max_frame = 0;
+    anim->frames = NULL;
+    anim->compressed = NULL;
 
     while(anim->commands)
     {
@@ -773,7 +1159,11 @@ void Anim_AddCommand(struct animation_frame_s *anim, const animation_command_p c
 }
 
 
-struct state_change_s *Anim_FindStateChangeByID(struct animation_frame_s *anim, uint32_t id)
+/*
+ * Linear versions of state change queries; used for animations without
+ * lookup tables and as reference in Anim_CheckStateChangeLUT.
+ */
+static state_change_p Anim_FindStateChangeByIDLinear(struct animation_frame_s *anim, uint32_t id)
 {
     state_change_p ret = anim->state_change;
     for(uint16_t i = 0; i < anim->state_change_count; i++, ret++)
@@ -788,11 +1178,26 @@ struct state_change_s *Anim_FindStateChangeByID(struct animation_frame_s *anim,
 }
 
 
-int Anim_GetAnimDispatchCase(struct ss_animation_s *ss_anim, uint32_t id)
+static int Anim_FindDispatchLinear(struct animation_frame_s *anim, struct state_change_s *stc, int current_frame, int new_frame)
 {
-    animation_frame_p anim = ss_anim->model->animations + ss_anim->prev_animation;
-    state_change_p stc = anim->state_change;
+    anim_dispatch_p disp = stc->anim_dispatch;
+    for(uint16_t i = 0; i < stc->anim_dispatch_count; i++, disp++)
+    {
+        if((anim->max_frame == 1) ||
+           ((new_frame >= disp->frame_low) && (new_frame <= disp->frame_high)) ||
+           ((current_frame <= disp->frame_high) && (new_frame >= disp->frame_high)))
+        {
+            return i;
+        }
+    }
 
+    return -1;
+}
+
+
+static int Anim_GetAnimDispatchCaseLinear(struct animation_frame_s *anim, uint32_t id, int frame)
+{
+    state_change_p stc = anim->state_change;
     for(uint16_t i = 0; i < anim->state_change_count; i++, stc++)
     {
         if(stc->id == id)
@@ -800,7 +1205,7 @@ int Anim_GetAnimDispatchCase(struct ss_animation_s *ss_anim, uint32_t id)
             anim_dispatch_p disp = stc->anim_dispatch;
             for(uint16_t j = 0; j < stc->anim_dispatch_count; j++, disp++)
             {
-                if((disp->frame_high >= disp->frame_low) && (ss_anim->prev_frame >= disp->frame_low) && (ss_anim->prev_frame <= disp->frame_high))
+                if((disp->frame_high >= disp->frame_low) && (frame >= disp->frame_low) && (frame <= disp->frame_high))
                 {
                     return (int)j;
                 }
@@ -812,6 +1217,265 @@ int Anim_GetAnimDispatchCase(struct ss_animation_s *ss_anim, uint32_t id)
 }
 
 
+static int StateChange_FindRange(struct state_change_s *stc, int frame)
+{
+    int low = 0;
+    int high = (int)stc->ranges_count - 1;
+    while(low <= high)
+    {
+        int mid = (low + high) / 2;
+        anim_dispatch_range_p range = stc->ranges + mid;
+        if(frame < range->frame_low)
+        {
+            high = mid - 1;
+        }
+        else if(frame > range->frame_high)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            return range->dispatch;
+        }
+    }
+
+    return -1;
+}
+
+
+static void StateChange_AddBound(uint32_t *bounds, uint16_t *bounds_count, uint32_t bound)
+{
+    uint16_t k = 0;
+    for(; (k < *bounds_count) && (bounds[k] < bound); k++);
+    if((k == *bounds_count) || (bounds[k] != bound))
+    {
+        memmove(bounds + k + 1, bounds + k, (*bounds_count - k) * sizeof(uint32_t));
+        bounds[k] = bound;
+        (*bounds_count)++;
+    }
+}
+
+
+static void StateChange_BuildRanges(struct state_change_s *stc)
+{
+    uint16_t count = stc->anim_dispatch_count;
+    uint32_t *bounds = (uint32_t*)malloc((2 * count + 1) * sizeof(uint32_t));
+    uint16_t bounds_count = 0;
+
+    stc->ranges_count = 0;
+    stc->ranges = (count) ? ((anim_dispatch_range_p)malloc(2 * count * sizeof(anim_dispatch_range_t))) : (NULL);
+    stc->dispatch_by_high = (count) ? ((uint16_t*)malloc(count * sizeof(uint16_t))) : (NULL);
+
+    // elementary intervals bounds, sorted and unique
+    for(uint16_t i = 0; i < count; i++)
+    {
+        anim_dispatch_p disp = stc->anim_dispatch + i;
+        if(disp->frame_high >= disp->frame_low)
+        {
+            StateChange_AddBound(bounds, &bounds_count, disp->frame_low);
+            StateChange_AddBound(bounds, &bounds_count, (uint32_t)disp->frame_high + 1);
+        }
+    }
+
+    for(uint16_t k = 0; k + 1 < bounds_count; k++)
+    {
+        uint32_t low = bounds[k];
+        uint32_t high = bounds[k + 1] - 1;
+        for(uint16_t i = 0; i < count; i++)
+        {
+            anim_dispatch_p disp = stc->anim_dispatch + i;
+            if((disp->frame_high >= disp->frame_low) && (disp->frame_low <= low) && (disp->frame_high >= high))
+            {
+                anim_dispatch_range_p prev = (stc->ranges_count > 0) ? (stc->ranges + stc->ranges_count - 1) : (NULL);
+                if(prev && (prev->dispatch == i) && ((uint32_t)prev->frame_high + 1 == low))
+                {
+                    prev->frame_high = high;
+                }
+                else
+                {
+                    anim_dispatch_range_p range = stc->ranges + stc->ranges_count++;
+                    range->frame_low = low;
+                    range->frame_high = high;
+                    range->dispatch = i;
+                    range->unused = 0;
+                }
+                break;
+            }
+        }
+    }
+    free(bounds);
+
+    // stable insertion sort by frame_high
+    for(uint16_t i = 0; i < count; i++)
+    {
+        uint16_t k = i;
+        for(; (k > 0) && (stc->anim_dispatch[stc->dispatch_by_high[k - 1]].frame_high > stc->anim_dispatch[i].frame_high); k--)
+        {
+            stc->dispatch_by_high[k] = stc->dispatch_by_high[k - 1];
+        }
+        stc->dispatch_by_high[k] = i;
+    }
+}
+
+
+void Anim_BuildStateChangeLUT(struct animation_frame_s *anim)
+{
+    uint16_t min_id = 0xFFFF, max_id = 0;
+
+    free(anim->state_change_lut);
+    anim->state_change_lut = NULL;
+    anim->state_change_lut_count = 0;
+    anim->state_change_lut_min = 0;
+
+    for(uint16_t i = 0; i < anim->state_change_count; i++)
+    {
+        state_change_p stc = anim->state_change + i;
+        free(stc->ranges);
+        free(stc->dispatch_by_high);
+        StateChange_BuildRanges(stc);
+        if(stc->id > 0x7FFF)
+        {
+            return;                                                             // out of table range, use linear search
+        }
+        min_id = (stc->id < min_id) ? (stc->id) : (min_id);
+        max_id = (stc->id > max_id) ? (stc->id) : (max_id);
+    }
+
+    if(anim->state_change_count > 0)
+    {
+        anim->state_change_lut_min = min_id;
+        anim->state_change_lut_count = max_id - min_id + 1;
+        anim->state_change_lut = (uint16_t*)malloc(anim->state_change_lut_count * sizeof(uint16_t));
+        for(uint16_t i = 0; i < anim->state_change_lut_count; i++)
+        {
+            anim->state_change_lut[i] = ANIM_STATE_CHANGE_NONE;
+        }
+        for(uint16_t i = 0; i < anim->state_change_count; i++)
+        {
+            uint16_t *entry = anim->state_change_lut + anim->state_change[i].id - min_id;
+            *entry = (*entry == ANIM_STATE_CHANGE_NONE) ? (i) : (*entry | ANIM_STATE_CHANGE_DUPLICATED);
+        }
+    }
+}
+
+/*
+ * Compares lookup tables with linear search for all states and frames
+ * (and frames steps up to 2), returns number of mismatches.
+ */
+uint32_t Anim_CheckStateChangeLUT(struct animation_frame_s *anim, uint32_t *checks_count)
+{
+    uint32_t mismatches = 0;
+    uint32_t max_id = anim->state_change_lut_min + anim->state_change_lut_count + 1;
+
+    for(uint32_t id = 0; id <= max_id; id++)
+    {
+        state_change_p stc = Anim_FindStateChangeByID(anim, id);
+        mismatches += (stc != Anim_FindStateChangeByIDLinear(anim, id)) ? (1) : (0);
+        (*checks_count)++;
+        for(int frame = 0; frame <= anim->max_frame; frame++)
+        {
+            mismatches += (Anim_GetDispatchCase(anim, id, frame) != Anim_GetAnimDispatchCaseLinear(anim, id, frame)) ? (1) : (0);
+            (*checks_count)++;
+
+            for(int step = 0; stc && (step <= 2); step++)
+            {
+                mismatches += (Anim_FindDispatch(anim, stc, frame, frame + step) != Anim_FindDispatchLinear(anim, stc, frame, frame + step)) ? (1) : (0);
+                (*checks_count)++;
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+
+struct state_change_s *Anim_FindStateChangeByID(struct animation_frame_s *anim, uint32_t id)
+{
+    if(anim->state_change_lut)
+    {
+        uint32_t i = id - anim->state_change_lut_min;
+        if((id >= anim->state_change_lut_min) && (i < anim->state_change_lut_count) && (anim->state_change_lut[i] != ANIM_STATE_CHANGE_NONE))
+        {
+            return anim->state_change + (anim->state_change_lut[i] & ~ANIM_STATE_CHANGE_DUPLICATED);
+        }
+        return NULL;
+    }
+
+    return Anim_FindStateChangeByIDLinear(anim, id);
+}
+
+/*
+ * Returns index of the first dispatch that switches animation on
+ * current_frame -> new_frame step, or -1.
+ */
+int  Anim_FindDispatch(struct animation_frame_s *anim, struct state_change_s *stc, int current_frame, int new_frame)
+{
+    int ret;
+
+    if(!stc->ranges && stc->anim_dispatch_count)
+    {
+        return Anim_FindDispatchLinear(anim, stc, current_frame, new_frame);
+    }
+    if((stc->anim_dispatch_count == 0) || (anim->max_frame == 1))
+    {
+        return (stc->anim_dispatch_count) ? (0) : (-1);
+    }
+
+    ret = StateChange_FindRange(stc, new_frame);
+
+    // frame_high is crossed by this step
+    if(current_frame <= new_frame)
+    {
+        int low = 0;
+        int high = stc->anim_dispatch_count;
+        while(low < high)
+        {
+            int mid = (low + high) / 2;
+            if(stc->anim_dispatch[stc->dispatch_by_high[mid]].frame_high < current_frame)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+        for(; (low < stc->anim_dispatch_count) && (stc->anim_dispatch[stc->dispatch_by_high[low]].frame_high <= new_frame); low++)
+        {
+            int i = stc->dispatch_by_high[low];
+            ret = ((ret < 0) || (i < ret)) ? (i) : (ret);
+        }
+    }
+
+    return ret;
+}
+
+
+static int Anim_GetDispatchCase(struct animation_frame_s *anim, uint32_t id, int frame)
+{
+    if(anim->state_change_lut)
+    {
+        uint32_t i = id - anim->state_change_lut_min;
+        if((id < anim->state_change_lut_min) || (i >= anim->state_change_lut_count) || (anim->state_change_lut[i] == ANIM_STATE_CHANGE_NONE))
+        {
+            return -1;
+        }
+        if(!(anim->state_change_lut[i] & ANIM_STATE_CHANGE_DUPLICATED))
+        {
+            return StateChange_FindRange(anim->state_change + anim->state_change_lut[i], frame);
+        }
+    }
+
+    return Anim_GetAnimDispatchCaseLinear(anim, id, frame);
+}
+
+
+int Anim_GetAnimDispatchCase(struct ss_animation_s *ss_anim, uint32_t id)
+{
+    return Anim_GetDispatchCase(ss_anim->model->animations + ss_anim->prev_animation, id, ss_anim->prev_frame);
+}
+
+
 void Anim_SetAnimation(struct ss_animation_s *ss_anim, int animation, int frame)
 {
     if(ss_anim && ss_anim->model && (animation < ss_anim->model->animation_count))
@@ -826,8 +1490,8 @@ void Anim_SetAnimation(struct ss_animation_s *ss_anim, int animation, int frame)
 
         ss_anim->target_state = -1;
         
-        BoneFrame_Copy(&ss_anim->current_bf, anim->frames + frame);
-        BoneFrame_Copy(&ss_anim->prev_bf, anim->frames + frame);
+        Anim_GetFrame(anim, frame, &ss_anim->current_bf);
+        Anim_GetFrame(anim, frame, &ss_anim->prev_bf);
         ss_anim->current_animation = animation;
         ss_anim->current_frame = frame;
         ss_anim->prev_animation = animation;
@@ -837,6 +1501,86 @@ void Anim_SetAnimation(struct ss_animation_s *ss_anim, int animation, int frame)
     }
 }
 
+/*
+ * One bone of the stored keyframe, for the users without bone frame (skybox).
+ */
+void Anim_GetKeyframeBoneTag(struct animation_frame_s *anim, int key, uint16_t bone, struct bone_tag_s *btag)
+{
+    if(anim->compressed)
+    {
+        Anim_DecodeBoneTag(anim, key, bone, btag);
+    }
+    else
+    {
+        *btag = anim->frames[key].bone_tags[bone];
+    }
+}
+
+/*
+ * Samples frame at 30 fps from keyframes, the same way as it was
+ * interpolated on level loading before. Compressed keyframes are decoded here.
+ */
+void Anim_GetFrame(struct animation_frame_s *anim, int frame, struct bone_frame_s *bf)
+{
+    int key = frame / anim->frame_rate;
+    int sub_frame = frame % anim->frame_rate;
+    bone_frame_p f0, f1;
+    float lerp, t;
+
+    if((sub_frame == 0) || (key + 1 >= anim->keyframes_count))
+    {
+        key = (key < anim->keyframes_count) ? (key) : (anim->keyframes_count - 1);
+        f0 = f1 = anim->frames + key;
+        lerp = 0.0f;
+        if(!anim->compressed)
+        {
+            BoneFrame_Copy(bf, f0);
+            return;
+        }
+    }
+    else
+    {
+        f0 = anim->frames + key;
+        f1 = f0 + 1;
+        lerp = (float)sub_frame / (float)anim->frame_rate;
+    }
+
+    t = 1.0f - lerp;
+    if(bf->bone_tag_count < f0->bone_tag_count)
+    {
+        bf->bone_tags = (bone_tag_p)realloc(bf->bone_tags, f0->bone_tag_count * sizeof(bone_tag_t));
+    }
+    bf->bone_tag_count = f0->bone_tag_count;
+
+    vec3_interpolate_macro(bf->centre, f0->centre, f1->centre, lerp, t);
+    vec3_interpolate_macro(bf->pos, f0->pos, f1->pos, lerp, t);
+    vec3_interpolate_macro(bf->bb_max, f0->bb_max, f1->bb_max, lerp, t);
+    vec3_interpolate_macro(bf->bb_min, f0->bb_min, f1->bb_min, lerp, t);
+    if(anim->compressed)
+    {
+        bone_tag_t b0, b1;
+        for(uint16_t k = 0; k < bf->bone_tag_count; k++)
+        {
+            Anim_DecodeBoneTag(anim, key, k, &b0);
+            if(f1 == f0)
+            {
+                bf->bone_tags[k] = b0;
+                continue;
+            }
+            Anim_DecodeBoneTag(anim, key + 1, k, &b1);
+            vec3_interpolate_macro(bf->bone_tags[k].offset, b0.offset, b1.offset, lerp, t);
+            vec4_slerp(bf->bone_tags[k].qrotate, b0.qrotate, b1.qrotate, lerp);
+        }
+        return;
+    }
+
+    for(uint16_t k = 0; k < bf->bone_tag_count; k++)
+    {
+        vec3_interpolate_macro(bf->bone_tags[k].offset, f0->bone_tags[k].offset, f1->bone_tags[k].offset, lerp, t);
+        vec4_slerp(bf->bone_tags[k].qrotate, f0->bone_tags[k].qrotate, f1->bone_tags[k].qrotate, lerp);
+    }
+}
+
 /*
  * Next frame and next anim calculation function.
  */
@@ -887,24 +1631,20 @@ int  Anim_SetNextFrame(struct ss_animation_s *ss_anim, float time)
      */
     if(stc)
     {
-        anim_dispatch_p disp = stc->anim_dispatch;
-        for(uint16_t i = 0; i < stc->anim_dispatch_count; i++, disp++)
+        int i = Anim_FindDispatch(current_anim, stc, ss_anim->current_frame, new_frame);
+        if(i >= 0)
         {
-            if((current_anim->max_frame == 1) ||
-               ((new_frame >= disp->frame_low) && (new_frame <= disp->frame_high)) ||
-               ((ss_anim->current_frame <= disp->frame_high) && (new_frame >= disp->frame_high)))
-            {
-                ss_anim->prev_animation = ss_anim->current_animation;
-                ss_anim->prev_frame = ss_anim->current_frame;
-                ss_anim->current_animation = disp->next_anim;
-                ss_anim->current_frame = disp->next_frame;
-                BoneFrame_Copy(&ss_anim->prev_bf, &ss_anim->current_bf);
-                BoneFrame_Copy(&ss_anim->current_bf, ss_anim->model->animations[ss_anim->current_animation].frames + ss_anim->current_frame);
-                ss_anim->frame_time = (float)ss_anim->current_frame * ss_anim->period + dt;
-                ss_anim->target_state = ss_anim->heavy_state ? ss_anim->target_state : -1;
-                ss_anim->frame_changing_state = 0x03;
-                return 0x03;
-            }
+            anim_dispatch_p disp = stc->anim_dispatch + i;
+            ss_anim->prev_animation = ss_anim->current_animation;
+            ss_anim->prev_frame = ss_anim->current_frame;
+            ss_anim->current_animation = disp->next_anim;
+            ss_anim->current_frame = disp->next_frame;
+            BoneFrame_Copy(&ss_anim->prev_bf, &ss_anim->current_bf);
+            Anim_GetFrame(ss_anim->model->animations + ss_anim->current_animation, ss_anim->current_frame, &ss_anim->current_bf);
+            ss_anim->frame_time = (float)ss_anim->current_frame * ss_anim->period + dt;
+            ss_anim->target_state = ss_anim->heavy_state ? ss_anim->target_state : -1;
+            ss_anim->frame_changing_state = 0x03;
+            return 0x03;
         }
     }
 
@@ -915,7 +1655,7 @@ int  Anim_SetNextFrame(struct ss_animation_s *ss_anim, float time)
         ss_anim->current_frame = current_anim->next_frame;
         ss_anim->current_animation = current_anim->next_anim->id;
         BoneFrame_Copy(&ss_anim->prev_bf, &ss_anim->current_bf);
-        BoneFrame_Copy(&ss_anim->current_bf, ss_anim->model->animations[ss_anim->current_animation].frames + ss_anim->current_frame);
+        Anim_GetFrame(ss_anim->model->animations + ss_anim->current_animation, ss_anim->current_frame, &ss_anim->current_bf);
         ss_anim->frame_time = (float)ss_anim->current_frame * ss_anim->period + dt;
         ss_anim->target_state = ss_anim->heavy_state ? ss_anim->target_state : -1;
         ss_anim->frame_changing_state = 0x02;
@@ -928,7 +1668,7 @@ int  Anim_SetNextFrame(struct ss_animation_s *ss_anim, float time)
         ss_anim->prev_frame = ss_anim->current_frame;
         ss_anim->current_frame = new_frame;
         BoneFrame_Copy(&ss_anim->prev_bf, &ss_anim->current_bf);
-        BoneFrame_Copy(&ss_anim->current_bf, ss_anim->model->animations[ss_anim->current_animation].frames + ss_anim->current_frame);
+        Anim_GetFrame(ss_anim->model->animations + ss_anim->current_animation, ss_anim->current_frame, &ss_anim->current_bf);
         ss_anim->frame_changing_state = 0x01;
         return 0x01;
     }
@@ -946,8 +1686,8 @@ int  Anim_IncTime(struct ss_animation_s *ss_anim, float time)
         ss_anim->prev_frame = 0;
         ss_anim->current_frame = 0;
         ss_anim->lerp = 0.0f;
-        BoneFrame_Copy(&ss_anim->current_bf, ss_anim->model->animations[ss_anim->current_animation].frames + ss_anim->current_frame);
-        BoneFrame_Copy(&ss_anim->prev_bf, ss_anim->model->animations[ss_anim->current_animation].frames + ss_anim->current_frame);
+        Anim_GetFrame(ss_anim->model->animations + ss_anim->current_animation, ss_anim->current_frame, &ss_anim->current_bf);
+        Anim_GetFrame(ss_anim->model->animations + ss_anim->current_animation, ss_anim->current_frame, &ss_anim->prev_bf);
         ss_anim->frame_changing_state = 0x02;
         return 2;
     }
@@ -963,15 +1703,15 @@ int  Anim_IncTime(struct ss_animation_s *ss_anim, float time)
         ss_anim->frame_time = (ss_anim->frame_time < 0.0f) ? (0.0f) : (ss_anim->frame_time);
         ss_anim->prev_frame = curr_anim->max_frame - 1;
         ss_anim->current_frame = curr_anim->max_frame - 1;
-        BoneFrame_Copy(&ss_anim->current_bf, ss_anim->model->animations[ss_anim->current_animation].frames + ss_anim->current_frame);
-        BoneFrame_Copy(&ss_anim->prev_bf, ss_anim->model->animations[ss_anim->current_animation].frames + ss_anim->prev_frame);
+        Anim_GetFrame(ss_anim->model->animations + ss_anim->current_animation, ss_anim->current_frame, &ss_anim->current_bf);
+        Anim_GetFrame(ss_anim->model->animations + ss_anim->current_animation, ss_anim->prev_frame, &ss_anim->prev_bf);
         ss_anim->lerp = 1.0f;
         ss_anim->frame_changing_state = 0x2;
         return 1;
     }
 
-    BoneFrame_Copy(&ss_anim->current_bf, ss_anim->model->animations[ss_anim->current_animation].frames + ss_anim->current_frame);
-    BoneFrame_Copy(&ss_anim->prev_bf, ss_anim->model->animations[ss_anim->current_animation].frames + ss_anim->prev_frame);
+    Anim_GetFrame(ss_anim->model->animations + ss_anim->current_animation, ss_anim->current_frame, &ss_anim->current_bf);
+    Anim_GetFrame(ss_anim->model->animations + ss_anim->current_animation, ss_anim->prev_frame, &ss_anim->prev_bf);
     
     float dt = ss_anim->frame_time - (float)ss_anim->prev_frame * ss_anim->period;
     ss_anim->lerp = dt / ss_anim->period;
@@ -1028,4 +1768,62 @@ void SSBoneFrame_FillSkinnedMeshMap(ss_bone_frame_p bf)
             }
         }
     }
-}
\ No newline at end of file
+}
+
+
+const float *SSBoneFrame_GetPalette(struct ss_bone_frame_s *bf)
+{
+    float *m = bf->palette.matrices;
+    if(!m)
+    {
+        return NULL;
+    }
+
+    palette_stats.current.mul_requested += bf->bone_tag_count;
+    if((bf->palette.pose_stamp == bf->pose_stamp) &&
+       (!bf->transform || !memcmp(bf->palette.transform, bf->transform->M4x4, sizeof(bf->palette.transform))))
+    {
+        palette_stats.current.reuses++;
+        return m;
+    }
+
+    palette_stats.current.builds++;
+    bf->palette.pose_stamp = bf->pose_stamp;
+    if(bf->transform)
+    {
+        Mat4_Copy(bf->palette.transform, bf->transform->M4x4);
+        for(uint16_t i = 0; i < bf->bone_tag_count; i++, m += 16)
+        {
+            Pose_Mat4_mul(m, bf->palette.transform, bf->bone_tags[i].current_transform);
+        }
+        palette_stats.current.mul_done += bf->bone_tag_count;
+    }
+    else
+    {
+        for(uint16_t i = 0; i < bf->bone_tag_count; i++, m += 16)
+        {
+            Mat4_Copy(m, bf->bone_tags[i].current_transform);
+        }
+    }
+
+    return bf->palette.matrices;
+}
+
+
+void SSBoneFrame_GetPaletteStats(uint32_t *builds, uint32_t *reuses, uint32_t *mul_requested, uint32_t *mul_done)
+{
+    *builds = palette_stats.last_frame.builds;
+    *reuses = palette_stats.last_frame.reuses;
+    *mul_requested = palette_stats.last_frame.mul_requested;
+    *mul_done = palette_stats.last_frame.mul_done;
+}
+
+
+void SSBoneFrame_ResetPaletteStats()
+{
+    palette_stats.last_frame = palette_stats.current;
+    palette_stats.current.builds = 0;
+    palette_stats.current.reuses = 0;
+    palette_stats.current.mul_requested = 0;
+    palette_stats.current.mul_done = 0;
+}
@@ -140,6 +140,13 @@ typedef struct ss_bone_frame_s
     float                       bb_max[3];                                      // bounding box max coordinates
     float                       centre[3];                                      // bounding box centre
     struct engine_transform_s  *transform;
+    uint32_t                    pose_stamp;                                     // changed each time when current_transform is rebuilt
+    struct
+    {
+        uint32_t                pose_stamp;                                     // pose the palette was built from
+        float                   transform[16];                                  // model transform the palette was built with
+        float                  *matrices;                                       // bone_tag_count world space bone matrices
+    }palette;
 
     struct ss_animation_s       animations;                                     // animations list
 }ss_bone_frame_t, *ss_bone_frame_p;
@@ -169,13 +176,31 @@ typedef struct anim_dispatch_s
     uint16_t    frame_high;                                                     // high border of state change condition
 }anim_dispatch_t, *anim_dispatch_p;
 
+/*
+ * precompiled dispatch search: disjoint frame ranges sorted by frame_low,
+ * each one keeps the first dispatch (in original order) that covers it.
+ */
+typedef struct anim_dispatch_range_s
+{
+    uint16_t    frame_low;
+    uint16_t    frame_high;
+    uint16_t    dispatch;
+    uint16_t    unused;
+}anim_dispatch_range_t, *anim_dispatch_range_p;
+
 typedef struct state_change_s
 {
-    uint32_t                    id;
-    uint16_t                    anim_dispatch_count;
-    struct anim_dispatch_s     *anim_dispatch;
+    uint32_t                        id;
+    uint16_t                        anim_dispatch_count;
+    uint16_t                        ranges_count;
+    struct anim_dispatch_s         *anim_dispatch;
+    struct anim_dispatch_range_s   *ranges;                                     // frame -> dispatch lookup
+    uint16_t                       *dispatch_by_high;                           // dispatch indexes sorted by frame_high
 }state_change_t, *state_change_p;
 
+#define ANIM_STATE_CHANGE_NONE          (0xFFFF)
+#define ANIM_STATE_CHANGE_DUPLICATED    (0x8000)                                // flag: animation has few state changes with that id
+
 typedef struct animation_command_s
 {
     uint16_t                    id;
@@ -186,6 +211,25 @@ typedef struct animation_command_s
     struct animation_command_s *next;
 }animation_command_t, *animation_command_p;
 
+/*
+ * compressed keyframes of one animation (optional, see SkeletalModel_CompressAnims):
+ * rotations are stored as smallest three 16 bit components, offsets that never
+ * change during animation are stored once, others are quantized in animation's range.
+ */
+#define ANIM_CONST_OFFSET_TRACK         (0xFFFF)
+
+typedef struct anim_compressed_s
+{
+    float                       offset_min[3];          // range of animated offsets
+    float                       offset_step[3];
+    uint16_t                    offset_tracks_count;    // number of animated offsets
+    uint16_t                    unused;
+    uint16_t                   *offset_track;           // per bone: ANIM_CONST_OFFSET_TRACK or animated offset index
+    float                      *const_offsets;          // per bone offsets for constant tracks
+    uint16_t                   *offsets;                // keyframes_count * offset_tracks_count * 3
+    uint16_t                   *rotations;              // keyframes_count * bone_tag_count * 3
+}anim_compressed_t, *anim_compressed_p;
+
 /*
  * one animation frame structure
  */
@@ -194,9 +238,15 @@ typedef struct animation_frame_s
     uint32_t                    id;
     uint16_t                    state_id;
     uint16_t                    max_frame;
-    uint16_t                    frames_count;           // Number of frames
+    uint16_t                    frames_count;           // Number of frames (30 fps)
     uint16_t                    state_change_count;     // Number of animation statechanges
-    struct bone_frame_s        *frames;                 // Frame data
+    uint16_t                    keyframes_count;        // Number of stored keyframes
+    uint16_t                    frame_rate;             // frames per keyframe, others are interpolated on sampling
+    uint16_t                    state_change_lut_min;   // state id of the first lookup table element
+    uint16_t                    state_change_lut_count;
+    uint16_t                   *state_change_lut;       // (state id - min) -> state change index or ANIM_STATE_CHANGE_NONE
+    struct bone_frame_s        *frames;                 // Keyframes data, placed in model's anim_data
+    struct anim_compressed_s   *compressed;             // if not NULL - frames have no bone tags
     struct state_change_s      *state_change;           // Animation statechanges data
     struct animation_command_s *commands;
     
@@ -224,6 +274,10 @@ typedef struct skeletal_model_s
 
     uint16_t                    animation_count;                                // number of animations
     struct animation_frame_s   *animations;                                     // animations data
+    uint32_t                    anim_data_size;                                 // keyframes block size in bytes
+    void                       *anim_data;                                      // all keyframes and bone tags in one block
+    float                       anim_rot_error;                                 // max compressed rotation error, degrees
+    float                       anim_offset_error;                              // max compressed offset error
 
     uint16_t                    mesh_count;                                     // number of model meshes
     struct mesh_tree_tag_s     *mesh_tree;                                      // base mesh tree.
@@ -231,12 +285,22 @@ typedef struct skeletal_model_s
 }skeletal_model_t, *skeletal_model_p;
 
 
+typedef struct animation_settings_s
+{
+    int8_t                      compression;                                    // store models keyframes compressed, applied on level loading
+}animation_settings_t, *animation_settings_p;
+
+extern animation_settings_t animation_settings;
+
+
 void SkeletalModel_Clear(skeletal_model_p model);
 void SkeletalModel_GenParentsIndexes(skeletal_model_p model);
 
 void SkeletalModel_FillTransparency(skeletal_model_p model);
 void SkeletalModel_CopyMeshes(mesh_tree_tag_p dst, mesh_tree_tag_p src, int tags_count);
 void SkeletalModel_CopyAnims(skeletal_model_p dst, skeletal_model_p src);
+struct bone_frame_s *SkeletalModel_AllocAnimData(skeletal_model_p model, uint32_t keyframes_count);
+int  SkeletalModel_CompressAnims(skeletal_model_p model);
 void BoneFrame_Copy(bone_frame_p dst, const bone_frame_p src);
 
 void SSBoneFrame_CreateFromModel(ss_bone_frame_p bf, skeletal_model_p model);
@@ -258,11 +322,24 @@ void SSBoneFrame_EnableOverrideAnim(struct ss_bone_frame_s *bf, struct ss_animat
 void SSBoneFrame_DisableOverrideAnimByType(struct ss_bone_frame_s *bf, uint16_t anim_type);
 void SSBoneFrame_DisableOverrideAnim(struct ss_bone_frame_s *bf, struct ss_animation_s *ss_anim);
 void SSBoneFrame_FillSkinnedMeshMap(ss_bone_frame_p model);
+/*
+ * Bone palette: transform * current_transform for every bone. It is built
+ * once per pose / model transform pair and shared read only by all consumers
+ * (ghosts, rigid bodies, renderer). Not thread safe: call it from main thread.
+ */
+const float *SSBoneFrame_GetPalette(struct ss_bone_frame_s *bf);
+void SSBoneFrame_GetPaletteStats(uint32_t *builds, uint32_t *reuses, uint32_t *mul_requested, uint32_t *mul_done);   // last frame counters
+void SSBoneFrame_ResetPaletteStats();                                           // call once per frame
 
 void Anim_AddCommand(struct animation_frame_s *anim, const animation_command_p command);
+void Anim_BuildStateChangeLUT(struct animation_frame_s *anim);
+uint32_t Anim_CheckStateChangeLUT(struct animation_frame_s *anim, uint32_t *checks_count);
 struct state_change_s *Anim_FindStateChangeByID(struct animation_frame_s *anim, uint32_t id);
+int  Anim_FindDispatch(struct animation_frame_s *anim, struct state_change_s *stc, int current_frame, int new_frame);
 int  Anim_GetAnimDispatchCase(struct ss_animation_s *ss_anim, uint32_t id);
 void Anim_SetAnimation(struct ss_animation_s *ss_anim, int animation, int frame);
+void Anim_GetFrame(struct animation_frame_s *anim, int frame, struct bone_frame_s *bf);
+void Anim_GetKeyframeBoneTag(struct animation_frame_s *anim, int key, uint16_t bone, struct bone_tag_s *btag);
 
 int  Anim_SetNextFrame(struct ss_animation_s *ss_anim, float time);
 int  Anim_IncTime(struct ss_animation_s *ss_anim, float time);
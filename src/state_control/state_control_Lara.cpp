@@ -228,2945 +228,3418 @@ static bool StateControl_LaraCanUseWeapon(struct entity_s *ent, int weapon_model
     }
 }
 
-int StateControl_Lara(struct entity_s *ent, struct ss_animation_s *ss_anim)
+/*
+ * Lara's states are dispatched through the handlers table, indexed by state id.
+ * Values, shared by handlers, are evaluated once per frame and passed to handler
+ * in the environment structure. Environment probes are cached by character
+ * controller, so the same probe in different states checks is done once.
+ */
+#define LARA_STATES_COUNT           (TR_STATE_LARA_PICKUP_FROM_CHEST + 1)
+
+typedef struct lara_env_s
 {
-    int i;
-    character_state_p state = &ent->character->state;
-    character_command_p cmd = &ent->character->cmd;
-    int clean_action = (cmd->action && (!state->weapon_ready));
-    float t, *pos = ent->transform.M4x4 + 12;
-    float global_offset[3], move[3], climb_from[3], climb_to[3], reaction[3];
-    height_info_t next_fc, *curr_fc;
-    climb_info_t *climb = &ent->character->climb;
-    curr_fc = &ent->character->height_info;
-    next_fc.self = ent->self;
-    ent->no_fix_skeletal_parts = BODY_PART_LEGS_2 | BODY_PART_LEGS_3 | BODY_PART_HANDS_3;
-    ent->character->rotate_speed_mult = 1.0f;
+    character_state_p           state;
+    character_command_p         cmd;
+    height_info_p               curr_fc;
+    climb_info_p                climb;
+    int                         clean_action;
+    int8_t                      low_vertical_space;
+    int8_t                      is_last_frame;
+    uint16_t                    current_state;
+}lara_env_t, *lara_env_p;
 
-    ss_anim->anim_frame_flags = ANIM_NORMAL_CONTROL;
+typedef void (*lara_state_handler_t)(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env);
 
-    int8_t low_vertical_space = (curr_fc->floor_hit.hit && curr_fc->ceiling_hit.hit && (curr_fc->ceiling_hit.point[2] - curr_fc->floor_hit.point[2] < ent->character->height - LARA_HANG_VERTICAL_EPSILON));
-    int8_t is_last_frame = ss_anim->model->animations[ss_anim->prev_animation].max_frame <= ss_anim->prev_frame + 1;
-    uint16_t current_state = Anim_GetCurrentState(ss_anim);
 
-    state->ragdoll = 0x00;
-    state->sprint = 0x00;
-    state->crouch = 0x00;
-    state->tightrope = (current_state >= TR_STATE_LARA_TIGHTROPE_IDLE) && (current_state <= TR_STATE_LARA_TIGHTROPE_EXIT);
+static void StateControl_LaraNoControl(struct entity_s * /*ent*/, struct ss_animation_s * /*ss_anim*/, lara_env_p /*env*/)
+{
+    // state has no own control, but it must not be processed as intermediate one
+}
 
-    if(ent->character->state.weapon_ready && !StateControl_LaraCanUseWeapon(ent, ent->character->weapon_id))
+
+/*
+ * Base onfloor animations
+ */
+static void StateControl_LaraDeath(struct entity_s *ent, struct ss_animation_s * /*ss_anim*/, lara_env_p env)
+{
+    character_state_p state = env->state;
+    int8_t is_last_frame = env->is_last_frame;
+
+    state->dead = 0x02;
+    if(is_last_frame && !(ent->type_flags & ENTITY_TYPE_DYNAMIC))
     {
-        state->weapon_ready = 0x00;
+        state->ragdoll = 0x01;
     }
+}
+
+static void StateControl_LaraStop(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    climb_info_p climb = env->climb;
+    int clean_action = env->clean_action;
+    int8_t low_vertical_space = env->low_vertical_space;
+    int i;
+    float t, *pos = ent->transform.M4x4 + 12;
+    float global_offset[3], move[3], climb_from[3], climb_to[3], reaction[3];
+    height_info_t next_fc;
+    next_fc.self = ent->self;
 
-    switch(current_state)
+    // Reset directional flag only on intermediate animation!
+    ent->no_fix_skeletal_parts |= BODY_PART_HANDS_2;
+    if(ss_anim->prev_animation == TR_ANIMATION_LARA_STAY_SOLID)
     {
-        /*
-         * Base onfloor animations
-         */
-        case TR_STATE_LARA_DEATH:
-            state->dead = 0x02;
-            if(is_last_frame && !(ent->type_flags & ENTITY_TYPE_DYNAMIC))
-            {
-                state->ragdoll = 0x01;
-            }
-            break;
+        ent->dir_flag = ENT_STAY;
+    }
 
-        case TR_STATE_LARA_STOP:
-            // Reset directional flag only on intermediate animation!
-            ent->no_fix_skeletal_parts |= BODY_PART_HANDS_2;
-            if(ss_anim->prev_animation == TR_ANIMATION_LARA_STAY_SOLID)
-            {
-                ent->dir_flag = ENT_STAY;
-            }
+    cmd->rot[0] = 0;
+    cmd->crouch |= low_vertical_space;
+    Character_Lean(ent, cmd, 0.0f);
 
-            cmd->rot[0] = 0;
-            cmd->crouch |= low_vertical_space;
-            Character_Lean(ent, cmd, 0.0f);
+    if( (climb->can_hang &&
+        (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON) &&
+        (ent->move_type == MOVE_CLIMBING)) ||
+        (ss_anim->prev_animation == TR_ANIMATION_LARA_STAY_SOLID) )
+    {
+        ent->move_type = MOVE_ON_FLOOR;
+        ent->no_move = 0x00;
+        state->wall_collide = 0x00;
+    }
 
-            if( (climb->can_hang &&
-                (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON) &&
-                (ent->move_type == MOVE_CLIMBING)) ||
-                (ss_anim->prev_animation == TR_ANIMATION_LARA_STAY_SOLID) )
+    if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
+        ent->dir_flag = ENT_STAY;
+    }
+    else if(state->dead == 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_DEATH;
+    }
+    else if(state->slide == CHARACTER_SLIDE_FRONT)
+    {
+        Audio_Send(TR_AUDIO_SOUND_LANDING, TR_AUDIO_EMITTER_ENTITY, ent->id);
+        if(cmd->jump)
+        {
+            ent->dir_flag = ENT_MOVE_FORWARD;
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_JUMP_FORWARD_BEGIN, 0);
+        }
+        else
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SLIDE_FORWARD, 0);
+        }
+    }
+    else if(state->slide == CHARACTER_SLIDE_BACK)
+    {
+        if(cmd->jump)
+        {
+            ent->dir_flag = ENT_MOVE_BACKWARD;
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_JUMP_BACK_BEGIN, 0);
+            Audio_Send(TR_AUDIO_SOUND_LANDING, TR_AUDIO_EMITTER_ENTITY, ent->id);
+        }
+        else
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_SLIDE_BACKWARD, 0);
+        }
+    }
+    else if(cmd->jump)
+    {
+        if(!curr_fc->quicksand)
+            ss_anim->target_state = TR_STATE_LARA_JUMP_PREPARE;           // jump sideways
+    }
+    else if(cmd->roll)
+    {
+        if(!curr_fc->quicksand && (ent->move_type != MOVE_CLIMBING) && (ent->no_fix_all == 0x00))
+        {
+            ent->dir_flag = ENT_MOVE_FORWARD;
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ROLL_BEGIN, 0);
+        }
+    }
+    else if(cmd->crouch)
+    {
+        if(!curr_fc->quicksand)
+            ss_anim->target_state = TR_STATE_LARA_CROUCH_IDLE;
+    }
+    else if(clean_action && Character_FindTraverse(ent))
+    {
+        ss_anim->target_state = TR_STATE_LARA_PUSHABLE_GRAB;
+        if(ent->transform.M4x4[4 + 0] > 0.9)
+        {
+            t = -ent->character->traversed_object->bf->bb_min[0] + 72.0f;
+        }
+        else if(ent->transform.M4x4[4 + 0] < -0.9)
+        {
+            t = ent->character->traversed_object->bf->bb_max[0] + 72.0f;
+        }
+        else if(ent->transform.M4x4[4 + 1] > 0.9)
+        {
+            t = -ent->character->traversed_object->bf->bb_min[1] + 72.0f;
+        }
+        else if(ent->transform.M4x4[4 + 1] < -0.9)
+        {
+            t = ent->character->traversed_object->bf->bb_max[1] + 72.0f;
+        }
+        else
+        {
+            t = 512.0f + 72.0f;                                           ///@PARANOID
+        }
+        float *v = ent->character->traversed_object->transform.M4x4 + 12;
+        pos[0] = v[0] - ent->transform.M4x4[4 + 0] * t;
+        pos[1] = v[1] - ent->transform.M4x4[4 + 1] * t;
+    }
+    else if(cmd->move[0] == 1)
+    {
+        if(cmd->shift)
+        {
+            vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
+            vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, WALK_FORWARD_OFFSET);
+            global_offset[2] += ent->bf->bb_max[2];
+            vec3_add(global_offset, global_offset, pos);
+            Character_ProbeHeightInfo(ent, global_offset, &next_fc);
+            if(((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide)) &&
+               (next_fc.floor_hit.hit && (next_fc.floor_hit.point[2] > pos[2] - ent->character->max_step_up_height) && (next_fc.floor_hit.point[2] <= pos[2] + ent->character->max_step_up_height)))
             {
                 ent->move_type = MOVE_ON_FLOOR;
-                ent->no_move = 0x00;
-                state->wall_collide = 0x00;
-            }
-
-            if(ent->move_type == MOVE_FREE_FALLING)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
-                ent->dir_flag = ENT_STAY;
-            }
-            else if(state->dead == 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_DEATH;
-            }
-            else if(state->slide == CHARACTER_SLIDE_FRONT)
-            {
-                Audio_Send(TR_AUDIO_SOUND_LANDING, TR_AUDIO_EMITTER_ENTITY, ent->id);
-                if(cmd->jump)
+                ent->dir_flag = ENT_MOVE_FORWARD;
+                if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
                 {
-                    ent->dir_flag = ENT_MOVE_FORWARD;
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_JUMP_FORWARD_BEGIN, 0);
+                    ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
                 }
                 else
                 {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SLIDE_FORWARD, 0);
+                    ss_anim->target_state = TR_STATE_LARA_WALK_FORWARD;
                 }
             }
-            else if(state->slide == CHARACTER_SLIDE_BACK)
+        }       // end IF CMD->SHIFT
+        else
+        {
+            vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
+            vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, RUN_FORWARD_OFFSET);
+            global_offset[2] += ent->bf->bb_max[2];
+            Character_CheckNextStep(ent, global_offset, &next_fc);
+            if(((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide)) && (!Character_HasStopSlant(ent, &next_fc)))
             {
-                if(cmd->jump)
+                ent->move_type = MOVE_ON_FLOOR;
+                ent->dir_flag = ENT_MOVE_FORWARD;
+                if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
                 {
-                    ent->dir_flag = ENT_MOVE_BACKWARD;
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_JUMP_BACK_BEGIN, 0);
-                    Audio_Send(TR_AUDIO_SOUND_LANDING, TR_AUDIO_EMITTER_ENTITY, ent->id);
+                    ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
                 }
                 else
                 {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_SLIDE_BACKWARD, 0);
-                }
-            }
-            else if(cmd->jump)
-            {
-                if(!curr_fc->quicksand)
-                    ss_anim->target_state = TR_STATE_LARA_JUMP_PREPARE;           // jump sideways
-            }
-            else if(cmd->roll)
-            {
-                if(!curr_fc->quicksand && (ent->move_type != MOVE_CLIMBING) && (ent->no_fix_all == 0x00))
-                {
-                    ent->dir_flag = ENT_MOVE_FORWARD;
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ROLL_BEGIN, 0);
+                    ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
                 }
             }
-            else if(cmd->crouch)
+        }
+
+        if( (clean_action) &&
+            ((ss_anim->prev_animation == TR_ANIMATION_LARA_STAY_IDLE)        ||
+             (ss_anim->prev_animation == TR_ANIMATION_LARA_STAY_SOLID)       ||
+             (ss_anim->prev_animation == TR_ANIMATION_LARA_WALL_SMASH_LEFT)  ||
+             (ss_anim->prev_animation == TR_ANIMATION_LARA_WALL_SMASH_RIGHT)) )
+        {
+            t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE + ent->character->climb_r;
+            climb_from[0] = pos[0];
+            climb_from[1] = pos[1];
+            climb_from[2] = pos[2] + 0.5 * DEFAULT_CLIMB_UP_HEIGHT;
+            climb_to[0] = pos[0] + t * ent->transform.M4x4[4 + 0];
+            climb_to[1] = pos[1] + t * ent->transform.M4x4[4 + 1];
+            climb_to[2] = pos[2] + ent->character->max_step_up_height;
+            if(curr_fc->ceiling_hit.hit && (climb_from[2] >= curr_fc->ceiling_hit.point[2] - ent->character->climb_r))
             {
-                if(!curr_fc->quicksand)
-                    ss_anim->target_state = TR_STATE_LARA_CROUCH_IDLE;
+                climb_from[2] = curr_fc->ceiling_hit.point[2] - ent->character->climb_r;
             }
-            else if(clean_action && Character_FindTraverse(ent))
+            Character_CheckClimbability(ent, climb, climb_from, climb_to);
+            if(climb->edge_hit &&
+               (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON) &&
+               (pos[2] + ent->character->max_step_up_height < climb->edge_point[2]) &&
+               (pos[2] + 2944.0f >= climb->edge_point[2]))              // trying to climb on
             {
-                ss_anim->target_state = TR_STATE_LARA_PUSHABLE_GRAB;
-                if(ent->transform.M4x4[4 + 0] > 0.9)
-                {
-                    t = -ent->character->traversed_object->bf->bb_min[0] + 72.0f;
-                }
-                else if(ent->transform.M4x4[4 + 0] < -0.9)
-                {
-                    t = ent->character->traversed_object->bf->bb_max[0] + 72.0f;
-                }
-                else if(ent->transform.M4x4[4 + 1] > 0.9)
+                if(pos[2] + 640.0f >= climb->edge_point[2])
                 {
-                    t = -ent->character->traversed_object->bf->bb_min[1] + 72.0f;
-                }
-                else if(ent->transform.M4x4[4 + 1] < -0.9)
-                {
-                    t = ent->character->traversed_object->bf->bb_max[1] + 72.0f;
-                }
-                else
-                {
-                    t = 512.0f + 72.0f;                                           ///@PARANOID
+                    ent->anim_linear_speed = 0.0f;
+                    ent->transform.angles[0] = climb->edge_z_ang;
+                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_2CLICK, 0);
+                    pos[2] = climb->edge_point[2] - 512.0f;
+                    vec3_copy(climb->point, climb->edge_point);
+                    ent->no_move = 0x01;
+                    return;
                 }
-                float *v = ent->character->traversed_object->transform.M4x4 + 12;
-                pos[0] = v[0] - ent->transform.M4x4[4 + 0] * t;
-                pos[1] = v[1] - ent->transform.M4x4[4 + 1] * t;
-            }
-            else if(cmd->move[0] == 1)
-            {
-                if(cmd->shift)
-                {
-                    vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
-                    vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, WALK_FORWARD_OFFSET);
-                    global_offset[2] += ent->bf->bb_max[2];
-                    vec3_add(global_offset, global_offset, pos);
-                    Character_GetHeightInfo(global_offset, &next_fc);
-                    if(((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide)) &&
-                       (next_fc.floor_hit.hit && (next_fc.floor_hit.point[2] > pos[2] - ent->character->max_step_up_height) && (next_fc.floor_hit.point[2] <= pos[2] + ent->character->max_step_up_height)))
-                    {
-                        ent->move_type = MOVE_ON_FLOOR;
-                        ent->dir_flag = ENT_MOVE_FORWARD;
-                        if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
-                        {
-                            ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
-                        }
-                        else
-                        {
-                            ss_anim->target_state = TR_STATE_LARA_WALK_FORWARD;
-                        }
-                    }
-                }       // end IF CMD->SHIFT
-                else
+                else if(pos[2] + 896.0f >= climb->edge_point[2])
                 {
-                    vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
-                    vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, RUN_FORWARD_OFFSET);
-                    global_offset[2] += ent->bf->bb_max[2];
-                    Character_CheckNextStep(ent, global_offset, &next_fc);
-                    if(((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide)) && (!Character_HasStopSlant(ent, &next_fc)))
-                    {
-                        ent->move_type = MOVE_ON_FLOOR;
-                        ent->dir_flag = ENT_MOVE_FORWARD;
-                        if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
-                        {
-                            ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
-                        }
-                        else
-                        {
-                            ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
-                        }
-                    }
+                    ent->anim_linear_speed = 0.0f;
+                    ent->transform.angles[0] = climb->edge_z_ang;
+                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_3CLICK, 0);
+                    pos[2] = climb->edge_point[2] - 768.0f;
+                    vec3_copy(climb->point, climb->edge_point);
+                    ent->no_move = 0x01;
+                    return;
                 }
+            }   // end IF MOVE_LITTLE_CLIMBING
 
-                if( (clean_action) &&
-                    ((ss_anim->prev_animation == TR_ANIMATION_LARA_STAY_IDLE)        ||
-                     (ss_anim->prev_animation == TR_ANIMATION_LARA_STAY_SOLID)       ||
-                     (ss_anim->prev_animation == TR_ANIMATION_LARA_WALL_SMASH_LEFT)  ||
-                     (ss_anim->prev_animation == TR_ANIMATION_LARA_WALL_SMASH_RIGHT)) )
-                {
-                    t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE + ent->character->climb_r;
-                    climb_from[0] = pos[0];
-                    climb_from[1] = pos[1];
-                    climb_from[2] = pos[2] + 0.5 * DEFAULT_CLIMB_UP_HEIGHT;
-                    climb_to[0] = pos[0] + t * ent->transform.M4x4[4 + 0];
-                    climb_to[1] = pos[1] + t * ent->transform.M4x4[4 + 1];
-                    climb_to[2] = pos[2] + ent->character->max_step_up_height;
-                    if(curr_fc->ceiling_hit.hit && (climb_from[2] >= curr_fc->ceiling_hit.point[2] - ent->character->climb_r))
-                    {
-                        climb_from[2] = curr_fc->ceiling_hit.point[2] - ent->character->climb_r;
-                    }
-                    Character_CheckClimbability(ent, climb, climb_from, climb_to);
-                    if(climb->edge_hit &&
-                       (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON) &&
-                       (pos[2] + ent->character->max_step_up_height < climb->edge_point[2]) &&
-                       (pos[2] + 2944.0f >= climb->edge_point[2]))              // trying to climb on
-                    {
-                        if(pos[2] + 640.0f >= climb->edge_point[2])
-                        {
-                            ent->anim_linear_speed = 0.0f;
-                            ent->transform.angles[0] = climb->edge_z_ang;
-                            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_2CLICK, 0);
-                            pos[2] = climb->edge_point[2] - 512.0f;
-                            vec3_copy(climb->point, climb->edge_point);
-                            ent->no_move = 0x01;
-                            break;
-                        }
-                        else if(pos[2] + 896.0f >= climb->edge_point[2])
-                        {
-                            ent->anim_linear_speed = 0.0f;
-                            ent->transform.angles[0] = climb->edge_z_ang;
-                            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_3CLICK, 0);
-                            pos[2] = climb->edge_point[2] - 768.0f;
-                            vec3_copy(climb->point, climb->edge_point);
-                            ent->no_move = 0x01;
-                            break;
-                        }
-                    }   // end IF MOVE_LITTLE_CLIMBING
-
-                    climb_from[2] += 0.5 * DEFAULT_CLIMB_UP_HEIGHT;
-                    if(curr_fc->ceiling_hit.hit && (climb_from[2] >= curr_fc->ceiling_hit.point[2] - ent->character->climb_r))
-                    {
-                        climb_from[2] = curr_fc->ceiling_hit.point[2] - ent->character->climb_r;
-                    }
-                    Character_CheckClimbability(ent, climb, climb_from, climb_to);
-                    if(climb->edge_hit                                                                &&
-                       (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON)   &&
-                       (pos[2] + ent->character->max_step_up_height < climb->edge_point[2])     &&
-                       (pos[2] + 2944.0f >= climb->edge_point[2]))               // trying to climb on
-                    {
-                        if(pos[2] + 1920.0f >= climb->edge_point[2])
-                        {
-                            ss_anim->target_state = TR_STATE_LARA_JUMP_UP;
-                            break;
-                        }
-                    }   // end IF MOVE_BIG_CLIMBING
-
-                    Character_CheckWallsClimbability(ent, climb);
-                    if(climb->wall_hit)
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_JUMP_UP;
-                        break;
-                    }
-                }
-            }       // end CMD->MOVE FORWARD
-            else if(cmd->move[0] == -1)
-            {
-                if(cmd->shift)
-                {
-                    vec3_mul_scalar(move, ent->transform.M4x4 + 4, -PENETRATION_TEST_OFFSET);
-                    if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
-                    {
-                        vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, -WALK_BACK_OFFSET);
-                        global_offset[2] += ent->bf->bb_max[2];
-                        vec3_add(global_offset, global_offset, pos);
-                        Character_GetHeightInfo(global_offset, &next_fc);
-                        if((next_fc.floor_hit.hit && (next_fc.floor_hit.point[2] > pos[2] - ent->character->max_step_up_height) && (next_fc.floor_hit.point[2] <= pos[2] + ent->character->max_step_up_height)))
-                        {
-                            ent->dir_flag = ENT_MOVE_BACKWARD;
-                            ss_anim->target_state = TR_STATE_LARA_WALK_BACK;
-                        }
-                    }
-                }
-                else    // RUN BACK
-                {
-                    vec3_mul_scalar(move, ent->transform.M4x4 + 4, - PENETRATION_TEST_OFFSET);
-                    if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
-                    {
-                        ent->dir_flag = ENT_MOVE_BACKWARD;
-                        if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
-                        {
-                            ss_anim->target_state = TR_STATE_LARA_WALK_BACK;
-                        }
-                        else
-                        {
-                            ss_anim->target_state = TR_STATE_LARA_RUN_BACK;
-                        }
-                    }
-                }
-            }       // end CMD->MOVE BACK
-            else if(cmd->move[1] == 1)
+            climb_from[2] += 0.5 * DEFAULT_CLIMB_UP_HEIGHT;
+            if(curr_fc->ceiling_hit.hit && (climb_from[2] >= curr_fc->ceiling_hit.point[2] - ent->character->climb_r))
             {
-                if(cmd->shift)
-                {
-                    vec3_mul_scalar(move, ent->transform.M4x4 + 0, PENETRATION_TEST_OFFSET);
-                    if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
-                    {
-                        vec3_mul_scalar(global_offset, ent->transform.M4x4 + 0, RUN_FORWARD_OFFSET);
-                        global_offset[2] += ent->bf->bb_max[2];
-                        i = Character_CheckNextStep(ent, global_offset, &next_fc);
-                        if((!state->wall_collide) && (i >= CHARACTER_STEP_DOWN_LITTLE && i <= CHARACTER_STEP_UP_LITTLE))
-                        {
-                            cmd->rot[0] = 0;
-                            ent->dir_flag = ENT_MOVE_RIGHT;
-                            ss_anim->target_state = TR_STATE_LARA_WALK_RIGHT;
-                        }
-                    }
-                }       //end IF CMD->SHIFT
-                else
-                {
-                    ss_anim->target_state = TR_STATE_LARA_TURN_RIGHT_SLOW;
-                }
-            }       // end MOVE RIGHT
-            else if(cmd->move[1] == -1)
+                climb_from[2] = curr_fc->ceiling_hit.point[2] - ent->character->climb_r;
+            }
+            Character_CheckClimbability(ent, climb, climb_from, climb_to);
+            if(climb->edge_hit                                                                &&
+               (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON)   &&
+               (pos[2] + ent->character->max_step_up_height < climb->edge_point[2])     &&
+               (pos[2] + 2944.0f >= climb->edge_point[2]))               // trying to climb on
             {
-                if(cmd->shift)
-                {
-                    vec3_mul_scalar(move, ent->transform.M4x4 + 0, -PENETRATION_TEST_OFFSET);
-                    if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
-                    {
-                        vec3_mul_scalar(global_offset, ent->transform.M4x4 + 0, -RUN_FORWARD_OFFSET);
-                        global_offset[2] += ent->bf->bb_max[2];
-                        i = Character_CheckNextStep(ent, global_offset, &next_fc);
-                        if((!state->wall_collide) && (i >= CHARACTER_STEP_DOWN_LITTLE && i <= CHARACTER_STEP_UP_LITTLE))
-                        {
-                            cmd->rot[0] = 0;
-                            ent->dir_flag = ENT_MOVE_LEFT;
-                            ss_anim->target_state = TR_STATE_LARA_WALK_LEFT;
-                        }
-                    }
-                }       //end IF CMD->SHIFT
-                else
+                if(pos[2] + 1920.0f >= climb->edge_point[2])
                 {
-                    ss_anim->target_state = TR_STATE_LARA_TURN_LEFT_SLOW;
+                    ss_anim->target_state = TR_STATE_LARA_JUMP_UP;
+                    return;
                 }
-            }       // end MOVE LEFT
-            break;
-
-        case TR_STATE_LARA_JUMP_PREPARE:
-            cmd->rot[0] = 0;
-            Character_Lean(ent, cmd, 0.0f);
+            }   // end IF MOVE_BIG_CLIMBING
 
-            if(state->slide == CHARACTER_SLIDE_BACK)      // Slide checking is only for jumps direction correction!
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_JUMP_BACK_BEGIN, 0);
-                cmd->move[0] = -1;
-            }
-            else if(state->slide == CHARACTER_SLIDE_FRONT)
+            Character_CheckWallsClimbability(ent, climb);
+            if(climb->wall_hit)
             {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_JUMP_FORWARD_BEGIN, 0);
-                cmd->move[0] = 1;
+                ss_anim->target_state = TR_STATE_LARA_JUMP_UP;
+                return;
             }
-            if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
-            {
-                ent->no_fix_skeletal_parts = ~(uint32_t)BODY_PART_BODY_LOW;
-                //Stay, directional jumps are not allowed whilst in wade depth
-            }
-            else if(cmd->move[0] == 1)
+        }
+    }       // end CMD->MOVE FORWARD
+    else if(cmd->move[0] == -1)
+    {
+        if(cmd->shift)
+        {
+            vec3_mul_scalar(move, ent->transform.M4x4 + 4, -PENETRATION_TEST_OFFSET);
+            if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
             {
-                ent->dir_flag = ENT_MOVE_FORWARD;
-                vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
-                if(Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0)
+                vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, -WALK_BACK_OFFSET);
+                global_offset[2] += ent->bf->bb_max[2];
+                vec3_add(global_offset, global_offset, pos);
+                Character_ProbeHeightInfo(ent, global_offset, &next_fc);
+                if((next_fc.floor_hit.hit && (next_fc.floor_hit.point[2] > pos[2] - ent->character->max_step_up_height) && (next_fc.floor_hit.point[2] <= pos[2] + ent->character->max_step_up_height)))
                 {
-                    ss_anim->target_state = TR_STATE_LARA_JUMP_FORWARD;           // jump forward
+                    ent->dir_flag = ENT_MOVE_BACKWARD;
+                    ss_anim->target_state = TR_STATE_LARA_WALK_BACK;
                 }
             }
-            else if(cmd->move[0] ==-1)
+        }
+        else    // RUN BACK
+        {
+            vec3_mul_scalar(move, ent->transform.M4x4 + 4, - PENETRATION_TEST_OFFSET);
+            if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
             {
                 ent->dir_flag = ENT_MOVE_BACKWARD;
-                vec3_mul_scalar(move, ent->transform.M4x4 + 4, -PENETRATION_TEST_OFFSET);
-                if(Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0)
+                if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
                 {
-                    ss_anim->target_state = TR_STATE_LARA_JUMP_BACK;              // jump backward
+                    ss_anim->target_state = TR_STATE_LARA_WALK_BACK;
                 }
-            }
-            else if(cmd->move[1] == 1)
-            {
-                ent->dir_flag = ENT_MOVE_RIGHT;
-                vec3_mul_scalar(move, ent->transform.M4x4 + 0, PENETRATION_TEST_OFFSET);
-                if(Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0)
+                else
                 {
-                    ss_anim->target_state = TR_STATE_LARA_JUMP_LEFT;              // jump right
+                    ss_anim->target_state = TR_STATE_LARA_RUN_BACK;
                 }
             }
-            else if(cmd->move[1] == -1)
+        }
+    }       // end CMD->MOVE BACK
+    else if(cmd->move[1] == 1)
+    {
+        if(cmd->shift)
+        {
+            vec3_mul_scalar(move, ent->transform.M4x4 + 0, PENETRATION_TEST_OFFSET);
+            if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
             {
-                ent->dir_flag = ENT_MOVE_LEFT;
-                vec3_mul_scalar(move, ent->transform.M4x4 + 0, -PENETRATION_TEST_OFFSET);
-                if(Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0)
+                vec3_mul_scalar(global_offset, ent->transform.M4x4 + 0, RUN_FORWARD_OFFSET);
+                global_offset[2] += ent->bf->bb_max[2];
+                i = Character_CheckNextStep(ent, global_offset, &next_fc);
+                if((!state->wall_collide) && (i >= CHARACTER_STEP_DOWN_LITTLE && i <= CHARACTER_STEP_UP_LITTLE))
                 {
-                    ss_anim->target_state = TR_STATE_LARA_JUMP_RIGHT;             // jump left
+                    cmd->rot[0] = 0;
+                    ent->dir_flag = ENT_MOVE_RIGHT;
+                    ss_anim->target_state = TR_STATE_LARA_WALK_RIGHT;
                 }
             }
-            else
-            {
-                ent->no_fix_skeletal_parts = ~(uint32_t)BODY_PART_BODY_LOW;
-            }
-            break;
-
-        case TR_STATE_LARA_JUMP_BACK:
-            cmd->rot[0] = 0;
-            if(state->floor_collide || ent->move_type == MOVE_ON_FLOOR)
+        }       //end IF CMD->SHIFT
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_TURN_RIGHT_SLOW;
+        }
+    }       // end MOVE RIGHT
+    else if(cmd->move[1] == -1)
+    {
+        if(cmd->shift)
+        {
+            vec3_mul_scalar(move, ent->transform.M4x4 + 0, -PENETRATION_TEST_OFFSET);
+            if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
             {
-                if(curr_fc->quicksand)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
-                }
-                else
+                vec3_mul_scalar(global_offset, ent->transform.M4x4 + 0, -RUN_FORWARD_OFFSET);
+                global_offset[2] += ent->bf->bb_max[2];
+                i = Character_CheckNextStep(ent, global_offset, &next_fc);
+                if((!state->wall_collide) && (i >= CHARACTER_STEP_DOWN_LITTLE && i <= CHARACTER_STEP_UP_LITTLE))
                 {
-                    ss_anim->target_state = TR_STATE_LARA_STOP;       // landing
+                    cmd->rot[0] = 0;
+                    ent->dir_flag = ENT_MOVE_LEFT;
+                    ss_anim->target_state = TR_STATE_LARA_WALK_LEFT;
                 }
             }
-            else if(state->wall_collide)
-            {
-                Engine_JoyRumble(200.0, 200);
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SMASH_JUMP, 0);
-                ent->dir_flag = ENT_MOVE_FORWARD;
-                Character_UpdateCurrentSpeed(ent, 1);
-            }
-            else if((ent->move_type == MOVE_UNDERWATER) || (ent->speed[2] <= -FREE_FALL_SPEED_2))
-            {
-                ss_anim->target_state = TR_STATE_LARA_FREEFALL;                   // free falling
-            }
-            else if(cmd->roll)
-            {
-                ss_anim->target_state = TR_STATE_LARA_JUMP_ROLL;
-            }
-            break;
+        }       //end IF CMD->SHIFT
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_TURN_LEFT_SLOW;
+        }
+    }       // end MOVE LEFT
+}
 
-        case TR_STATE_LARA_JUMP_LEFT:
-            cmd->rot[0] = 0;
-            if(state->floor_collide || ent->move_type == MOVE_ON_FLOOR)
-            {
-                if(curr_fc->quicksand)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
-                }
-                else
-                {
-                    ss_anim->target_state = TR_STATE_LARA_STOP;       // landing
-                }
-            }
-            else if(state->wall_collide)
-            {
-                Engine_JoyRumble(200.0, 200);
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SMASH_JUMP, 0);
-                ent->dir_flag = ENT_MOVE_RIGHT;
-                Character_UpdateCurrentSpeed(ent, 1);
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_FREEFALL;
-            }
-            break;
+static void StateControl_LaraJumpPrepare(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    float move[3], reaction[3];
 
-        case TR_STATE_LARA_JUMP_RIGHT:
-            cmd->rot[0] = 0;
-            if(state->floor_collide || ent->move_type == MOVE_ON_FLOOR)
-            {
-                if(curr_fc->quicksand)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
-                }
-                else
-                {
-                    ss_anim->target_state = TR_STATE_LARA_STOP;       // landing
-                }
-            }
-            else if(state->wall_collide)
-            {
-                Engine_JoyRumble(200.0, 200);
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SMASH_JUMP, 0);
-                ent->dir_flag = ENT_MOVE_LEFT;
-                Character_UpdateCurrentSpeed(ent, 1);
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_FREEFALL;
-            }
-            break;
+    cmd->rot[0] = 0;
+    Character_Lean(ent, cmd, 0.0f);
 
-        case TR_STATE_LARA_RUN_BACK:
-            ent->dir_flag = ENT_MOVE_BACKWARD;
+    if(state->slide == CHARACTER_SLIDE_BACK)      // Slide checking is only for jumps direction correction!
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_JUMP_BACK_BEGIN, 0);
+        cmd->move[0] = -1;
+    }
+    else if(state->slide == CHARACTER_SLIDE_FRONT)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_JUMP_FORWARD_BEGIN, 0);
+        cmd->move[0] = 1;
+    }
+    if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
+    {
+        ent->no_fix_skeletal_parts = ~(uint32_t)BODY_PART_BODY_LOW;
+        //Stay, directional jumps are not allowed whilst in wade depth
+    }
+    else if(cmd->move[0] == 1)
+    {
+        ent->dir_flag = ENT_MOVE_FORWARD;
+        vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
+        if(Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0)
+        {
+            ss_anim->target_state = TR_STATE_LARA_JUMP_FORWARD;           // jump forward
+        }
+    }
+    else if(cmd->move[0] ==-1)
+    {
+        ent->dir_flag = ENT_MOVE_BACKWARD;
+        vec3_mul_scalar(move, ent->transform.M4x4 + 4, -PENETRATION_TEST_OFFSET);
+        if(Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0)
+        {
+            ss_anim->target_state = TR_STATE_LARA_JUMP_BACK;              // jump backward
+        }
+    }
+    else if(cmd->move[1] == 1)
+    {
+        ent->dir_flag = ENT_MOVE_RIGHT;
+        vec3_mul_scalar(move, ent->transform.M4x4 + 0, PENETRATION_TEST_OFFSET);
+        if(Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0)
+        {
+            ss_anim->target_state = TR_STATE_LARA_JUMP_LEFT;              // jump right
+        }
+    }
+    else if(cmd->move[1] == -1)
+    {
+        ent->dir_flag = ENT_MOVE_LEFT;
+        vec3_mul_scalar(move, ent->transform.M4x4 + 0, -PENETRATION_TEST_OFFSET);
+        if(Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0)
+        {
+            ss_anim->target_state = TR_STATE_LARA_JUMP_RIGHT;             // jump left
+        }
+    }
+    else
+    {
+        ent->no_fix_skeletal_parts = ~(uint32_t)BODY_PART_BODY_LOW;
+    }
+}
 
-            if(ent->move_type == MOVE_FREE_FALLING)
-            {
-                ent->dir_flag = ENT_MOVE_FORWARD;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_BACK, 0);
-            }
-            else if(state->wall_collide)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_2CLICK_END, 0);
-            }
-            break;
+static void StateControl_LaraJumpBack(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+
+    cmd->rot[0] = 0;
+    if(state->floor_collide || ent->move_type == MOVE_ON_FLOOR)
+    {
+        if(curr_fc->quicksand)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
+        }
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_STOP;       // landing
+        }
+    }
+    else if(state->wall_collide)
+    {
+        Engine_JoyRumble(200.0, 200);
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SMASH_JUMP, 0);
+        ent->dir_flag = ENT_MOVE_FORWARD;
+        Character_UpdateCurrentSpeed(ent, 1);
+    }
+    else if((ent->move_type == MOVE_UNDERWATER) || (ent->speed[2] <= -FREE_FALL_SPEED_2))
+    {
+        ss_anim->target_state = TR_STATE_LARA_FREEFALL;                   // free falling
+    }
+    else if(cmd->roll)
+    {
+        ss_anim->target_state = TR_STATE_LARA_JUMP_ROLL;
+    }
+}
 
+static void StateControl_LaraJumpLeft(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
 
-        case TR_STATE_LARA_TURN_LEFT_SLOW:
-        case TR_STATE_LARA_TURN_RIGHT_SLOW:
-            ent->character->rotate_speed_mult = 0.7f;
-            ent->dir_flag = ENT_STAY;
-            Character_Lean(ent, cmd, 0.0f);
-            ent->no_fix_skeletal_parts = BODY_PART_LEGS_2 | BODY_PART_LEGS_3;
+    cmd->rot[0] = 0;
+    if(state->floor_collide || ent->move_type == MOVE_ON_FLOOR)
+    {
+        if(curr_fc->quicksand)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
+        }
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_STOP;       // landing
+        }
+    }
+    else if(state->wall_collide)
+    {
+        Engine_JoyRumble(200.0, 200);
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SMASH_JUMP, 0);
+        ent->dir_flag = ENT_MOVE_RIGHT;
+        Character_UpdateCurrentSpeed(ent, 1);
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_FREEFALL;
+    }
+}
 
-            if(cmd->move[0] == 1)
-            {
-                int substance_state = Entity_GetSubstanceState(ent);
-                if((substance_state == ENTITY_SUBSTANCE_NONE) ||
-                   (substance_state == ENTITY_SUBSTANCE_WATER_SHALLOW))
-                {
-                    if(cmd->shift)
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_WALK_FORWARD;
-                        ent->dir_flag = ENT_MOVE_FORWARD;
-                    }
-                    else
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
-                        ent->dir_flag = ENT_MOVE_FORWARD;
-                    }
-                }
-                else
-                {
-                    ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
-                    ent->dir_flag = ENT_MOVE_FORWARD;
-                }
-            }
-            else if(((current_state == TR_STATE_LARA_TURN_LEFT_SLOW ) && (cmd->move[1] == -1)) ||
-                    ((current_state == TR_STATE_LARA_TURN_RIGHT_SLOW) && (cmd->move[1] ==  1))  )
-            {
-                int substance_state = Entity_GetSubstanceState(ent);
-                if((is_last_frame) &&
-                   (substance_state != ENTITY_SUBSTANCE_WATER_WADE) &&
-                   (substance_state != ENTITY_SUBSTANCE_QUICKSAND_CONSUMED) &&
-                   (substance_state != ENTITY_SUBSTANCE_QUICKSAND_SHALLOW))
-                 {
-                     ss_anim->target_state = TR_STATE_LARA_TURN_FAST;
-                 }
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_STOP;
-            }
-            break;
+static void StateControl_LaraJumpRight(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
 
-        case TR_STATE_LARA_TURN_FAST:
-            // 65 - wade
-            ent->dir_flag = ENT_STAY;
-            ent->no_fix_skeletal_parts = BODY_PART_LEGS_2 | BODY_PART_LEGS_3;
-            Character_Lean(ent, cmd, 0.0f);
+    cmd->rot[0] = 0;
+    if(state->floor_collide || ent->move_type == MOVE_ON_FLOOR)
+    {
+        if(curr_fc->quicksand)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
+        }
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_STOP;       // landing
+        }
+    }
+    else if(state->wall_collide)
+    {
+        Engine_JoyRumble(200.0, 200);
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SMASH_JUMP, 0);
+        ent->dir_flag = ENT_MOVE_LEFT;
+        Character_UpdateCurrentSpeed(ent, 1);
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_FREEFALL;
+    }
+}
 
-            if(ent->move_type == MOVE_FREE_FALLING)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
-            }
-            else if(cmd->move[0] == 1 && cmd->jump == 0 && cmd->crouch == 0 && cmd->shift)
+static void StateControl_LaraRunBack(struct entity_s *ent, struct ss_animation_s * /*ss_anim*/, lara_env_p env)
+{
+    character_state_p state = env->state;
+
+    ent->dir_flag = ENT_MOVE_BACKWARD;
+
+    if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        ent->dir_flag = ENT_MOVE_FORWARD;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_BACK, 0);
+    }
+    else if(state->wall_collide)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_2CLICK_END, 0);
+    }
+}
+
+static void StateControl_LaraTurnSlow(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    int8_t is_last_frame = env->is_last_frame;
+    uint16_t current_state = env->current_state;
+
+    ent->character->rotate_speed_mult = 0.7f;
+    ent->dir_flag = ENT_STAY;
+    Character_Lean(ent, cmd, 0.0f);
+    ent->no_fix_skeletal_parts = BODY_PART_LEGS_2 | BODY_PART_LEGS_3;
+
+    if(cmd->move[0] == 1)
+    {
+        int substance_state = Entity_GetSubstanceState(ent);
+        if((substance_state == ENTITY_SUBSTANCE_NONE) ||
+           (substance_state == ENTITY_SUBSTANCE_WATER_SHALLOW))
+        {
+            if(cmd->shift)
             {
                 ss_anim->target_state = TR_STATE_LARA_WALK_FORWARD;
                 ent->dir_flag = ENT_MOVE_FORWARD;
             }
-            else if(cmd->move[0] == 1 && cmd->jump == 0 && cmd->crouch == 0 && cmd->shift == 0)
+            else
             {
                 ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
                 ent->dir_flag = ENT_MOVE_FORWARD;
             }
-            else if(cmd->move[1] == 0)
-            {
-                ss_anim->target_state = TR_STATE_LARA_STOP;
-            }
-            break;
-
-            /*
-             * RUN AND WALK animations section
-             */
-        case TR_STATE_LARA_RUN_FORWARD:
+        }
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
             ent->dir_flag = ENT_MOVE_FORWARD;
-            cmd->crouch |= low_vertical_space;
+        }
+    }
+    else if(((current_state == TR_STATE_LARA_TURN_LEFT_SLOW ) && (cmd->move[1] == -1)) ||
+            ((current_state == TR_STATE_LARA_TURN_RIGHT_SLOW) && (cmd->move[1] ==  1))  )
+    {
+        int substance_state = Entity_GetSubstanceState(ent);
+        if((is_last_frame) &&
+           (substance_state != ENTITY_SUBSTANCE_WATER_WADE) &&
+           (substance_state != ENTITY_SUBSTANCE_QUICKSAND_CONSUMED) &&
+           (substance_state != ENTITY_SUBSTANCE_QUICKSAND_SHALLOW))
+         {
+             ss_anim->target_state = TR_STATE_LARA_TURN_FAST;
+         }
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
+}
 
-            Character_Lean(ent, cmd, 6.0f);
-            vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, RUN_FORWARD_OFFSET);
-            global_offset[2] += ent->bf->bb_max[2];
-            i = Character_CheckNextStep(ent, global_offset, &next_fc);
+static void StateControl_LaraTurnFast(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
 
-            if(ent->move_type == MOVE_ON_FLOOR)
-            {
-                ent->no_fix_skeletal_parts = BODY_PART_HANDS | BODY_PART_LEGS;
-            }
+    // 65 - wade
+    ent->dir_flag = ENT_STAY;
+    ent->no_fix_skeletal_parts = BODY_PART_LEGS_2 | BODY_PART_LEGS_3;
+    Character_Lean(ent, cmd, 0.0f);
 
-            if(ent->move_type == MOVE_FREE_FALLING)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
-            }
-            else if(state->dead == 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_DEATH;
-            }
-            else if(state->slide == CHARACTER_SLIDE_FRONT)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SLIDE_FORWARD, 0);
-            }
-            else if(state->slide == CHARACTER_SLIDE_BACK)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_SLIDE_BACKWARD, 0);
-                ent->dir_flag = ENT_MOVE_BACKWARD;
-            }
-            else if(Character_HasStopSlant(ent, &next_fc))
-            {
-                ent->dir_flag = ENT_STAY;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
-            }
-            else if(cmd->crouch)
-            {
-                ss_anim->target_state = TR_STATE_LARA_CROUCH_IDLE;
-            }
-            else if((cmd->move[0] == 1) && (cmd->crouch == 0) && (ent->character->state.step_z == 0x01))
-            {
-                ent->dir_flag = ENT_STAY;
-                i = Anim_GetAnimDispatchCase(ss_anim, 2);                       // MOST CORRECT STATECHANGE!!!
-                if(i == 0)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_RUN_UP_STEP_RIGHT, 0);
-                    pos[2] = curr_fc->floor_hit.point[2];
-                    ent->dir_flag = ENT_MOVE_FORWARD;
-                }
-                else //if(i == 1)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_RUN_UP_STEP_LEFT, 0);
-                    pos[2] = curr_fc->floor_hit.point[2];
-                    ent->dir_flag = ENT_MOVE_FORWARD;
-                }
-            }
-            else if(state->wall_collide)
-            {
-                vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, RUN_FORWARD_OFFSET);
-                global_offset[2] += 1024.0f;
-                if(ss_anim->prev_animation == TR_ANIMATION_LARA_STAY_TO_RUN)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
-                }
-                else
-                {
-                    Engine_JoyRumble(200.0, 200);
+    if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
+    }
+    else if(cmd->move[0] == 1 && cmd->jump == 0 && cmd->crouch == 0 && cmd->shift)
+    {
+        ss_anim->target_state = TR_STATE_LARA_WALK_FORWARD;
+        ent->dir_flag = ENT_MOVE_FORWARD;
+    }
+    else if(cmd->move[0] == 1 && cmd->jump == 0 && cmd->crouch == 0 && cmd->shift == 0)
+    {
+        ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
+        ent->dir_flag = ENT_MOVE_FORWARD;
+    }
+    else if(cmd->move[1] == 0)
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
+}
 
-                    if(cmd->move[0] == 1)
-                    {
-                        i = Anim_GetAnimDispatchCase(ss_anim, 2);
-                        if(i == 1)
-                        {
-                            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALL_SMASH_LEFT, 0);
-                        }
-                        else
-                        {
-                            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALL_SMASH_RIGHT, 0);
-                        }
-                    }
-                    else
-                    {
-                        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_SOLID, 0);
-                    }
-                }
-                Character_UpdateCurrentSpeed(ent, 0);
-            }
-            else if(cmd->move[0] == 1)                                          // If we continue running...
+/*
+ * RUN AND WALK animations section
+ */
+static void StateControl_LaraRunForward(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    int8_t low_vertical_space = env->low_vertical_space;
+    int i;
+    float *pos = ent->transform.M4x4 + 12;
+    float global_offset[3];
+    height_info_t next_fc;
+    next_fc.self = ent->self;
+
+    ent->dir_flag = ENT_MOVE_FORWARD;
+    cmd->crouch |= low_vertical_space;
+
+    Character_Lean(ent, cmd, 6.0f);
+    vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, RUN_FORWARD_OFFSET);
+    global_offset[2] += ent->bf->bb_max[2];
+    i = Character_CheckNextStep(ent, global_offset, &next_fc);
+
+    if(ent->move_type == MOVE_ON_FLOOR)
+    {
+        ent->no_fix_skeletal_parts = BODY_PART_HANDS | BODY_PART_LEGS;
+    }
+
+    if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
+    }
+    else if(state->dead == 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_DEATH;
+    }
+    else if(state->slide == CHARACTER_SLIDE_FRONT)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SLIDE_FORWARD, 0);
+    }
+    else if(state->slide == CHARACTER_SLIDE_BACK)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_SLIDE_BACKWARD, 0);
+        ent->dir_flag = ENT_MOVE_BACKWARD;
+    }
+    else if(Character_HasStopSlant(ent, &next_fc))
+    {
+        ent->dir_flag = ENT_STAY;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
+    }
+    else if(cmd->crouch)
+    {
+        ss_anim->target_state = TR_STATE_LARA_CROUCH_IDLE;
+    }
+    else if((cmd->move[0] == 1) && (cmd->crouch == 0) && (ent->character->state.step_z == 0x01))
+    {
+        ent->dir_flag = ENT_STAY;
+        i = Anim_GetAnimDispatchCase(ss_anim, 2);                       // MOST CORRECT STATECHANGE!!!
+        if(i == 0)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_RUN_UP_STEP_RIGHT, 0);
+            pos[2] = curr_fc->floor_hit.point[2];
+            ent->dir_flag = ENT_MOVE_FORWARD;
+        }
+        else //if(i == 1)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_RUN_UP_STEP_LEFT, 0);
+            pos[2] = curr_fc->floor_hit.point[2];
+            ent->dir_flag = ENT_MOVE_FORWARD;
+        }
+    }
+    else if(state->wall_collide)
+    {
+        vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, RUN_FORWARD_OFFSET);
+        global_offset[2] += 1024.0f;
+        if(ss_anim->prev_animation == TR_ANIMATION_LARA_STAY_TO_RUN)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
+        }
+        else
+        {
+            Engine_JoyRumble(200.0, 200);
+
+            if(cmd->move[0] == 1)
             {
-                if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
-                {
-                    ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
-                }
-                else if(cmd->shift)
-                {
-                    ss_anim->target_state = TR_STATE_LARA_WALK_FORWARD;
-                }
-                else if((cmd->jump) && (ss_anim->prev_animation != TR_ANIMATION_LARA_STAY_TO_RUN))
-                {
-                    ss_anim->target_state = TR_STATE_LARA_JUMP_FORWARD;
-                }
-                else if(cmd->roll)
+                i = Anim_GetAnimDispatchCase(ss_anim, 2);
+                if(i == 1)
                 {
-                    ent->dir_flag = ENT_MOVE_FORWARD;
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ROLL_BEGIN, 0);
+                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALL_SMASH_LEFT, 0);
                 }
-                else if(cmd->sprint)
+                else
                 {
-                    ss_anim->target_state = TR_STATE_LARA_SPRINT;
+                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALL_SMASH_RIGHT, 0);
                 }
             }
             else
             {
-                ss_anim->target_state = TR_STATE_LARA_STOP;
+                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_SOLID, 0);
             }
-            break;
+        }
+        Character_UpdateCurrentSpeed(ent, 0);
+    }
+    else if(cmd->move[0] == 1)                                          // If we continue running...
+    {
+        if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
+        {
+            ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
+        }
+        else if(cmd->shift)
+        {
+            ss_anim->target_state = TR_STATE_LARA_WALK_FORWARD;
+        }
+        else if((cmd->jump) && (ss_anim->prev_animation != TR_ANIMATION_LARA_STAY_TO_RUN))
+        {
+            ss_anim->target_state = TR_STATE_LARA_JUMP_FORWARD;
+        }
+        else if(cmd->roll)
+        {
+            ent->dir_flag = ENT_MOVE_FORWARD;
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ROLL_BEGIN, 0);
+        }
+        else if(cmd->sprint)
+        {
+            ss_anim->target_state = TR_STATE_LARA_SPRINT;
+        }
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
+}
 
-        case TR_STATE_LARA_SPRINT:
-            state->sprint = 0x01;
-            vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, RUN_FORWARD_OFFSET);
-            Character_Lean(ent, cmd, 12.0f);
-            global_offset[2] += ent->bf->bb_max[2];
-            i = Character_CheckNextStep(ent, global_offset, &next_fc);
-            cmd->crouch |= low_vertical_space;
+static void StateControl_LaraSprint(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    int8_t low_vertical_space = env->low_vertical_space;
+    int i;
+    float global_offset[3];
+    height_info_t next_fc;
+    next_fc.self = ent->self;
 
-            if(ent->move_type == MOVE_ON_FLOOR)
-            {
-                ent->no_fix_skeletal_parts = BODY_PART_LEGS_1 | BODY_PART_LEGS_2 | BODY_PART_LEGS_3;
-            }
+    state->sprint = 0x01;
+    vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, RUN_FORWARD_OFFSET);
+    Character_Lean(ent, cmd, 12.0f);
+    global_offset[2] += ent->bf->bb_max[2];
+    i = Character_CheckNextStep(ent, global_offset, &next_fc);
+    cmd->crouch |= low_vertical_space;
 
-            if(!Character_GetParam(ent, PARAM_STAMINA))
-            {
-                ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
-            }
-            else if(ent->move_type == MOVE_FREE_FALLING)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
-            }
-            else if(state->dead == 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;    // Normal run then die
-            }
-            else if(state->slide == CHARACTER_SLIDE_FRONT)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SLIDE_FORWARD, 0);
-            }
-            else if(state->slide == CHARACTER_SLIDE_BACK)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_SLIDE_BACKWARD, 0);
-            }
-            else if((next_fc.floor_hit.normale[2] < ent->character->critical_slant_z_component) && (i > CHARACTER_STEP_HORIZONTAL))
-            {
-                ent->anim_linear_speed = 0.0f;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);       ///@FIXME: maybe RUN_TO_STAY
-            }
-            else if((next_fc.floor_hit.normale[2] >= ent->character->critical_slant_z_component) && (i == CHARACTER_STEP_UP_BIG))
-            {
-                ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;     // Interrupt sprint
-            }
-            else if(state->wall_collide)
-            {
-                Engine_JoyRumble(200.0, 200);
+    if(ent->move_type == MOVE_ON_FLOOR)
+    {
+        ent->no_fix_skeletal_parts = BODY_PART_LEGS_1 | BODY_PART_LEGS_2 | BODY_PART_LEGS_3;
+    }
 
-                i = Anim_GetAnimDispatchCase(ss_anim, 2);
-                if(i == 1)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALL_SMASH_LEFT, 0);
-                }
-                else if(i == 0)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALL_SMASH_RIGHT, 0);
-                }
-                Character_UpdateCurrentSpeed(ent, 0);
-            }
-            else if(cmd->sprint == 0)
-            {
-                if(cmd->move[0] == 1)
-                {
-                    ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
-                }
-                else
-                {
-                    ss_anim->target_state = TR_STATE_LARA_STOP;
-                }
-            }
-            else
-            {
-                if(cmd->jump)
-                {
-                    ss_anim->target_state = TR_STATE_LARA_SPRINT_ROLL;
-                }
-                else if(cmd->roll)
-                {
-                    ent->dir_flag = ENT_MOVE_FORWARD;
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ROLL_BEGIN, 0);
-                }
-                else if(cmd->crouch)
-                {
-                    ss_anim->target_state = TR_STATE_LARA_CROUCH_IDLE;
-                }
-                else if(cmd->move[0] == 0)
-                {
-                    ss_anim->target_state = TR_STATE_LARA_STOP;
-                }
-            }
-            break;
+    if(!Character_GetParam(ent, PARAM_STAMINA))
+    {
+        ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
+    }
+    else if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
+    }
+    else if(state->dead == 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;    // Normal run then die
+    }
+    else if(state->slide == CHARACTER_SLIDE_FRONT)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SLIDE_FORWARD, 0);
+    }
+    else if(state->slide == CHARACTER_SLIDE_BACK)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_SLIDE_BACKWARD, 0);
+    }
+    else if((next_fc.floor_hit.normale[2] < ent->character->critical_slant_z_component) && (i > CHARACTER_STEP_HORIZONTAL))
+    {
+        ent->anim_linear_speed = 0.0f;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);       ///@FIXME: maybe RUN_TO_STAY
+    }
+    else if((next_fc.floor_hit.normale[2] >= ent->character->critical_slant_z_component) && (i == CHARACTER_STEP_UP_BIG))
+    {
+        ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;     // Interrupt sprint
+    }
+    else if(state->wall_collide)
+    {
+        Engine_JoyRumble(200.0, 200);
 
-        case TR_STATE_LARA_WALK_FORWARD:
-            ent->character->rotate_speed_mult = 0.4f;
-            Character_Lean(ent, cmd, 0.0f);
+        i = Anim_GetAnimDispatchCase(ss_anim, 2);
+        if(i == 1)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALL_SMASH_LEFT, 0);
+        }
+        else if(i == 0)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALL_SMASH_RIGHT, 0);
+        }
+        Character_UpdateCurrentSpeed(ent, 0);
+    }
+    else if(cmd->sprint == 0)
+    {
+        if(cmd->move[0] == 1)
+        {
+            ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
+        }
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_STOP;
+        }
+    }
+    else
+    {
+        if(cmd->jump)
+        {
+            ss_anim->target_state = TR_STATE_LARA_SPRINT_ROLL;
+        }
+        else if(cmd->roll)
+        {
+            ent->dir_flag = ENT_MOVE_FORWARD;
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ROLL_BEGIN, 0);
+        }
+        else if(cmd->crouch)
+        {
+            ss_anim->target_state = TR_STATE_LARA_CROUCH_IDLE;
+        }
+        else if(cmd->move[0] == 0)
+        {
+            ss_anim->target_state = TR_STATE_LARA_STOP;
+        }
+    }
+}
 
-            vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, WALK_FORWARD_OFFSET);
-            global_offset[2] += ent->bf->bb_max[2];
-            i = Character_CheckNextStep(ent, global_offset, &next_fc);
+static void StateControl_LaraWalkForward(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    int8_t low_vertical_space = env->low_vertical_space;
+    int i;
+    float *pos = ent->transform.M4x4 + 12;
+    float global_offset[3];
+    height_info_t next_fc;
+    next_fc.self = ent->self;
+
+    ent->character->rotate_speed_mult = 0.4f;
+    Character_Lean(ent, cmd, 0.0f);
+
+    vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, WALK_FORWARD_OFFSET);
+    global_offset[2] += ent->bf->bb_max[2];
+    i = Character_CheckNextStep(ent, global_offset, &next_fc);
+    ent->dir_flag = ENT_MOVE_FORWARD;
+
+    if(ent->move_type == MOVE_ON_FLOOR)
+    {
+        ent->no_fix_skeletal_parts = BODY_PART_LEGS_1 | BODY_PART_LEGS_2 | BODY_PART_LEGS_3;
+    }
+
+    if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
+    }
+    else if(state->dead == 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
+    else if((next_fc.floor_hit.normale[2] >= ent->character->critical_slant_z_component) && (ent->character->state.step_z == 0x01))
+    {
+        /*
+         * climb up
+         */
+        ent->dir_flag = ENT_STAY;
+        i = Anim_GetAnimDispatchCase(ss_anim, 2);
+        if(i == 1)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_UP_STEP_RIGHT, 0);
+            pos[2] = curr_fc->floor_hit.point[2];
+            ent->move_type = MOVE_ON_FLOOR;
+            ent->dir_flag = ENT_MOVE_FORWARD;
+        }
+        else
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_UP_STEP_LEFT, 0);
+            pos[2] = curr_fc->floor_hit.point[2];
+            ent->move_type = MOVE_ON_FLOOR;
+            ent->dir_flag = ENT_MOVE_FORWARD;
+        }
+    }
+    else if((next_fc.floor_hit.normale[2] >= ent->character->critical_slant_z_component) && (ent->character->state.step_z == 0x02))
+    {
+        /*
+         * climb down
+         */
+        ent->dir_flag = ENT_STAY;
+        i = Anim_GetAnimDispatchCase(ss_anim, 2);
+        if(i == 1)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_DOWN_RIGHT, 0);
+            pos[2] = curr_fc->floor_hit.point[2];
+            ent->move_type = MOVE_ON_FLOOR;
+            ent->dir_flag = ENT_MOVE_FORWARD;
+        }
+        else //if(i == 0)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_DOWN_LEFT, 0);
+            pos[2] = curr_fc->floor_hit.point[2];
+            ent->move_type = MOVE_ON_FLOOR;
             ent->dir_flag = ENT_MOVE_FORWARD;
+        }
+    }
+    else if(state->wall_collide || low_vertical_space ||
+            (i < CHARACTER_STEP_DOWN_BIG || i > CHARACTER_STEP_UP_BIG) ||
+            (next_fc.floor_hit.normale[2] < ent->character->critical_slant_z_component))
+    {
+        // too high else if slide
+        ent->dir_flag = ENT_STAY;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
+    }
+    else if(cmd->move[0] != 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
+    else if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
+    {
+        ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
+    }
+    else if(cmd->move[0] == 1 && cmd->crouch == 0 && cmd->shift == 0)
+    {
+        ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
+    }
+}
 
-            if(ent->move_type == MOVE_ON_FLOOR)
-            {
-                ent->no_fix_skeletal_parts = BODY_PART_LEGS_1 | BODY_PART_LEGS_2 | BODY_PART_LEGS_3;
-            }
+static void StateControl_LaraWadeForward(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    float move[3], reaction[3];
+
+    ent->character->rotate_speed_mult = 0.4f;
+    ent->dir_flag = ENT_MOVE_FORWARD;
+    ent->move_type = MOVE_ON_FLOOR;
+
+    if(ent->character->height_info.quicksand)
+    {
+        ent->anim_linear_speed = (ent->anim_linear_speed > MAX_SPEED_QUICKSAND) ? MAX_SPEED_QUICKSAND : ent->anim_linear_speed;
+    }
+
+    if(cmd->move[0] == 1)
+    {
+        vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
+        Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER);
+    }
+
+    if(state->dead == 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
 
-            if(ent->move_type == MOVE_FREE_FALLING)
+    if(!curr_fc->floor_hit.hit || ent->move_type == MOVE_FREE_FALLING)  // free fall, next swim
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
+    }
+    else if(curr_fc->water)
+    {
+        float depth = curr_fc->transition_level - curr_fc->floor_hit.point[2];
+        if(depth <= ent->character->wade_depth)
+        {
+            // run / walk case
+            if((cmd->move[0] == 1) && (!state->wall_collide))
             {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
+                ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
             }
-            else if(state->dead == 1)
+            else
             {
                 ss_anim->target_state = TR_STATE_LARA_STOP;
             }
-            else if((next_fc.floor_hit.normale[2] >= ent->character->critical_slant_z_component) && (ent->character->state.step_z == 0x01))
-            {
-                /*
-                 * climb up
-                 */
-                ent->dir_flag = ENT_STAY;
-                i = Anim_GetAnimDispatchCase(ss_anim, 2);
-                if(i == 1)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_UP_STEP_RIGHT, 0);
-                    pos[2] = curr_fc->floor_hit.point[2];
-                    ent->move_type = MOVE_ON_FLOOR;
-                    ent->dir_flag = ENT_MOVE_FORWARD;
-                }
-                else
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_UP_STEP_LEFT, 0);
-                    pos[2] = curr_fc->floor_hit.point[2];
-                    ent->move_type = MOVE_ON_FLOOR;
-                    ent->dir_flag = ENT_MOVE_FORWARD;
-                }
-            }
-            else if((next_fc.floor_hit.normale[2] >= ent->character->critical_slant_z_component) && (ent->character->state.step_z == 0x02))
-            {
-                /*
-                 * climb down
-                 */
-                ent->dir_flag = ENT_STAY;
-                i = Anim_GetAnimDispatchCase(ss_anim, 2);
-                if(i == 1)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_DOWN_RIGHT, 0);
-                    pos[2] = curr_fc->floor_hit.point[2];
-                    ent->move_type = MOVE_ON_FLOOR;
-                    ent->dir_flag = ENT_MOVE_FORWARD;
-                }
-                else //if(i == 0)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_DOWN_LEFT, 0);
-                    pos[2] = curr_fc->floor_hit.point[2];
-                    ent->move_type = MOVE_ON_FLOOR;
-                    ent->dir_flag = ENT_MOVE_FORWARD;
-                }
-            }
-            else if(state->wall_collide || low_vertical_space ||
-                    (i < CHARACTER_STEP_DOWN_BIG || i > CHARACTER_STEP_UP_BIG) ||
-                    (next_fc.floor_hit.normale[2] < ent->character->critical_slant_z_component))
-            {
-                // too high else if slide
-                ent->dir_flag = ENT_STAY;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
-            }
-            else if(cmd->move[0] != 1)
+        }
+        else if(depth <= ent->character->height - ent->character->swim_depth)
+        {
+            // wade case
+            if((cmd->move[0] != 1) || (state->wall_collide))
             {
                 ss_anim->target_state = TR_STATE_LARA_STOP;
             }
-            else if((curr_fc->water || curr_fc->quicksand) && curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] > ent->character->wade_depth))
-            {
-                ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
-            }
-            else if(cmd->move[0] == 1 && cmd->crouch == 0 && cmd->shift == 0)
+        }
+        else
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_SWIM_FORWARD, 0);
+            ss_anim->target_state = TR_STATE_LARA_ONWATER_FORWARD;
+            ent->move_type = MOVE_ON_WATER;
+        }
+    }
+    else                                                                // no water, stay else if run / walk
+    {
+        if((cmd->move[0] == 1) && (!state->wall_collide))
+        {
+            if(!curr_fc->quicksand)
             {
                 ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
             }
-            break;
+        }
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_STOP;
+        }
+    }
+}
 
+static void StateControl_LaraWalkBack(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    int i;
+    float *pos = ent->transform.M4x4 + 12;
+    float global_offset[3];
+    height_info_t next_fc;
+    next_fc.self = ent->self;
 
-        case TR_STATE_LARA_WADE_FORWARD:
-            ent->character->rotate_speed_mult = 0.4f;
-            ent->dir_flag = ENT_MOVE_FORWARD;
-            ent->move_type = MOVE_ON_FLOOR;
+    ent->character->rotate_speed_mult = 0.4f;
+    ent->dir_flag = ENT_MOVE_BACKWARD;
 
-            if(ent->character->height_info.quicksand)
-            {
-                ent->anim_linear_speed = (ent->anim_linear_speed > MAX_SPEED_QUICKSAND) ? MAX_SPEED_QUICKSAND : ent->anim_linear_speed;
-            }
+    if(ent->character->height_info.quicksand)
+    {
+        ent->anim_linear_speed = (ent->anim_linear_speed > MAX_SPEED_QUICKSAND) ? MAX_SPEED_QUICKSAND : ent->anim_linear_speed;
+    }
 
-            if(cmd->move[0] == 1)
-            {
-                vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
-                Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER);
-            }
+    vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, -WALK_BACK_OFFSET);
+    global_offset[2] += ent->bf->bb_max[2];
+    i = Character_CheckNextStep(ent, global_offset, &next_fc);
+    if(curr_fc->water && (!curr_fc->floor_hit.hit || (curr_fc->floor_hit.point[2] + ent->character->height - ent->character->swim_depth < curr_fc->transition_level)))
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_SWIM_BACK, 0);
+        ss_anim->target_state = TR_STATE_LARA_ONWATER_BACK;
+        ent->move_type = MOVE_ON_WATER;
+    }
+    else if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
+    }
+    else if((i < CHARACTER_STEP_DOWN_BIG) || (i > CHARACTER_STEP_UP_BIG) ||
+            (next_fc.floor_hit.normale[2] < ent->character->critical_slant_z_component))
+    {
+        ent->dir_flag = ENT_STAY;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_2CLICK_END, 0);
+    }
+    else if((next_fc.floor_hit.normale[2] >= ent->character->critical_slant_z_component) && (ent->character->state.step_z == 0x02))
+    {
+        int frames_count = ss_anim->model->animations[TR_ANIMATION_LARA_WALK_DOWN_BACK_LEFT].frames_count;
+        int frames_count2 = (frames_count + 1) / 2;
+        if((ss_anim->prev_frame >= 0) && (ss_anim->prev_frame <= frames_count2))
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_DOWN_BACK_LEFT, ss_anim->prev_frame);
+            pos[2] = curr_fc->floor_hit.point[2];
+            ent->dir_flag = ENT_MOVE_BACKWARD;
+        }
+        else if((ss_anim->prev_frame >= frames_count) && (ss_anim->prev_frame <= frames_count + frames_count2))
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_DOWN_BACK_RIGHT, ss_anim->prev_frame - frames_count);
+            pos[2] = curr_fc->floor_hit.point[2];
+            ent->dir_flag = ENT_MOVE_BACKWARD;
+        }
+    }
+    else if((cmd->move[0] == -1) && ((cmd->shift) || (ent->character->height_info.quicksand)))
+    {
+        ent->dir_flag = ENT_MOVE_BACKWARD;
+        ss_anim->target_state = TR_STATE_LARA_WALK_BACK;
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
+}
 
-            if(state->dead == 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_STOP;
-            }
+static void StateControl_LaraWalkLeft(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    float *pos = ent->transform.M4x4 + 12;
+    float global_offset[3];
+    height_info_t next_fc;
+    next_fc.self = ent->self;
 
-            if(!curr_fc->floor_hit.hit || ent->move_type == MOVE_FREE_FALLING)  // free fall, next swim
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
-            }
-            else if(curr_fc->water)
-            {
-                float depth = curr_fc->transition_level - curr_fc->floor_hit.point[2];
-                if(depth <= ent->character->wade_depth)
-                {
-                    // run / walk case
-                    if((cmd->move[0] == 1) && (!state->wall_collide))
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
-                    }
-                    else
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_STOP;
-                    }
-                }
-                else if(depth <= ent->character->height - ent->character->swim_depth)
-                {
-                    // wade case
-                    if((cmd->move[0] != 1) || (state->wall_collide))
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_STOP;
-                    }
-                }
-                else
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_SWIM_FORWARD, 0);
-                    ss_anim->target_state = TR_STATE_LARA_ONWATER_FORWARD;
-                    ent->move_type = MOVE_ON_WATER;
-                }
-            }
-            else                                                                // no water, stay else if run / walk
+    cmd->rot[0] = 0;
+    ent->dir_flag = ENT_MOVE_LEFT;
+    if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
+    }
+    else if(cmd->move[1] == -1 && cmd->shift)
+    {
+        vec3_mul_scalar(global_offset, ent->transform.M4x4 + 0, -RUN_FORWARD_OFFSET);  // not an error - RUN_... more correct here
+        global_offset[2] += ent->bf->bb_max[2];
+        vec3_add(global_offset, global_offset, pos);
+        Character_ProbeHeightInfo(ent, global_offset, &next_fc);
+        if(next_fc.floor_hit.hit && (next_fc.floor_hit.point[2] > pos[2] - ent->character->max_step_up_height) && (next_fc.floor_hit.point[2] <= pos[2] + ent->character->max_step_up_height))
+        {
+            if(curr_fc->water && (!curr_fc->floor_hit.hit || (curr_fc->floor_hit.point[2] - curr_fc->transition_level > ent->character->height - ent->character->swim_depth)))
             {
-                if((cmd->move[0] == 1) && (!state->wall_collide))
-                {
-                    if(!curr_fc->quicksand)
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
-                    }
-                }
-                else
-                {
-                    ss_anim->target_state = TR_STATE_LARA_STOP;
-                }
+                ss_anim->target_state = TR_STATE_LARA_ONWATER_LEFT;
+                ss_anim->onEndFrame = ent_to_on_water;
             }
-            break;
+        }
+        else
+        {
+            ent->dir_flag = ENT_STAY;
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_SOLID, 0);
+        }
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
+}
 
-        case TR_STATE_LARA_WALK_BACK:
-            ent->character->rotate_speed_mult = 0.4f;
-            ent->dir_flag = ENT_MOVE_BACKWARD;
+static void StateControl_LaraWalkRight(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    float *pos = ent->transform.M4x4 + 12;
+    float global_offset[3];
+    height_info_t next_fc;
+    next_fc.self = ent->self;
 
-            if(ent->character->height_info.quicksand)
+    cmd->rot[0] = 0;
+    ent->dir_flag = ENT_MOVE_RIGHT;
+    if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
+    }
+    else if(cmd->move[1] == 1 && cmd->shift)
+    {
+        vec3_mul_scalar(global_offset, ent->transform.M4x4 + 0, RUN_FORWARD_OFFSET);// not an error - RUN_... more correct here
+        global_offset[2] += ent->bf->bb_max[2];
+        vec3_add(global_offset, global_offset, pos);
+        Character_ProbeHeightInfo(ent, global_offset, &next_fc);
+        if(next_fc.floor_hit.hit && (next_fc.floor_hit.point[2] > pos[2] - ent->character->max_step_up_height) && (next_fc.floor_hit.point[2] <= pos[2] + ent->character->max_step_up_height))
+        {
+            if(curr_fc->water && (!curr_fc->floor_hit.hit || (curr_fc->floor_hit.point[2] - curr_fc->transition_level > ent->character->height - ent->character->swim_depth)))
             {
-                ent->anim_linear_speed = (ent->anim_linear_speed > MAX_SPEED_QUICKSAND) ? MAX_SPEED_QUICKSAND : ent->anim_linear_speed;
+                ss_anim->target_state = TR_STATE_LARA_ONWATER_RIGHT;
+                ss_anim->onEndFrame = ent_to_on_water;
             }
+        }
+        else
+        {
+            ent->dir_flag = ENT_STAY;
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_SOLID, 0);
+        }
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
+}
 
-            vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, -WALK_BACK_OFFSET);
-            global_offset[2] += ent->bf->bb_max[2];
-            i = Character_CheckNextStep(ent, global_offset, &next_fc);
-            if(curr_fc->water && (!curr_fc->floor_hit.hit || (curr_fc->floor_hit.point[2] + ent->character->height - ent->character->swim_depth < curr_fc->transition_level)))
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_SWIM_BACK, 0);
-                ss_anim->target_state = TR_STATE_LARA_ONWATER_BACK;
-                ent->move_type = MOVE_ON_WATER;
-            }
-            else if(ent->move_type == MOVE_FREE_FALLING)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
-            }
-            else if((i < CHARACTER_STEP_DOWN_BIG) || (i > CHARACTER_STEP_UP_BIG) ||
-                    (next_fc.floor_hit.normale[2] < ent->character->critical_slant_z_component))
-            {
-                ent->dir_flag = ENT_STAY;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_2CLICK_END, 0);
-            }
-            else if((next_fc.floor_hit.normale[2] >= ent->character->critical_slant_z_component) && (ent->character->state.step_z == 0x02))
+/*
+ * Slide animations section
+ */
+static void StateControl_LaraSlideBack(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+
+    cmd->rot[0] = 0;
+    Character_Lean(ent, cmd, 0.0f);
+    ent->dir_flag = ENT_MOVE_BACKWARD;
+
+    if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        if(clean_action)
+        {
+            ent->speed[0] = -ent->transform.M4x4[4 + 0] * 128.0f;
+            ent->speed[1] = -ent->transform.M4x4[4 + 1] * 128.0f;
+            ent->transform.M4x4[12 + 0] -= ent->transform.M4x4[4 + 0] * 128.0f;    ///@HACK!
+            ent->transform.M4x4[12 + 1] -= ent->transform.M4x4[4 + 1] * 128.0f;
+        }
+
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
+    }
+    else if(!state->slide)
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
+    else if(state->slide && cmd->jump)
+    {
+        ss_anim->target_state = TR_STATE_LARA_JUMP_BACK;
+    }
+    else
+    {
+        return;
+    }
+
+    Audio_Kill(TR_AUDIO_SOUND_SLIDING, TR_AUDIO_EMITTER_ENTITY, ent->id);
+}
+
+static void StateControl_LaraSlideForward(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+
+    cmd->rot[0] = 0;
+    Character_Lean(ent, cmd, 0.0f);
+    ent->dir_flag = ENT_MOVE_FORWARD;
+
+    if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
+    }
+    else if(!state->slide)
+    {
+        if((cmd->move[0] == 1) && (World_GetVersion() >= TR_III))
+        {
+             ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
+        }
+        else
+        {
+             ss_anim->target_state = TR_STATE_LARA_STOP;                  // stop
+        }
+    }
+    else if(state->slide && cmd->jump)
+    {
+        ss_anim->target_state = TR_STATE_LARA_JUMP_FORWARD;               // jump
+    }
+    else
+    {
+        return;
+    }
+
+    Audio_Kill(TR_AUDIO_SOUND_SLIDING, TR_AUDIO_EMITTER_ENTITY, ent->id);
+}
+
+/*
+ * Misk animations
+ */
+static void StateControl_LaraPushableGrab(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+
+    ent->move_type = MOVE_ON_FLOOR;
+    ent->no_fix_all = 0x01;
+    cmd->rot[0] = 0;
+
+    if(clean_action)//If Lara is grabbing the block
+    {
+        ent->dir_flag = ENT_STAY;
+        ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;               //We hold it (loop last frame)
+        if(cmd->move[0] != 0)
+        {
+            int tf = Character_CheckTraverse(ent, ent->character->traversed_object);
+            if((cmd->move[0] == 1) && (tf & 0x01))                      //If player press up push
             {
-                int frames_count = ss_anim->model->animations[TR_ANIMATION_LARA_WALK_DOWN_BACK_LEFT].frames_count;
-                int frames_count2 = (frames_count + 1) / 2;
-                if((ss_anim->prev_frame >= 0) && (ss_anim->prev_frame <= frames_count2))
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_DOWN_BACK_LEFT, ss_anim->prev_frame);
-                    pos[2] = curr_fc->floor_hit.point[2];
-                    ent->dir_flag = ENT_MOVE_BACKWARD;
-                }
-                else if((ss_anim->prev_frame >= frames_count) && (ss_anim->prev_frame <= frames_count + frames_count2))
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WALK_DOWN_BACK_RIGHT, ss_anim->prev_frame - frames_count);
-                    pos[2] = curr_fc->floor_hit.point[2];
-                    ent->dir_flag = ENT_MOVE_BACKWARD;
-                }
+                ent->dir_flag = ENT_MOVE_FORWARD;
+                ss_anim->anim_frame_flags = ANIM_NORMAL_CONTROL;
+                ss_anim->target_state = TR_STATE_LARA_PUSHABLE_PUSH;
             }
-            else if((cmd->move[0] == -1) && ((cmd->shift) || (ent->character->height_info.quicksand)))
+            else if((cmd->move[0] == -1) && (tf & 0x02))                //If player press down pull
             {
                 ent->dir_flag = ENT_MOVE_BACKWARD;
-                ss_anim->target_state = TR_STATE_LARA_WALK_BACK;
+                ss_anim->anim_frame_flags = ANIM_NORMAL_CONTROL;
+                ss_anim->target_state = TR_STATE_LARA_PUSHABLE_PULL;
             }
-            else
+        }
+    }
+    else//Lara has let go of the block
+    {
+        ent->dir_flag = ENT_STAY;
+        ss_anim->anim_frame_flags = ANIM_NORMAL_CONTROL;                //We no longer loop last frame
+        ss_anim->target_state = TR_STATE_LARA_STOP;                       //Switch to next Lara state
+    }
+}
+
+static void StateControl_LaraPushablePush(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+    int i;
+    float t;
+
+    ent->no_fix_all = 0x01;
+    ss_anim->onEndFrame = ent_stop_traverse;
+    cmd->rot[0] = 0;
+    ent->character->cam_follow_center = 64;
+    i = ss_anim->model->animations[ss_anim->prev_animation].frames_count;
+
+    if(!clean_action || !(0x01 & Character_CheckTraverse(ent, ent->character->traversed_object)))   //For TOMB4/5 If Lara is pushing and action let go, don't push
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
+
+    if((ent->character->traversed_object != NULL) && (ss_anim->prev_frame > 16) && (ss_anim->prev_frame < i - 16)) ///@FIXME: magick 16
+    {
+        bool was_traversed = false;
+
+        if(ent->transform.M4x4[4 + 0] > 0.9)
+        {
+            t = ent->transform.M4x4[12 + 0] + (ent->bf->bb_max[1] - ent->character->traversed_object->bf->bb_min[0] - 32.0f);
+            if(t > ent->character->traversed_object->transform.M4x4[12 + 0])
             {
-                ss_anim->target_state = TR_STATE_LARA_STOP;
+                ent->character->traversed_object->transform.M4x4[12 + 0] = t;
+                was_traversed = true;
             }
-            break;
-
-        case TR_STATE_LARA_WALK_LEFT:
-            cmd->rot[0] = 0;
-            ent->dir_flag = ENT_MOVE_LEFT;
-            if(ent->move_type == MOVE_FREE_FALLING)
+        }
+        else if(ent->transform.M4x4[4 + 0] < -0.9)
+        {
+            t = ent->transform.M4x4[12 + 0] - (ent->bf->bb_max[1] + ent->character->traversed_object->bf->bb_max[0] - 32.0f);
+            if(t < ent->character->traversed_object->transform.M4x4[12 + 0])
             {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
+                ent->character->traversed_object->transform.M4x4[12 + 0] = t;
+                was_traversed = true;
             }
-            else if(cmd->move[1] == -1 && cmd->shift)
+        }
+        else if(ent->transform.M4x4[4 + 1] > 0.9)
+        {
+            t = ent->transform.M4x4[12 + 1] + (ent->bf->bb_max[1] - ent->character->traversed_object->bf->bb_min[1] - 32.0f);
+            if(t > ent->character->traversed_object->transform.M4x4[12 + 1])
             {
-                vec3_mul_scalar(global_offset, ent->transform.M4x4 + 0, -RUN_FORWARD_OFFSET);  // not an error - RUN_... more correct here
-                global_offset[2] += ent->bf->bb_max[2];
-                vec3_add(global_offset, global_offset, pos);
-                Character_GetHeightInfo(global_offset, &next_fc);
-                if(next_fc.floor_hit.hit && (next_fc.floor_hit.point[2] > pos[2] - ent->character->max_step_up_height) && (next_fc.floor_hit.point[2] <= pos[2] + ent->character->max_step_up_height))
-                {
-                    if(curr_fc->water && (!curr_fc->floor_hit.hit || (curr_fc->floor_hit.point[2] - curr_fc->transition_level > ent->character->height - ent->character->swim_depth)))
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_ONWATER_LEFT;
-                        ss_anim->onEndFrame = ent_to_on_water;
-                    }
-                }
-                else
-                {
-                    ent->dir_flag = ENT_STAY;
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_SOLID, 0);
-                }
+                ent->character->traversed_object->transform.M4x4[12 + 1] = t;
+                was_traversed = true;
             }
-            else
+        }
+        else if(ent->transform.M4x4[4 + 1] < -0.9)
+        {
+            t = ent->transform.M4x4[12 + 1] - (ent->bf->bb_max[1] + ent->character->traversed_object->bf->bb_max[1] - 32.0f);
+            if(t < ent->character->traversed_object->transform.M4x4[12 + 1])
             {
-                ss_anim->target_state = TR_STATE_LARA_STOP;
+                ent->character->traversed_object->transform.M4x4[12 + 1] = t;
+                was_traversed = true;
             }
-            break;
+        }
 
-        case TR_STATE_LARA_WALK_RIGHT:
-            cmd->rot[0] = 0;
-            ent->dir_flag = ENT_MOVE_RIGHT;
-            if(ent->move_type == MOVE_FREE_FALLING)
+        if(World_GetVersion() > TR_III)
+        {
+            if(was_traversed)
             {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
+                if(Audio_IsEffectPlaying(TR_AUDIO_SOUND_PUSHABLE,TR_AUDIO_EMITTER_ENTITY,ent->id) == -1)
+                    Audio_Send(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
             }
-            else if(cmd->move[1] == 1 && cmd->shift)
+            else
             {
-                vec3_mul_scalar(global_offset, ent->transform.M4x4 + 0, RUN_FORWARD_OFFSET);// not an error - RUN_... more correct here
-                global_offset[2] += ent->bf->bb_max[2];
-                vec3_add(global_offset, global_offset, pos);
-                Character_GetHeightInfo(global_offset, &next_fc);
-                if(next_fc.floor_hit.hit && (next_fc.floor_hit.point[2] > pos[2] - ent->character->max_step_up_height) && (next_fc.floor_hit.point[2] <= pos[2] + ent->character->max_step_up_height))
-                {
-                    if(curr_fc->water && (!curr_fc->floor_hit.hit || (curr_fc->floor_hit.point[2] - curr_fc->transition_level > ent->character->height - ent->character->swim_depth)))
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_ONWATER_RIGHT;
-                        ss_anim->onEndFrame = ent_to_on_water;
-                    }
-                }
-                else
-                {
-                    ent->dir_flag = ENT_STAY;
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_SOLID, 0);
-                }
+                Audio_Kill(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
             }
-            else
+        }
+        else
+        {
+            if( (ss_anim->prev_frame == 49)   ||
+                (ss_anim->prev_frame == 110)  ||
+                (ss_anim->prev_frame == 142)   )
             {
-                ss_anim->target_state = TR_STATE_LARA_STOP;
+                if(Audio_IsEffectPlaying(TR_AUDIO_SOUND_PUSHABLE,TR_AUDIO_EMITTER_ENTITY,ent->id) == -1)
+                    Audio_Send(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
             }
-            break;
+        }
 
-            /*
-             * Slide animations section
-             */
-        case TR_STATE_LARA_SLIDE_BACK:
-            cmd->rot[0] = 0;
-            Character_Lean(ent, cmd, 0.0f);
-            ent->dir_flag = ENT_MOVE_BACKWARD;
+        Entity_UpdateRigidBody(ent->character->traversed_object, 1);
+    }
+    else
+    {
+        if(World_GetVersion() > TR_III)
+        {
+            Audio_Kill(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
+        }
+    }
+}
 
-            if(ent->move_type == MOVE_FREE_FALLING)
-            {
-                if(clean_action)
-                {
-                    ent->speed[0] = -ent->transform.M4x4[4 + 0] * 128.0f;
-                    ent->speed[1] = -ent->transform.M4x4[4 + 1] * 128.0f;
-                    ent->transform.M4x4[12 + 0] -= ent->transform.M4x4[4 + 0] * 128.0f;    ///@HACK!
-                    ent->transform.M4x4[12 + 1] -= ent->transform.M4x4[4 + 1] * 128.0f;
-                }
+static void StateControl_LaraPushablePull(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+    int i;
+    float t;
 
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
-            }
-            else if(!state->slide)
-            {
-                ss_anim->target_state = TR_STATE_LARA_STOP;
-            }
-            else if(state->slide && cmd->jump)
-            {
-                ss_anim->target_state = TR_STATE_LARA_JUMP_BACK;
-            }
-            else
-            {
-                break;
-            }
+    ent->no_fix_all = 0x01;
+    ss_anim->onEndFrame = ent_stop_traverse;
+    cmd->rot[0] = 0;
+    ent->character->cam_follow_center = 64;
+    i = ss_anim->model->animations[ss_anim->prev_animation].frames_count;
 
-            Audio_Kill(TR_AUDIO_SOUND_SLIDING, TR_AUDIO_EMITTER_ENTITY, ent->id);
-            break;
+    if(!clean_action || !(0x02 & Character_CheckTraverse(ent, ent->character->traversed_object)))   //For TOMB4/5 If Lara is pulling and action let go, don't pull
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
 
-        case TR_STATE_LARA_SLIDE_FORWARD:
-            cmd->rot[0] = 0;
-            Character_Lean(ent, cmd, 0.0f);
-            ent->dir_flag = ENT_MOVE_FORWARD;
+    if((ent->character->traversed_object != NULL) && (ss_anim->prev_frame > 20) && (ss_anim->prev_frame < i - 16)) ///@FIXME: magick 20
+    {
+        bool was_traversed = false;
 
-            if(ent->move_type == MOVE_FREE_FALLING)
+        if(ent->transform.M4x4[4 + 0] > 0.9)
+        {
+            t = ent->transform.M4x4[12 + 0] + (ent->bf->bb_max[1] - ent->character->traversed_object->bf->bb_min[0] - 32.0f);
+            if(t < ent->character->traversed_object->transform.M4x4[12 + 0])
             {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
+                ent->character->traversed_object->transform.M4x4[12 + 0] = t;
+                was_traversed = true;
             }
-            else if(!state->slide)
+        }
+        else if(ent->transform.M4x4[4 + 0] < -0.9)
+        {
+            t = ent->transform.M4x4[12 + 0] - (ent->bf->bb_max[1] + ent->character->traversed_object->bf->bb_max[0] - 32.0f);
+            if(t > ent->character->traversed_object->transform.M4x4[12 + 0])
             {
-                if((cmd->move[0] == 1) && (World_GetVersion() >= TR_III))
-                {
-                     ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
-                }
-                else
-                {
-                     ss_anim->target_state = TR_STATE_LARA_STOP;                  // stop
-                }
+                ent->character->traversed_object->transform.M4x4[12 + 0] = t;
+                was_traversed = true;
             }
-            else if(state->slide && cmd->jump)
+        }
+        else if(ent->transform.M4x4[4 + 1] > 0.9)
+        {
+            t = ent->transform.M4x4[12 + 1] + (ent->bf->bb_max[1] - ent->character->traversed_object->bf->bb_min[1] - 32.0f);
+            if(t < ent->character->traversed_object->transform.M4x4[12 + 1])
             {
-                ss_anim->target_state = TR_STATE_LARA_JUMP_FORWARD;               // jump
+                ent->character->traversed_object->transform.M4x4[12 + 1] = t;
+                was_traversed = true;
             }
-            else
+        }
+        else if(ent->transform.M4x4[4 + 1] < -0.9)
+        {
+            t = ent->transform.M4x4[12 + 1] - (ent->bf->bb_max[1] + ent->character->traversed_object->bf->bb_max[1] - 32.0f);
+            if(t > ent->character->traversed_object->transform.M4x4[12 + 1])
             {
-                break;
+                ent->character->traversed_object->transform.M4x4[12 + 1] = t;
+                was_traversed = true;
             }
+        }
 
-            Audio_Kill(TR_AUDIO_SOUND_SLIDING, TR_AUDIO_EMITTER_ENTITY, ent->id);
-            break;
-
-            /*
-             * Misk animations
-             */
-        case TR_STATE_LARA_PUSHABLE_GRAB:
-            ent->move_type = MOVE_ON_FLOOR;
-            ent->no_fix_all = 0x01;
-            cmd->rot[0] = 0;
+        if(World_GetVersion() > TR_III)
+        {
+            if(was_traversed)
+            {
+                if(Audio_IsEffectPlaying(TR_AUDIO_SOUND_PUSHABLE,TR_AUDIO_EMITTER_ENTITY,ent->id) == -1)
 
-            if(clean_action)//If Lara is grabbing the block
+                    Audio_Send(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
+            }
+            else
             {
-                ent->dir_flag = ENT_STAY;
-                ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;               //We hold it (loop last frame)
-                if(cmd->move[0] != 0)
-                {
-                    int tf = Character_CheckTraverse(ent, ent->character->traversed_object);
-                    if((cmd->move[0] == 1) && (tf & 0x01))                      //If player press up push
-                    {
-                        ent->dir_flag = ENT_MOVE_FORWARD;
-                        ss_anim->anim_frame_flags = ANIM_NORMAL_CONTROL;
-                        ss_anim->target_state = TR_STATE_LARA_PUSHABLE_PUSH;
-                    }
-                    else if((cmd->move[0] == -1) && (tf & 0x02))                //If player press down pull
-                    {
-                        ent->dir_flag = ENT_MOVE_BACKWARD;
-                        ss_anim->anim_frame_flags = ANIM_NORMAL_CONTROL;
-                        ss_anim->target_state = TR_STATE_LARA_PUSHABLE_PULL;
-                    }
-                }
+                Audio_Kill(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
             }
-            else//Lara has let go of the block
+        }
+        else
+        {
+            if( (ss_anim->prev_frame == 40)  ||
+                (ss_anim->prev_frame == 92)  ||
+                (ss_anim->prev_frame == 124) ||
+                (ss_anim->prev_frame == 156)  )
             {
-                ent->dir_flag = ENT_STAY;
-                ss_anim->anim_frame_flags = ANIM_NORMAL_CONTROL;                //We no longer loop last frame
-                ss_anim->target_state = TR_STATE_LARA_STOP;                       //Switch to next Lara state
+                if(Audio_IsEffectPlaying(TR_AUDIO_SOUND_PUSHABLE,TR_AUDIO_EMITTER_ENTITY,ent->id) == -1)
+                    Audio_Send(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
             }
-            break;
-
-        case TR_STATE_LARA_PUSHABLE_PUSH:
-            ent->no_fix_all = 0x01;
-            ss_anim->onEndFrame = ent_stop_traverse;
-            cmd->rot[0] = 0;
-            ent->character->cam_follow_center = 64;
-            i = ss_anim->model->animations[ss_anim->prev_animation].frames_count;
+        }
 
-            if(!clean_action || !(0x01 & Character_CheckTraverse(ent, ent->character->traversed_object)))   //For TOMB4/5 If Lara is pushing and action let go, don't push
+        Entity_UpdateRigidBody(ent->character->traversed_object, 1);
+    }
+    else
+    {
+        if(World_GetVersion() > TR_III)
+        {
+            Audio_Kill(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
+        }
+    }
+}
+
+static void StateControl_LaraRollBackward(struct entity_s *ent, struct ss_animation_s * /*ss_anim*/, lara_env_p env)
+{
+    int8_t low_vertical_space = env->low_vertical_space;
+
+    if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
+    }
+    else if(low_vertical_space)
+    {
+        ent->dir_flag = ENT_STAY;
+    }
+}
+
+/*
+ * Climbing section
+ */
+static void StateControl_LaraJumpUp(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    climb_info_p climb = env->climb;
+    int clean_action = env->clean_action;
+    float t, *pos = ent->transform.M4x4 + 12;
+    float climb_from[3], climb_to[3];
+
+    cmd->rot[0] = 0;
+    ent->no_fix_all = 0x01;
+    if(clean_action && (ent->move_type != MOVE_WALLS_CLIMB) && (ent->move_type != MOVE_CLIMBING) && (ss_anim->prev_frame > 2))
+    {
+        t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE + ent->character->climb_r;
+        Character_GetMiddleHandsPos(ent, climb_from);
+        climb_from[0] -= ent->character->climb_r * ent->transform.M4x4[4 + 0];
+        climb_from[1] -= ent->character->climb_r * ent->transform.M4x4[4 + 1];
+        climb_from[2] += ent->character->climb_r + engine_frame_time * ent->speed[2];
+        climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
+        climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
+        climb_to[2] = climb_from[2] - ent->character->max_step_up_height;
+        Character_CheckClimbability(ent, climb, climb_from, climb_to);
+        if(climb->edge_hit)
+        {
+            vec3_copy(climb->point, climb->edge_point);
+            ent->transform.angles[0] = climb->edge_z_ang;
+            Entity_UpdateTransform(ent);
+            ent->move_type = MOVE_CLIMBING;                             // hang on
+            vec3_set_zero(ent->speed);
+            pos[0] = climb->point[0] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 0];
+            pos[1] = climb->point[1] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 1];
+            pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
+            return;
+        }
+        else
+        {
+            Character_CheckWallsClimbability(ent, climb);
+            if((climb->wall_hit) &&
+               (ent->speed[2] < 0.0f)) // Only hang if speed is lower than zero.
             {
-                ss_anim->target_state = TR_STATE_LARA_STOP;
+                // Fix the position to the TR metering step.
+                pos[2] = (float)((int)((pos[2]) / TR_METERING_STEP) * TR_METERING_STEP);
+                ent->move_type = MOVE_WALLS_CLIMB;
+                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_HANG_IDLE, -1);
+                return;
             }
+        }
+    }
 
-            if((ent->character->traversed_object != NULL) && (ss_anim->prev_frame > 16) && (ss_anim->prev_frame < i - 16)) ///@FIXME: magick 16
-            {
-                bool was_traversed = false;
+    if(cmd->move[0] == 1)
+    {
+        ent->dir_flag = ENT_MOVE_FORWARD;
+    }
+    else if(cmd->move[0] == -1)
+    {
+        ent->dir_flag = ENT_MOVE_BACKWARD;
+    }
+    else if(cmd->move[1] == 1)
+    {
+        ent->dir_flag = ENT_MOVE_RIGHT;
+    }
+    else if(cmd->move[1] == -1)
+    {
+        ent->dir_flag = ENT_MOVE_LEFT;
+    }
+    else
+    {
+        ent->dir_flag = ENT_STAY;
+    }
 
-                if(ent->transform.M4x4[4 + 0] > 0.9)
-                {
-                    t = ent->transform.M4x4[12 + 0] + (ent->bf->bb_max[1] - ent->character->traversed_object->bf->bb_min[0] - 32.0f);
-                    if(t > ent->character->traversed_object->transform.M4x4[12 + 0])
-                    {
-                        ent->character->traversed_object->transform.M4x4[12 + 0] = t;
-                        was_traversed = true;
-                    }
-                }
-                else if(ent->transform.M4x4[4 + 0] < -0.9)
-                {
-                    t = ent->transform.M4x4[12 + 0] - (ent->bf->bb_max[1] + ent->character->traversed_object->bf->bb_max[0] - 32.0f);
-                    if(t < ent->character->traversed_object->transform.M4x4[12 + 0])
-                    {
-                        ent->character->traversed_object->transform.M4x4[12 + 0] = t;
-                        was_traversed = true;
-                    }
-                }
-                else if(ent->transform.M4x4[4 + 1] > 0.9)
-                {
-                    t = ent->transform.M4x4[12 + 1] + (ent->bf->bb_max[1] - ent->character->traversed_object->bf->bb_min[1] - 32.0f);
-                    if(t > ent->character->traversed_object->transform.M4x4[12 + 1])
-                    {
-                        ent->character->traversed_object->transform.M4x4[12 + 1] = t;
-                        was_traversed = true;
-                    }
-                }
-                else if(ent->transform.M4x4[4 + 1] < -0.9)
-                {
-                    t = ent->transform.M4x4[12 + 1] - (ent->bf->bb_max[1] + ent->character->traversed_object->bf->bb_max[1] - 32.0f);
-                    if(t < ent->character->traversed_object->transform.M4x4[12 + 1])
-                    {
-                        ent->character->traversed_object->transform.M4x4[12 + 1] = t;
-                        was_traversed = true;
-                    }
-                }
+    if(ent->move_type == MOVE_UNDERWATER)
+    {
+        float new_tr[16];
+        Mat4_Copy(new_tr, ent->transform.M4x4);
+        vec3_sub_mul(new_tr + 12, new_tr + 12, new_tr + 4, 256.0f);
+        ent->transform.angles[1] = -45.0f;
+        Mat4_SetAnglesZXY(new_tr, ent->transform.angles);
+        cmd->rot[1] = 0.0f;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_TO_UNDERWATER, 0, new_tr);
+    }
+    else if(clean_action && (curr_fc->ceiling_climb) && (curr_fc->ceiling_hit.hit) && (pos[2] + ent->bf->bb_max[2] > curr_fc->ceiling_hit.point[2] - 64.0f))
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
+        ss_anim->onEndFrame = ent_to_monkey_swing;
+    }
+    else if(clean_action && (ent->move_type == MOVE_CLIMBING))
+    {
+        ss_anim->target_state = TR_STATE_LARA_HANG;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_HANG_IDLE, -1);
+    }
+    else if(state->floor_collide || (ent->move_type == MOVE_ON_FLOOR))
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;                       // landing immediately
+    }
+    else
+    {
+        if(ent->speed[2] < -FREE_FALL_SPEED_2)                          // next free fall stage
+        {
+            ent->move_type = MOVE_FREE_FALLING;
+            ss_anim->target_state = TR_STATE_LARA_FREEFALL;
+        }
+        return;
+    }
+}
 
-                if(World_GetVersion() > TR_III)
-                {
-                    if(was_traversed)
-                    {
-                        if(Audio_IsEffectPlaying(TR_AUDIO_SOUND_PUSHABLE,TR_AUDIO_EMITTER_ENTITY,ent->id) == -1)
-                            Audio_Send(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
-                    }
-                    else
-                    {
-                        Audio_Kill(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
-                    }
-                }
-                else
-                {
-                    if( (ss_anim->prev_frame == 49)   ||
-                        (ss_anim->prev_frame == 110)  ||
-                        (ss_anim->prev_frame == 142)   )
-                    {
-                        if(Audio_IsEffectPlaying(TR_AUDIO_SOUND_PUSHABLE,TR_AUDIO_EMITTER_ENTITY,ent->id) == -1)
-                            Audio_Send(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
-                    }
-                }
+static void StateControl_LaraReach(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    climb_info_p climb = env->climb;
+    int clean_action = env->clean_action;
+    float t, *pos = ent->transform.M4x4 + 12;
+    float climb_from[3], climb_to[3];
+
+    cmd->rot[0] = 0;
+    if(ent->move_type == MOVE_UNDERWATER)
+    {
+        float new_tr[16];
+        Mat4_Copy(new_tr, ent->transform.M4x4);
+        ent->transform.angles[1] = -45.0f;
+        Mat4_SetAnglesZXY(new_tr, ent->transform.angles);
+        cmd->rot[1] = 0.0f;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_TO_UNDERWATER, 0, new_tr);
+        return;
+    }
+
+    if(clean_action)
+    {
+        if(ent->move_type == MOVE_FREE_FALLING)
+        {
+            t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE;
+            Character_GetMiddleHandsPos(ent, climb_from);
+            climb_from[0] -= ent->character->climb_r * ent->transform.M4x4[4 + 0];
+            climb_from[1] -= ent->character->climb_r * ent->transform.M4x4[4 + 1];
+            climb_from[2] += ent->character->climb_r + engine_frame_time * ent->speed[2];
+            climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
+            climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
+            climb_to[2] = climb_from[2] - ent->character->height;
+            Character_CheckClimbability(ent, climb, climb_from, climb_to);  //global_offset, &next_fc, ent->character->height);
+            if(climb->edge_hit && climb->can_hang)
+            {
+                vec3_copy(climb->point, climb->edge_point);
+                ent->transform.angles[0] = climb->edge_z_ang;
+                Entity_UpdateTransform(ent);
+                ent->move_type = MOVE_CLIMBING;                             // hang on
+                vec3_set_zero(ent->speed);
+            }
 
-                Entity_UpdateRigidBody(ent->character->traversed_object, 1);
+            // If Lara is moving backwards off the ledge we want to move Lara slightly forwards
+            // depending on the current angle.
+            if((ent->dir_flag == ENT_MOVE_BACKWARD) && (ent->move_type == MOVE_CLIMBING))
+            {
+                pos[0] = climb->point[0] - ent->transform.M4x4[4 + 0] * (ent->character->forvard_size + 16.0f);
+                pos[1] = climb->point[1] - ent->transform.M4x4[4 + 1] * (ent->character->forvard_size + 16.0f);
             }
-            else
+        }
+        if(ent->move_type == MOVE_FREE_FALLING)
+        {
+            Character_CheckWallsClimbability(ent, climb);
+            if(climb->wall_hit)
             {
-                if(World_GetVersion() > TR_III)
-                {
-                    Audio_Kill(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
-                }
+                ent->move_type = MOVE_WALLS_CLIMB;
+                ss_anim->target_state = TR_STATE_LARA_HANG;
             }
-            break;
+        }
+        else if(ent->move_type == MOVE_WALLS_CLIMB)
+        {
+            ss_anim->target_state = TR_STATE_LARA_HANG;
+        }
+    }
 
-        case TR_STATE_LARA_PUSHABLE_PULL:
-            ent->no_fix_all = 0x01;
-            ss_anim->onEndFrame = ent_stop_traverse;
-            cmd->rot[0] = 0;
-            ent->character->cam_follow_center = 64;
-            i = ss_anim->model->animations[ss_anim->prev_animation].frames_count;
+    if(((ent->move_type != MOVE_ON_FLOOR)) && clean_action && (curr_fc->ceiling_climb) && (curr_fc->ceiling_hit.hit) && (pos[2] + ent->bf->bb_max[2] > curr_fc->ceiling_hit.point[2] - 64.0f))
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
+        ss_anim->onEndFrame = ent_to_monkey_swing;
+        return;
+    }
+    if((state->floor_collide || (ent->move_type == MOVE_ON_FLOOR)) && (!clean_action || (climb->can_hang == 0)))
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;                       // middle landing
+        return;
+    }
+
+    if((ent->speed[2] < -FREE_FALL_SPEED_2))
+    {
+        ent->move_type = MOVE_FREE_FALLING;
+        ss_anim->target_state = TR_STATE_LARA_FREEFALL;
+        return;
+    }
+
+    if(ent->move_type == MOVE_CLIMBING)
+    {
+        vec3_set_zero(ent->speed);
+        ss_anim->target_state = TR_STATE_LARA_HANG;
+#if OSCILLATE_HANG_USE
+        vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
+        if(Entity_CheckNextPenetration(ent, cmd, move) == 0)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_OSCILLATE_HANG_ON, 0);
+            ent_to_edge_climb(ent);
+        }
+#endif
+    }
+}
+
+/*other code here prevents to UGLY Lara's move in end of "climb on", do not loose ent_set_on_floor_after_climb callback here!*/
+static void StateControl_LaraGrabbing(struct entity_s *ent, struct ss_animation_s * /*ss_anim*/, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+
+    cmd->rot[0] = 0;
+    ent->no_fix_all = 0x01;
+}
+
+static void StateControl_LaraHang(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    climb_info_p climb = env->climb;
+    int clean_action = env->clean_action;
+    float t, *pos = ent->transform.M4x4 + 12;
+    float move[3], climb_from[3], climb_to[3], reaction[3];
 
-            if(!clean_action || !(0x02 & Character_CheckTraverse(ent, ent->character->traversed_object)))   //For TOMB4/5 If Lara is pulling and action let go, don't pull
+    cmd->rot[0] = 0;
+
+    if(ent->move_type == MOVE_WALLS_CLIMB)
+    {
+        if(clean_action)
+        {
+            if((climb->wall_hit == 0x02) && (cmd->move[0] == 0) && (cmd->move[1] == 0))
             {
-                ss_anim->target_state = TR_STATE_LARA_STOP;
+                ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
             }
-
-            if((ent->character->traversed_object != NULL) && (ss_anim->prev_frame > 20) && (ss_anim->prev_frame < i - 16)) ///@FIXME: magick 20
+            else if(climb->wall_hit == 0x00)
             {
-                bool was_traversed = false;
-
-                if(ent->transform.M4x4[4 + 0] > 0.9)
-                {
-                    t = ent->transform.M4x4[12 + 0] + (ent->bf->bb_max[1] - ent->character->traversed_object->bf->bb_min[0] - 32.0f);
-                    if(t < ent->character->traversed_object->transform.M4x4[12 + 0])
-                    {
-                        ent->character->traversed_object->transform.M4x4[12 + 0] = t;
-                        was_traversed = true;
-                    }
-                }
-                else if(ent->transform.M4x4[4 + 0] < -0.9)
+                if(climb->can_hang)
                 {
-                    t = ent->transform.M4x4[12 + 0] - (ent->bf->bb_max[1] + ent->character->traversed_object->bf->bb_max[0] - 32.0f);
-                    if(t > ent->character->traversed_object->transform.M4x4[12 + 0])
-                    {
-                        ent->character->traversed_object->transform.M4x4[12 + 0] = t;
-                        was_traversed = true;
-                    }
+                    ent->move_type = MOVE_CLIMBING;
                 }
-                else if(ent->transform.M4x4[4 + 1] > 0.9)
+                else
                 {
-                    t = ent->transform.M4x4[12 + 1] + (ent->bf->bb_max[1] - ent->character->traversed_object->bf->bb_min[1] - 32.0f);
-                    if(t < ent->character->traversed_object->transform.M4x4[12 + 1])
-                    {
-                        ent->character->traversed_object->transform.M4x4[12 + 1] = t;
-                        was_traversed = true;
-                    }
+                    ent->move_type = MOVE_FREE_FALLING;
                 }
-                else if(ent->transform.M4x4[4 + 1] < -0.9)
+            }
+            else if(cmd->move[0] == 1)             // UP
+            {
+                ent->dir_flag = ENT_MOVE_FORWARD;
+                if(ss_anim->prev_animation != TR_ANIMATION_LARA_LADDER_UP_HANDS)
                 {
-                    t = ent->transform.M4x4[12 + 1] - (ent->bf->bb_max[1] + ent->character->traversed_object->bf->bb_max[1] - 32.0f);
-                    if(t > ent->character->traversed_object->transform.M4x4[12 + 1])
+                    if(climb->edge_hit && (climb->next_z_space >= 512.0f - LARA_HANG_VERTICAL_EPSILON) && ((climb->next_z_space < ent->character->height - LARA_HANG_VERTICAL_EPSILON) || cmd->crouch))
                     {
-                        ent->character->traversed_object->transform.M4x4[12 + 1] = t;
-                        was_traversed = true;
+                        vec3_copy(climb->point, climb->edge_point);
+                        ss_anim->target_state = TR_STATE_LARA_CLIMB_TO_CRAWL;     // crawlspace climb
+                        ent->move_type = MOVE_CLIMBING;
                     }
-                }
-
-                if(World_GetVersion() > TR_III)
-                {
-                    if(was_traversed)
+                    else if(climb->edge_hit && (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON))
                     {
-                        if(Audio_IsEffectPlaying(TR_AUDIO_SOUND_PUSHABLE,TR_AUDIO_EMITTER_ENTITY,ent->id) == -1)
-
-                            Audio_Send(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
+                        vec3_copy(climb->point, climb->edge_point);
+                        ss_anim->target_state = (cmd->shift) ? (TR_STATE_LARA_HANDSTAND) : (TR_STATE_LARA_GRABBING);               // climb up
+                        ent->move_type = MOVE_CLIMBING;
                     }
                     else
                     {
-                        Audio_Kill(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
-                    }
-                }
-                else
-                {
-                    if( (ss_anim->prev_frame == 40)  ||
-                        (ss_anim->prev_frame == 92)  ||
-                        (ss_anim->prev_frame == 124) ||
-                        (ss_anim->prev_frame == 156)  )
-                    {
-                        if(Audio_IsEffectPlaying(TR_AUDIO_SOUND_PUSHABLE,TR_AUDIO_EMITTER_ENTITY,ent->id) == -1)
-                            Audio_Send(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
+                        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LADDER_UP_HANDS, 0);
                     }
                 }
-
-                Entity_UpdateRigidBody(ent->character->traversed_object, 1);
-            }
-            else
-            {
-                if(World_GetVersion() > TR_III)
-                {
-                    Audio_Kill(TR_AUDIO_SOUND_PUSHABLE, TR_AUDIO_EMITTER_ENTITY, ent->id);
-                }
-            }
-            break;
-
-        case TR_STATE_LARA_ROLL_FORWARD:
-            break;
-
-        case TR_STATE_LARA_ROLL_BACKWARD:
-            if(ent->move_type == MOVE_FREE_FALLING)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
             }
-            else if(low_vertical_space)
+            else if(cmd->move[0] ==-1)                                  // DOWN
             {
-                ent->dir_flag = ENT_STAY;
-            }
-            break;
-
-        /*
-         * Climbing section
-         */
-        case TR_STATE_LARA_JUMP_UP:
-            cmd->rot[0] = 0;
-            ent->no_fix_all = 0x01;
-            if(clean_action && (ent->move_type != MOVE_WALLS_CLIMB) && (ent->move_type != MOVE_CLIMBING) && (ss_anim->prev_frame > 2))
-            {
-                t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE + ent->character->climb_r;
-                Character_GetMiddleHandsPos(ent, climb_from);
-                climb_from[0] -= ent->character->climb_r * ent->transform.M4x4[4 + 0];
-                climb_from[1] -= ent->character->climb_r * ent->transform.M4x4[4 + 1];
-                climb_from[2] += ent->character->climb_r + engine_frame_time * ent->speed[2];
-                climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
-                climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
-                climb_to[2] = climb_from[2] - ent->character->max_step_up_height;
-                Character_CheckClimbability(ent, climb, climb_from, climb_to);
-                if(climb->edge_hit)
+                if(ent->character->height_info.floor_hit.hit && (ent->transform.M4x4[12 + 2] < ent->character->height_info.floor_hit.point[2] + ent->character->max_step_up_height))
                 {
-                    vec3_copy(climb->point, climb->edge_point);
-                    ent->transform.angles[0] = climb->edge_z_ang;
-                    Entity_UpdateTransform(ent);
-                    ent->move_type = MOVE_CLIMBING;                             // hang on
-                    vec3_set_zero(ent->speed);
-                    pos[0] = climb->point[0] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 0];
-                    pos[1] = climb->point[1] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 1];
-                    pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
-                    break;
+                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
+                    ent->move_type = MOVE_FREE_FALLING;
+                    return;
                 }
-                else
+                ent->dir_flag = ENT_MOVE_BACKWARD;
+                if(ss_anim->prev_animation != TR_ANIMATION_LARA_LADDER_DOWN_HANDS)
                 {
-                    Character_CheckWallsClimbability(ent, climb);
-                    if((climb->wall_hit) &&
-                       (ent->speed[2] < 0.0f)) // Only hang if speed is lower than zero.
-                    {
-                        // Fix the position to the TR metering step.
-                        pos[2] = (float)((int)((pos[2]) / TR_METERING_STEP) * TR_METERING_STEP);
-                        ent->move_type = MOVE_WALLS_CLIMB;
-                        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_HANG_IDLE, -1);
-                        break;
-                    }
+                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LADDER_DOWN_HANDS, 0);
                 }
             }
-
-            if(cmd->move[0] == 1)
+            else if(cmd->move[1] == 1)
             {
-                ent->dir_flag = ENT_MOVE_FORWARD;
+                ent->dir_flag = ENT_MOVE_RIGHT;
+                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_RIGHT, 0); // edge climb right
             }
-            else if(cmd->move[0] == -1)
+            else if(cmd->move[1] ==-1)
             {
-                ent->dir_flag = ENT_MOVE_BACKWARD;
+                ent->dir_flag = ENT_MOVE_LEFT;
+                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_LEFT, 0); // edge climb left
             }
-            else if(cmd->move[1] == 1)
+        }
+        else
+        {
+            vec3_set_zero(ent->speed);
+            ent->move_type = MOVE_FREE_FALLING;
+        }
+        return;
+    }
+
+    if((state->dead == 0) && clean_action)                              // we have to update climb point every time so entity can move
+    {
+        //t = LARA_TRY_HANG_WALL_OFFSET;
+        t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE;
+        Character_GetMiddleHandsPos(ent, climb_from);
+        if(climb->edge_hit && (climb->edge_point[2] > climb_from[2]))
+        {
+            climb_from[2] = climb->edge_point[2];
+        }
+        climb_from[0] -= ent->character->climb_r * ent->transform.M4x4[4 + 0];
+        climb_from[1] -= ent->character->climb_r * ent->transform.M4x4[4 + 1];
+        climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
+        climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
+        climb_to[2] = climb_from[2] - ent->character->max_step_up_height;
+        Character_CheckClimbability(ent, climb, climb_from, climb_to);
+        if(climb->can_hang)
+        {
+            vec3_copy(climb->point, climb->edge_point);
+            ent->transform.angles[0] = climb->edge_z_ang;
+            Entity_UpdateTransform(ent);
+            ent->move_type = MOVE_CLIMBING;                             // hang on
+        }
+    }
+    else
+    {
+        ent->move_type = MOVE_FREE_FALLING;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0); // fall down
+        return;
+    }
+
+    if(ent->move_type == MOVE_CLIMBING)
+    {
+        if(cmd->move[0] == 1)
+        {
+            pos[0] = climb->point[0] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 0];
+            pos[1] = climb->point[1] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 1];
+            pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
+            if(climb->edge_hit && (climb->next_z_space >= 512.0f - LARA_HANG_VERTICAL_EPSILON) && ((climb->next_z_space < ent->character->height - LARA_HANG_VERTICAL_EPSILON) || cmd->crouch))
             {
-                ent->dir_flag = ENT_MOVE_RIGHT;
+                vec3_copy(climb->point, climb->edge_point);
+                ss_anim->target_state = TR_STATE_LARA_CLIMB_TO_CRAWL;     // crawlspace climb
             }
-            else if(cmd->move[1] == -1)
+            else if(climb->edge_hit && (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON))
             {
-                ent->dir_flag = ENT_MOVE_LEFT;
+                vec3_copy(climb->point, climb->edge_point);
+                ss_anim->target_state = (cmd->shift) ? (TR_STATE_LARA_HANDSTAND) : (TR_STATE_LARA_GRABBING);               // climb up
             }
             else
             {
-                ent->dir_flag = ENT_STAY;
+                vec3_set_zero(ent->speed);
+                ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;       // disable shake
             }
-
-            if(ent->move_type == MOVE_UNDERWATER)
+        }
+        else if(cmd->move[0] ==-1)                                      // check walls climbing
+        {
+            Character_CheckWallsClimbability(ent, climb);
+            if(climb->wall_hit)
             {
-                float new_tr[16];
-                Mat4_Copy(new_tr, ent->transform.M4x4);
-                vec3_sub_mul(new_tr + 12, new_tr + 12, new_tr + 4, 256.0f);
-                ent->transform.angles[1] = -45.0f;
-                Mat4_SetAnglesZXY(new_tr, ent->transform.angles);
-                cmd->rot[1] = 0.0f;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_TO_UNDERWATER, 0, new_tr);
+                ent->move_type = MOVE_WALLS_CLIMB;
             }
-            else if(clean_action && (curr_fc->ceiling_climb) && (curr_fc->ceiling_hit.hit) && (pos[2] + ent->bf->bb_max[2] > curr_fc->ceiling_hit.point[2] - 64.0f))
+            ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;           // disable shake
+        }
+        else if(cmd->move[1] ==-1)
+        {
+            vec3_mul_scalar(move, ent->transform.M4x4 + 0, -PENETRATION_TEST_OFFSET);
+            if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide)) //we only want lara to shimmy when last frame is reached!
             {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
-                ss_anim->onEndFrame = ent_to_monkey_swing;
+                ent->dir_flag = ENT_MOVE_LEFT;
+                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_LEFT, 0);
             }
-            else if(clean_action && (ent->move_type == MOVE_CLIMBING))
+            else
             {
-                ss_anim->target_state = TR_STATE_LARA_HANG;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_HANG_IDLE, -1);
+                ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;       // disable shake
             }
-            else if(state->floor_collide || (ent->move_type == MOVE_ON_FLOOR))
+        }
+        else if(cmd->move[1] == 1)
+        {
+            vec3_mul_scalar(move, ent->transform.M4x4 + 0, PENETRATION_TEST_OFFSET);
+            if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide)) //we only want lara to shimmy when last frame is reached!
             {
-                ss_anim->target_state = TR_STATE_LARA_STOP;                       // landing immediately
+                ent->dir_flag = ENT_MOVE_RIGHT;
+                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_RIGHT, 0);
             }
             else
             {
-                if(ent->speed[2] < -FREE_FALL_SPEED_2)                          // next free fall stage
-                {
-                    ent->move_type = MOVE_FREE_FALLING;
-                    ss_anim->target_state = TR_STATE_LARA_FREEFALL;
-                }
-                break;
-            }
-            break;
-
-        case TR_STATE_LARA_REACH:
-            cmd->rot[0] = 0;
-            if(ent->move_type == MOVE_UNDERWATER)
-            {
-                float new_tr[16];
-                Mat4_Copy(new_tr, ent->transform.M4x4);
-                ent->transform.angles[1] = -45.0f;
-                Mat4_SetAnglesZXY(new_tr, ent->transform.angles);
-                cmd->rot[1] = 0.0f;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_TO_UNDERWATER, 0, new_tr);
-                break;
+                ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;       // disable shake
             }
+        }
+        else
+        {
+            ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;           // disable shake
+            pos[0] = climb->point[0] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 0];
+            pos[1] = climb->point[1] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 1];
+            pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
+            vec3_set_zero(ent->speed);
+        }
+    }
+    else if(clean_action && (curr_fc->ceiling_climb) && (curr_fc->ceiling_hit.hit) && (pos[2] + ent->bf->bb_max[2] > curr_fc->ceiling_hit.point[2] - 64.0f))
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
+        ss_anim->onEndFrame = ent_to_monkey_swing;
+    }
+    else
+    {
+        ent->move_type = MOVE_FREE_FALLING;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0); // fall down
+    }
+}
 
-            if(clean_action)
-            {
-                if(ent->move_type == MOVE_FREE_FALLING)
-                {
-                    t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE;
-                    Character_GetMiddleHandsPos(ent, climb_from);
-                    climb_from[0] -= ent->character->climb_r * ent->transform.M4x4[4 + 0];
-                    climb_from[1] -= ent->character->climb_r * ent->transform.M4x4[4 + 1];
-                    climb_from[2] += ent->character->climb_r + engine_frame_time * ent->speed[2];
-                    climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
-                    climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
-                    climb_to[2] = climb_from[2] - ent->character->height;
-                    Character_CheckClimbability(ent, climb, climb_from, climb_to);  //global_offset, &next_fc, ent->character->height);
-                    if(climb->edge_hit && climb->can_hang)
-                    {
-                        vec3_copy(climb->point, climb->edge_point);
-                        ent->transform.angles[0] = climb->edge_z_ang;
-                        Entity_UpdateTransform(ent);
-                        ent->move_type = MOVE_CLIMBING;                             // hang on
-                        vec3_set_zero(ent->speed);
-                    }
+static void StateControl_LaraZiplineRide(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    int clean_action = env->clean_action;
 
-                    // If Lara is moving backwards off the ledge we want to move Lara slightly forwards
-                    // depending on the current angle.
-                    if((ent->dir_flag == ENT_MOVE_BACKWARD) && (ent->move_type == MOVE_CLIMBING))
-                    {
-                        pos[0] = climb->point[0] - ent->transform.M4x4[4 + 0] * (ent->character->forvard_size + 16.0f);
-                        pos[1] = climb->point[1] - ent->transform.M4x4[4 + 1] * (ent->character->forvard_size + 16.0f);
-                    }
-                }
-                if(ent->move_type == MOVE_FREE_FALLING)
-                {
-                    Character_CheckWallsClimbability(ent, climb);
-                    if(climb->wall_hit)
-                    {
-                        ent->move_type = MOVE_WALLS_CLIMB;
-                        ss_anim->target_state = TR_STATE_LARA_HANG;
-                    }
-                }
-                else if(ent->move_type == MOVE_WALLS_CLIMB)
-                {
-                    ss_anim->target_state = TR_STATE_LARA_HANG;
-                }
-            }
+    ss_anim->target_state = (clean_action) ? (TR_STATE_LARA_ZIPLINE_RIDE) : (TR_STATE_LARA_JUMP_FORWARD);
+    ent->speed[2] = 0.0f;
+}
 
-            if(((ent->move_type != MOVE_ON_FLOOR)) && clean_action && (curr_fc->ceiling_climb) && (curr_fc->ceiling_hit.hit) && (pos[2] + ent->bf->bb_max[2] > curr_fc->ceiling_hit.point[2] - 64.0f))
+static void StateControl_LaraLadderIdle(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    climb_info_p climb = env->climb;
+    int clean_action = env->clean_action;
+    float *pos = ent->transform.M4x4 + 12;
+
+    cmd->rot[0] = 0;
+    ent->dir_flag = ENT_STAY;
+    ent->no_move = 0x00;
+    ent->character->cam_follow_center = 64;
+    if(ent->move_type == MOVE_CLIMBING)
+    {
+        ss_anim->target_state = TR_STATE_LARA_GRABBING;
+        return;
+    }
+    ent->move_type = MOVE_WALLS_CLIMB;
+    if(!clean_action)
+    {
+        ent->move_type = MOVE_FREE_FALLING;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STOP_HANG_VERTICAL, 0); // fall down
+    }
+    else if(cmd->jump)
+    {
+        ss_anim->target_state = TR_STATE_LARA_JUMP_BACK;
+        ent->dir_flag = ENT_MOVE_BACKWARD;
+    }
+    else if(!climb->wall_hit)
+    {
+        if(climb->edge_hit)
+        {
+            if((climb->next_z_space >= 512.0f) && (cmd->move[0] == 1))
             {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
-                ss_anim->onEndFrame = ent_to_monkey_swing;
-                break;
+                float hands_pos[3];
+                Character_GetMiddleHandsPos(ent, hands_pos);
+                pos[2] += climb->edge_point[2] - hands_pos[2];
+                ss_anim->target_state = TR_STATE_LARA_GRABBING;
             }
-            if((state->floor_collide || (ent->move_type == MOVE_ON_FLOOR)) && (!clean_action || (climb->can_hang == 0)))
+            else
             {
-                ss_anim->target_state = TR_STATE_LARA_STOP;                       // middle landing
-                break;
+                ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
             }
+        }
+        else
+        {
+            ent->move_type = MOVE_FREE_FALLING;
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STOP_HANG_VERTICAL, 0); // fall down
+        }
+    }
+    else if(cmd->move[0] == 1)
+    {
+        if(climb->edge_hit && (climb->next_z_space >= 512.0f))
+        {
+            float hands_pos[3];
+            Character_GetMiddleHandsPos(ent, hands_pos);
+            pos[2] += climb->edge_point[2] - hands_pos[2];
+            ent->move_type = MOVE_CLIMBING;
+            ss_anim->target_state = TR_STATE_LARA_GRABBING;
+        }
+        else if((!curr_fc->ceiling_hit.hit) || (pos[2] + ent->bf->bb_max[2] < curr_fc->ceiling_hit.point[2]))
+        {
+            ss_anim->target_state = TR_STATE_LARA_LADDER_UP;
+        }
+    }
+    else if(cmd->move[0] == -1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_LADDER_DOWN;
+    }
+    else if(cmd->move[1] == 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_LADDER_RIGHT;
+    }
+    else if(cmd->move[1] == -1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_LADDER_LEFT;
+    }
+}
 
-            if((ent->speed[2] < -FREE_FALL_SPEED_2))
-            {
-                ent->move_type = MOVE_FREE_FALLING;
-                ss_anim->target_state = TR_STATE_LARA_FREEFALL;
-                break;
-            }
+static void StateControl_LaraLadderLeft(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    int clean_action = env->clean_action;
 
-            if(ent->move_type == MOVE_CLIMBING)
-            {
-                vec3_set_zero(ent->speed);
-                ss_anim->target_state = TR_STATE_LARA_HANG;
-#if OSCILLATE_HANG_USE
-                vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
-                if(Entity_CheckNextPenetration(ent, cmd, move) == 0)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_OSCILLATE_HANG_ON, 0);
-                    ent_to_edge_climb(ent);
-                }
-#endif
-            }
-            break;
+    ent->dir_flag = ENT_MOVE_LEFT;
+    if(!clean_action || (ent->character->climb.wall_hit == 0))
+    {
+        ss_anim->target_state = TR_STATE_LARA_HANG;
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
+    }
+}
 
-            /*other code here prevents to UGLY Lara's move in end of "climb on", do not loose ent_set_on_floor_after_climb callback here!*/
-        case TR_STATE_LARA_HANDSTAND:
-        case TR_STATE_LARA_GRABBING:
-        case TR_STATE_LARA_CLIMB_TO_CRAWL:
-            cmd->rot[0] = 0;
-            ent->no_fix_all = 0x01;
-            break;
+static void StateControl_LaraLadderRight(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    int clean_action = env->clean_action;
 
-        case TR_STATE_LARA_HANG:
-            cmd->rot[0] = 0;
+    ent->dir_flag = ENT_MOVE_RIGHT;
+    if(!clean_action || (ent->character->climb.wall_hit == 0))
+    {
+        ss_anim->target_state = TR_STATE_LARA_HANG;
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
+    }
+}
 
-            if(ent->move_type == MOVE_WALLS_CLIMB)
-            {
-                if(clean_action)
-                {
-                    if((climb->wall_hit == 0x02) && (cmd->move[0] == 0) && (cmd->move[1] == 0))
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
-                    }
-                    else if(climb->wall_hit == 0x00)
-                    {
-                        if(climb->can_hang)
-                        {
-                            ent->move_type = MOVE_CLIMBING;
-                        }
-                        else
-                        {
-                            ent->move_type = MOVE_FREE_FALLING;
-                        }
-                    }
-                    else if(cmd->move[0] == 1)             // UP
-                    {
-                        ent->dir_flag = ENT_MOVE_FORWARD;
-                        if(ss_anim->prev_animation != TR_ANIMATION_LARA_LADDER_UP_HANDS)
-                        {
-                            if(climb->edge_hit && (climb->next_z_space >= 512.0f - LARA_HANG_VERTICAL_EPSILON) && ((climb->next_z_space < ent->character->height - LARA_HANG_VERTICAL_EPSILON) || cmd->crouch))
-                            {
-                                vec3_copy(climb->point, climb->edge_point);
-                                ss_anim->target_state = TR_STATE_LARA_CLIMB_TO_CRAWL;     // crawlspace climb
-                                ent->move_type = MOVE_CLIMBING;
-                            }
-                            else if(climb->edge_hit && (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON))
-                            {
-                                vec3_copy(climb->point, climb->edge_point);
-                                ss_anim->target_state = (cmd->shift) ? (TR_STATE_LARA_HANDSTAND) : (TR_STATE_LARA_GRABBING);               // climb up
-                                ent->move_type = MOVE_CLIMBING;
-                            }
-                            else
-                            {
-                                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LADDER_UP_HANDS, 0);
-                            }
-                        }
-                    }
-                    else if(cmd->move[0] ==-1)                                  // DOWN
-                    {
-                        if(ent->character->height_info.floor_hit.hit && (ent->transform.M4x4[12 + 2] < ent->character->height_info.floor_hit.point[2] + ent->character->max_step_up_height))
-                        {
-                            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
-                            ent->move_type = MOVE_FREE_FALLING;
-                            break;
-                        }
-                        ent->dir_flag = ENT_MOVE_BACKWARD;
-                        if(ss_anim->prev_animation != TR_ANIMATION_LARA_LADDER_DOWN_HANDS)
-                        {
-                            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LADDER_DOWN_HANDS, 0);
-                        }
-                    }
-                    else if(cmd->move[1] == 1)
-                    {
-                        ent->dir_flag = ENT_MOVE_RIGHT;
-                        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_RIGHT, 0); // edge climb right
-                    }
-                    else if(cmd->move[1] ==-1)
-                    {
-                        ent->dir_flag = ENT_MOVE_LEFT;
-                        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_LEFT, 0); // edge climb left
-                    }
-                }
-                else
-                {
-                    vec3_set_zero(ent->speed);
-                    ent->move_type = MOVE_FREE_FALLING;
-                }
-                break;
-            }
+static void StateControl_LaraLadderUp(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    climb_info_p climb = env->climb;
+    int clean_action = env->clean_action;
+    float *pos = ent->transform.M4x4 + 12;
+
+    ent->character->cam_follow_center = 64;
+    if((ent->move_type == MOVE_CLIMBING) || (cmd->move[0] <= 0) ||
+       ((curr_fc->ceiling_hit.hit && (pos[2] + ent->bf->bb_max[2] >= curr_fc->ceiling_hit.point[2]))))
+    {
+        ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
+        return;
+    }
 
-            if((state->dead == 0) && clean_action)                              // we have to update climb point every time so entity can move
-            {
-                //t = LARA_TRY_HANG_WALL_OFFSET;
-                t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE;
-                Character_GetMiddleHandsPos(ent, climb_from);
-                if(climb->edge_hit && (climb->edge_point[2] > climb_from[2]))
-                {
-                    climb_from[2] = climb->edge_point[2];
-                }
-                climb_from[0] -= ent->character->climb_r * ent->transform.M4x4[4 + 0];
-                climb_from[1] -= ent->character->climb_r * ent->transform.M4x4[4 + 1];
-                climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
-                climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
-                climb_to[2] = climb_from[2] - ent->character->max_step_up_height;
-                Character_CheckClimbability(ent, climb, climb_from, climb_to);
-                if(climb->can_hang)
-                {
-                    vec3_copy(climb->point, climb->edge_point);
-                    ent->transform.angles[0] = climb->edge_z_ang;
-                    Entity_UpdateTransform(ent);
-                    ent->move_type = MOVE_CLIMBING;                             // hang on
-                }
-            }
-            else
-            {
-                ent->move_type = MOVE_FREE_FALLING;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0); // fall down
-                break;
-            }
+    if(clean_action && ent->character->climb.wall_hit)
+    {
+        if(climb->edge_hit && (climb->next_z_space >= 512.0f))
+        {
+            ent->move_type = MOVE_CLIMBING;
+            ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
+        }
+    }
+    else
+    {
+        // Free fall after stop
+        ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
+    }
+}
 
-            if(ent->move_type == MOVE_CLIMBING)
-            {
-                if(cmd->move[0] == 1)
-                {
-                    pos[0] = climb->point[0] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 0];
-                    pos[1] = climb->point[1] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 1];
-                    pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
-                    if(climb->edge_hit && (climb->next_z_space >= 512.0f - LARA_HANG_VERTICAL_EPSILON) && ((climb->next_z_space < ent->character->height - LARA_HANG_VERTICAL_EPSILON) || cmd->crouch))
-                    {
-                        vec3_copy(climb->point, climb->edge_point);
-                        ss_anim->target_state = TR_STATE_LARA_CLIMB_TO_CRAWL;     // crawlspace climb
-                    }
-                    else if(climb->edge_hit && (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON))
-                    {
-                        vec3_copy(climb->point, climb->edge_point);
-                        ss_anim->target_state = (cmd->shift) ? (TR_STATE_LARA_HANDSTAND) : (TR_STATE_LARA_GRABBING);               // climb up
-                    }
-                    else
-                    {
-                        vec3_set_zero(ent->speed);
-                        ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;       // disable shake
-                    }
-                }
-                else if(cmd->move[0] ==-1)                                      // check walls climbing
-                {
-                    Character_CheckWallsClimbability(ent, climb);
-                    if(climb->wall_hit)
-                    {
-                        ent->move_type = MOVE_WALLS_CLIMB;
-                    }
-                    ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;           // disable shake
-                }
-                else if(cmd->move[1] ==-1)
-                {
-                    vec3_mul_scalar(move, ent->transform.M4x4 + 0, -PENETRATION_TEST_OFFSET);
-                    if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide)) //we only want lara to shimmy when last frame is reached!
-                    {
-                        ent->dir_flag = ENT_MOVE_LEFT;
-                        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_LEFT, 0);
-                    }
-                    else
-                    {
-                        ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;       // disable shake
-                    }
-                }
-                else if(cmd->move[1] == 1)
-                {
-                    vec3_mul_scalar(move, ent->transform.M4x4 + 0, PENETRATION_TEST_OFFSET);
-                    if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide)) //we only want lara to shimmy when last frame is reached!
-                    {
-                        ent->dir_flag = ENT_MOVE_RIGHT;
-                        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CLIMB_RIGHT, 0);
-                    }
-                    else
-                    {
-                        ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;       // disable shake
-                    }
-                }
-                else
-                {
-                    ss_anim->anim_frame_flags = ANIM_LOOP_LAST_FRAME;           // disable shake
-                    pos[0] = climb->point[0] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 0];
-                    pos[1] = climb->point[1] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 1];
-                    pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
-                    vec3_set_zero(ent->speed);
-                }
-            }
-            else if(clean_action && (curr_fc->ceiling_climb) && (curr_fc->ceiling_hit.hit) && (pos[2] + ent->bf->bb_max[2] > curr_fc->ceiling_hit.point[2] - 64.0f))
+static void StateControl_LaraLadderDown(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+
+    ent->no_move = 0x00;
+    ent->character->cam_follow_center = 64;
+    if(clean_action && ent->character->climb.wall_hit && (cmd->move[0] < 0))
+    {
+        if(ent->character->height_info.floor_hit.hit && (ent->transform.M4x4[12 + 2] < ent->character->height_info.floor_hit.point[2] + 256.0f))
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_STATE_LARA_FALL_BACKWARD, 0);
+            ent->move_type = MOVE_FREE_FALLING;
+            return;
+        }
+        if(ent->character->climb.wall_hit != 0x02)
+        {
+            ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
+        }
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
+    }
+}
+
+static void StateControl_LaraShimmyLeft(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    climb_info_p climb = env->climb;
+    int clean_action = env->clean_action;
+    float t, *pos = ent->transform.M4x4 + 12;
+    float move[3], climb_from[3], climb_to[3], reaction[3];
+
+    ent->no_fix_skeletal_parts = BODY_PART_LEGS_2 | BODY_PART_LEGS_3 | BODY_PART_HANDS_3 | BODY_PART_HEAD;
+
+    cmd->rot[0] = 0;
+    ent->dir_flag = ENT_MOVE_LEFT;
+    if(!clean_action)
+    {
+        vec3_set_zero(ent->speed);
+        ent->move_type = MOVE_FREE_FALLING;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0); // fall down
+        return;
+    }
+
+    if(ent->move_type == MOVE_WALLS_CLIMB)
+    {
+        if(!ent->character->climb.wall_hit)
+        {
+            if(ent->character->climb.edge_hit && ent->character->climb.can_hang)
             {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
-                ss_anim->onEndFrame = ent_to_monkey_swing;
+                ent->move_type = MOVE_CLIMBING;
             }
             else
             {
                 ent->move_type = MOVE_FREE_FALLING;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0); // fall down
+                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STOP_HANG_VERTICAL, 0); // fall down
             }
-            break;
+        }
+    }
+    else
+    {
+        t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE;
+        Character_GetMiddleHandsPos(ent, climb_from);
+        if(climb->edge_hit && (climb->edge_point[2] > climb_from[2]))
+        {
+            climb_from[2] = climb->edge_point[2];
+        }
+        climb_from[0] -= ent->character->climb_r * ent->transform.M4x4[4 + 0];
+        climb_from[1] -= ent->character->climb_r * ent->transform.M4x4[4 + 1];
+        climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
+        climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
+        climb_to[2] = climb_from[2] - ent->character->max_step_up_height;
+        Character_CheckClimbability(ent, climb, climb_from, climb_to);
+        if(climb->edge_hit)
+        {
+            vec3_copy(climb->point, climb->edge_point);
+            ent->transform.angles[0] = climb->edge_z_ang;
+            Entity_UpdateTransform(ent);
+            ent->move_type = MOVE_CLIMBING;                             // hang on
+            pos[0] = climb->point[0] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 0];
+            pos[1] = climb->point[1] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 1];
+            pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
+            vec3_set_zero(ent->speed);
+        }
+        else
+        {
+            ent->move_type = MOVE_FREE_FALLING;
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STOP_HANG_VERTICAL, 0); // fall down
+            return;
+        }
+    }
 
-        case TR_STATE_LARA_ZIPLINE_RIDE:
-            ss_anim->target_state = (clean_action) ? (TR_STATE_LARA_ZIPLINE_RIDE) : (TR_STATE_LARA_JUMP_FORWARD);
-            ent->speed[2] = 0.0f;
-            break;
+    if(cmd->move[1] ==-1)
+    {
+        vec3_mul_scalar(move, ent->transform.M4x4 + 0, -PENETRATION_TEST_OFFSET);
+        if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) > 0) && state->wall_collide)
+        {
+            ss_anim->target_state = TR_STATE_LARA_HANG;
+        }
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_HANG;
+    }
+}
 
-        case TR_STATE_LARA_LADDER_IDLE:
-            cmd->rot[0] = 0;
-            ent->dir_flag = ENT_STAY;
-            ent->no_move = 0x00;
-            ent->character->cam_follow_center = 64;
-            if(ent->move_type == MOVE_CLIMBING)
+static void StateControl_LaraShimmyRight(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    climb_info_p climb = env->climb;
+    int clean_action = env->clean_action;
+    float t, *pos = ent->transform.M4x4 + 12;
+    float move[3], climb_from[3], climb_to[3], reaction[3];
+
+    ent->no_fix_skeletal_parts = BODY_PART_LEGS_2 | BODY_PART_LEGS_3 | BODY_PART_HANDS_3 | BODY_PART_HEAD;
+
+    cmd->rot[0] = 0;
+    ent->dir_flag = ENT_MOVE_RIGHT;
+    if(!clean_action)
+    {
+        vec3_set_zero(ent->speed);
+        ent->move_type = MOVE_FREE_FALLING;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0); // fall down
+        return;
+    }
+
+    if(ent->move_type == MOVE_WALLS_CLIMB)
+    {
+        if(!ent->character->climb.wall_hit)
+        {
+            if(ent->character->climb.edge_hit && ent->character->climb.can_hang)
             {
-                ss_anim->target_state = TR_STATE_LARA_GRABBING;
-                break;
+                ent->move_type = MOVE_CLIMBING;
             }
-            ent->move_type = MOVE_WALLS_CLIMB;
-            if(!clean_action)
+            else
             {
                 ent->move_type = MOVE_FREE_FALLING;
                 Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STOP_HANG_VERTICAL, 0); // fall down
             }
-            else if(cmd->jump)
-            {
-                ss_anim->target_state = TR_STATE_LARA_JUMP_BACK;
-                ent->dir_flag = ENT_MOVE_BACKWARD;
-            }
-            else if(!climb->wall_hit)
-            {
-                if(climb->edge_hit)
-                {
-                    if((climb->next_z_space >= 512.0f) && (cmd->move[0] == 1))
-                    {
-                        float hands_pos[3];
-                        Character_GetMiddleHandsPos(ent, hands_pos);
-                        pos[2] += climb->edge_point[2] - hands_pos[2];
-                        ss_anim->target_state = TR_STATE_LARA_GRABBING;
-                    }
-                    else
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
-                    }
-                }
-                else
-                {
-                    ent->move_type = MOVE_FREE_FALLING;
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STOP_HANG_VERTICAL, 0); // fall down
-                }
-            }
-            else if(cmd->move[0] == 1)
-            {
-                if(climb->edge_hit && (climb->next_z_space >= 512.0f))
-                {
-                    float hands_pos[3];
-                    Character_GetMiddleHandsPos(ent, hands_pos);
-                    pos[2] += climb->edge_point[2] - hands_pos[2];
-                    ent->move_type = MOVE_CLIMBING;
-                    ss_anim->target_state = TR_STATE_LARA_GRABBING;
-                }
-                else if((!curr_fc->ceiling_hit.hit) || (pos[2] + ent->bf->bb_max[2] < curr_fc->ceiling_hit.point[2]))
-                {
-                    ss_anim->target_state = TR_STATE_LARA_LADDER_UP;
-                }
-            }
-            else if(cmd->move[0] == -1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_LADDER_DOWN;
-            }
-            else if(cmd->move[1] == 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_LADDER_RIGHT;
-            }
-            else if(cmd->move[1] == -1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_LADDER_LEFT;
-            }
-            break;
-
-        case TR_STATE_LARA_LADDER_LEFT:
-            ent->dir_flag = ENT_MOVE_LEFT;
-            if(!clean_action || (ent->character->climb.wall_hit == 0))
-            {
-                ss_anim->target_state = TR_STATE_LARA_HANG;
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
-            }
-            break;
-
-        case TR_STATE_LARA_LADDER_RIGHT:
-            ent->dir_flag = ENT_MOVE_RIGHT;
-            if(!clean_action || (ent->character->climb.wall_hit == 0))
-            {
-                ss_anim->target_state = TR_STATE_LARA_HANG;
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
-            }
-            break;
-
-        case TR_STATE_LARA_LADDER_UP:
-            ent->character->cam_follow_center = 64;
-            if((ent->move_type == MOVE_CLIMBING) || (cmd->move[0] <= 0) ||
-               ((curr_fc->ceiling_hit.hit && (pos[2] + ent->bf->bb_max[2] >= curr_fc->ceiling_hit.point[2]))))
-            {
-                ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
-                break;
-            }
-
-            if(clean_action && ent->character->climb.wall_hit)
-            {
-                if(climb->edge_hit && (climb->next_z_space >= 512.0f))
-                {
-                    ent->move_type = MOVE_CLIMBING;
-                    ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
-                }
-            }
-            else
-            {
-                // Free fall after stop
-                ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
-            }
-            break;
-
-        case TR_STATE_LARA_LADDER_DOWN:
-            ent->no_move = 0x00;
-            ent->character->cam_follow_center = 64;
-            if(clean_action && ent->character->climb.wall_hit && (cmd->move[0] < 0))
-            {
-                if(ent->character->height_info.floor_hit.hit && (ent->transform.M4x4[12 + 2] < ent->character->height_info.floor_hit.point[2] + 256.0f))
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_STATE_LARA_FALL_BACKWARD, 0);
-                    ent->move_type = MOVE_FREE_FALLING;
-                    break;
-                }
-                if(ent->character->climb.wall_hit != 0x02)
-                {
-                    ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
-                }
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_LADDER_IDLE;
-            }
-            break;
+        }
+    }
+    else
+    {
+        t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE;
+        Character_GetMiddleHandsPos(ent, climb_from);
+        if(climb->edge_hit && (climb->edge_point[2] > climb_from[2]))
+        {
+            climb_from[2] = climb->edge_point[2];
+        }
+        climb_from[0] -= ent->character->climb_r * ent->transform.M4x4[4 + 0];
+        climb_from[1] -= ent->character->climb_r * ent->transform.M4x4[4 + 1];
+        climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
+        climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
+        climb_to[2] = climb_from[2] - ent->character->max_step_up_height;
+        Character_CheckClimbability(ent, climb, climb_from, climb_to);
+        if(climb->edge_hit)
+        {
+            vec3_copy(climb->point, climb->edge_point);
+            ent->transform.angles[0] = climb->edge_z_ang;
+            Entity_UpdateTransform(ent);
+            ent->move_type = MOVE_CLIMBING;                             // hang on
+            pos[0] = climb->point[0] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 0];
+            pos[1] = climb->point[1] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 1];
+            pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
+            vec3_set_zero(ent->speed);
+        }
+        else
+        {
+            ent->move_type = MOVE_FREE_FALLING;
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STOP_HANG_VERTICAL, 0); // fall down
+            return;
+        }
+    }
 
-        case TR_STATE_LARA_SHIMMY_LEFT:
-            ent->no_fix_skeletal_parts = BODY_PART_LEGS_2 | BODY_PART_LEGS_3 | BODY_PART_HANDS_3 | BODY_PART_HEAD;
+    if(cmd->move[1] == 1)
+    {
+        vec3_mul_scalar(move, ent->transform.M4x4 + 0, PENETRATION_TEST_OFFSET);
+        if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) > 0) && state->wall_collide)
+        {
+            ss_anim->target_state = TR_STATE_LARA_HANG;
+        }
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_HANG;
+    }
+}
 
-            cmd->rot[0] = 0;
-            ent->dir_flag = ENT_MOVE_LEFT;
-            if(!clean_action)
-            {
-                vec3_set_zero(ent->speed);
-                ent->move_type = MOVE_FREE_FALLING;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0); // fall down
-                break;
-            }
+static void StateControl_LaraJumpForward(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+    uint16_t current_state = env->current_state;
 
-            if(ent->move_type == MOVE_WALLS_CLIMB)
-            {
-                if(!ent->character->climb.wall_hit)
-                {
-                    if(ent->character->climb.edge_hit && ent->character->climb.can_hang)
-                    {
-                        ent->move_type = MOVE_CLIMBING;
-                    }
-                    else
-                    {
-                        ent->move_type = MOVE_FREE_FALLING;
-                        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STOP_HANG_VERTICAL, 0); // fall down
-                    }
-                }
-            }
-            else
-            {
-                t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE;
-                Character_GetMiddleHandsPos(ent, climb_from);
-                if(climb->edge_hit && (climb->edge_point[2] > climb_from[2]))
-                {
-                    climb_from[2] = climb->edge_point[2];
-                }
-                climb_from[0] -= ent->character->climb_r * ent->transform.M4x4[4 + 0];
-                climb_from[1] -= ent->character->climb_r * ent->transform.M4x4[4 + 1];
-                climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
-                climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
-                climb_to[2] = climb_from[2] - ent->character->max_step_up_height;
-                Character_CheckClimbability(ent, climb, climb_from, climb_to);
-                if(climb->edge_hit)
-                {
-                    vec3_copy(climb->point, climb->edge_point);
-                    ent->transform.angles[0] = climb->edge_z_ang;
-                    Entity_UpdateTransform(ent);
-                    ent->move_type = MOVE_CLIMBING;                             // hang on
-                    pos[0] = climb->point[0] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 0];
-                    pos[1] = climb->point[1] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 1];
-                    pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
-                    vec3_set_zero(ent->speed);
-                }
-                else
-                {
-                    ent->move_type = MOVE_FREE_FALLING;
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STOP_HANG_VERTICAL, 0); // fall down
-                    break;
-                }
-            }
+    ent->no_fix_skeletal_parts = BODY_PART_LEGS_1 | BODY_PART_LEGS_2 | BODY_PART_LEGS_3;
+    Character_Lean(ent, cmd, 4.0f);
 
-            if(cmd->move[1] ==-1)
-            {
-                vec3_mul_scalar(move, ent->transform.M4x4 + 0, -PENETRATION_TEST_OFFSET);
-                if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) > 0) && state->wall_collide)
-                {
-                    ss_anim->target_state = TR_STATE_LARA_HANG;
-                }
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_HANG;
-            }
-            break;
+    if(state->floor_collide || (ent->move_type == MOVE_ON_FLOOR))
+    {
+        if((cmd->move[0] == 1) && (current_state == TR_STATE_LARA_JUMP_FORWARD))
+        {
+            ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
+        }
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_STOP;
+        }
+        ent->move_type = MOVE_ON_FLOOR;
+    }
+    else if(ent->move_type == MOVE_UNDERWATER)
+    {
+        float new_tr[16];
+        Mat4_Copy(new_tr, ent->transform.M4x4);
+        vec3_sub_mul(new_tr + 12, new_tr + 12, new_tr + 4, 256.0f);
+        ent->transform.angles[1] = -45.0f;
+        Mat4_SetAnglesZXY(new_tr, ent->transform.angles);
+        cmd->rot[1] = 0.0f;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_TO_UNDERWATER, 0, new_tr);
+    }
+    else if(state->wall_collide)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SMASH_JUMP, 0);
+        ent->dir_flag = ENT_MOVE_BACKWARD;
+        Character_UpdateCurrentSpeed(ent, 1);
+    }
+    else if(ent->speed[2] <= -FREE_FALL_SPEED_2)
+    {
+        ss_anim->target_state = TR_STATE_LARA_FREEFALL;                    // free falling
+    }
+    else if(clean_action)
+    {
+        ss_anim->target_state = TR_STATE_LARA_REACH;
+    }
+    else if(cmd->shift && !ent->character->state.weapon_ready)
+    {
+        ss_anim->target_state = TR_STATE_LARA_SWANDIVE_BEGIN;             // fly like fish
+    }
+    else if(ent->speed[2] <= -FREE_FALL_SPEED_2)
+    {
+        ss_anim->target_state = TR_STATE_LARA_FREEFALL;                   // free falling
+    }
+    else if(cmd->roll)
+    {
+        ss_anim->target_state = TR_STATE_LARA_JUMP_ROLL;
+    }
+}
 
-        case TR_STATE_LARA_SHIMMY_RIGHT:
-            ent->no_fix_skeletal_parts = BODY_PART_LEGS_2 | BODY_PART_LEGS_3 | BODY_PART_HANDS_3 | BODY_PART_HEAD;
+/*
+ * FREE FALL TO UNDERWATER CASES
+ */
+static void StateControl_LaraFreefall(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
 
-            cmd->rot[0] = 0;
-            ent->dir_flag = ENT_MOVE_RIGHT;
-            if(!clean_action)
-            {
-                vec3_set_zero(ent->speed);
-                ent->move_type = MOVE_FREE_FALLING;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0); // fall down
-                break;
-            }
+    Character_Lean(ent, cmd, 1.0f);
 
-            if(ent->move_type == MOVE_WALLS_CLIMB)
-            {
-                if(!ent->character->climb.wall_hit)
-                {
-                    if(ent->character->climb.edge_hit && ent->character->climb.can_hang)
-                    {
-                        ent->move_type = MOVE_CLIMBING;
-                    }
-                    else
-                    {
-                        ent->move_type = MOVE_FREE_FALLING;
-                        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STOP_HANG_VERTICAL, 0); // fall down
-                    }
-                }
-            }
-            else
-            {
-                t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE;
-                Character_GetMiddleHandsPos(ent, climb_from);
-                if(climb->edge_hit && (climb->edge_point[2] > climb_from[2]))
-                {
-                    climb_from[2] = climb->edge_point[2];
-                }
-                climb_from[0] -= ent->character->climb_r * ent->transform.M4x4[4 + 0];
-                climb_from[1] -= ent->character->climb_r * ent->transform.M4x4[4 + 1];
-                climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
-                climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
-                climb_to[2] = climb_from[2] - ent->character->max_step_up_height;
-                Character_CheckClimbability(ent, climb, climb_from, climb_to);
-                if(climb->edge_hit)
-                {
-                    vec3_copy(climb->point, climb->edge_point);
-                    ent->transform.angles[0] = climb->edge_z_ang;
-                    Entity_UpdateTransform(ent);
-                    ent->move_type = MOVE_CLIMBING;                             // hang on
-                    pos[0] = climb->point[0] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 0];
-                    pos[1] = climb->point[1] - (LARA_HANG_WALL_DISTANCE) * ent->transform.M4x4[4 + 1];
-                    pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
-                    vec3_set_zero(ent->speed);
-                }
-                else
-                {
-                    ent->move_type = MOVE_FREE_FALLING;
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STOP_HANG_VERTICAL, 0); // fall down
-                    break;
-                }
-            }
+    if( (int(ent->speed[2]) <=  -FREE_FALL_SPEED_CRITICAL) &&
+        (int(ent->speed[2]) >= (-FREE_FALL_SPEED_CRITICAL-100)) )
+    {
+        ent->speed[2] = -FREE_FALL_SPEED_CRITICAL-101;
+        Audio_Send(TR_AUDIO_SOUND_LARASCREAM, TR_AUDIO_EMITTER_ENTITY, ent->id);       // Scream
+    }
+    else if(ent->speed[2] <= -FREE_FALL_SPEED_MAXSAFE)
+    {
+        //Reset these to zero so Lara is only falling downwards
+        ent->speed[0] = 0.0f;
+        ent->speed[1] = 0.0f;
+    }
 
-            if(cmd->move[1] == 1)
+    if(ent->move_type == MOVE_UNDERWATER)
+    {
+        float new_tr[16];
+        Mat4_Copy(new_tr, ent->transform.M4x4);
+        vec3_sub_mul(new_tr + 12, new_tr + 12, new_tr + 4, 256.0f);
+        ent->transform.angles[1] = -45.0f;
+        Mat4_SetAnglesZXY(new_tr, ent->transform.angles);
+        cmd->rot[1] = 0.0f;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_TO_UNDERWATER, 0, new_tr);
+        Audio_Kill(TR_AUDIO_SOUND_LARASCREAM, TR_AUDIO_EMITTER_ENTITY, ent->id);       // Stop scream
+
+        // Splash sound is hardcoded, beginning with TR3.
+        if(World_GetVersion() > TR_II)
+        {
+            Audio_Send(TR_AUDIO_SOUND_SPLASH, TR_AUDIO_EMITTER_ENTITY, ent->id);
+        }
+    }
+    else if(state->floor_collide || (ent->move_type == MOVE_ON_FLOOR))
+    {
+        if(ent->self->room->content->room_flags & TR_ROOM_FLAG_QUICKSAND)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
+            Audio_Kill(TR_AUDIO_SOUND_LARASCREAM, TR_AUDIO_EMITTER_ENTITY, ent->id);
+        }
+        else if(ent->speed[2] <= -FREE_FALL_SPEED_MAXSAFE)
+        {
+            if(!Character_ChangeParam(ent, PARAM_HEALTH, (ent->speed[2] + FREE_FALL_SPEED_MAXSAFE) / 2))
             {
-                vec3_mul_scalar(move, ent->transform.M4x4 + 0, PENETRATION_TEST_OFFSET);
-                if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) > 0) && state->wall_collide)
-                {
-                    ss_anim->target_state = TR_STATE_LARA_HANG;
-                }
+                state->dead = 1;
+                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LANDING_DEATH, 0);
+                Engine_JoyRumble(200.0, 500);
             }
             else
             {
-                ss_anim->target_state = TR_STATE_LARA_HANG;
+                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LANDING_HARD, 0);
             }
-            break;
-
-        case TR_STATE_LARA_JUMP_FORWARD:
-        case TR_STATE_LARA_FALL_BACKWARD:
-            ent->no_fix_skeletal_parts = BODY_PART_LEGS_1 | BODY_PART_LEGS_2 | BODY_PART_LEGS_3;
-            Character_Lean(ent, cmd, 4.0f);
-
-            if(state->floor_collide || (ent->move_type == MOVE_ON_FLOOR))
-            {
-                if((cmd->move[0] == 1) && (current_state == TR_STATE_LARA_JUMP_FORWARD))
-                {
-                    ss_anim->target_state = TR_STATE_LARA_RUN_FORWARD;
-                }
-                else
-                {
-                    ss_anim->target_state = TR_STATE_LARA_STOP;
-                }
-                ent->move_type = MOVE_ON_FLOOR;
-            }
-            else if(ent->move_type == MOVE_UNDERWATER)
-            {
-                float new_tr[16];
-                Mat4_Copy(new_tr, ent->transform.M4x4);
-                vec3_sub_mul(new_tr + 12, new_tr + 12, new_tr + 4, 256.0f);
-                ent->transform.angles[1] = -45.0f;
-                Mat4_SetAnglesZXY(new_tr, ent->transform.angles);
-                cmd->rot[1] = 0.0f;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_TO_UNDERWATER, 0, new_tr);
-            }
-            else if(state->wall_collide)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_SMASH_JUMP, 0);
-                ent->dir_flag = ENT_MOVE_BACKWARD;
-                Character_UpdateCurrentSpeed(ent, 1);
-            }
-            else if(ent->speed[2] <= -FREE_FALL_SPEED_2)
-            {
-                ss_anim->target_state = TR_STATE_LARA_FREEFALL;                    // free falling
-            }
-            else if(clean_action)
-            {
-                ss_anim->target_state = TR_STATE_LARA_REACH;
-            }
-            else if(cmd->shift && !ent->character->state.weapon_ready)
-            {
-                ss_anim->target_state = TR_STATE_LARA_SWANDIVE_BEGIN;             // fly like fish
-            }
-            else if(ent->speed[2] <= -FREE_FALL_SPEED_2)
-            {
-                ss_anim->target_state = TR_STATE_LARA_FREEFALL;                   // free falling
-            }
-            else if(cmd->roll)
-            {
-                ss_anim->target_state = TR_STATE_LARA_JUMP_ROLL;
-            }
-            break;
+        }
+        else if(ent->speed[2] <= -FREE_FALL_SPEED_2)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LANDING_HARD, 0);
+        }
+        else
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LANDING_MIDDLE, 0);
+        }
 
-            /*
-             * FREE FALL TO UNDERWATER CASES
-             */
-        case TR_STATE_LARA_UNDERWATER_DIVING:
-            break;
+        if(state->dead == 1)
+        {
+            ss_anim->target_state = TR_STATE_LARA_DEATH;
+            Audio_Kill(TR_AUDIO_SOUND_LARASCREAM, TR_AUDIO_EMITTER_ENTITY, ent->id);
+        }
+    }
+    else if(clean_action)
+    {
+        ent->dir_flag = ENT_MOVE_FORWARD;
+        ss_anim->target_state = TR_STATE_LARA_REACH;
+    }
+}
 
-        case TR_STATE_LARA_FREEFALL:
-            Character_Lean(ent, cmd, 1.0f);
+static void StateControl_LaraSwandiveBegin(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
 
-            if( (int(ent->speed[2]) <=  -FREE_FALL_SPEED_CRITICAL) &&
-                (int(ent->speed[2]) >= (-FREE_FALL_SPEED_CRITICAL-100)) )
-            {
-                ent->speed[2] = -FREE_FALL_SPEED_CRITICAL-101;
-                Audio_Send(TR_AUDIO_SOUND_LARASCREAM, TR_AUDIO_EMITTER_ENTITY, ent->id);       // Scream
-            }
-            else if(ent->speed[2] <= -FREE_FALL_SPEED_MAXSAFE)
-            {
-                //Reset these to zero so Lara is only falling downwards
-                ent->speed[0] = 0.0f;
-                ent->speed[1] = 0.0f;
-            }
+    ent->character->rotate_speed_mult = 0.4f;
+    if(state->floor_collide || ent->move_type == MOVE_ON_FLOOR)
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;                       // landing - roll
+    }
+    else if(ent->move_type == MOVE_UNDERWATER)
+    {
+        ss_anim->target_state = TR_STATE_LARA_UNDERWATER_DIVING;
+        ss_anim->onEndFrame = ent_correct_diving_angle;
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_SWANDIVE_END;               // next stage
+    }
+}
 
-            if(ent->move_type == MOVE_UNDERWATER)
-            {
-                float new_tr[16];
-                Mat4_Copy(new_tr, ent->transform.M4x4);
-                vec3_sub_mul(new_tr + 12, new_tr + 12, new_tr + 4, 256.0f);
-                ent->transform.angles[1] = -45.0f;
-                Mat4_SetAnglesZXY(new_tr, ent->transform.angles);
-                cmd->rot[1] = 0.0f;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_TO_UNDERWATER, 0, new_tr);
-                Audio_Kill(TR_AUDIO_SOUND_LARASCREAM, TR_AUDIO_EMITTER_ENTITY, ent->id);       // Stop scream
+static void StateControl_LaraSwandiveEnd(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
 
-                // Splash sound is hardcoded, beginning with TR3.
-                if(World_GetVersion() > TR_II)
-                {
-                    Audio_Send(TR_AUDIO_SOUND_SPLASH, TR_AUDIO_EMITTER_ENTITY, ent->id);
-                }
-            }
-            else if(state->floor_collide || (ent->move_type == MOVE_ON_FLOOR))
-            {
-                if(ent->self->room->content->room_flags & TR_ROOM_FLAG_QUICKSAND)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_STAY_IDLE, 0);
-                    Audio_Kill(TR_AUDIO_SOUND_LARASCREAM, TR_AUDIO_EMITTER_ENTITY, ent->id);
-                }
-                else if(ent->speed[2] <= -FREE_FALL_SPEED_MAXSAFE)
-                {
-                    if(!Character_ChangeParam(ent, PARAM_HEALTH, (ent->speed[2] + FREE_FALL_SPEED_MAXSAFE) / 2))
-                    {
-                        state->dead = 1;
-                        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LANDING_DEATH, 0);
-                        Engine_JoyRumble(200.0, 500);
-                    }
-                    else
-                    {
-                        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LANDING_HARD, 0);
-                    }
-                }
-                else if(ent->speed[2] <= -FREE_FALL_SPEED_2)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LANDING_HARD, 0);
-                }
-                else
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LANDING_MIDDLE, 0);
-                }
+    cmd->rot[0] = 0;
 
-                if(state->dead == 1)
-                {
-                    ss_anim->target_state = TR_STATE_LARA_DEATH;
-                    Audio_Kill(TR_AUDIO_SOUND_LARASCREAM, TR_AUDIO_EMITTER_ENTITY, ent->id);
-                }
-            }
-            else if(clean_action)
-            {
-                ent->dir_flag = ENT_MOVE_FORWARD;
-                ss_anim->target_state = TR_STATE_LARA_REACH;
-            }
-            break;
+    //Reset these to zero so Lara is only falling downwards
+    ent->speed[0] = 0.0f;
+    ent->speed[1] = 0.0f;
 
-        case TR_STATE_LARA_SWANDIVE_BEGIN:
-            ent->character->rotate_speed_mult = 0.4f;
-            if(state->floor_collide || ent->move_type == MOVE_ON_FLOOR)
-            {
-                ss_anim->target_state = TR_STATE_LARA_STOP;                       // landing - roll
-            }
-            else if(ent->move_type == MOVE_UNDERWATER)
-            {
-                ss_anim->target_state = TR_STATE_LARA_UNDERWATER_DIVING;
-                ss_anim->onEndFrame = ent_correct_diving_angle;
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_SWANDIVE_END;               // next stage
-            }
-            break;
+    if(state->floor_collide || (ent->move_type == MOVE_ON_FLOOR))
+    {
+        if(curr_fc->quicksand)
+        {
+            state->dead = 1;
+            Character_SetParam(ent, PARAM_HEALTH, 0.0f);
+            Character_SetParam(ent, PARAM_AIR, 0.0f);
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LANDING_DEATH, -1);
+        }
+        else
+        {
+            Character_SetParam(ent, PARAM_HEALTH, 0.0f);
+            ss_anim->target_state = TR_STATE_LARA_DEATH;
+        }
+    }
+    else if(ent->move_type == MOVE_UNDERWATER)
+    {
+        ss_anim->target_state = TR_STATE_LARA_UNDERWATER_DIVING;
+        ss_anim->onEndFrame = ent_correct_diving_angle;
+    }
+    else if(cmd->jump)
+    {
+        ss_anim->target_state = TR_STATE_LARA_JUMP_ROLL;
+    }
+}
 
-        case TR_STATE_LARA_SWANDIVE_END:
-            cmd->rot[0] = 0;
+/*
+ * WATER ANIMATIONS
+ */
+static void StateControl_LaraUnderwaterStop(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
 
-            //Reset these to zero so Lara is only falling downwards
-            ent->speed[0] = 0.0f;
-            ent->speed[1] = 0.0f;
+    if(ent->move_type != MOVE_UNDERWATER && ent->move_type != MOVE_ON_WATER)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, 0, 0);
+    }
+    else if(state->dead == 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_WATER_DEATH;
+    }
+    else if(cmd->roll)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_ROLL_BEGIN, 0);
+    }
+    else if(cmd->jump)
+    {
+        ss_anim->target_state = TR_STATE_LARA_UNDERWATER_FORWARD;
+    }
+}
 
-            if(state->floor_collide || (ent->move_type == MOVE_ON_FLOOR))
-            {
-                if(curr_fc->quicksand)
-                {
-                    state->dead = 1;
-                    Character_SetParam(ent, PARAM_HEALTH, 0.0f);
-                    Character_SetParam(ent, PARAM_AIR, 0.0f);
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_LANDING_DEATH, -1);
-                }
-                else
-                {
-                    Character_SetParam(ent, PARAM_HEALTH, 0.0f);
-                    ss_anim->target_state = TR_STATE_LARA_DEATH;
-                }
-            }
-            else if(ent->move_type == MOVE_UNDERWATER)
-            {
-                ss_anim->target_state = TR_STATE_LARA_UNDERWATER_DIVING;
-                ss_anim->onEndFrame = ent_correct_diving_angle;
-            }
-            else if(cmd->jump)
-            {
-                ss_anim->target_state = TR_STATE_LARA_JUMP_ROLL;
-            }
-            break;
+static void StateControl_LaraWaterDeath(struct entity_s *ent, struct ss_animation_s * /*ss_anim*/, lara_env_p /*env*/)
+{
+    float *pos = ent->transform.M4x4 + 12;
 
-            /*
-             * WATER ANIMATIONS
-             */
-        case TR_STATE_LARA_UNDERWATER_STOP:
-            if(ent->move_type != MOVE_UNDERWATER && ent->move_type != MOVE_ON_WATER)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, 0, 0);
-            }
-            else if(state->dead == 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_WATER_DEATH;
-            }
-            else if(cmd->roll)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_ROLL_BEGIN, 0);
-            }
-            else if(cmd->jump)
-            {
-                ss_anim->target_state = TR_STATE_LARA_UNDERWATER_FORWARD;
-            }
-            break;
+    if(ent->move_type != MOVE_ON_WATER)
+    {
+        pos[2] += TR_METERING_STEP * engine_frame_time;                 // go to the air
+    }
+}
 
-        case TR_STATE_LARA_WATER_DEATH:
-            if(ent->move_type != MOVE_ON_WATER)
-            {
-                pos[2] += TR_METERING_STEP * engine_frame_time;                 // go to the air
-            }
-            break;
+static void StateControl_LaraUnderwaterForward(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
 
+    if(ent->move_type != MOVE_UNDERWATER && ent->move_type != MOVE_ON_WATER)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, 0, 0);
+    }
+    else if(state->dead == 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_WATER_DEATH;
+    }
+    else if(curr_fc->floor_hit.hit && curr_fc->water && (curr_fc->transition_level - curr_fc->floor_hit.point[2] <= ent->character->max_step_up_height))
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_TO_WADE, 0); // go to the air
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+        vec3_copy(ent->character->climb.point, curr_fc->floor_hit.point);   ///@FIXME: without it Lara are pulled high up, but this string was not been here.
+        ent->move_type = MOVE_ON_FLOOR;
+    }
+    else if(cmd->roll)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_ROLL_BEGIN, 0);
+    }
+    else if(cmd->jump)
+    {
+        if(ent->move_type == MOVE_ON_WATER)
+        {
+            ent->linear_speed = 0.0f;
+            ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_TO_ONWATER, 0); // go to the air
+        }
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_UNDERWATER_INERTIA;
+    }
+}
 
-        case TR_STATE_LARA_UNDERWATER_FORWARD:
-            if(ent->move_type != MOVE_UNDERWATER && ent->move_type != MOVE_ON_WATER)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, 0, 0);
-            }
-            else if(state->dead == 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_WATER_DEATH;
-            }
-            else if(curr_fc->floor_hit.hit && curr_fc->water && (curr_fc->transition_level - curr_fc->floor_hit.point[2] <= ent->character->max_step_up_height))
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_TO_WADE, 0); // go to the air
-                ss_anim->target_state = TR_STATE_LARA_STOP;
-                vec3_copy(ent->character->climb.point, curr_fc->floor_hit.point);   ///@FIXME: without it Lara are pulled high up, but this string was not been here.
-                ent->move_type = MOVE_ON_FLOOR;
-            }
-            else if(cmd->roll)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_ROLL_BEGIN, 0);
-            }
-            else if(cmd->jump)
-            {
-                if(ent->move_type == MOVE_ON_WATER)
-                {
-                    ent->linear_speed = 0.0f;
-                    ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_TO_ONWATER, 0); // go to the air
-                }
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_UNDERWATER_INERTIA;
-            }
-            break;
+static void StateControl_LaraUnderwaterInertia(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
 
-        case TR_STATE_LARA_UNDERWATER_INERTIA:
-            if(ent->move_type == MOVE_ON_WATER)
-            {
-                ent->linear_speed = 0.0f;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_TO_ONWATER, 0); // go to the air
-            }
-            else if(state->dead == 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_WATER_DEATH;
-            }
-            else if(cmd->roll)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_ROLL_BEGIN, 0);
-            }
-            else if(cmd->jump)
-            {
-                ss_anim->target_state = TR_STATE_LARA_UNDERWATER_FORWARD;
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_UNDERWATER_STOP;
-            }
-            break;
+    if(ent->move_type == MOVE_ON_WATER)
+    {
+        ent->linear_speed = 0.0f;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_TO_ONWATER, 0); // go to the air
+    }
+    else if(state->dead == 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_WATER_DEATH;
+    }
+    else if(cmd->roll)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_UNDERWATER_ROLL_BEGIN, 0);
+    }
+    else if(cmd->jump)
+    {
+        ss_anim->target_state = TR_STATE_LARA_UNDERWATER_FORWARD;
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_UNDERWATER_STOP;
+    }
+}
 
-        case TR_STATE_LARA_ONWATER_STOP:
-            if(state->uw_current)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_DIVE_ALTERNATE, 0);
-                ent->move_type = MOVE_UNDERWATER;
-                break;
-            }
+static void StateControl_LaraOnwaterStop(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    climb_info_p climb = env->climb;
+    int clean_action = env->clean_action;
+    int8_t low_vertical_space = env->low_vertical_space;
+    float t, *pos = ent->transform.M4x4 + 12;
+    float climb_from[3], climb_to[3];
 
-            if(clean_action && (cmd->move[0] == 1) && (ent->move_type != MOVE_CLIMBING))
-            {
-                t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE;
-                climb_from[0] = pos[0];
-                climb_from[1] = pos[1];
-                climb_from[2] = curr_fc->transition_level + TR_METERING_STEP;
-                climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
-                climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
-                climb_to[2] = climb_from[2] - ent->character->max_step_up_height - TR_METERING_STEP;
-                Character_CheckClimbability(ent, climb, climb_from, climb_to);
-                low_vertical_space = climb->edge_hit && climb->edge_point[2] <= curr_fc->transition_level;
-                if(climb->edge_hit && (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON))
-                {
-                    ent->anim_linear_speed = 0.0f;
-                    ent->linear_speed = 0.0f;
-                    ent->dir_flag = ENT_STAY;
-                    ent->move_type = MOVE_CLIMBING;
-                    ent->transform.angles[0] = climb->edge_z_ang;
-                    Entity_UpdateTransform(ent);
-                    vec3_copy(climb->point, climb->edge_point);
-                }
-            }
+    if(state->uw_current)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_DIVE_ALTERNATE, 0);
+        ent->move_type = MOVE_UNDERWATER;
+        return;
+    }
 
-            if(ent->move_type == MOVE_CLIMBING)
-            {
-                ent->anim_linear_speed = 0.0f;
-                ent->linear_speed = 0.0f;
-                vec3_set_zero(ent->speed);
-                cmd->rot[0] = 0;
-                if(low_vertical_space)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_TO_LAND_LOW, 0);
-                }
-                else
-                {
-                    ss_anim->target_state = TR_STATE_LARA_STOP;
-                }
-            }
-            else if(state->dead == 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_WATER_DEATH;
-            }
-            else if((cmd->move[0] == 1) || cmd->jump)                           // dive works correct only after TR_STATE_LARA_ONWATER_FORWARD
-            {
-                ent->dir_flag = ENT_MOVE_FORWARD;
-                ss_anim->target_state = TR_STATE_LARA_ONWATER_FORWARD;
-            }
-            else if(cmd->move[0] ==-1)
-            {
-                ent->dir_flag = ENT_MOVE_BACKWARD;
-                ss_anim->target_state = TR_STATE_LARA_ONWATER_BACK;
-            }
-            else if(cmd->move[1] ==-1)
-            {
-                if(cmd->shift)
-                {
-                    ent->dir_flag = ENT_MOVE_LEFT;
-                    cmd->rot[0] = 0;
-                    ss_anim->target_state = TR_STATE_LARA_ONWATER_LEFT;
-                }
-                else
-                {
-                    // rotate on water
-                }
-            }
-            else if(cmd->move[1] == 1)
-            {
-                if(cmd->shift)
-                {
-                    ent->dir_flag = ENT_MOVE_RIGHT;
-                    cmd->rot[0] = 0;
-                    ss_anim->target_state = TR_STATE_LARA_ONWATER_RIGHT;
-                }
-                else
-                {
-                    // rotate on water
-                }
-            }
-            else if(ent->move_type == MOVE_UNDERWATER)
-            {
-                ent->move_type = MOVE_ON_WATER;
-            }
-            break;
+    if(clean_action && (cmd->move[0] == 1) && (ent->move_type != MOVE_CLIMBING))
+    {
+        t = LARA_TRY_HANG_WALL_OFFSET + LARA_HANG_WALL_DISTANCE;
+        climb_from[0] = pos[0];
+        climb_from[1] = pos[1];
+        climb_from[2] = curr_fc->transition_level + TR_METERING_STEP;
+        climb_to[0] = climb_from[0] + t * ent->transform.M4x4[4 + 0];
+        climb_to[1] = climb_from[1] + t * ent->transform.M4x4[4 + 1];
+        climb_to[2] = climb_from[2] - ent->character->max_step_up_height - TR_METERING_STEP;
+        Character_CheckClimbability(ent, climb, climb_from, climb_to);
+        low_vertical_space = climb->edge_hit && climb->edge_point[2] <= curr_fc->transition_level;
+        if(climb->edge_hit && (climb->next_z_space >= ent->character->height - LARA_HANG_VERTICAL_EPSILON))
+        {
+            ent->anim_linear_speed = 0.0f;
+            ent->linear_speed = 0.0f;
+            ent->dir_flag = ENT_STAY;
+            ent->move_type = MOVE_CLIMBING;
+            ent->transform.angles[0] = climb->edge_z_ang;
+            Entity_UpdateTransform(ent);
+            vec3_copy(climb->point, climb->edge_point);
+        }
+    }
 
-        case TR_STATE_LARA_ONWATER_EXIT:
-            ent->no_move = 0x01;
+    if(ent->move_type == MOVE_CLIMBING)
+    {
+        ent->anim_linear_speed = 0.0f;
+        ent->linear_speed = 0.0f;
+        vec3_set_zero(ent->speed);
+        cmd->rot[0] = 0;
+        if(low_vertical_space)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_TO_LAND_LOW, 0);
+        }
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_STOP;
+        }
+    }
+    else if(state->dead == 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_WATER_DEATH;
+    }
+    else if((cmd->move[0] == 1) || cmd->jump)                           // dive works correct only after TR_STATE_LARA_ONWATER_FORWARD
+    {
+        ent->dir_flag = ENT_MOVE_FORWARD;
+        ss_anim->target_state = TR_STATE_LARA_ONWATER_FORWARD;
+    }
+    else if(cmd->move[0] ==-1)
+    {
+        ent->dir_flag = ENT_MOVE_BACKWARD;
+        ss_anim->target_state = TR_STATE_LARA_ONWATER_BACK;
+    }
+    else if(cmd->move[1] ==-1)
+    {
+        if(cmd->shift)
+        {
+            ent->dir_flag = ENT_MOVE_LEFT;
             cmd->rot[0] = 0;
-            pos[0] = climb->point[0] + ent->transform.M4x4[4 + 0] * 48.0f;
-            pos[1] = climb->point[1] + ent->transform.M4x4[4 + 1] * 48.0f;
-            pos[2] = climb->point[2];
-            break;
+            ss_anim->target_state = TR_STATE_LARA_ONWATER_LEFT;
+        }
+        else
+        {
+            // rotate on water
+        }
+    }
+    else if(cmd->move[1] == 1)
+    {
+        if(cmd->shift)
+        {
+            ent->dir_flag = ENT_MOVE_RIGHT;
+            cmd->rot[0] = 0;
+            ss_anim->target_state = TR_STATE_LARA_ONWATER_RIGHT;
+        }
+        else
+        {
+            // rotate on water
+        }
+    }
+    else if(ent->move_type == MOVE_UNDERWATER)
+    {
+        ent->move_type = MOVE_ON_WATER;
+    }
+}
 
-        case TR_STATE_LARA_ONWATER_FORWARD:
-            if(state->uw_current)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_DIVE_ALTERNATE, 0);
-                ent->move_type = MOVE_UNDERWATER;
-                break;
-            }
+static void StateControl_LaraOnwaterExit(struct entity_s *ent, struct ss_animation_s * /*ss_anim*/, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    climb_info_p climb = env->climb;
+    float *pos = ent->transform.M4x4 + 12;
+
+    ent->no_move = 0x01;
+    cmd->rot[0] = 0;
+    pos[0] = climb->point[0] + ent->transform.M4x4[4 + 0] * 48.0f;
+    pos[1] = climb->point[1] + ent->transform.M4x4[4 + 1] * 48.0f;
+    pos[2] = climb->point[2];
+}
 
-            if(state->dead)
-            {
-                ss_anim->target_state = TR_STATE_LARA_WATER_DEATH;
-            }
-            else if(cmd->jump)
-            {
-                t = pos[2];
-                Character_GetHeightInfo(pos, &next_fc);
-                pos[2] = t;
-                ss_anim->target_state = TR_STATE_LARA_UNDERWATER_FORWARD;
-                ss_anim->onEndFrame = ent_set_underwater;                       // dive
-            }
-            else if(curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] < ent->character->height - ent->character->swim_depth))
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WADE, 0);
-                ent->move_type = MOVE_ON_FLOOR;
-                //ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
-                //ss_anim->onEndFrame = ent_set_on_floor;
-            }
-            else if((cmd->move[0] == 1) && !clean_action)
-            {
-                ss_anim->target_state = current_state;
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
-            }
-            break;
+static void StateControl_LaraOnwaterForward(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    int clean_action = env->clean_action;
+    uint16_t current_state = env->current_state;
+    float t, *pos = ent->transform.M4x4 + 12;
+    height_info_t next_fc;
+    next_fc.self = ent->self;
 
-        case TR_STATE_LARA_ONWATER_BACK:
-            if(state->uw_current)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_DIVE_ALTERNATE, 0);
-                ent->move_type = MOVE_UNDERWATER;
-                break;
-            }
+    if(state->uw_current)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_DIVE_ALTERNATE, 0);
+        ent->move_type = MOVE_UNDERWATER;
+        return;
+    }
 
-            if(cmd->move[0] == -1 && cmd->jump == 0)
-            {
-                if(!curr_fc->floor_hit.hit || (curr_fc->floor_hit.point[2] + ent->character->height < curr_fc->transition_level))
-                {
-                    //ent->current_state = TR_STATE_CURRENT;                      // continue swimming
-                }
-                else
-                {
-                    ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
-                }
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
-            }
-            break;
+    if(state->dead)
+    {
+        ss_anim->target_state = TR_STATE_LARA_WATER_DEATH;
+    }
+    else if(cmd->jump)
+    {
+        t = pos[2];
+        Character_ProbeHeightInfo(ent, pos, &next_fc);
+        pos[2] = t;
+        ss_anim->target_state = TR_STATE_LARA_UNDERWATER_FORWARD;
+        ss_anim->onEndFrame = ent_set_underwater;                       // dive
+    }
+    else if(curr_fc->floor_hit.hit && (curr_fc->transition_level - curr_fc->floor_hit.point[2] < ent->character->height - ent->character->swim_depth))
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_WADE, 0);
+        ent->move_type = MOVE_ON_FLOOR;
+        //ss_anim->target_state = TR_STATE_LARA_WADE_FORWARD;
+        //ss_anim->onEndFrame = ent_set_on_floor;
+    }
+    else if((cmd->move[0] == 1) && !clean_action)
+    {
+        ss_anim->target_state = current_state;
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
+    }
+}
 
-        case TR_STATE_LARA_ONWATER_LEFT:
-            if(state->uw_current)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_DIVE_ALTERNATE, 0);
-                ent->move_type = MOVE_UNDERWATER;
-                break;
-            }
+static void StateControl_LaraOnwaterBack(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
 
-            cmd->rot[0] = 0;
-            if(cmd->jump == 0)
-            {
-                if(cmd->move[1] ==-1 && cmd->shift)
-                {
-                    if(!curr_fc->floor_hit.hit || (pos[2] - ent->character->height > curr_fc->floor_hit.point[2]))
-                    {
-                        // walk left
-                        ss_anim->target_state = TR_STATE_LARA_ONWATER_LEFT;
-                    }
-                    else
-                    {
-                        // walk left
-                        ss_anim->target_state = TR_STATE_LARA_WALK_LEFT;
-                        ss_anim->onEndFrame = ent_set_on_floor;
-                    }
-                }
-                else
-                {
-                    ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
-                }
-            }
-            else
-            {
-                ss_anim->target_state = TR_STATE_LARA_UNDERWATER_DIVING;
-            }
-            break;
+    if(state->uw_current)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_DIVE_ALTERNATE, 0);
+        ent->move_type = MOVE_UNDERWATER;
+        return;
+    }
 
-        case TR_STATE_LARA_ONWATER_RIGHT:
-            if(state->uw_current)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_DIVE_ALTERNATE, 0);
-                ent->move_type = MOVE_UNDERWATER;
-                break;
-            }
+    if(cmd->move[0] == -1 && cmd->jump == 0)
+    {
+        if(!curr_fc->floor_hit.hit || (curr_fc->floor_hit.point[2] + ent->character->height < curr_fc->transition_level))
+        {
+            //ent->current_state = TR_STATE_CURRENT;                      // continue swimming
+        }
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
+        }
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
+    }
+}
 
-            cmd->rot[0] = 0;
-            if(cmd->jump == 0)
+static void StateControl_LaraOnwaterLeft(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    float *pos = ent->transform.M4x4 + 12;
+
+    if(state->uw_current)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_DIVE_ALTERNATE, 0);
+        ent->move_type = MOVE_UNDERWATER;
+        return;
+    }
+
+    cmd->rot[0] = 0;
+    if(cmd->jump == 0)
+    {
+        if(cmd->move[1] ==-1 && cmd->shift)
+        {
+            if(!curr_fc->floor_hit.hit || (pos[2] - ent->character->height > curr_fc->floor_hit.point[2]))
             {
-                if(cmd->move[1] == 1 && cmd->shift)
-                {
-                    if(!curr_fc->floor_hit.hit || (pos[2] - ent->character->height > curr_fc->floor_hit.point[2]))
-                    {
-                        // swim RIGHT
-                        ss_anim->target_state = TR_STATE_LARA_ONWATER_RIGHT;
-                    }
-                    else
-                    {
-                        // walk left
-                        ss_anim->target_state = TR_STATE_LARA_WALK_RIGHT;
-                        ss_anim->onEndFrame = ent_set_on_floor;
-                    }
-                }
-                else
-                {
-                    ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
-                }
+                // walk left
+                ss_anim->target_state = TR_STATE_LARA_ONWATER_LEFT;
             }
             else
             {
-                ss_anim->target_state = TR_STATE_LARA_UNDERWATER_DIVING;
+                // walk left
+                ss_anim->target_state = TR_STATE_LARA_WALK_LEFT;
+                ss_anim->onEndFrame = ent_set_on_floor;
             }
-            break;
+        }
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
+        }
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_UNDERWATER_DIVING;
+    }
+}
 
-            /*
-             * CROUCH SECTION
-             */
-        case TR_STATE_LARA_CROUCH_IDLE:
-            state->crouch = 0x01;
-            ent->dir_flag = ENT_MOVE_FORWARD;
-            ent->no_fix_skeletal_parts = BODY_PART_HANDS | BODY_PART_LEGS;
-            move[0] = pos[0];
-            move[1] = pos[1];
-            move[2] = pos[2] + 0.5 * (ent->bf->bb_max[2] - ent->bf->bb_min[2]);
-            Character_GetHeightInfo(move, &next_fc);
+static void StateControl_LaraOnwaterRight(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    float *pos = ent->transform.M4x4 + 12;
 
-            Character_Lean(ent, cmd, 0.0f);
+    if(state->uw_current)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_ONWATER_DIVE_ALTERNATE, 0);
+        ent->move_type = MOVE_UNDERWATER;
+        return;
+    }
 
-            if((cmd->crouch == 0) && !low_vertical_space)
-            {
-                ss_anim->target_state = TR_STATE_LARA_STOP;                       // Back to stand
-            }
-            else if(!state->weapon_ready && ((cmd->move[0] != 0) || (state->dead == 1)))
-            {
-                ss_anim->target_state = TR_STATE_LARA_CRAWL_IDLE;                 // Both forward & back provoke crawl stage
-            }
-            else if(!state->weapon_ready && cmd->jump)
+    cmd->rot[0] = 0;
+    if(cmd->jump == 0)
+    {
+        if(cmd->move[1] == 1 && cmd->shift)
+        {
+            if(!curr_fc->floor_hit.hit || (pos[2] - ent->character->height > curr_fc->floor_hit.point[2]))
             {
-                ss_anim->target_state = TR_STATE_LARA_CROUCH_ROLL;                // Crouch roll
+                // swim RIGHT
+                ss_anim->target_state = TR_STATE_LARA_ONWATER_RIGHT;
             }
             else
             {
-                if(World_GetVersion() > TR_III)
-                {
-                    if(cmd->move[1] == 1)
-                    {
-                        ent->dir_flag = ENT_MOVE_FORWARD;
-                        ss_anim->target_state = TR_STATE_LARA_CROUCH_TURN_RIGHT;
-                    }
-                    else if(cmd->move[1] == -1)
-                    {
-                        ent->dir_flag = ENT_MOVE_FORWARD;
-                        ss_anim->target_state = TR_STATE_LARA_CROUCH_TURN_LEFT;
-                    }
-                }
-                else
-                {
-                    cmd->rot[0] = 0;
-                }
+                // walk left
+                ss_anim->target_state = TR_STATE_LARA_WALK_RIGHT;
+                ss_anim->onEndFrame = ent_set_on_floor;
             }
-            break;
+        }
+        else
+        {
+            ss_anim->target_state = TR_STATE_LARA_ONWATER_STOP;
+        }
+    }
+    else
+    {
+        ss_anim->target_state = TR_STATE_LARA_UNDERWATER_DIVING;
+    }
+}
 
-        case TR_STATE_LARA_CROUCH_ROLL:
-        case TR_STATE_LARA_SPRINT_ROLL:
-            state->crouch = 0x01;
-            state->sprint = 0x01;
-            cmd->rot[0] = 0;
-            Character_Lean(ent, cmd, 0.0f);
-            if(ent->move_type == MOVE_FREE_FALLING)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
-            }
+/*
+ * CROUCH SECTION
+ */
+static void StateControl_LaraCrouchIdle(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    int8_t low_vertical_space = env->low_vertical_space;
+    float *pos = ent->transform.M4x4 + 12;
+    float move[3];
+    height_info_t next_fc;
+    next_fc.self = ent->self;
 
-            vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
-            if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) > 0) && state->wall_collide)  // Smash into wall
-            {
-                ss_anim->target_state = TR_STATE_LARA_STOP;
-            }
-            break;
+    state->crouch = 0x01;
+    ent->dir_flag = ENT_MOVE_FORWARD;
+    ent->no_fix_skeletal_parts = BODY_PART_HANDS | BODY_PART_LEGS;
+    move[0] = pos[0];
+    move[1] = pos[1];
+    move[2] = pos[2] + 0.5 * (ent->bf->bb_max[2] - ent->bf->bb_min[2]);
+    Character_ProbeHeightInfo(ent, move, &next_fc);
 
-        case TR_STATE_LARA_CRAWL_IDLE:
-            state->crouch = 0x01;
-            ent->dir_flag = ENT_MOVE_FORWARD;
-            ent->no_fix_skeletal_parts = BODY_PART_HANDS | BODY_PART_LEGS;
-            if(state->dead == 1)
-            {
-                ent->dir_flag = ENT_STAY;
-                ss_anim->target_state = TR_STATE_LARA_DEATH;
-            }
-            else if(cmd->move[1] == -1)
+    Character_Lean(ent, cmd, 0.0f);
+
+    if((cmd->crouch == 0) && !low_vertical_space)
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;                       // Back to stand
+    }
+    else if(!state->weapon_ready && ((cmd->move[0] != 0) || (state->dead == 1)))
+    {
+        ss_anim->target_state = TR_STATE_LARA_CRAWL_IDLE;                 // Both forward & back provoke crawl stage
+    }
+    else if(!state->weapon_ready && cmd->jump)
+    {
+        ss_anim->target_state = TR_STATE_LARA_CROUCH_ROLL;                // Crouch roll
+    }
+    else
+    {
+        if(World_GetVersion() > TR_III)
+        {
+            if(cmd->move[1] == 1)
             {
                 ent->dir_flag = ENT_MOVE_FORWARD;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_TURN_LEFT, 0);
+                ss_anim->target_state = TR_STATE_LARA_CROUCH_TURN_RIGHT;
             }
-            else if(cmd->move[1] == 1)
+            else if(cmd->move[1] == -1)
             {
                 ent->dir_flag = ENT_MOVE_FORWARD;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_TURN_RIGHT, 0);
-            }
-            else if(cmd->move[0] == 1)
-            {
-                vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
-                if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
-                {
-                    vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, CRAWL_FORWARD_OFFSET);
-                    global_offset[2] += 0.5 * (ent->bf->bb_max[2] + ent->bf->bb_min[2]);
-                    vec3_add(global_offset, global_offset, pos);
-                    Character_GetHeightInfo(global_offset, &next_fc);
-                    if((next_fc.floor_hit.point[2] < pos[2] + ent->character->min_step_up_height) &&
-                       (next_fc.floor_hit.point[2] > pos[2] - ent->character->min_step_up_height))
-                    {
-                        ss_anim->target_state = TR_STATE_LARA_CRAWL_FORWARD;           // In TR4+, first state is crawlspace jump
-                    }
-                }
-            }
-            else if(cmd->move[0] == -1)
-            {
-                vec3_mul_scalar(move, ent->transform.M4x4 + 4, -PENETRATION_TEST_OFFSET);
-                if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
-                {
-                    vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, -CRAWL_FORWARD_OFFSET);
-                    global_offset[2] += 0.5 * (ent->bf->bb_max[2] + ent->bf->bb_min[2]);
-                    vec3_add(global_offset, global_offset, pos);
-                    Character_GetHeightInfo(global_offset, &next_fc);
-                    if((next_fc.floor_hit.point[2] < pos[2] + ent->character->min_step_up_height) &&
-                       (next_fc.floor_hit.point[2] > pos[2] - ent->character->min_step_up_height))
-                    {
-                        ent->dir_flag = ENT_MOVE_BACKWARD;
-                        ss_anim->target_state = TR_STATE_LARA_CRAWL_BACK;
-                    }
-                    else if(clean_action && (!state->wall_collide) &&
-                       (next_fc.floor_hit.point[2] < pos[2] - ent->character->height))
-                    {
-                        climb_from[0] = pos[0] + ent->transform.M4x4[4 + 0] * ent->bf->bb_min[1];
-                        climb_from[1] = pos[1] + ent->transform.M4x4[4 + 1] * ent->bf->bb_min[1];
-                        climb_from[2] = pos[2];
-                        climb_to[0] = pos[0];
-                        climb_to[1] = pos[1];
-                        climb_to[2] = pos[2] - ent->character->max_step_up_height;
-                        Character_CheckClimbability(ent, climb, climb_from, climb_to);
-                        if(climb->can_hang)
-                        {
-                            ent->transform.angles[0] = climb->edge_z_ang;
-                            ent->dir_flag = ENT_MOVE_BACKWARD;
-                            ent->move_type = MOVE_CLIMBING;
-                            vec3_copy(climb->point, climb->edge_point);
-                            ss_anim->target_state = TR_STATE_LARA_CRAWL_TO_CLIMB;
-                        }
-                    }
-                }
-            }
-            else if(!cmd->crouch)
-            {
-                ss_anim->target_state = TR_STATE_LARA_CROUCH_IDLE;                // Back to crouch.
+                ss_anim->target_state = TR_STATE_LARA_CROUCH_TURN_LEFT;
             }
-            break;
+        }
+        else
+        {
+            cmd->rot[0] = 0;
+        }
+    }
+}
 
-        case TR_STATE_LARA_CRAWL_TO_CLIMB:
-            if(ss_anim->model->animations[ss_anim->current_animation].max_frame == 1)
-            {
-                Anim_SetAnimation(ss_anim, TR_ANIMATION_LARA_HANG_IDLE, -1);
-                pos[0] = climb->point[0] - ent->transform.M4x4[4 + 0] * LARA_HANG_WALL_DISTANCE;
-                pos[1] = climb->point[1] - ent->transform.M4x4[4 + 1] * LARA_HANG_WALL_DISTANCE;
-                pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
-                SSBoneFrame_Update(ent->bf, 0.0f);
-                Entity_UpdateRigidBody(ent, 1);
-            }
-            break;
+static void StateControl_LaraCrouchRoll(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    float move[3], reaction[3];
+
+    state->crouch = 0x01;
+    state->sprint = 0x01;
+    cmd->rot[0] = 0;
+    Character_Lean(ent, cmd, 0.0f);
+    if(ent->move_type == MOVE_FREE_FALLING)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_FREE_FALL_FORWARD, 0);
+    }
 
-        case TR_STATE_LARA_CRAWL_FORWARD:
-            state->crouch = 0x01;
-            ent->dir_flag = ENT_MOVE_FORWARD;
-            ent->no_fix_skeletal_parts = BODY_PART_HANDS | BODY_PART_LEGS;
-            ent->character->rotate_speed_mult = 0.5f;
-            vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
-            if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) > 0) && state->wall_collide)
-            {
-                ent->dir_flag = ENT_STAY;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_IDLE, 0);
-                break;
-            }
+    vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
+    if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) > 0) && state->wall_collide)  // Smash into wall
+    {
+        ss_anim->target_state = TR_STATE_LARA_STOP;
+    }
+}
+
+static void StateControl_LaraCrawlIdle(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    climb_info_p climb = env->climb;
+    int clean_action = env->clean_action;
+    float *pos = ent->transform.M4x4 + 12;
+    float global_offset[3], move[3], climb_from[3], climb_to[3], reaction[3];
+    height_info_t next_fc;
+    next_fc.self = ent->self;
+
+    state->crouch = 0x01;
+    ent->dir_flag = ENT_MOVE_FORWARD;
+    ent->no_fix_skeletal_parts = BODY_PART_HANDS | BODY_PART_LEGS;
+    if(state->dead == 1)
+    {
+        ent->dir_flag = ENT_STAY;
+        ss_anim->target_state = TR_STATE_LARA_DEATH;
+    }
+    else if(cmd->move[1] == -1)
+    {
+        ent->dir_flag = ENT_MOVE_FORWARD;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_TURN_LEFT, 0);
+    }
+    else if(cmd->move[1] == 1)
+    {
+        ent->dir_flag = ENT_MOVE_FORWARD;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_TURN_RIGHT, 0);
+    }
+    else if(cmd->move[0] == 1)
+    {
+        vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
+        if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
+        {
             vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, CRAWL_FORWARD_OFFSET);
             global_offset[2] += 0.5 * (ent->bf->bb_max[2] + ent->bf->bb_min[2]);
             vec3_add(global_offset, global_offset, pos);
-            Character_GetHeightInfo(global_offset, &next_fc);
-
-            if((cmd->move[0] != 1) || (state->dead == 1))
-            {
-                ss_anim->target_state = TR_STATE_LARA_CRAWL_IDLE; // Stop
-            }
-            else if( (next_fc.floor_hit.point[2] >= pos[2] + ent->character->min_step_up_height) ||
-                     (next_fc.floor_hit.point[2] <= pos[2] - ent->character->min_step_up_height)  )
-            {
-                ent->dir_flag = ENT_STAY;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_IDLE, 0);
-            }
-            break;
-
-        case TR_STATE_LARA_CRAWL_BACK:
-            state->crouch = 0x01;
-            ent->dir_flag = ENT_MOVE_FORWARD;   // Absurd? No, Core Design.
-            ent->no_fix_skeletal_parts = BODY_PART_HANDS | BODY_PART_LEGS;
-            ent->character->rotate_speed_mult = 0.5f;
-            vec3_mul_scalar(move, ent->transform.M4x4 + 4, -PENETRATION_TEST_OFFSET);
-            if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) > 0) && state->wall_collide)
+            Character_ProbeHeightInfo(ent, global_offset, &next_fc);
+            if((next_fc.floor_hit.point[2] < pos[2] + ent->character->min_step_up_height) &&
+               (next_fc.floor_hit.point[2] > pos[2] - ent->character->min_step_up_height))
             {
-                ent->dir_flag = ENT_STAY;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_IDLE, 0);
-                break;
+                ss_anim->target_state = TR_STATE_LARA_CRAWL_FORWARD;           // In TR4+, first state is crawlspace jump
             }
+        }
+    }
+    else if(cmd->move[0] == -1)
+    {
+        vec3_mul_scalar(move, ent->transform.M4x4 + 4, -PENETRATION_TEST_OFFSET);
+        if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) == 0) || (!state->wall_collide))
+        {
             vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, -CRAWL_FORWARD_OFFSET);
             global_offset[2] += 0.5 * (ent->bf->bb_max[2] + ent->bf->bb_min[2]);
             vec3_add(global_offset, global_offset, pos);
-            Character_GetHeightInfo(global_offset, &next_fc);
-            if((cmd->move[0] != -1) || (state->dead == 1))
+            Character_ProbeHeightInfo(ent, global_offset, &next_fc);
+            if((next_fc.floor_hit.point[2] < pos[2] + ent->character->min_step_up_height) &&
+               (next_fc.floor_hit.point[2] > pos[2] - ent->character->min_step_up_height))
             {
-                ss_anim->target_state = TR_STATE_LARA_CRAWL_IDLE; // Stop
+                ent->dir_flag = ENT_MOVE_BACKWARD;
+                ss_anim->target_state = TR_STATE_LARA_CRAWL_BACK;
             }
-            else if((next_fc.floor_hit.point[2] >= pos[2] + ent->character->min_step_up_height) ||
-                    (next_fc.floor_hit.point[2] <= pos[2] - ent->character->min_step_up_height))
+            else if(clean_action && (!state->wall_collide) &&
+               (next_fc.floor_hit.point[2] < pos[2] - ent->character->height))
             {
-                ent->dir_flag = ENT_STAY;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_IDLE, 0);
+                climb_from[0] = pos[0] + ent->transform.M4x4[4 + 0] * ent->bf->bb_min[1];
+                climb_from[1] = pos[1] + ent->transform.M4x4[4 + 1] * ent->bf->bb_min[1];
+                climb_from[2] = pos[2];
+                climb_to[0] = pos[0];
+                climb_to[1] = pos[1];
+                climb_to[2] = pos[2] - ent->character->max_step_up_height;
+                Character_CheckClimbability(ent, climb, climb_from, climb_to);
+                if(climb->can_hang)
+                {
+                    ent->transform.angles[0] = climb->edge_z_ang;
+                    ent->dir_flag = ENT_MOVE_BACKWARD;
+                    ent->move_type = MOVE_CLIMBING;
+                    vec3_copy(climb->point, climb->edge_point);
+                    ss_anim->target_state = TR_STATE_LARA_CRAWL_TO_CLIMB;
+                }
             }
-            break;
+        }
+    }
+    else if(!cmd->crouch)
+    {
+        ss_anim->target_state = TR_STATE_LARA_CROUCH_IDLE;                // Back to crouch.
+    }
+}
 
-        case TR_STATE_LARA_CRAWL_TURN_LEFT:
-            state->crouch = 0x01;
-            ent->dir_flag = ENT_MOVE_FORWARD;
-            ent->no_fix_skeletal_parts = BODY_PART_HANDS_2 | BODY_PART_HANDS_3 | BODY_PART_LEGS_3;
-            ent->character->rotate_speed_mult = ((ss_anim->prev_frame > 3) && (ss_anim->prev_frame < 14)) ? (1.0f) : (0.0f);
+static void StateControl_LaraCrawlToClimb(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    climb_info_p climb = env->climb;
+    float *pos = ent->transform.M4x4 + 12;
 
-            if((cmd->move[1] != -1) || (state->dead == 1))
-            {
-                ss_anim->target_state = TR_STATE_LARA_CRAWL_IDLE; // stop
-            }
-            break;
+    if(ss_anim->model->animations[ss_anim->current_animation].max_frame == 1)
+    {
+        Anim_SetAnimation(ss_anim, TR_ANIMATION_LARA_HANG_IDLE, -1);
+        pos[0] = climb->point[0] - ent->transform.M4x4[4 + 0] * LARA_HANG_WALL_DISTANCE;
+        pos[1] = climb->point[1] - ent->transform.M4x4[4 + 1] * LARA_HANG_WALL_DISTANCE;
+        pos[2] = climb->point[2] - ent->bf->bb_max[2] + LARA_HANG_VERTICAL_OFFSET;
+        SSBoneFrame_Update(ent->bf, 0.0f);
+        Entity_UpdateRigidBody(ent, 1);
+    }
+}
 
-        case TR_STATE_LARA_CRAWL_TURN_RIGHT:
-            state->crouch = 0x01;
-            ent->dir_flag = ENT_MOVE_FORWARD;
-            ent->no_fix_skeletal_parts = BODY_PART_HANDS_2 | BODY_PART_HANDS_3 | BODY_PART_LEGS_3;
-            ent->character->rotate_speed_mult = ((ss_anim->prev_frame > 3) && (ss_anim->prev_frame < 14)) ? (1.0f) : (0.0f);
+static void StateControl_LaraCrawlForward(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    float *pos = ent->transform.M4x4 + 12;
+    float global_offset[3], move[3], reaction[3];
+    height_info_t next_fc;
+    next_fc.self = ent->self;
 
-            if((cmd->move[1] != 1) || (state->dead == 1))
-            {
-                ss_anim->target_state = TR_STATE_LARA_CRAWL_IDLE; // stop
-            }
-            break;
+    state->crouch = 0x01;
+    ent->dir_flag = ENT_MOVE_FORWARD;
+    ent->no_fix_skeletal_parts = BODY_PART_HANDS | BODY_PART_LEGS;
+    ent->character->rotate_speed_mult = 0.5f;
+    vec3_mul_scalar(move, ent->transform.M4x4 + 4, PENETRATION_TEST_OFFSET);
+    if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) > 0) && state->wall_collide)
+    {
+        ent->dir_flag = ENT_STAY;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_IDLE, 0);
+        return;
+    }
+    vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, CRAWL_FORWARD_OFFSET);
+    global_offset[2] += 0.5 * (ent->bf->bb_max[2] + ent->bf->bb_min[2]);
+    vec3_add(global_offset, global_offset, pos);
+    Character_ProbeHeightInfo(ent, global_offset, &next_fc);
 
-        case TR_STATE_LARA_CROUCH_TURN_LEFT:
-        case TR_STATE_LARA_CROUCH_TURN_RIGHT:
-            state->crouch = 0x01;
-            ent->no_fix_skeletal_parts = BODY_PART_HANDS_2 | BODY_PART_HANDS_3 | BODY_PART_LEGS_3;
-            ent->character->rotate_speed_mult = ((ss_anim->prev_frame > 3) && (ss_anim->prev_frame < 23)) ? (0.6f) : (0.0f);
+    if((cmd->move[0] != 1) || (state->dead == 1))
+    {
+        ss_anim->target_state = TR_STATE_LARA_CRAWL_IDLE; // Stop
+    }
+    else if( (next_fc.floor_hit.point[2] >= pos[2] + ent->character->min_step_up_height) ||
+             (next_fc.floor_hit.point[2] <= pos[2] - ent->character->min_step_up_height)  )
+    {
+        ent->dir_flag = ENT_STAY;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_IDLE, 0);
+    }
+}
 
-            if((cmd->move[1] == 0) || (state->dead == 1))
-            {
-                ss_anim->target_state = TR_STATE_LARA_CROUCH_IDLE;
-            }
-            break;
+static void StateControl_LaraCrawlBack(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+    float *pos = ent->transform.M4x4 + 12;
+    float global_offset[3], move[3], reaction[3];
+    height_info_t next_fc;
+    next_fc.self = ent->self;
 
-            /*
-             * CLIMB MONKEY
-             */
-        case TR_STATE_LARA_MONKEYSWING_IDLE:
-            cmd->rot[0] = 0;
+    state->crouch = 0x01;
+    ent->dir_flag = ENT_MOVE_FORWARD;   // Absurd? No, Core Design.
+    ent->no_fix_skeletal_parts = BODY_PART_HANDS | BODY_PART_LEGS;
+    ent->character->rotate_speed_mult = 0.5f;
+    vec3_mul_scalar(move, ent->transform.M4x4 + 4, -PENETRATION_TEST_OFFSET);
+    if((Entity_CheckNextPenetration(ent, NULL, move, reaction, COLLISION_FILTER_CHARACTER) > 0) && state->wall_collide)
+    {
+        ent->dir_flag = ENT_STAY;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_IDLE, 0);
+        return;
+    }
+    vec3_mul_scalar(global_offset, ent->transform.M4x4 + 4, -CRAWL_FORWARD_OFFSET);
+    global_offset[2] += 0.5 * (ent->bf->bb_max[2] + ent->bf->bb_min[2]);
+    vec3_add(global_offset, global_offset, pos);
+    Character_ProbeHeightInfo(ent, global_offset, &next_fc);
+    if((cmd->move[0] != -1) || (state->dead == 1))
+    {
+        ss_anim->target_state = TR_STATE_LARA_CRAWL_IDLE; // Stop
+    }
+    else if((next_fc.floor_hit.point[2] >= pos[2] + ent->character->min_step_up_height) ||
+            (next_fc.floor_hit.point[2] <= pos[2] - ent->character->min_step_up_height))
+    {
+        ent->dir_flag = ENT_STAY;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_CRAWL_IDLE, 0);
+    }
+}
+
+static void StateControl_LaraCrawlTurnLeft(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+
+    state->crouch = 0x01;
+    ent->dir_flag = ENT_MOVE_FORWARD;
+    ent->no_fix_skeletal_parts = BODY_PART_HANDS_2 | BODY_PART_HANDS_3 | BODY_PART_LEGS_3;
+    ent->character->rotate_speed_mult = ((ss_anim->prev_frame > 3) && (ss_anim->prev_frame < 14)) ? (1.0f) : (0.0f);
+
+    if((cmd->move[1] != -1) || (state->dead == 1))
+    {
+        ss_anim->target_state = TR_STATE_LARA_CRAWL_IDLE; // stop
+    }
+}
+
+static void StateControl_LaraCrawlTurnRight(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+
+    state->crouch = 0x01;
+    ent->dir_flag = ENT_MOVE_FORWARD;
+    ent->no_fix_skeletal_parts = BODY_PART_HANDS_2 | BODY_PART_HANDS_3 | BODY_PART_LEGS_3;
+    ent->character->rotate_speed_mult = ((ss_anim->prev_frame > 3) && (ss_anim->prev_frame < 14)) ? (1.0f) : (0.0f);
+
+    if((cmd->move[1] != 1) || (state->dead == 1))
+    {
+        ss_anim->target_state = TR_STATE_LARA_CRAWL_IDLE; // stop
+    }
+}
+
+static void StateControl_LaraCrouchTurn(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_state_p state = env->state;
+    character_command_p cmd = env->cmd;
+
+    state->crouch = 0x01;
+    ent->no_fix_skeletal_parts = BODY_PART_HANDS_2 | BODY_PART_HANDS_3 | BODY_PART_LEGS_3;
+    ent->character->rotate_speed_mult = ((ss_anim->prev_frame > 3) && (ss_anim->prev_frame < 23)) ? (0.6f) : (0.0f);
+
+    if((cmd->move[1] == 0) || (state->dead == 1))
+    {
+        ss_anim->target_state = TR_STATE_LARA_CROUCH_IDLE;
+    }
+}
+
+/*
+ * CLIMB MONKEY
+ */
+static void StateControl_LaraMonkeyswingIdle(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    height_info_p curr_fc = env->curr_fc;
+    int clean_action = env->clean_action;
+    float *pos = ent->transform.M4x4 + 12;
+
+    cmd->rot[0] = 0;
+    ent->dir_flag = ENT_STAY;
+    ///@FIXME: stick for TR_III+ monkey swing fix... something wrong with anim 150
+    if(clean_action && (ent->move_type != MOVE_MONKEYSWING) && (curr_fc->ceiling_climb) && (curr_fc->ceiling_hit.hit) && (pos[2] + ent->bf->bb_max[2] > curr_fc->ceiling_hit.point[2] - 96.0f))
+    {
+        ent->move_type = MOVE_MONKEYSWING;
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_MONKEY_IDLE, 0);
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
+        pos[2] = ent->character->height_info.ceiling_hit.point[2] - ent->bf->bb_max[2];
+    }
+
+    if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
+        ent->dir_flag = ENT_STAY;
+        ent->move_type = MOVE_FREE_FALLING;
+    }
+    else if(cmd->shift && (cmd->move[1] ==-1))
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_LEFT;
+    }
+    else if(cmd->shift && (cmd->move[1] == 1))
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_RIGHT;
+    }
+    else if(cmd->move[0] == 1)
+    {
+        ent->dir_flag = ENT_MOVE_FORWARD;
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_FORWARD;
+    }
+    else if(cmd->move[1] ==-1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_TURN_LEFT;
+    }
+    else if(cmd->move[1] == 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_TURN_RIGHT;
+    }
+}
+
+static void StateControl_LaraMonkeyswingTurnLeft(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+
+    ent->character->rotate_speed_mult = 0.5f;
+    if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
+        ent->dir_flag = ENT_STAY;
+        ent->move_type = MOVE_FREE_FALLING;
+    }
+    else if(cmd->move[1] != -1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
+    }
+}
+
+static void StateControl_LaraMonkeyswingTurnRight(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+
+    ent->character->rotate_speed_mult = 0.5f;
+    if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
+        ent->dir_flag = ENT_STAY;
+        ent->move_type = MOVE_FREE_FALLING;
+    }
+    else if(cmd->move[1] != 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
+    }
+}
+
+static void StateControl_LaraMonkeyswingForward(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+
+    ent->character->rotate_speed_mult = 0.45f;
+    ent->dir_flag = ENT_MOVE_FORWARD;
+
+    if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
+        ent->move_type = MOVE_FREE_FALLING;
+    }
+    else if(cmd->move[0] != 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
+    }
+}
+
+static void StateControl_LaraMonkeyswingLeft(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+
+    cmd->rot[0] = 0;
+    ent->dir_flag = ENT_MOVE_LEFT;
+
+    if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
+        ent->move_type = MOVE_FREE_FALLING;
+    }
+    else if(cmd->move[0] != 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
+    }
+}
+
+static void StateControl_LaraMonkeyswingRight(struct entity_s *ent, struct ss_animation_s *ss_anim, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+
+    cmd->rot[0] = 0;
+    ent->dir_flag = ENT_MOVE_RIGHT;
+
+    if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
+    {
+        Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
+        ent->move_type = MOVE_FREE_FALLING;
+    }
+    else if(cmd->move[0] != 1)
+    {
+        ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
+    }
+}
+
+/*
+ * intermediate animations are processed automatically.
+ */
+static void StateControl_LaraDefault(struct entity_s *ent, struct ss_animation_s * /*ss_anim*/, lara_env_p env)
+{
+    character_command_p cmd = env->cmd;
+    int clean_action = env->clean_action;
+
+    cmd->rot[0] = 0;
+    if((ent->move_type == MOVE_MONKEYSWING) || (ent->move_type == MOVE_WALLS_CLIMB))
+    {
+        if(!clean_action)
+        {
+            Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
             ent->dir_flag = ENT_STAY;
-            ///@FIXME: stick for TR_III+ monkey swing fix... something wrong with anim 150
-            if(clean_action && (ent->move_type != MOVE_MONKEYSWING) && (curr_fc->ceiling_climb) && (curr_fc->ceiling_hit.hit) && (pos[2] + ent->bf->bb_max[2] > curr_fc->ceiling_hit.point[2] - 96.0f))
-            {
-                ent->move_type = MOVE_MONKEYSWING;
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_MONKEY_IDLE, 0);
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
-                pos[2] = ent->character->height_info.ceiling_hit.point[2] - ent->bf->bb_max[2];
-            }
+            ent->move_type = MOVE_FREE_FALLING;
+        }
+    }
+}
 
-            if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
-                ent->dir_flag = ENT_STAY;
-                ent->move_type = MOVE_FREE_FALLING;
-            }
-            else if(cmd->shift && (cmd->move[1] ==-1))
-            {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_LEFT;
-            }
-            else if(cmd->shift && (cmd->move[1] == 1))
-            {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_RIGHT;
-            }
-            else if(cmd->move[0] == 1)
-            {
-                ent->dir_flag = ENT_MOVE_FORWARD;
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_FORWARD;
-            }
-            else if(cmd->move[1] ==-1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_TURN_LEFT;
-            }
-            else if(cmd->move[1] == 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_TURN_RIGHT;
-            }
-            break;
+static lara_state_handler_t lara_state_handlers[LARA_STATES_COUNT] = {0};
 
-        case TR_STATE_LARA_MONKEYSWING_TURN_LEFT:
-            ent->character->rotate_speed_mult = 0.5f;
-            if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
-                ent->dir_flag = ENT_STAY;
-                ent->move_type = MOVE_FREE_FALLING;
-            }
-            else if(cmd->move[1] != -1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
-            }
-            break;
+static void StateControl_LaraInitHandlers()
+{
+    lara_state_handlers[TR_STATE_LARA_DEATH] = StateControl_LaraDeath;
+    lara_state_handlers[TR_STATE_LARA_STOP] = StateControl_LaraStop;
+    lara_state_handlers[TR_STATE_LARA_JUMP_PREPARE] = StateControl_LaraJumpPrepare;
+    lara_state_handlers[TR_STATE_LARA_JUMP_BACK] = StateControl_LaraJumpBack;
+    lara_state_handlers[TR_STATE_LARA_JUMP_LEFT] = StateControl_LaraJumpLeft;
+    lara_state_handlers[TR_STATE_LARA_JUMP_RIGHT] = StateControl_LaraJumpRight;
+    lara_state_handlers[TR_STATE_LARA_RUN_BACK] = StateControl_LaraRunBack;
+    lara_state_handlers[TR_STATE_LARA_TURN_LEFT_SLOW] = StateControl_LaraTurnSlow;
+    lara_state_handlers[TR_STATE_LARA_TURN_RIGHT_SLOW] = StateControl_LaraTurnSlow;
+    lara_state_handlers[TR_STATE_LARA_TURN_FAST] = StateControl_LaraTurnFast;
+    lara_state_handlers[TR_STATE_LARA_RUN_FORWARD] = StateControl_LaraRunForward;
+    lara_state_handlers[TR_STATE_LARA_SPRINT] = StateControl_LaraSprint;
+    lara_state_handlers[TR_STATE_LARA_WALK_FORWARD] = StateControl_LaraWalkForward;
+    lara_state_handlers[TR_STATE_LARA_WADE_FORWARD] = StateControl_LaraWadeForward;
+    lara_state_handlers[TR_STATE_LARA_WALK_BACK] = StateControl_LaraWalkBack;
+    lara_state_handlers[TR_STATE_LARA_WALK_LEFT] = StateControl_LaraWalkLeft;
+    lara_state_handlers[TR_STATE_LARA_WALK_RIGHT] = StateControl_LaraWalkRight;
+    lara_state_handlers[TR_STATE_LARA_SLIDE_BACK] = StateControl_LaraSlideBack;
+    lara_state_handlers[TR_STATE_LARA_SLIDE_FORWARD] = StateControl_LaraSlideForward;
+    lara_state_handlers[TR_STATE_LARA_PUSHABLE_GRAB] = StateControl_LaraPushableGrab;
+    lara_state_handlers[TR_STATE_LARA_PUSHABLE_PUSH] = StateControl_LaraPushablePush;
+    lara_state_handlers[TR_STATE_LARA_PUSHABLE_PULL] = StateControl_LaraPushablePull;
+    lara_state_handlers[TR_STATE_LARA_ROLL_FORWARD] = StateControl_LaraNoControl;
+    lara_state_handlers[TR_STATE_LARA_ROLL_BACKWARD] = StateControl_LaraRollBackward;
+    lara_state_handlers[TR_STATE_LARA_JUMP_UP] = StateControl_LaraJumpUp;
+    lara_state_handlers[TR_STATE_LARA_REACH] = StateControl_LaraReach;
+    lara_state_handlers[TR_STATE_LARA_HANDSTAND] = StateControl_LaraGrabbing;
+    lara_state_handlers[TR_STATE_LARA_GRABBING] = StateControl_LaraGrabbing;
+    lara_state_handlers[TR_STATE_LARA_CLIMB_TO_CRAWL] = StateControl_LaraGrabbing;
+    lara_state_handlers[TR_STATE_LARA_HANG] = StateControl_LaraHang;
+    lara_state_handlers[TR_STATE_LARA_ZIPLINE_RIDE] = StateControl_LaraZiplineRide;
+    lara_state_handlers[TR_STATE_LARA_LADDER_IDLE] = StateControl_LaraLadderIdle;
+    lara_state_handlers[TR_STATE_LARA_LADDER_LEFT] = StateControl_LaraLadderLeft;
+    lara_state_handlers[TR_STATE_LARA_LADDER_RIGHT] = StateControl_LaraLadderRight;
+    lara_state_handlers[TR_STATE_LARA_LADDER_UP] = StateControl_LaraLadderUp;
+    lara_state_handlers[TR_STATE_LARA_LADDER_DOWN] = StateControl_LaraLadderDown;
+    lara_state_handlers[TR_STATE_LARA_SHIMMY_LEFT] = StateControl_LaraShimmyLeft;
+    lara_state_handlers[TR_STATE_LARA_SHIMMY_RIGHT] = StateControl_LaraShimmyRight;
+    lara_state_handlers[TR_STATE_LARA_JUMP_FORWARD] = StateControl_LaraJumpForward;
+    lara_state_handlers[TR_STATE_LARA_FALL_BACKWARD] = StateControl_LaraJumpForward;
+    lara_state_handlers[TR_STATE_LARA_UNDERWATER_DIVING] = StateControl_LaraNoControl;
+    lara_state_handlers[TR_STATE_LARA_FREEFALL] = StateControl_LaraFreefall;
+    lara_state_handlers[TR_STATE_LARA_SWANDIVE_BEGIN] = StateControl_LaraSwandiveBegin;
+    lara_state_handlers[TR_STATE_LARA_SWANDIVE_END] = StateControl_LaraSwandiveEnd;
+    lara_state_handlers[TR_STATE_LARA_UNDERWATER_STOP] = StateControl_LaraUnderwaterStop;
+    lara_state_handlers[TR_STATE_LARA_WATER_DEATH] = StateControl_LaraWaterDeath;
+    lara_state_handlers[TR_STATE_LARA_UNDERWATER_FORWARD] = StateControl_LaraUnderwaterForward;
+    lara_state_handlers[TR_STATE_LARA_UNDERWATER_INERTIA] = StateControl_LaraUnderwaterInertia;
+    lara_state_handlers[TR_STATE_LARA_ONWATER_STOP] = StateControl_LaraOnwaterStop;
+    lara_state_handlers[TR_STATE_LARA_ONWATER_EXIT] = StateControl_LaraOnwaterExit;
+    lara_state_handlers[TR_STATE_LARA_ONWATER_FORWARD] = StateControl_LaraOnwaterForward;
+    lara_state_handlers[TR_STATE_LARA_ONWATER_BACK] = StateControl_LaraOnwaterBack;
+    lara_state_handlers[TR_STATE_LARA_ONWATER_LEFT] = StateControl_LaraOnwaterLeft;
+    lara_state_handlers[TR_STATE_LARA_ONWATER_RIGHT] = StateControl_LaraOnwaterRight;
+    lara_state_handlers[TR_STATE_LARA_CROUCH_IDLE] = StateControl_LaraCrouchIdle;
+    lara_state_handlers[TR_STATE_LARA_CROUCH_ROLL] = StateControl_LaraCrouchRoll;
+    lara_state_handlers[TR_STATE_LARA_SPRINT_ROLL] = StateControl_LaraCrouchRoll;
+    lara_state_handlers[TR_STATE_LARA_CRAWL_IDLE] = StateControl_LaraCrawlIdle;
+    lara_state_handlers[TR_STATE_LARA_CRAWL_TO_CLIMB] = StateControl_LaraCrawlToClimb;
+    lara_state_handlers[TR_STATE_LARA_CRAWL_FORWARD] = StateControl_LaraCrawlForward;
+    lara_state_handlers[TR_STATE_LARA_CRAWL_BACK] = StateControl_LaraCrawlBack;
+    lara_state_handlers[TR_STATE_LARA_CRAWL_TURN_LEFT] = StateControl_LaraCrawlTurnLeft;
+    lara_state_handlers[TR_STATE_LARA_CRAWL_TURN_RIGHT] = StateControl_LaraCrawlTurnRight;
+    lara_state_handlers[TR_STATE_LARA_CROUCH_TURN_LEFT] = StateControl_LaraCrouchTurn;
+    lara_state_handlers[TR_STATE_LARA_CROUCH_TURN_RIGHT] = StateControl_LaraCrouchTurn;
+    lara_state_handlers[TR_STATE_LARA_MONKEYSWING_IDLE] = StateControl_LaraMonkeyswingIdle;
+    lara_state_handlers[TR_STATE_LARA_MONKEYSWING_TURN_LEFT] = StateControl_LaraMonkeyswingTurnLeft;
+    lara_state_handlers[TR_STATE_LARA_MONKEYSWING_TURN_RIGHT] = StateControl_LaraMonkeyswingTurnRight;
+    lara_state_handlers[TR_STATE_LARA_MONKEYSWING_FORWARD] = StateControl_LaraMonkeyswingForward;
+    lara_state_handlers[TR_STATE_LARA_MONKEYSWING_LEFT] = StateControl_LaraMonkeyswingLeft;
+    lara_state_handlers[TR_STATE_LARA_MONKEYSWING_RIGHT] = StateControl_LaraMonkeyswingRight;
+}
 
-        case TR_STATE_LARA_MONKEYSWING_TURN_RIGHT:
-            ent->character->rotate_speed_mult = 0.5f;
-            if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
-                ent->dir_flag = ENT_STAY;
-                ent->move_type = MOVE_FREE_FALLING;
-            }
-            else if(cmd->move[1] != 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
-            }
-            break;
+int StateControl_Lara(struct entity_s *ent, struct ss_animation_s *ss_anim)
+{
+    lara_env_t env;
+    lara_state_handler_t handler;
+    character_state_p state = &ent->character->state;
+    height_info_p curr_fc = &ent->character->height_info;
 
-        case TR_STATE_LARA_MONKEYSWING_FORWARD:
-            ent->character->rotate_speed_mult = 0.45f;
-            ent->dir_flag = ENT_MOVE_FORWARD;
+    if(!lara_state_handlers[TR_STATE_LARA_STOP])
+    {
+        StateControl_LaraInitHandlers();
+    }
 
-            if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
-                ent->move_type = MOVE_FREE_FALLING;
-            }
-            else if(cmd->move[0] != 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
-            }
-            break;
+    env.state = state;
+    env.cmd = &ent->character->cmd;
+    env.curr_fc = curr_fc;
+    env.climb = &ent->character->climb;
+    env.clean_action = (env.cmd->action && (!state->weapon_ready));
+    ent->no_fix_skeletal_parts = BODY_PART_LEGS_2 | BODY_PART_LEGS_3 | BODY_PART_HANDS_3;
+    ent->character->rotate_speed_mult = 1.0f;
 
-        case TR_STATE_LARA_MONKEYSWING_LEFT:
-            cmd->rot[0] = 0;
-            ent->dir_flag = ENT_MOVE_LEFT;
+    ss_anim->anim_frame_flags = ANIM_NORMAL_CONTROL;
 
-            if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
-                ent->move_type = MOVE_FREE_FALLING;
-            }
-            else if(cmd->move[0] != 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
-            }
-            break;
+    env.low_vertical_space = (curr_fc->floor_hit.hit && curr_fc->ceiling_hit.hit && (curr_fc->ceiling_hit.point[2] - curr_fc->floor_hit.point[2] < ent->character->height - LARA_HANG_VERTICAL_EPSILON));
+    env.is_last_frame = ss_anim->model->animations[ss_anim->prev_animation].max_frame <= ss_anim->prev_frame + 1;
+    env.current_state = Anim_GetCurrentState(ss_anim);
 
-        case TR_STATE_LARA_MONKEYSWING_RIGHT:
-            cmd->rot[0] = 0;
-            ent->dir_flag = ENT_MOVE_RIGHT;
+    state->ragdoll = 0x00;
+    state->sprint = 0x00;
+    state->crouch = 0x00;
+    state->tightrope = (env.current_state >= TR_STATE_LARA_TIGHTROPE_IDLE) && (env.current_state <= TR_STATE_LARA_TIGHTROPE_EXIT);
 
-            if((ent->move_type != MOVE_MONKEYSWING) || !clean_action)
-            {
-                Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_TRY_HANG_VERTICAL, 0);
-                ent->move_type = MOVE_FREE_FALLING;
-            }
-            else if(cmd->move[0] != 1)
-            {
-                ss_anim->target_state = TR_STATE_LARA_MONKEYSWING_IDLE;
-            }
-            break;
+    if(ent->character->state.weapon_ready && !StateControl_LaraCanUseWeapon(ent, ent->character->weapon_id))
+    {
+        state->weapon_ready = 0x00;
+    }
 
-            /*
-             * intermediate animations are processed automatically.
-             */
-        default:
-            cmd->rot[0] = 0;
-            if((ent->move_type == MOVE_MONKEYSWING) || (ent->move_type == MOVE_WALLS_CLIMB))
-            {
-                if(!clean_action)
-                {
-                    Entity_SetAnimation(ent, ANIM_TYPE_BASE, TR_ANIMATION_LARA_START_FREE_FALL, 0);
-                    ent->dir_flag = ENT_STAY;
-                    ent->move_type = MOVE_FREE_FALLING;
-                }
-            }
-            break;
-    };
+    // states without handler are processed by default one
+    handler = (env.current_state < LARA_STATES_COUNT) ? (lara_state_handlers[env.current_state]) : (NULL);
+    handler = (handler) ? (handler) : (StateControl_LaraDefault);
+    handler(ent, ss_anim, &env);
 
     /*
      * additional animations control
@@ -3197,6 +3670,7 @@ int StateControl_Lara(struct entity_s *ent, struct ss_animation_s *ss_anim)
     return 0;
 }
 
+
 /*
  * Weapon routine handling
  */
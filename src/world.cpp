@@ -29,10 +29,13 @@ extern "C" {
 #include "gui/gui_inventory.h"
 #include "vt/vt_level.h"
 #include "room.h"
+#include "room_zones.h"
 #include "world.h"
 #include "mesh.h"
 #include "skeletal_model.h"
 #include "entity.h"
+#include "entity_grid.h"
+#include "room_grid.h"
 #include "character_controller.h"
 #include "engine.h"
 #include "gameflow.h"
@@ -79,9 +82,28 @@ extern "C" {
     struct entity_s                *player;                 // this is an unique Lara's pointer =)
     struct skeletal_model_s        *sky_box;                // global skybox
 
-    struct avl_header_s             entity_tree;
+    struct
+    {
+        uint32_t                    size;                   // ids table size
+        uint32_t                    count;                  // entities in world
+        uint32_t                   *handles;                // entity id -> entity pool handle
+    }                               entities;
     struct avl_header_s             items_tree;
 
+    struct
+    {
+        int32_t                     depth;                  // rooms graph distance from player, < 0 - all entities are active
+        int32_t                     need_update;
+        struct room_s              *center_room;
+        uint32_t                    size;
+        uint32_t                    count;                  // active entities count
+        uint32_t                    sleeping_count;
+        struct entity_s           **entities;               // dense active entities array, NULL for removed
+        uint16_t                   *room_dist;
+        uint32_t                   *room_queue;
+        float                       update_time;            // ms, last list rebuild
+    }                               activation;
+
     uint32_t                        type;
 
     uint32_t                        cameras_sinks_count;    // Amount of cameras and sinks.
@@ -93,6 +115,14 @@ extern "C" {
     struct flyby_camera_sequence_s *flyby_camera_sequences;
 } global_world;
 
+static struct
+{
+    uint32_t                        queries;
+    uint32_t                        geometry_hits;
+    uint32_t                        refines;                // bullet rays for segment tail
+    uint32_t                        fallbacks;              // whole segment bullet rays
+} long_ray_stats = {0};
+
 
 // private load level functions prototypes:
 void World_SetEntityModelProperties(struct entity_s *ent);
@@ -125,8 +155,8 @@ void World_GenRoomCollision();
 void World_FixRooms();
 void World_BuildNearRoomsList(struct room_s *room);
 void World_BuildOverlappedRoomsList(struct room_s *room);
+static void World_RemoveActiveEntity(struct entity_s *ent);
 
-extern "C" void AVL_DeleteEntity(void *p) { Entity_Delete((entity_p)p); }
 extern "C" void AVL_DeleteItem(void *p) { BaseItem_Delete((base_item_p)p); }
 
 void World_Prepare()
@@ -168,10 +198,21 @@ void World_Prepare()
     global_world.skeletal_models = NULL;
     global_world.skeletal_models_count = 0;
     global_world.sky_box = NULL;
-    AVL_Init(&global_world.entity_tree);
-    global_world.entity_tree.free_data = AVL_DeleteEntity;
+    global_world.entities.size = 0;
+    global_world.entities.count = 0;
+    global_world.entities.handles = NULL;
     AVL_Init(&global_world.items_tree);
     global_world.items_tree.free_data = AVL_DeleteItem;
+    global_world.activation.depth = -1;
+    global_world.activation.need_update = 1;
+    global_world.activation.center_room = NULL;
+    global_world.activation.size = 0;
+    global_world.activation.count = 0;
+    global_world.activation.sleeping_count = 0;
+    global_world.activation.entities = NULL;
+    global_world.activation.room_dist = NULL;
+    global_world.activation.room_queue = NULL;
+    global_world.activation.update_time = 0.0f;
 }
 
 
@@ -236,6 +277,7 @@ void World_Open(const char *path, int trv)
     Gui_DrawLoadScreen(800);
 
     World_GenRoomCollision();
+    RoomGrid_Build(global_world.rooms, global_world.rooms_count);
     Gui_DrawLoadScreen(850);
 
     // Find and set skybox.
@@ -243,9 +285,13 @@ void World_Open(const char *path, int trv)
     Gui_DrawLoadScreen(860);
 
     // Generate entity functions.
-    for(avl_node_p p = global_world.entity_tree.list; p; p = p->next)
+    for(uint32_t i = 0; i < global_world.entities.size; i++)
     {
-        World_SetEntityFunction((entity_p)p->data);
+        entity_p ent = Entity_GetByHandle(global_world.entities.handles[i]);
+        if(ent)
+        {
+            World_SetEntityFunction(ent);
+        }
     }
     Gui_DrawLoadScreen(910);
 
@@ -294,7 +340,23 @@ void World_Clear()
     global_world.player = NULL;
 
     /* entity empty must be done before rooms destroy */
-    AVL_MakeEmpty(&global_world.entity_tree);
+    for(uint32_t i = 0; i < global_world.entities.size; i++)
+    {
+        Entity_Delete(Entity_GetByHandle(global_world.entities.handles[i]));
+    }
+    free(global_world.entities.handles);
+    global_world.entities.handles = NULL;
+    global_world.entities.size = 0;
+    global_world.entities.count = 0;
+    global_world.activation.need_update = 1;
+    global_world.activation.center_room = NULL;
+    global_world.activation.count = 0;
+    global_world.activation.sleeping_count = 0;
+    free(global_world.activation.room_dist);
+    free(global_world.activation.room_queue);
+    global_world.activation.room_dist = NULL;
+    global_world.activation.room_queue = NULL;
+    EntityGrid_Clear();
 
     /* Now we can delete physics misc objects */
     Physics_CleanUpObjects();
@@ -323,6 +385,9 @@ void World_Clear()
         free(global_world.room_boxes);
         global_world.room_boxes = NULL;
     }
+    Room_ClearPathSearch();
+    Zones_Clear();
+    RoomGrid_Clear();
 
     if(global_world.overlaps_count)
     {
@@ -473,11 +538,13 @@ uint32_t World_SpawnEntity(uint32_t model_id, uint32_t room_id, float pos[3], fl
         entity = Entity_Create();
         if(id < 0)
         {
-            avl_node_p max = global_world.entity_tree.root;
-            while(max)
+            for(uint32_t i = global_world.entities.size; i > 0; i--)
             {
-                entity->id = max->key + 1;
-                max = max->right;
+                if(Entity_GetByHandle(global_world.entities.handles[i - 1]))
+                {
+                    entity->id = i;
+                    break;
+                }
             }
         }
         else
@@ -527,8 +594,11 @@ uint32_t World_SpawnEntity(uint32_t model_id, uint32_t room_id, float pos[3], fl
         {
             Room_AddObject(entity->self->room, entity->self);
         }
-        World_AddEntity(entity);
-        return entity->id;
+        if(World_AddEntity(entity))
+        {
+            return entity->id;
+        }
+        Entity_Delete(entity);
     }
 
     return ENTITY_ID_NONE;
@@ -537,8 +607,7 @@ uint32_t World_SpawnEntity(uint32_t model_id, uint32_t room_id, float pos[3], fl
 
 struct entity_s *World_GetEntityByID(uint32_t id)
 {
-    avl_node_p p = AVL_SearchNode(&global_world.entity_tree, id);
-    return (p) ? ((entity_p)p->data) : (NULL);
+    return (id < global_world.entities.size) ? (Entity_GetByHandle(global_world.entities.handles[id])) : (NULL);
 }
 
 
@@ -567,25 +636,241 @@ struct entity_s *World_GetPlayer()
 
 void World_IterateAllEntities(int (*iterator)(struct entity_s *ent, void *data), void *data)
 {
-    for(avl_node_p p = global_world.entity_tree.list; p; )
+    for(uint32_t i = 0; i < global_world.entities.size; i++)
     {
-        entity_p ent = (entity_p)p->data;
+        entity_p ent = Entity_GetByHandle(global_world.entities.handles[i]);
+        if(!ent)
+        {
+            continue;
+        }
         if(ent->state_flags & ENTITY_STATE_DELETED)
         {
-            avl_node_p next = p->next;
-            AVL_DeleteNode(&global_world.entity_tree, p);
-            p = next;
+            World_DeleteEntity(ent->id);
             continue;
         }
         if(iterator(ent, data))
         {
             break;
         }
-        p = p->next;
     }
 }
 
 
+/*
+ * ENTITIES ACTIVATION
+ * Entities placed farther than activation depth (in rooms, by portals) from
+ * the player's room are sleeping: they are not iterated by frame update.
+ * Sleeping entities are woken by player's room change, trigger or script.
+ */
+static void World_RemoveActiveEntity(struct entity_s *ent)
+{
+    for(uint32_t i = 0; i < global_world.activation.count; i++)
+    {
+        if(global_world.activation.entities[i] == ent)
+        {
+            global_world.activation.entities[i] = NULL;
+            break;
+        }
+    }
+    global_world.activation.need_update = 1;
+}
+
+
+static void World_UpdateRoomsDistance(struct room_s *center_room, uint16_t max_dist)
+{
+    uint32_t queue_begin = 0;
+    uint32_t queue_end = 0;
+
+    if(!global_world.activation.room_dist)
+    {
+        global_world.activation.room_dist = (uint16_t*)malloc(global_world.rooms_count * sizeof(uint16_t));
+        global_world.activation.room_queue = (uint32_t*)malloc(global_world.rooms_count * sizeof(uint32_t));
+    }
+    for(uint32_t i = 0; i < global_world.rooms_count; i++)
+    {
+        global_world.activation.room_dist[i] = 0xFFFF;
+    }
+
+    global_world.activation.room_dist[center_room->id] = 0;
+    global_world.activation.room_queue[queue_end++] = center_room->id;
+    while(queue_begin < queue_end)
+    {
+        room_p r = global_world.rooms + global_world.activation.room_queue[queue_begin++];
+        uint16_t dist = global_world.activation.room_dist[r->id] + 1;
+        if(dist > max_dist)
+        {
+            continue;
+        }
+        for(uint32_t i = 0; i < r->content->portals_count; i++)
+        {
+            room_p dest = r->content->portals[i].dest_room;
+            for(int j = 0; dest && (j < 2); j++, dest = dest->real_room)
+            {
+                if(global_world.activation.room_dist[dest->id] > dist)
+                {
+                    global_world.activation.room_dist[dest->id] = dist;
+                    global_world.activation.room_queue[queue_end++] = dest->id;
+                }
+            }
+        }
+    }
+}
+
+
+static int World_IsEntityInActivationRegion(struct entity_s *ent)
+{
+    room_p room = ent->self->room;
+    if((global_world.activation.depth < 0) || !global_world.activation.center_room ||
+       (ent == global_world.player) || !room || (ent->awake_time > 0.0f) ||
+       (ent->type_flags & ENTITY_TYPE_DYNAMIC))
+    {
+        return 1;
+    }
+
+    return global_world.activation.room_dist[room->id] <= global_world.activation.depth;
+}
+
+
+static void World_BuildActiveEntitiesList()
+{
+    uint64_t start = SDL_GetPerformanceCounter();
+
+    if(global_world.activation.size < global_world.entities.count)
+    {
+        global_world.activation.size = global_world.entities.count + 64;
+        global_world.activation.entities = (entity_p*)realloc(global_world.activation.entities, global_world.activation.size * sizeof(entity_p));
+    }
+
+    if((global_world.activation.depth >= 0) && global_world.activation.center_room)
+    {
+        World_UpdateRoomsDistance(global_world.activation.center_room, global_world.activation.depth);
+    }
+
+    global_world.activation.count = 0;
+    global_world.activation.sleeping_count = 0;
+    EntityGrid_Clear();
+    for(uint32_t i = 0; i < global_world.entities.size; i++)
+    {
+        entity_p ent = Entity_GetByHandle(global_world.entities.handles[i]);
+        if(!ent)
+        {
+            continue;
+        }
+        if(ent->state_flags & ENTITY_STATE_DELETED)
+        {
+            global_world.entities.handles[i] = ENTITY_HANDLE_NONE;
+            global_world.entities.count--;
+            Entity_Delete(ent);
+        }
+        else if(World_IsEntityInActivationRegion(ent))
+        {
+            global_world.activation.entities[global_world.activation.count++] = ent;
+            EntityGrid_Add(ent);
+        }
+        else
+        {
+            global_world.activation.sleeping_count++;
+        }
+    }
+    global_world.activation.need_update = 0;
+    global_world.activation.update_time = 1000.0f * (float)(SDL_GetPerformanceCounter() - start) / (float)SDL_GetPerformanceFrequency();
+}
+
+
+void World_SetActivationDepth(int32_t depth)
+{
+    global_world.activation.depth = (depth < 0) ? (-1) : ((depth > 0xFFFE) ? (0xFFFE) : (depth));
+    global_world.activation.need_update = 1;
+}
+
+
+int32_t World_GetActivationDepth()
+{
+    return global_world.activation.depth;
+}
+
+
+void World_WakeEntity(struct entity_s *ent, float time)
+{
+    if(ent)
+    {
+        ent->awake_time = (ent->awake_time > time) ? (ent->awake_time) : (time);
+        ent->awake_time = (ent->awake_time > ent->timer) ? (ent->awake_time) : (ent->timer);
+        if((global_world.activation.depth >= 0) && global_world.activation.center_room)
+        {
+            global_world.activation.need_update = 1;
+        }
+    }
+}
+
+
+void World_UpdateActiveEntities(float time)
+{
+    room_p center_room = (global_world.player) ? (global_world.player->self->room) : (NULL);
+    if(center_room != global_world.activation.center_room)
+    {
+        global_world.activation.center_room = center_room;
+        global_world.activation.need_update = 1;
+    }
+
+    for(uint32_t i = 0; i < global_world.activation.count; i++)
+    {
+        entity_p ent = global_world.activation.entities[i];
+        if(ent && (ent->awake_time > 0.0f))
+        {
+            ent->awake_time -= time;
+            if(ent->awake_time <= 0.0f)
+            {
+                ent->awake_time = 0.0f;
+                global_world.activation.need_update |= (global_world.activation.depth >= 0);
+            }
+        }
+    }
+
+    if(global_world.activation.need_update)
+    {
+        World_BuildActiveEntitiesList();
+    }
+}
+
+
+void World_IterateActiveEntities(int (*iterator)(struct entity_s *ent, void *data), void *data)
+{
+    uint32_t count;
+    if(global_world.activation.need_update)
+    {
+        World_BuildActiveEntitiesList();
+    }
+
+    count = global_world.activation.count;                                      // entities added by iterator are taken on the next rebuild
+    for(uint32_t i = 0; i < count; i++)
+    {
+        entity_p ent = global_world.activation.entities[i];
+        if(!ent)
+        {
+            continue;
+        }
+        if(ent->state_flags & ENTITY_STATE_DELETED)
+        {
+            global_world.activation.need_update = 1;                            // frame update lists may still hold it, freed on rebuild
+            continue;
+        }
+        if(iterator(ent, data))
+        {
+            break;
+        }
+    }
+}
+
+
+void World_GetActivationStats(uint32_t *active, uint32_t *sleeping, float *update_time)
+{
+    *active = global_world.activation.count;
+    *sleeping = global_world.activation.sleeping_count;
+    *update_time = global_world.activation.update_time;
+}
+
+
 struct flyby_camera_sequence_s *World_GetFlyBySequences()
 {
     return global_world.flyby_camera_sequences;
@@ -694,16 +979,73 @@ int World_AddAnimSeq(struct anim_seq_s *seq)
 
 int World_AddEntity(struct entity_s *entity)
 {
-    return (AVL_InsertReplace(&global_world.entity_tree, entity->id, entity)) ? (0x01) : (0x00);
+    entity_p old_entity;
+
+    if(entity->id >= WORLD_MAX_ENTITY_ID)
+    {
+        Con_Warning("entity id %d is out of range, max = %d", entity->id, WORLD_MAX_ENTITY_ID - 1);
+        return 0x00;
+    }
+
+    if(entity->id >= global_world.entities.size)
+    {
+        uint32_t new_size = (global_world.entities.size) ? (global_world.entities.size) : (256);
+        while(new_size <= entity->id)
+        {
+            new_size *= 2;
+        }
+        global_world.entities.handles = (uint32_t*)realloc(global_world.entities.handles, new_size * sizeof(uint32_t));
+        for(uint32_t i = global_world.entities.size; i < new_size; i++)
+        {
+            global_world.entities.handles[i] = ENTITY_HANDLE_NONE;
+        }
+        global_world.entities.size = new_size;
+    }
+
+    old_entity = Entity_GetByHandle(global_world.entities.handles[entity->id]);
+    if(old_entity != entity)
+    {
+        if(old_entity)
+        {
+            World_RemoveActiveEntity(old_entity);                               // replaced
+            Entity_Delete(old_entity);
+            global_world.entities.count--;
+        }
+        global_world.entities.handles[entity->id] = entity->handle;
+        global_world.entities.count++;
+    }
+    global_world.activation.need_update = 1;
+
+    return 0x01;
 }
 
 
 int World_DeleteEntity(uint32_t id)
 {
-    avl_node_p p = AVL_SearchNode(&global_world.entity_tree, id);
-    if(p)
+    entity_p ent = World_GetEntityByID(id);
+    if(ent)
     {
-        AVL_DeleteNode(&global_world.entity_tree, p);
+        World_RemoveActiveEntity(ent);
+        global_world.entities.handles[id] = ENTITY_HANDLE_NONE;
+        global_world.entities.count--;
+        Entity_Delete(ent);
+        return 1;
+    }
+    return 0;
+}
+
+
+/*
+ * Safe to call from entity logic / scripts during frame update: entity stays
+ * valid for the rest of the frame and is freed on the next active list rebuild.
+ */
+int World_MarkEntityDeleted(uint32_t id)
+{
+    entity_p ent = World_GetEntityByID(id);
+    if(ent)
+    {
+        ent->state_flags |= ENTITY_STATE_DELETED;
+        global_world.activation.need_update = 1;
         return 1;
     }
     return 0;
@@ -823,9 +1165,24 @@ struct room_s *World_GetRoomByID(uint32_t id)
 
 
 struct room_s *World_FindRoomByPos(float pos[3])
+{
+    if(RoomGrid_IsBuilt())
+    {
+        return RoomGrid_FindRoom(pos);
+    }
+
+    RoomGrid_CountFallbackScan();
+    return World_FindRoomByPosScan(pos);
+}
+
+/*
+ * Full rooms scan, rooms grid reference.
+ */
+struct room_s *World_FindRoomByPosScan(float pos[3])
 {
     const float z_margin = TR_METERING_SECTORSIZE / 2.0f;
     room_p r = global_world.rooms;
+
     for(uint32_t i = 0; i < global_world.rooms_count; i++, r++)
     {
         if((r == r->real_room) &&
@@ -893,6 +1250,117 @@ struct room_s *World_FindRoomByPosCogerrence(float pos[3], struct room_s *old_ro
 }
 
 
+/*
+ * Line of sight test: rooms geometry by sectors DDA (Room_LongRayTest), then
+ * OBB of entities and static meshes in passed rooms; bullet ray is used only
+ * for the tail of segment, from the nearest OBB candidate to geometry hit.
+ * Normale is approximate (opposite to ray direction) for rooms hits. Without
+ * rooms in filter or out of rooms it is the same as Physics_RayTest.
+ */
+int World_LongRayTest(struct collision_result_s *result, float from[3], float to[3], struct engine_container_s *cont, int16_t filter)
+{
+    struct room_s *rooms[WORLD_LONG_RAY_MAX_ROOMS];
+    struct room_s *room = (cont && cont->room) ? (cont->room->real_room) : (NULL);
+    engine_container_p hit_obj = NULL;
+    float dir[3], geom_fraction = 1.0f, obj_fraction = 1.0f;
+    int rooms_count = 0;
+
+    long_ray_stats.queries++;
+    if(!room || !Room_GetSectorRaw(room, from))
+    {
+        room = World_FindRoomByPos(from);
+    }
+    if(!room || !(filter & COLLISION_GROUP_STATIC_ROOM))
+    {
+        long_ray_stats.fallbacks++;
+        return Physics_RayTest(result, from, to, cont, filter);
+    }
+
+    vec3_sub(dir, to, from);
+    if(Room_LongRayTest(&room, from, to, &geom_fraction, rooms, &rooms_count, WORLD_LONG_RAY_MAX_ROOMS))
+    {
+        hit_obj = room->self;
+        long_ray_stats.geometry_hits++;
+    }
+
+    for(int i = 0; i < rooms_count; i++)
+    {
+        room_p r = rooms[i];
+        float t;
+        if(filter & COLLISION_GROUP_STATIC_OBLECT)
+        {
+            for(uint32_t j = 0; j < r->content->static_mesh_count; j++)
+            {
+                static_mesh_p sm = r->content->static_mesh + j;
+                if(sm->physics_body && sm->self && (sm->self->collision_group & filter) &&
+                   OBB_RayTest(sm->obb, from, to, &t) && (t < obj_fraction))
+                {
+                    obj_fraction = t;
+                }
+            }
+        }
+        for(engine_container_p c = r->containers; c; c = c->next)
+        {
+            if((c != cont) && (c->object_type == OBJECT_ENTITY) && (c->collision_group & filter))
+            {
+                entity_p ent = (entity_p)c->object;
+                if((ent->state_flags & ENTITY_STATE_ENABLED) && OBB_RayTest(ent->obb, from, to, &t) && (t < obj_fraction))
+                {
+                    obj_fraction = t;
+                }
+            }
+        }
+    }
+
+    if(obj_fraction < geom_fraction)
+    {
+        collision_result_t cs;
+        float len, tail_from[3], tail_to[3];
+        len = vec3_abs(dir);
+        obj_fraction -= (len > 0.0f) ? (WORLD_LONG_RAY_TAIL_MARGIN / len) : (0.0f);
+        obj_fraction = (obj_fraction > 0.0f) ? (obj_fraction) : (0.0f);
+        vec3_add_mul(tail_from, from, dir, obj_fraction);
+        vec3_add_mul(tail_to, from, dir, geom_fraction);
+        long_ray_stats.refines++;
+        if(Physics_RayTest(&cs, tail_from, tail_to, cont, filter & ~COLLISION_GROUP_STATIC_ROOM))
+        {
+            if(result)
+            {
+                *result = cs;
+                result->fraction = obj_fraction + cs.fraction * (geom_fraction - obj_fraction);
+            }
+            return 1;
+        }
+    }
+
+    if(result)
+    {
+        result->obj = hit_obj;
+        result->bone_num = 0;
+        result->hit = (hit_obj) ? (0x01) : (0x00);
+        result->fraction = geom_fraction;
+        vec3_copy_inv(result->normale, dir);
+        if(vec3_abs(result->normale) > 0.0f)
+        {
+            float t;
+            vec3_norm(result->normale, t);
+        }
+        vec3_add_mul(result->point, from, dir, geom_fraction);
+    }
+
+    return (hit_obj) ? (1) : (0);
+}
+
+
+void World_GetLongRayStats(uint32_t *queries, uint32_t *geometry_hits, uint32_t *refines, uint32_t *fallbacks)
+{
+    *queries = long_ray_stats.queries;
+    *geometry_hits = long_ray_stats.geometry_hits;
+    *refines = long_ray_stats.refines;
+    *fallbacks = long_ray_stats.fallbacks;
+}
+
+
 struct room_sector_s *World_GetRoomSector(int room_id, int x, int y)
 {
     if((room_id >= 0) && ((uint32_t)room_id < global_world.rooms_count))
@@ -1734,6 +2202,8 @@ void World_GenRoom(struct room_s *room, class VT_Level *tr)
     room->containers = NULL;
     room->is_in_r_list = 0;
     room->is_swapped = 0;
+    room->grid_stamp = 0;
+    room->collision_stamp = 0;
 
     Mat4_E_macro(room->transform);
     TR_vertex_to_arr(room->transform + 12, &tr->rooms[room->id].offset);
@@ -2482,6 +2952,31 @@ void World_GenRoomCollision()
 }
 
 
+void World_GetRoomCollisionStats(int mode, struct room_collision_stats_s *stats)
+{
+    room_p r = global_world.rooms;
+
+    memset(stats, 0x00, sizeof(room_collision_stats_t));
+    for(uint32_t i = 0; r && (i < global_world.rooms_count); i++, r++)
+    {
+        int num_tweens = r->sectors_count * 4;
+        size_t buff_size = num_tweens * sizeof(sector_tween_t);
+        sector_tween_p room_tween = (sector_tween_p)Sys_GetTempMem(buff_size);
+
+        for(int j = 0; j < num_tweens; j++)
+        {
+            room_tween[j].ceiling_tween_type = TR_SECTOR_TWEEN_TYPE_NONE;
+            room_tween[j].floor_tween_type   = TR_SECTOR_TWEEN_TYPE_NONE;
+        }
+
+        num_tweens = Res_Sector_GenStaticTweens(r, room_tween);
+        Physics_GetRoomCollisionStats(r, r->content->sectors, r->sectors_count, room_tween, num_tweens, mode, stats);
+
+        Sys_ReturnTempMem(buff_size);
+    }
+}
+
+
 void World_FixRooms()
 {
     room_p r = global_world.rooms;
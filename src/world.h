@@ -9,6 +9,11 @@
 #define FLIP_STATE_ON       (0x01)
 #define FLIP_STATE_BY_FLAG  (0x03)
 
+#define WORLD_MAX_ENTITY_ID         (0x100000)      // ids table limit, entity with bigger id is not added
+#define WORLD_ACTIVATION_WAKE_TIME  (4.0f)          // seconds entity stays active out of activation region after waking
+#define WORLD_LONG_RAY_MAX_ROOMS    (64)            // rooms for objects tests in long ray
+#define WORLD_LONG_RAY_TAIL_MARGIN  (32.0f)         // bullet tail ray starts before OBB hit
+
 
 void World_Prepare();
 void World_Open(const char *path, int trv);
@@ -20,6 +25,12 @@ struct entity_s *World_GetEntityByID(uint32_t id);
 void World_SetPlayer(struct entity_s *entity);
 struct entity_s *World_GetPlayer();
 void World_IterateAllEntities(int (*iterator)(struct entity_s *ent, void *data), void *data);
+void World_IterateActiveEntities(int (*iterator)(struct entity_s *ent, void *data), void *data);
+void World_SetActivationDepth(int32_t depth);
+int32_t World_GetActivationDepth();
+void World_WakeEntity(struct entity_s *ent, float time);
+void World_UpdateActiveEntities(float time);
+void World_GetActivationStats(uint32_t *active, uint32_t *sleeping, float *update_time);
 struct flyby_camera_sequence_s *World_GetFlyBySequences();
 struct base_item_s *World_GetBaseItemByID(uint32_t id);
 struct base_item_s *World_GetBaseItemByWorldModelID(uint32_t id);
@@ -28,12 +39,14 @@ struct camera_frame_s *World_GetCinematicFrame(uint32_t id);
 
 void World_GetSkeletalModelsInfo(struct skeletal_model_s **models, uint32_t *models_count);
 void World_GetRoomInfo(struct room_s **rooms, uint32_t *rooms_count);
+void World_GetRoomCollisionStats(int mode, struct room_collision_stats_s *stats);
 void World_GetAnimSeqInfo(struct anim_seq_s **seq, uint32_t *seq_count);
 void World_GetFlipInfo(uint8_t **flip_map, uint8_t **flip_state, uint32_t *flip_count);
 
 int World_AddAnimSeq(struct anim_seq_s *seq);
 int World_AddEntity(struct entity_s *entity);
 int World_DeleteEntity(uint32_t id);
+int World_MarkEntityDeleted(uint32_t id);
 int World_CreateItem(uint32_t item_id, uint32_t model_id, uint32_t world_model_id, uint16_t type, uint16_t count, const char *name);
 int World_DeleteItem(uint32_t item_id);
 struct base_mesh_s *World_GetMeshByID(uint32_t ID);
@@ -43,7 +56,10 @@ struct skeletal_model_s* World_GetSkybox();
 
 struct room_s *World_GetRoomByID(uint32_t id);
 struct room_s *World_FindRoomByPos(float pos[3]);
+struct room_s *World_FindRoomByPosScan(float pos[3]);
 struct room_s *World_FindRoomByPosCogerrence(float pos[3], struct room_s *old_room);
+int World_LongRayTest(struct collision_result_s *result, float from[3], float to[3], struct engine_container_s *cont, int16_t filter);
+void World_GetLongRayStats(uint32_t *queries, uint32_t *geometry_hits, uint32_t *refines, uint32_t *fallbacks);
 struct room_sector_s *World_GetRoomSector(int room_id, int x, int y);
 uint32_t World_GetRoomBoxesCount();
 struct room_box_s *World_GetRoomBoxByID(uint32_t id);